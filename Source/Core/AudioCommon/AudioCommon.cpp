@@ -69,9 +69,11 @@ namespace AudioCommon
 			{
 				if (SConfig::GetInstance().m_DumpAudio)
 				{
-					std::string audio_file_name = File::GetUserPath(D_DUMPAUDIO_IDX) + "audiodump.wav";
+					int format = SConfig::GetInstance().m_DumpAudioFormat;
+					std::string audio_file_name = File::GetUserPath(D_DUMPAUDIO_IDX) +
+						(format == AUDIO_DUMP_FLAC ? "audiodump.flac" : "audiodump.wav");
 					File::CreateFullPath(audio_file_name);
-					mixer->StartLogAudio(audio_file_name.c_str());
+					mixer->StartLogAudio(audio_file_name.c_str(), format);
 				}
 
 				return soundStream;
@@ -143,16 +145,10 @@ namespace AudioCommon
 		{
 			// audio typically doesn't maintain its own "paused" state
 			// (that's already handled by the CPU and whatever else being paused)
-			// so it should be good enough to only lock/unlock here.
+			// so it should be good enough to only pause the mixer here.
 			CMixer* pMixer = soundStream->GetMixer();
 			if (pMixer)
-			{
-				std::mutex& csMixing = pMixer->MixerCritical();
-				if (doLock)
-					csMixing.lock();
-				else
-					csMixing.unlock();
-			}
+				pMixer->SetPaused(doLock);
 		}
 	}
 	void UpdateSoundStream()
@@ -0,0 +1,128 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+
+#include "AudioCommon/AudioDumper.h"
+#include "Common/Common.h"
+#include "Common/Thread.h"
+
+// How long the writer sleeps when the ring runs dry
+#define DUMP_POLL_MS 10
+
+AudioDumper::AudioDumper()
+	: m_format(AUDIO_DUMP_WAV)
+	, m_indexW(0)
+	, m_indexR(0)
+	, m_dropped(0)
+	, m_running(false)
+{
+}
+
+AudioDumper::~AudioDumper()
+{
+	Stop();
+}
+
+bool AudioDumper::Start(const char *filename, unsigned int sample_rate, int format)
+{
+	if (IsRunning())
+		return false;
+
+	m_format = format;
+	if (m_format == AUDIO_DUMP_FLAC)
+	{
+		if (!m_flac_writer.Start(filename, sample_rate))
+			return false;
+	}
+	else
+	{
+		if (!m_wave_writer.Start(filename, sample_rate))
+			return false;
+		m_wave_writer.SetSkipSilence(false);
+	}
+
+	// The ring stays allocated once used, so a late AddStereoSamples racing
+	// with Stop never writes to freed memory.
+	if (m_ring.empty())
+		m_ring.resize(DUMP_RING_FRAMES * 2);
+	m_indexW.store(0, std::memory_order_relaxed);
+	m_indexR.store(0, std::memory_order_relaxed);
+	m_dropped.store(0, std::memory_order_relaxed);
+
+	m_running.store(true, std::memory_order_release);
+	m_thread = std::thread(&AudioDumper::WriterThread, this);
+	return true;
+}
+
+void AudioDumper::Stop()
+{
+	if (!m_running.exchange(false))
+		return;
+
+	m_thread.join();
+	while (Drain(DUMP_CHUNK_FRAMES))
+		;
+
+	if (m_format == AUDIO_DUMP_FLAC)
+		m_flac_writer.Stop();
+	else
+		m_wave_writer.Stop();
+
+	u32 dropped = GetDroppedFrames();
+	if (dropped)
+		WARN_LOG(AUDIO, "Audio dump dropped %u frames, the disk could not keep up", dropped);
+}
+
+void AudioDumper::AddStereoSamples(const short *sample_data, u32 count)
+{
+	if (!m_running.load(std::memory_order_acquire))
+		return;
+
+	const u32 indexW = m_indexW.load(std::memory_order_relaxed);
+	const u32 indexR = m_indexR.load(std::memory_order_acquire);
+	if (count > DUMP_RING_FRAMES - (indexW - indexR))
+	{
+		m_dropped.fetch_add(count, std::memory_order_relaxed);
+		return;
+	}
+
+	const u32 pos = indexW & (DUMP_RING_FRAMES - 1);
+	const u32 first = std::min(count, DUMP_RING_FRAMES - pos);
+	memcpy(&m_ring[pos * 2], sample_data, first * 4);
+	memcpy(&m_ring[0], sample_data + first * 2, (count - first) * 4);
+
+	m_indexW.store(indexW + count, std::memory_order_release);
+}
+
+u32 AudioDumper::Drain(u32 max_frames)
+{
+	const u32 indexR = m_indexR.load(std::memory_order_relaxed);
+	const u32 indexW = m_indexW.load(std::memory_order_acquire);
+	const u32 pos = indexR & (DUMP_RING_FRAMES - 1);
+	// Up to the end of the ring, the rest goes in the next call
+	const u32 count = std::min(std::min(indexW - indexR, max_frames), DUMP_RING_FRAMES - pos);
+	if (!count)
+		return 0;
+
+	if (m_format == AUDIO_DUMP_FLAC)
+		m_flac_writer.AddStereoSamples(&m_ring[pos * 2], count);
+	else
+		m_wave_writer.AddStereoSamples(&m_ring[pos * 2], count);
+
+	m_indexR.store(indexR + count, std::memory_order_release);
+	return count;
+}
+
+void AudioDumper::WriterThread()
+{
+	Common::SetCurrentThreadName("Audio dumper");
+
+	while (m_running.load(std::memory_order_acquire))
+	{
+		if (!Drain(DUMP_CHUNK_FRAMES))
+			Common::SleepCurrentThread(DUMP_POLL_MS);
+	}
+}
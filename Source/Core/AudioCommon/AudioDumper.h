@@ -0,0 +1,68 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// ---------------------------------------------------------------------------------
+// Class: AudioDumper
+// Description: Dumps the mixer output to disk without blocking the audio
+// thread. AddStereoSamples copies the frames into a ring, a writer thread
+// drains it into a WAV or FLAC file in big chunks. Frames that don't fit the
+// ring are dropped and counted.
+// ---------------------------------------------------------------------------------
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "AudioCommon/FLACWriter.h"
+#include "AudioCommon/WaveFile.h"
+
+#define DUMP_RING_FRAMES (1 << 18) // ~5s at 48000 Hz
+#define DUMP_CHUNK_FRAMES (64 * 1024)
+
+enum
+{
+	AUDIO_DUMP_WAV = 0,
+	AUDIO_DUMP_FLAC,
+};
+
+class AudioDumper
+{
+public:
+	AudioDumper();
+	~AudioDumper();
+
+	bool Start(const char *filename, unsigned int sample_rate, int format);
+	// Writes out what is left in the ring and closes the file
+	void Stop();
+	bool IsRunning() const { return m_running.load(std::memory_order_relaxed); }
+
+	// Called from the audio thread
+	void AddStereoSamples(const short *sample_data, u32 count);
+
+	u32 GetDroppedFrames() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+	AudioDumper(const AudioDumper&)/* = delete*/;
+	AudioDumper& operator=(const AudioDumper&)/* = delete*/;
+
+	void WriterThread();
+	// Writes up to max_frames from the ring, returns how many
+	u32 Drain(u32 max_frames);
+
+	int m_format;
+	WaveFileWriter m_wave_writer;
+	FLACFileWriter m_flac_writer;
+
+	std::vector<short> m_ring;
+	// Frame counts. Only the audio thread writes m_indexW and only the writer
+	// thread m_indexR.
+	std::atomic<u32> m_indexW;
+	std::atomic<u32> m_indexR;
+	std::atomic<u32> m_dropped;
+
+	std::atomic<bool> m_running;
+	std::thread m_thread;
+};
@@ -7,15 +7,20 @@
 //  * Copyright (c) 2004-2006 Milan Cutka
 //  * based on mplayer HRTF plugin by ylai
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
-#include <functional>
 #include <string.h>
 #include <vector>
 
 #include "AudioCommon/DPL2Decoder.h"
+#include "Common/Common.h"
 #include "Common/MathUtil.h"
 
+#if _M_X86
+#include <emmintrin.h>
+#endif
+
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
@@ -23,6 +28,11 @@
 #define M_SQRT1_2 0.70710678118654752440
 #endif
 
+// Frames decoded per block
+#define DPL2_BLOCK  256
+#define LFE_TAPS    256
+#define FWRDURATION 240 // FWR average duration (samples)
+
 int olddelay = -1;
 unsigned int oldfreq = 0;
 unsigned int dlbuflen;
@@ -30,49 +40,13 @@ int cyc_pos;
 float l_fwr, r_fwr, lpr_fwr, lmr_fwr;
 std::vector<float> fwrbuf_l, fwrbuf_r;
 float adapt_l_gain, adapt_r_gain, adapt_lpr_gain, adapt_lmr_gain;
-std::vector<float> lf, rf, lr, rr, cf, cr;
-float LFE_buf[256];
-unsigned int lfe_pos;
 float *filter_coefs_lfe;
 unsigned int len125;
 
-template<class T,class _ftype_t> static _ftype_t dotproduct(int count,const T *buf,const _ftype_t *coefficients)
-{
-	float sum0=0,sum1=0,sum2=0,sum3=0;
-	for (;count>=4;buf+=4,coefficients+=4,count-=4)
-	{
-		sum0+=buf[0]*coefficients[0];
-		sum1+=buf[1]*coefficients[1];
-		sum2+=buf[2]*coefficients[2];
-		sum3+=buf[3]*coefficients[3];
-	}
-	while (count--) sum0+= *buf++ * *coefficients++;
-	return sum0+sum1+sum2+sum3;
-}
-
-template<class T> static T firfilter(const T *buf, int pos, int len, int count, const float *coefficients)
-{
-	int count1, count2;
-
-	if (pos >= count)
-	{
-		pos -= count;
-		count1 = count; count2 = 0;
-	}
-	else
-	{
-		count2 = pos;
-		count1 = count - pos;
-		pos = len - count1;
-	}
-
-	// high part of window
-	const T *ptr = &buf[pos];
-
-	float r1=dotproduct(count1,ptr,coefficients);coefficients+=count1;
-	float r2=dotproduct(count2,buf,coefficients);
-	return T(r1+r2);
-}
+// LFE filter input, the last LFE_TAPS - 1 frames of the previous block first.
+GC_ALIGNED16(static float lfe_history[LFE_TAPS - 1 + DPL2_BLOCK]);
+// filter_coefs_lfe in the order of the history frames they multiply
+GC_ALIGNED16(static float lfe_coefs[LFE_TAPS]);
 
 /*
 // Hamming
@@ -171,14 +145,7 @@ void onSeek(void)
 	std::fill(fwrbuf_l.begin(), fwrbuf_l.end(), 0.0f);
 	std::fill(fwrbuf_r.begin(), fwrbuf_r.end(), 0.0f);
 	adapt_l_gain = adapt_r_gain = adapt_lpr_gain = adapt_lmr_gain = 0;
-	std::fill(lf.begin(), lf.end(), 0.0f);
-	std::fill(rf.begin(), rf.end(), 0.0f);
-	std::fill(lr.begin(), lr.end(), 0.0f);
-	std::fill(rr.begin(), rr.end(), 0.0f);
-	std::fill(cf.begin(), cf.end(), 0.0f);
-	std::fill(cr.begin(), cr.end(), 0.0f);
-	lfe_pos = 0;
-	memset(LFE_buf, 0, sizeof(LFE_buf));
+	memset(lfe_history, 0, sizeof(lfe_history));
 }
 
 void done(void)
@@ -212,165 +179,186 @@ float passive_lock(float x)
 	return x1 - x1 / (1 + ax1s * ax1s) + 1;
 }
 
-void matrix_decode(const float *in, const int k, const int il,
-	const int ir, bool decode_rear,
-	const int _dlbuflen,
-	float _l_fwr, float _r_fwr,
-	float _lpr_fwr, float _lmr_fwr,
-	float *_adapt_l_gain, float *_adapt_r_gain,
-	float *_adapt_lpr_gain, float *_adapt_lmr_gain,
-	float *_lf, float *_rf, float *_lr,
-	float *_rr, float *_cf)
+static inline float agc_rate(float d_gain)
 {
-	static const float M9_03DB = 0.3535533906f;
 	static const float MATAGCTRIG = 8.0f;   /* (Fuzzy) AGC trigger */
 	static const float MATAGCDECAY = 1.0f;  /* AGC baseline decay rate (1/samp.) */
+
+	float f = d_gain * (1.0f / MATAGCTRIG);
+	return MATAGCDECAY - MATAGCDECAY / (1 + f * f);
+}
+
+// Decodes count frames into out (L, R, C, -, Ls, Rs) and the LFE filter input
+// into lfe_in. The AGC adapts every frame, so this runs frame by frame with
+// the decoder state kept in locals. The rear delay is always 0, so the
+// channels are written straight to out.
+static void matrix_decode(const float *in, int count, float *out, float *lfe_in)
+{
+	static const float M9_03DB = 0.3535533906f;
 	static const float MATCOMPGAIN = 0.37f; /* Cross talk compensation gain,  0.50 - 0.55 is full cancellation. */
+	const float SQRT1_2 = (float)M_SQRT1_2;
 
-	const int kr = (k + olddelay) % _dlbuflen;
-	float l_gain = (_l_fwr + _r_fwr) / (1 + _l_fwr + _l_fwr);
-	float r_gain = (_l_fwr + _r_fwr) / (1 + _r_fwr + _r_fwr);
-	// The 2nd axis has strong gain fluctuations, and therefore require
-	// limits.  The factor corresponds to the 1 / amplification of (Lt
-	// - Rt) when (Lt, Rt) is strongly correlated. (e.g. during
-	// dialogues).  It should be bigger than -12 dB to prevent
-	// distortion.
-	float lmr_lim_fwr = _lmr_fwr > M9_03DB * _lpr_fwr ? _lmr_fwr : M9_03DB * _lpr_fwr;
-	float lpr_gain = (_lpr_fwr + lmr_lim_fwr) / (1 + _lpr_fwr + _lpr_fwr);
-	float lmr_gain = (_lpr_fwr + lmr_lim_fwr) / (1 + lmr_lim_fwr + lmr_lim_fwr);
-	float lmr_unlim_gain = (_lpr_fwr + _lmr_fwr) / (1 + _lmr_fwr + _lmr_fwr);
-	float lpr, lmr;
-	float l_agc, r_agc, lpr_agc, lmr_agc;
-	float f, d_gain, c_gain, c_agc_cfk;
-
-	/*** AXIS NO. 1: (Lt, Rt) -> (C, Ls, Rs) ***/
-	/* AGC adaption */
-	d_gain = (fabs(l_gain - *_adapt_l_gain) + fabs(r_gain - *_adapt_r_gain)) * 0.5f;
-	f = d_gain * (1.0f / MATAGCTRIG);
-	f = MATAGCDECAY - MATAGCDECAY / (1 + f * f);
-	*_adapt_l_gain = (1 - f) * *_adapt_l_gain + f * l_gain;
-	*_adapt_r_gain = (1 - f) * *_adapt_r_gain + f * r_gain;
-	/* Matrix */
-	l_agc = in[il] * passive_lock(*_adapt_l_gain);
-	r_agc = in[ir] * passive_lock(*_adapt_r_gain);
-	_cf[k] = (l_agc + r_agc) * (float)M_SQRT1_2;
-	if (decode_rear)
+	float l_fwr_ = l_fwr, r_fwr_ = r_fwr, lpr_fwr_ = lpr_fwr, lmr_fwr_ = lmr_fwr;
+	float adapt_l = adapt_l_gain, adapt_r = adapt_r_gain;
+	float adapt_lpr = adapt_lpr_gain, adapt_lmr = adapt_lmr_gain;
+	float *fwr_l = &fwrbuf_l[0], *fwr_r = &fwrbuf_r[0];
+	int k = cyc_pos;
+
+	for (int i = 0; i < count; ++i, in += 2, out += 6)
 	{
-		_lr[kr] = _rr[kr] = (l_agc - r_agc) * (float)M_SQRT1_2;
+		const float in_l = in[0], in_r = in[1];
+
+		/* Update the full wave rectified total amplitude */
+		/* Input matrix decoder */
+		const float old_l = fwr_l[k], old_r = fwr_r[k];
+		l_fwr_ += fabsf(in_l) - fabsf(old_l);
+		r_fwr_ += fabsf(in_r) - fabsf(old_r);
+		lpr_fwr_ += fabsf(in_l + in_r) - fabsf(old_l + old_r);
+		lmr_fwr_ += fabsf(in_l - in_r) - fabsf(old_l - old_r);
+
+		/* Matrix encoded 2 channel sources */
+		fwr_l[k] = in_l;
+		fwr_r[k] = in_r;
+
+		float l_gain = (l_fwr_ + r_fwr_) / (1 + l_fwr_ + l_fwr_);
+		float r_gain = (l_fwr_ + r_fwr_) / (1 + r_fwr_ + r_fwr_);
+		// The 2nd axis has strong gain fluctuations, and therefore require
+		// limits.  The factor corresponds to the 1 / amplification of (Lt
+		// - Rt) when (Lt, Rt) is strongly correlated. (e.g. during
+		// dialogues).  It should be bigger than -12 dB to prevent
+		// distortion.
+		float lmr_lim_fwr = lmr_fwr_ > M9_03DB * lpr_fwr_ ? lmr_fwr_ : M9_03DB * lpr_fwr_;
+		float lpr_gain = (lpr_fwr_ + lmr_lim_fwr) / (1 + lpr_fwr_ + lpr_fwr_);
+		float lmr_gain = (lpr_fwr_ + lmr_lim_fwr) / (1 + lmr_lim_fwr + lmr_lim_fwr);
+		float lmr_unlim_gain = (lpr_fwr_ + lmr_fwr_) / (1 + lmr_fwr_ + lmr_fwr_);
+
+		/*** AXIS NO. 1: (Lt, Rt) -> (C, Ls, Rs) ***/
+		/* AGC adaption */
+		float f = agc_rate((fabsf(l_gain - adapt_l) + fabsf(r_gain - adapt_r)) * 0.5f);
+		adapt_l = (1 - f) * adapt_l + f * l_gain;
+		adapt_r = (1 - f) * adapt_r + f * r_gain;
+		/* Matrix */
+		float l_agc = in_l * passive_lock(adapt_l);
+		float r_agc = in_r * passive_lock(adapt_r);
+		float cf = (l_agc + r_agc) * SQRT1_2;
 		// Stereo rear channel is steered with the same AGC steering as
 		// the decoding matrix. Note this requires a fast updating AGC
 		// at the order of 20 ms (which is the case here).
-		_lr[kr] *= (_l_fwr + _l_fwr) / (1 + _l_fwr + _r_fwr);
-		_rr[kr] *= (_r_fwr + _r_fwr) / (1 + _l_fwr + _r_fwr);
+		float rear = (l_agc - r_agc) * SQRT1_2;
+		out[4] = rear * ((l_fwr_ + l_fwr_) / (1 + l_fwr_ + r_fwr_));
+		out[5] = rear * ((r_fwr_ + r_fwr_) / (1 + l_fwr_ + r_fwr_));
+
+		/*** AXIS NO. 2: (Lt + Rt, Lt - Rt) -> (L, R) ***/
+		float lpr = (in_l + in_r) * SQRT1_2;
+		float lmr = (in_l - in_r) * SQRT1_2;
+		/* AGC adaption */
+		f = agc_rate(fabsf(lmr_unlim_gain - adapt_lmr));
+		adapt_lpr = (1 - f) * adapt_lpr + f * lpr_gain;
+		adapt_lmr = (1 - f) * adapt_lmr + f * lmr_gain;
+		/* Matrix */
+		float lpr_agc = lpr * passive_lock(adapt_lpr);
+		float lmr_agc = lmr * passive_lock(adapt_lmr);
+		float lf = (lpr_agc + lmr_agc) * SQRT1_2;
+		float rf = (lpr_agc - lmr_agc) * SQRT1_2;
+
+		/*** CENTER FRONT CANCELLATION ***/
+		// A heuristic approach exploits that Lt + Rt gain contains the
+		// information about Lt, Rt correlation.  This effectively reshapes
+		// the front and rear "cones" to concentrate Lt + Rt to C and
+		// introduce Lt - Rt in L, R.
+		/* 0.67677 is the empirical lower bound for lpr_gain. */
+		float c_gain = 8 * (adapt_lpr - 0.67677f);
+		c_gain = c_gain > 0 ? c_gain : 0;
+		// c_gain should not be too high, not even reaching full
+		// cancellation (~ 0.50 - 0.55 at current AGC implementation), or
+		// the center will sound too narrow. */
+		c_gain = MATCOMPGAIN / (1 + c_gain * c_gain);
+		float c_agc_cfk = c_gain * cf;
+		out[0] = lf - c_agc_cfk;
+		out[1] = rf - c_agc_cfk;
+		out[2] = cf + c_agc_cfk + c_agc_cfk;
+		lfe_in[i] = (out[0] + out[1]) / 2;
+
+		// Next sample...
+		if (--k < 0)
+			k += dlbuflen;
 	}
 
-	/*** AXIS NO. 2: (Lt + Rt, Lt - Rt) -> (L, R) ***/
-	lpr = (in[il] + in[ir]) * (float)M_SQRT1_2;
-	lmr = (in[il] - in[ir]) * (float)M_SQRT1_2;
-	/* AGC adaption */
-	d_gain = fabs(lmr_unlim_gain - *_adapt_lmr_gain);
-	f = d_gain * (1.0f / MATAGCTRIG);
-	f = MATAGCDECAY - MATAGCDECAY / (1 + f * f);
-	*_adapt_lpr_gain = (1 - f) * *_adapt_lpr_gain + f * lpr_gain;
-	*_adapt_lmr_gain = (1 - f) * *_adapt_lmr_gain + f * lmr_gain;
-	/* Matrix */
-	lpr_agc = lpr * passive_lock(*_adapt_lpr_gain);
-	lmr_agc = lmr * passive_lock(*_adapt_lmr_gain);
-	_lf[k] = (lpr_agc + lmr_agc) * (float)M_SQRT1_2;
-	_rf[k] = (lpr_agc - lmr_agc) * (float)M_SQRT1_2;
-
-	/*** CENTER FRONT CANCELLATION ***/
-	// A heuristic approach exploits that Lt + Rt gain contains the
-	// information about Lt, Rt correlation.  This effectively reshapes
-	// the front and rear "cones" to concentrate Lt + Rt to C and
-	// introduce Lt - Rt in L, R.
-	/* 0.67677 is the empirical lower bound for lpr_gain. */
-	c_gain = 8 * (*_adapt_lpr_gain - 0.67677f);
-	c_gain = c_gain > 0 ? c_gain : 0;
-	// c_gain should not be too high, not even reaching full
-	// cancellation (~ 0.50 - 0.55 at current AGC implementation), or
-	// the center will sound too narrow. */
-	c_gain = MATCOMPGAIN / (1 + c_gain * c_gain);
-	c_agc_cfk = c_gain * _cf[k];
-	_lf[k] -= c_agc_cfk;
-	_rf[k] -= c_agc_cfk;
-	_cf[k] += c_agc_cfk + c_agc_cfk;
+	l_fwr = l_fwr_; r_fwr = r_fwr_; lpr_fwr = lpr_fwr_; lmr_fwr = lmr_fwr_;
+	adapt_l_gain = adapt_l; adapt_r_gain = adapt_r;
+	adapt_lpr_gain = adapt_lpr; adapt_lmr_gain = adapt_lmr;
+	cyc_pos = k;
+}
+
+// Low passes count frames of lfe_history into the LFE channel of out.
+static void lfe_filter(int count, float *out)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		const float *x = &lfe_history[i];
+		int k = 0;
+		float sum;
+
+#if _M_X86
+		__m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+		for (; k < LFE_TAPS; k += 8)
+		{
+			sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(x + k), _mm_load_ps(lfe_coefs + k)));
+			sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(x + k + 4), _mm_load_ps(lfe_coefs + k + 4)));
+		}
+		sum0 = _mm_add_ps(sum0, sum1);
+		sum0 = _mm_add_ps(sum0, _mm_movehl_ps(sum0, sum0));
+		sum0 = _mm_add_ss(sum0, _mm_shuffle_ps(sum0, sum0, 1));
+		sum = _mm_cvtss_f32(sum0);
+#else
+		float sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+		for (; k < LFE_TAPS; k += 4)
+		{
+			sum0 += x[k] * lfe_coefs[k];
+			sum1 += x[k + 1] * lfe_coefs[k + 1];
+			sum2 += x[k + 2] * lfe_coefs[k + 2];
+			sum3 += x[k + 3] * lfe_coefs[k + 3];
+		}
+		sum = sum0 + sum1 + sum2 + sum3;
+#endif
+
+		out[i * 6 + 3] = sum;
+	}
 }
 
 void dpl2decode(float *samples, int numsamples, float *out)
 {
-	static const unsigned int FWRDURATION = 240; // FWR average duration (samples)
 	static const int cfg_delay = 0;
 	static const unsigned int fmt_freq = 48000;
-	static const unsigned int fmt_nchannels = 2; // input channels
-
-	int cur = 0;
 
 	if (olddelay != cfg_delay || oldfreq != fmt_freq)
 	{
 		done();
 		olddelay = cfg_delay;
 		oldfreq = fmt_freq;
-		dlbuflen = std::max(FWRDURATION, (fmt_freq * cfg_delay / 1000)); //+(len7000-1);
+		dlbuflen = std::max<unsigned int>(FWRDURATION, (fmt_freq * cfg_delay / 1000)); //+(len7000-1);
 		cyc_pos = dlbuflen - 1;
 		fwrbuf_l.resize(dlbuflen);
 		fwrbuf_r.resize(dlbuflen);
-		lf.resize(dlbuflen);
-		rf.resize(dlbuflen);
-		lr.resize(dlbuflen);
-		rr.resize(dlbuflen);
-		cf.resize(dlbuflen);
-		cr.resize(dlbuflen);
 		filter_coefs_lfe = calc_coefficients_125Hz_lowpass(fmt_freq);
-		lfe_pos = 0;
-		memset(LFE_buf, 0, sizeof(LFE_buf));
+		// The newest frame is weighed by the first tap and the ones before
+		// it by the rest, starting with the oldest.
+		for (unsigned int i = 0; i < LFE_TAPS - 1; i++)
+			lfe_coefs[i] = filter_coefs_lfe[i + 1];
+		lfe_coefs[LFE_TAPS - 1] = filter_coefs_lfe[0];
+		memset(lfe_history, 0, sizeof(lfe_history));
 	}
 
-	float *in = samples; // Input audio data
-	float *end = in + numsamples * fmt_nchannels; // Loop end
-
-	while (in < end)
+	while (numsamples > 0)
 	{
-		const int k = cyc_pos;
-
-		const int fwr_pos = (k + FWRDURATION) % dlbuflen;
-		/* Update the full wave rectified total amplitude */
-		/* Input matrix decoder */
-		l_fwr += fabs(in[0]) - fabs(fwrbuf_l[fwr_pos]);
-		r_fwr += fabs(in[1]) - fabs(fwrbuf_r[fwr_pos]);
-		lpr_fwr += fabs(in[0] + in[1]) - fabs(fwrbuf_l[fwr_pos] + fwrbuf_r[fwr_pos]);
-		lmr_fwr += fabs(in[0] - in[1]) - fabs(fwrbuf_l[fwr_pos] - fwrbuf_r[fwr_pos]);
-
-		/* Matrix encoded 2 channel sources */
-		fwrbuf_l[k] = in[0];
-		fwrbuf_r[k] = in[1];
-		matrix_decode(in, k, 0, 1, true, dlbuflen,
-			l_fwr, r_fwr,
-			lpr_fwr, lmr_fwr,
-			&adapt_l_gain, &adapt_r_gain,
-			&adapt_lpr_gain, &adapt_lmr_gain,
-			&lf[0], &rf[0], &lr[0], &rr[0], &cf[0]);
-
-		out[cur + 0] = lf[k];
-		out[cur + 1] = rf[k];
-		out[cur + 2] = cf[k];
-		LFE_buf[lfe_pos] = (out[0] + out[1]) / 2;
-		out[cur + 3] = firfilter(LFE_buf, lfe_pos, len125, len125, filter_coefs_lfe);
-		lfe_pos++;
-		if (lfe_pos == len125)
-		{
-			lfe_pos = 0;
-		}
-		out[cur + 4] = lr[k];
-		out[cur + 5] = rr[k];
-		// Next sample...
-		in += 2;
-		cur += 6;
-		cyc_pos--;
-		if (cyc_pos < 0)
-		{
-			cyc_pos += dlbuflen;
-		}
+		int count = std::min(numsamples, DPL2_BLOCK);
+		matrix_decode(samples, count, out, &lfe_history[LFE_TAPS - 1]);
+		lfe_filter(count, out);
+		memmove(lfe_history, &lfe_history[count], (LFE_TAPS - 1) * sizeof(float));
+
+		samples += count * 2;
+		out += count * 6;
+		numsamples -= count;
 	}
 }
 
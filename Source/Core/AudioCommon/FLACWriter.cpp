@@ -0,0 +1,445 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "AudioCommon/FLACWriter.h"
+#include "Common/Common.h"
+
+// Encoded data is written out once this much has collected
+#define FLAC_OUTPUT_CHUNK (1024 * 1024)
+#define FLAC_MAX_FIXED_ORDER 4
+#define FLAC_MAX_PARTITION_ORDER 8
+// Largest Rice parameter of the 4-bit parameter coding method, 15 is the escape code
+#define FLAC_MAX_RICE_PARAM 14
+
+enum
+{
+	CHANNELS_INDEPENDENT = 1,
+	CHANNELS_LEFT_SIDE   = 8,
+	CHANNELS_RIGHT_SIDE  = 9,
+	CHANNELS_MID_SIDE    = 10,
+};
+
+namespace
+{
+
+class BitWriter
+{
+public:
+	BitWriter(std::vector<u8>& out) : m_out(out), m_acc(0), m_bits(0) {}
+
+	// bits can be 0 to 32
+	void Write(u32 value, int bits)
+	{
+		if (bits == 0)
+			return;
+		m_acc = (m_acc << bits) | (value & (u32)((1ULL << bits) - 1));
+		m_bits += bits;
+		while (m_bits >= 8)
+		{
+			m_bits -= 8;
+			m_out.push_back((u8)(m_acc >> m_bits));
+		}
+	}
+
+	// quotient zeros followed by a one
+	void WriteUnary(u32 quotient)
+	{
+		for (; quotient >= 32; quotient -= 32)
+			Write(0, 32);
+		Write(1, quotient + 1);
+	}
+
+	void Align()
+	{
+		if (m_bits)
+			Write(0, 8 - m_bits);
+	}
+
+private:
+	std::vector<u8>& m_out;
+	u64 m_acc;
+	int m_bits;
+};
+
+}
+
+static u8 CRC8(const u8 *data, size_t size)
+{
+	u8 crc = 0;
+	for (size_t i = 0; i < size; i++)
+	{
+		crc ^= data[i];
+		for (int j = 0; j < 8; j++)
+			crc = (crc & 0x80) ? (u8)((crc << 1) ^ 0x07) : (u8)(crc << 1);
+	}
+	return crc;
+}
+
+static u16 CRC16(const u8 *data, size_t size)
+{
+	u16 crc = 0;
+	for (size_t i = 0; i < size; i++)
+	{
+		crc ^= (u16)data[i] << 8;
+		for (int j = 0; j < 8; j++)
+			crc = (crc & 0x8000) ? (u16)((crc << 1) ^ 0x8005) : (u16)(crc << 1);
+	}
+	return crc;
+}
+
+// Residual of the fixed predictor of the given order at sample i
+static inline s32 FixedResidual(const s32 *x, u32 i, int order)
+{
+	switch (order)
+	{
+	case 0: return x[i];
+	case 1: return x[i] - x[i - 1];
+	case 2: return x[i] - 2 * x[i - 1] + x[i - 2];
+	case 3: return x[i] - 3 * x[i - 1] + 3 * x[i - 2] - x[i - 3];
+	default: return x[i] - 4 * x[i - 1] + 6 * x[i - 2] - 4 * x[i - 3] + x[i - 4];
+	}
+}
+
+static inline u32 ZigZag(s32 value)
+{
+	return ((u32)value << 1) ^ (u32)(value >> 31);
+}
+
+// Picks the fixed predictor order with the smallest residuals, returns their
+// absolute sum as an estimate of the channel's cost
+static u64 ChooseOrder(const s32 *x, u32 count, int& best_order)
+{
+	u64 sums[FLAC_MAX_FIXED_ORDER + 1] = {};
+	const int max_order = count > FLAC_MAX_FIXED_ORDER ? FLAC_MAX_FIXED_ORDER : 0;
+
+	// Every order is summed over the same samples so they compare fairly
+	for (u32 i = max_order; i < count; i++)
+	{
+		for (int order = 0; order <= max_order; order++)
+			sums[order] += std::abs(FixedResidual(x, i, order));
+	}
+
+	best_order = 0;
+	for (int order = 1; order <= max_order; order++)
+	{
+		if (sums[order] < sums[best_order])
+			best_order = order;
+	}
+	return sums[best_order];
+}
+
+static inline int RiceParam(u64 sum, u32 count)
+{
+	int param = 0;
+	if (count)
+	{
+		for (u64 mean = sum / count; mean > 1 && param < FLAC_MAX_RICE_PARAM; mean >>= 1)
+			param++;
+	}
+	return param;
+}
+
+static void WriteSubframe(BitWriter& bw, const s32 *x, u32 count, int bps)
+{
+	// Silence and other constant runs
+	bool constant = true;
+	for (u32 i = 1; i < count && constant; i++)
+		constant = x[i] == x[0];
+	if (constant)
+	{
+		bw.Write(0, 8); // zero bit, SUBFRAME_CONSTANT, no wasted bits
+		bw.Write((u32)x[0], bps);
+		return;
+	}
+
+	int order;
+	ChooseOrder(x, count, order);
+
+	u32 residuals[FLAC_BLOCK_SIZE];
+	for (u32 i = order; i < count; i++)
+		residuals[i] = ZigZag(FixedResidual(x, i, order));
+
+	// Finest partitioning that's allowed, then sums for every coarser one
+	int max_partition_order = 0;
+	while (max_partition_order < FLAC_MAX_PARTITION_ORDER &&
+	       (count & ((2u << max_partition_order) - 1)) == 0 &&
+	       (count >> (max_partition_order + 1)) > (u32)order)
+		max_partition_order++;
+
+	u64 sums[FLAC_MAX_PARTITION_ORDER + 1][1 << FLAC_MAX_PARTITION_ORDER];
+	{
+		const u32 partition_size = count >> max_partition_order;
+		u32 i = order;
+		for (u32 p = 0; p < (1u << max_partition_order); p++)
+		{
+			u64 sum = 0;
+			for (u32 end = (p + 1) * partition_size; i < end; i++)
+				sum += residuals[i];
+			sums[max_partition_order][p] = sum;
+		}
+		for (int po = max_partition_order - 1; po >= 0; po--)
+		{
+			for (u32 p = 0; p < (1u << po); p++)
+				sums[po][p] = sums[po + 1][p * 2] + sums[po + 1][p * 2 + 1];
+		}
+	}
+
+	// Estimated size of each partitioning
+	int best_partition_order = 0;
+	u64 best_bits = ~0ULL;
+	for (int po = 0; po <= max_partition_order; po++)
+	{
+		u64 bits = 0;
+		for (u32 p = 0; p < (1u << po); p++)
+		{
+			u32 n = (count >> po) - (p == 0 ? order : 0);
+			int param = RiceParam(sums[po][p], n);
+			bits += 4 + (u64)n * (param + 1) + (sums[po][p] >> param);
+		}
+		if (bits < best_bits)
+		{
+			best_bits = bits;
+			best_partition_order = po;
+		}
+	}
+
+	bw.Write(0, 1);
+	bw.Write(8 | order, 6); // SUBFRAME_FIXED
+	bw.Write(0, 1);
+	for (int i = 0; i < order; i++)
+		bw.Write((u32)x[i], bps);
+
+	bw.Write(0, 2); // Rice coding with 4-bit parameters
+	bw.Write(best_partition_order, 4);
+	u32 i = order;
+	for (u32 p = 0; p < (1u << best_partition_order); p++)
+	{
+		u32 end = (p + 1) * (count >> best_partition_order);
+		int param = RiceParam(sums[best_partition_order][p], end - i);
+		bw.Write(param, 4);
+		for (; i < end; i++)
+		{
+			bw.WriteUnary(residuals[i] >> param);
+			bw.Write(residuals[i], param);
+		}
+	}
+}
+
+void FLACFileWriter::EncodeFrame(const s32 *left, const s32 *right, u32 count, u32 frame_number, std::vector<u8>& out)
+{
+	s32 mid[FLAC_BLOCK_SIZE], side[FLAC_BLOCK_SIZE];
+	for (u32 i = 0; i < count; i++)
+	{
+		mid[i] = (left[i] + right[i]) >> 1;
+		side[i] = left[i] - right[i];
+	}
+
+	// Pick the cheapest stereo decorrelation
+	int order;
+	u64 left_cost = ChooseOrder(left, count, order);
+	u64 right_cost = ChooseOrder(right, count, order);
+	u64 mid_cost = ChooseOrder(mid, count, order);
+	u64 side_cost = ChooseOrder(side, count, order);
+
+	int assignment = CHANNELS_INDEPENDENT;
+	u64 best_cost = left_cost + right_cost;
+	if (left_cost + side_cost < best_cost)
+	{
+		assignment = CHANNELS_LEFT_SIDE;
+		best_cost = left_cost + side_cost;
+	}
+	if (right_cost + side_cost < best_cost)
+	{
+		assignment = CHANNELS_RIGHT_SIDE;
+		best_cost = right_cost + side_cost;
+	}
+	if (mid_cost + side_cost < best_cost)
+		assignment = CHANNELS_MID_SIDE;
+
+	out.clear();
+	BitWriter bw(out);
+
+	// Frame header
+	bw.Write(0x3ffe, 14); // sync code
+	bw.Write(0, 1);
+	bw.Write(0, 1); // fixed block size
+	bw.Write(count == FLAC_BLOCK_SIZE ? 12 : 7, 4); // 4096 or 16 bit size at the end of the header
+	bw.Write(0, 4); // sample rate from STREAMINFO
+	bw.Write(assignment, 4);
+	bw.Write(4, 3); // 16 bits per sample
+	bw.Write(0, 1);
+
+	// Frame number, UTF-8 coded
+	if (frame_number < 0x80)
+	{
+		bw.Write(frame_number, 8);
+	}
+	else
+	{
+		int extra = frame_number < 0x800 ? 1 : frame_number < 0x10000 ? 2 : frame_number < 0x200000 ? 3 :
+		            frame_number < 0x4000000 ? 4 : 5;
+		bw.Write(((0xff00 >> (extra + 1)) & 0xff) | (frame_number >> (extra * 6)), 8);
+		for (int i = extra - 1; i >= 0; i--)
+			bw.Write(0x80 | ((frame_number >> (i * 6)) & 0x3f), 8);
+	}
+
+	if (count != FLAC_BLOCK_SIZE)
+		bw.Write(count - 1, 16);
+	bw.Write(CRC8(out.data(), out.size()), 8);
+
+	switch (assignment)
+	{
+	case CHANNELS_INDEPENDENT:
+		WriteSubframe(bw, left, count, 16);
+		WriteSubframe(bw, right, count, 16);
+		break;
+	case CHANNELS_LEFT_SIDE:
+		WriteSubframe(bw, left, count, 16);
+		WriteSubframe(bw, side, count, 17);
+		break;
+	case CHANNELS_RIGHT_SIDE:
+		WriteSubframe(bw, side, count, 17);
+		WriteSubframe(bw, right, count, 16);
+		break;
+	case CHANNELS_MID_SIDE:
+		WriteSubframe(bw, mid, count, 16);
+		WriteSubframe(bw, side, count, 17);
+		break;
+	}
+
+	bw.Align();
+	u16 crc = CRC16(out.data(), out.size());
+	out.push_back((u8)(crc >> 8));
+	out.push_back((u8)crc);
+}
+
+FLACFileWriter::FLACFileWriter()
+	: m_sample_rate(0)
+	, m_total_frames(0)
+	, m_frame_number(0)
+	, m_min_frame_size(0)
+	, m_max_frame_size(0)
+	, m_block_used(0)
+{
+}
+
+FLACFileWriter::~FLACFileWriter()
+{
+	Stop();
+}
+
+bool FLACFileWriter::Start(const char *filename, unsigned int sample_rate)
+{
+	if (m_file)
+	{
+		PanicAlertT("The file %s was already open, the file header will not be written.", filename);
+		return false;
+	}
+
+	m_file.Open(filename, "wb");
+	if (!m_file)
+	{
+		PanicAlertT("The file %s could not be opened for writing. Please check if it's already opened by another program.", filename);
+		return false;
+	}
+
+	m_sample_rate = sample_rate;
+	m_total_frames = 0;
+	m_frame_number = 0;
+	m_min_frame_size = 0;
+	m_max_frame_size = 0;
+	m_block_used = 0;
+	m_output.clear();
+	m_output.reserve(FLAC_OUTPUT_CHUNK + FLAC_BLOCK_SIZE * 8);
+
+	// Rewritten with the final sizes by Stop
+	WriteStreamInfo();
+	return true;
+}
+
+void FLACFileWriter::Stop()
+{
+	if (!m_file)
+		return;
+
+	FlushBlock();
+	FlushOutput();
+	m_file.Seek(0, SEEK_SET);
+	WriteStreamInfo();
+	m_file.Close();
+}
+
+void FLACFileWriter::WriteStreamInfo()
+{
+	std::vector<u8> header;
+	BitWriter bw(header);
+
+	bw.Write('f', 8); bw.Write('L', 8); bw.Write('a', 8); bw.Write('C', 8);
+	bw.Write(0x80, 8); // last metadata block, STREAMINFO
+	bw.Write(34, 24);
+	bw.Write(FLAC_BLOCK_SIZE, 16); // min and max block size
+	bw.Write(FLAC_BLOCK_SIZE, 16);
+	bw.Write(m_min_frame_size, 24);
+	bw.Write(m_max_frame_size, 24);
+	bw.Write(m_sample_rate, 20);
+	bw.Write(1, 3); // 2 channels
+	bw.Write(15, 5); // 16 bits per sample
+	bw.Write((u32)(m_total_frames >> 32), 4);
+	bw.Write((u32)m_total_frames, 32);
+	// No MD5 of the audio
+	for (int i = 0; i < 4; i++)
+		bw.Write(0, 32);
+
+	m_file.WriteBytes(header.data(), header.size());
+}
+
+void FLACFileWriter::AddStereoSamples(const short *sample_data, u32 count)
+{
+	if (!m_file)
+		PanicAlertT("FLACFileWriter - file not open.");
+
+	while (count)
+	{
+		u32 n = std::min(count, FLAC_BLOCK_SIZE - m_block_used);
+		for (u32 i = 0; i < n; i++)
+		{
+			m_left[m_block_used + i] = sample_data[i * 2];
+			m_right[m_block_used + i] = sample_data[i * 2 + 1];
+		}
+		m_block_used += n;
+		sample_data += n * 2;
+		count -= n;
+
+		if (m_block_used == FLAC_BLOCK_SIZE)
+			FlushBlock();
+	}
+}
+
+void FLACFileWriter::FlushBlock()
+{
+	if (!m_block_used)
+		return;
+
+	EncodeFrame(m_left, m_right, m_block_used, m_frame_number++, m_frame);
+	m_output.insert(m_output.end(), m_frame.begin(), m_frame.end());
+
+	u32 size = (u32)m_frame.size();
+	m_min_frame_size = m_min_frame_size ? std::min(m_min_frame_size, size) : size;
+	m_max_frame_size = std::max(m_max_frame_size, size);
+	m_total_frames += m_block_used;
+	m_block_used = 0;
+
+	if (m_output.size() >= FLAC_OUTPUT_CHUNK)
+		FlushOutput();
+}
+
+void FLACFileWriter::FlushOutput()
+{
+	if (!m_output.empty())
+		m_file.WriteBytes(m_output.data(), m_output.size());
+	m_output.clear();
+}
@@ -0,0 +1,59 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// ---------------------------------------------------------------------------------
+// Class: FLACFileWriter
+// Description: Writes 16-bit stereo audio streams losslessly compressed as FLAC.
+// Same interface as WaveFileWriter. Only fixed predictors are used, which keeps
+// the encoder cheap and still roughly halves the size of game audio.
+// If Stop is not called when it destructs, the destructor will call Stop().
+// ---------------------------------------------------------------------------------
+
+#pragma once
+
+#include <vector>
+
+#include "Common/FileUtil.h"
+
+#define FLAC_BLOCK_SIZE 4096
+
+class FLACFileWriter
+{
+public:
+	FLACFileWriter();
+	~FLACFileWriter();
+
+	bool Start(const char *filename, unsigned int sample_rate);
+	void Stop();
+
+	void AddStereoSamples(const short *sample_data, u32 count);
+	u64 GetAudioSize() const { return m_total_frames * 4; }
+
+	// Encodes one frame of count samples per channel into out. Exposed for the
+	// tests.
+	static void EncodeFrame(const s32 *left, const s32 *right, u32 count, u32 frame_number, std::vector<u8>& out);
+
+private:
+	FLACFileWriter(const FLACFileWriter&)/* = delete*/;
+	FLACFileWriter& operator=(const FLACFileWriter&)/* = delete*/;
+
+	void FlushBlock();
+	void FlushOutput();
+	void WriteStreamInfo();
+
+	File::IOFile m_file;
+	unsigned int m_sample_rate;
+	u64 m_total_frames;
+	u32 m_frame_number;
+	u32 m_min_frame_size;
+	u32 m_max_frame_size;
+
+	s32 m_left[FLAC_BLOCK_SIZE];
+	s32 m_right[FLAC_BLOCK_SIZE];
+	u32 m_block_used;
+
+	// Encoded frames, written out in big chunks
+	std::vector<u8> m_output;
+	std::vector<u8> m_frame;
+};
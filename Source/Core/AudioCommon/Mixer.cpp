@@ -2,11 +2,17 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "AudioCommon/AudioCommon.h"
 #include "AudioCommon/Mixer.h"
-#include "Common/Atomic.h"
 #include "Common/CPUDetect.h"
+#include "Common/MathUtil.h"
+#include "Common/StringUtil.h"
+#include "Common/Thread.h"
+#include "Common/Timer.h"
 #include "Core/ConfigManager.h"
+#include "Core/Core.h"
 #include "Core/Host.h"
 #include "Core/HW/AudioInterface.h"
 #include "Core/HW/VideoInterface.h"
@@ -18,36 +24,69 @@
 #include <tmmintrin.h>
 #endif
 
-// Executed from sound stream thread
-unsigned int CMixer::Mix(short* samples, unsigned int numSamples, bool consider_framelimit)
+CMixer::MixerFifo::MixerFifo(CMixer *mixer)
+	: m_mixer(mixer)
+	, m_indexW(0)
+	, m_indexR(0)
+	, m_resampler(Resampler::Create(SConfig::GetInstance().m_Resampler))
+	, m_numLeftI(0.0f)
+	, m_playing(false)
+	, m_underruns(0)
+	, m_overruns(0)
 {
-	if (!samples)
-		return 0;
+	memset(m_buffer, 0, sizeof(m_buffer));
+}
 
-	std::lock_guard<std::mutex> lk(m_csMixing);
+CMixer::CMixer(unsigned int AISampleRate, unsigned int DACSampleRate, unsigned int BackendSampleRate)
+	: m_aiSampleRate(AISampleRate)
+	, m_dacSampleRate(DACSampleRate)
+	, m_bits(16)
+	, m_channels(2)
+	, m_HLEready(false)
+	, m_logAudio(false)
+	, m_dma_mixer(this)
+	, m_streaming_mixer(this)
+	, m_paused(false)
+	, m_mixing(false)
+	, m_reportedXruns(0)
+	, m_lastXrunReport(0)
+{
+	m_lastFrame[0] = m_lastFrame[1] = 0;
 
-	if (PowerPC::GetState() != PowerPC::CPU_RUNNING)
-	{
-		// Silence
-		memset(samples, 0, numSamples * 4);
-		return numSamples;
-	}
+	// AyuanX: The internal (Core & DSP) sample rate is fixed at 32KHz
+	// So when AI/DAC sample rate differs than 32KHz, we have to do re-sampling
+	m_sampleRate = BackendSampleRate;
 
-	unsigned int currentSample = 0;
+	const SConfig& config = SConfig::GetInstance();
+	m_lowWatermark = config.m_MixerLowWatermark;
+	m_highWatermark = std::max(config.m_MixerHighWatermark, config.m_MixerLowWatermark);
 
-	// Cache access in non-volatile variable
-	// This is the only function changing the read value, so it's safe to
-	// cache it locally although it's written here.
-	// The writing pointer will be modified outside, but it will only increase,
-	// so we will just ignore new written data while interpolating.
-	// Without this cache, the compiler wouldn't be allowed to optimize the
-	// interpolation loop.
-	u32 indexR = Common::AtomicLoad(m_indexR);
-	u32 indexW = Common::AtomicLoad(m_indexW);
+	INFO_LOG(AUDIO_INTERFACE, "Mixer is initialized (AISampleRate:%i, DACSampleRate:%i)", AISampleRate, DACSampleRate);
+}
+
+// Converts a watermark to frames at the given input rate
+static u32 WatermarkFrames(unsigned int ms, unsigned int rate)
+{
+	return std::min<u32>(ms * rate / 1000, MAX_SAMPLES - 1);
+}
 
-	float numLeft = ((indexW - indexR) & INDEX_MASK) / 2;
+u32 CMixer::MixerFifo::NumFrames() const
+{
+	return ((m_indexW.load(std::memory_order_acquire) - m_indexR.load(std::memory_order_acquire)) & INDEX_MASK) / 2;
+}
+
+// Executed from sound stream thread
+unsigned int CMixer::MixerFifo::Mix(short* samples, unsigned int numSamples, unsigned int input_rate, bool consider_framelimit)
+{
+	// This is the only function changing the read index. The acquire load of
+	// the write index makes the samples before it visible; newer ones are
+	// ignored until the next call.
+	u32 indexR = m_indexR.load(std::memory_order_relaxed);
+	u32 indexW = m_indexW.load(std::memory_order_acquire);
+
+	float numLeft = ((indexW - indexR) & INDEX_MASK) / 2 + m_resampler->GetDelay();
 	m_numLeftI = (numLeft + m_numLeftI*(CONTROL_AVG-1)) / CONTROL_AVG;
-	float offset = (m_numLeftI - LOW_WATERMARK) * CONTROL_FACTOR;
+	float offset = (m_numLeftI - WatermarkFrames(m_mixer->m_lowWatermark, input_rate)) * CONTROL_FACTOR;
 	if(offset > MAX_FREQ_SHIFT) offset = MAX_FREQ_SHIFT;
 	if(offset < -MAX_FREQ_SHIFT) offset = -MAX_FREQ_SHIFT;
 
@@ -56,88 +95,94 @@ unsigned int CMixer::Mix(short* samples, unsigned int numSamples, bool consider_
 	//remember fractional offset
 
 	u32 framelimit = SConfig::GetInstance().m_Framelimit;
-	float aid_sample_rate = AudioInterface::GetAIDSampleRate() + offset;
+	float aid_sample_rate = input_rate + offset;
 	if (consider_framelimit && framelimit > 2)
 	{
 		aid_sample_rate = aid_sample_rate * (framelimit - 1) * 5 / VideoInterface::TargetRefreshRate;
 	}
 
-	static u32 frac = 0;
-	const u32 ratio = (u32)( 65536.0f * aid_sample_rate / (float)m_sampleRate );
+	const u32 ratio = (u32)( 65536.0f * aid_sample_rate / (float)m_mixer->m_sampleRate );
 
 	if(ratio > 0x10000)
 		ERROR_LOG(AUDIO, "ratio out of range");
 
-	for (; currentSample < numSamples*2 && ((indexW-indexR) & INDEX_MASK) > 2; currentSample+=2) {
-		u32 indexR2 = indexR + 2; //next sample
+	unsigned int written = m_resampler->Resample(m_buffer, INDEX_MASK, indexR, indexW, samples, numSamples, ratio);
 
-		s16 l1 = Common::swap16(m_buffer[indexR & INDEX_MASK]); //current
-		s16 l2 = Common::swap16(m_buffer[indexR2 & INDEX_MASK]); //next
-		int sampleL = ((l1 << 16) + (l2 - l1) * (u16)frac)  >> 16;
-		samples[currentSample+1] = sampleL;
+	// Hand the space back to PushSamples
+	m_indexR.store(indexR, std::memory_order_release);
 
-		s16 r1 = Common::swap16(m_buffer[(indexR + 1) & INDEX_MASK]); //current
-		s16 r2 = Common::swap16(m_buffer[(indexR2 + 1) & INDEX_MASK]); //next
-		int sampleR = ((r1 << 16) + (r2 - r1) * (u16)frac)  >> 16;
-		samples[currentSample] = sampleR;
+	// Count running dry while playing, not every callback of silence after it
+	if (written < numSamples && m_playing)
+		m_underruns.fetch_add(1, std::memory_order_relaxed);
+	m_playing = written == numSamples;
 
-		frac += ratio;
-		indexR += 2 * (u16)(frac >> 16);
-		frac &= 0xffff;
+	return written;
+}
+
+// Executed from sound stream thread
+unsigned int CMixer::Mix(short* samples, unsigned int numSamples, bool consider_framelimit)
+{
+	if (!samples)
+		return 0;
+
+	// Together with SetPaused, either this sees the pause or SetPaused waits
+	// for this call to finish.
+	m_mixing.store(true);
+	if (m_paused.load() || PowerPC::GetState() != PowerPC::CPU_RUNNING)
+	{
+		m_mixing.store(false, std::memory_order_release);
+		// Silence
+		memset(samples, 0, numSamples * 4);
+		return numSamples;
 	}
 
-	// Padding
-	unsigned short s[2];
-	s[0] = Common::swap16(m_buffer[(indexR - 1) & INDEX_MASK]);
-	s[1] = Common::swap16(m_buffer[(indexR - 2) & INDEX_MASK]);
+	unsigned int currentSample = m_dma_mixer.Mix(samples, numSamples, AudioInterface::GetAIDSampleRate(), consider_framelimit) * 2;
+
+	// Padding, with the last frame the DSP played
+	if (currentSample)
+	{
+		m_lastFrame[0] = samples[currentSample - 2];
+		m_lastFrame[1] = samples[currentSample - 1];
+	}
 	for (; currentSample < numSamples*2; currentSample+=2)
 	{
-		samples[currentSample] = s[0];
-		samples[currentSample+1] = s[1];
+		samples[currentSample] = m_lastFrame[0];
+		samples[currentSample+1] = m_lastFrame[1];
 	}
 
-	// Flush cached variable
-	Common::AtomicStore(m_indexR, indexR);
-
 	// Add the DSPHLE sound, re-sampling is done inside
 	Premix(samples, numSamples);
 
 	// Add the DTK Music
-	// Re-sampling is done inside
-	AudioInterface::Callback_GetStreaming(samples, numSamples, m_sampleRate);
+	short streaming[MAX_SAMPLES * 2];
+	unsigned int streamed = m_streaming_mixer.Mix(streaming, std::min<unsigned int>(numSamples, MAX_SAMPLES),
+	                                              AudioInterface::GetAISSampleRate(), consider_framelimit);
+	for (unsigned int i = 0; i < streamed * 2; i++)
+	{
+		int sample = samples[i] + streaming[i];
+		MathUtil::Clamp(&sample, -32767, 32767);
+		samples[i] = sample;
+	}
+
 	if (m_logAudio)
-		g_wave_writer.AddStereoSamples(samples, numSamples);
+		m_dumper.AddStereoSamples(samples, numSamples);
 
+	m_mixing.store(false, std::memory_order_release);
 	return numSamples;
 }
 
-
-void CMixer::PushSamples(const short *samples, unsigned int num_samples)
+bool CMixer::MixerFifo::PushSamples(const short *samples, unsigned int num_samples)
 {
-	// Cache access in non-volatile variable
-	// indexR isn't allowed to cache in the audio throttling loop as it
-	// needs to get updates to not deadlock.
-	u32 indexW = Common::AtomicLoad(m_indexW);
-
-	if (m_throttle)
-	{
-		// The auto throttle function. This loop will put a ceiling on the CPU MHz.
-		while (num_samples * 2 + ((indexW - Common::AtomicLoad(m_indexR)) & INDEX_MASK) >= MAX_SAMPLES * 2)
-		{
-			if (*PowerPC::GetStatePtr() != PowerPC::CPU_RUNNING || soundStream->IsMuted())
-				break;
-			// Shortcut key for Throttle Skipping
-			if (Host_GetKeyState('\t'))
-				break;
-			SLEEP(1);
-			soundStream->Update();
-		}
-	}
+	// Only this thread writes the write index
+	u32 indexW = m_indexW.load(std::memory_order_relaxed);
 
 	// Check if we have enough free space
 	// indexW == m_indexR results in empty buffer, so indexR must always be smaller than indexW
-	if (num_samples * 2 + ((indexW - Common::AtomicLoad(m_indexR)) & INDEX_MASK) >= MAX_SAMPLES * 2)
-		return;
+	if (num_samples * 2 + ((indexW - m_indexR.load(std::memory_order_acquire)) & INDEX_MASK) >= MAX_SAMPLES * 2)
+	{
+		m_overruns.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
 
 	// AyuanX: Actual re-sampling work has been moved to sound thread
 	// to alleviate the workload on main thread
@@ -153,8 +198,57 @@ void CMixer::PushSamples(const short *samples, unsigned int num_samples)
 		memcpy(&m_buffer[indexW & INDEX_MASK], samples, num_samples * 4);
 	}
 
-	Common::AtomicAdd(m_indexW, num_samples * 2);
+	// Publish the samples to Mix
+	m_indexW.store(indexW + num_samples * 2, std::memory_order_release);
+	return true;
+}
+
+void CMixer::PushSamples(const short *samples, unsigned int num_samples)
+{
+	if (m_throttle)
+	{
+		// The auto throttle function. This loop will put a ceiling on the CPU MHz.
+		u32 high_watermark = WatermarkFrames(m_highWatermark, AudioInterface::GetAIDSampleRate());
+		while (num_samples + m_dma_mixer.NumFrames() >= high_watermark)
+		{
+			if (*PowerPC::GetStatePtr() != PowerPC::CPU_RUNNING || soundStream->IsMuted())
+				break;
+			// Shortcut key for Throttle Skipping
+			if (Host_GetKeyState('\t'))
+				break;
+			SLEEP(1);
+			soundStream->Update();
+		}
+	}
+
+	m_dma_mixer.PushSamples(samples, num_samples);
+	ReportXruns();
+}
+
+void CMixer::PushStreamingSamples(const short *samples, unsigned int num_samples)
+{
+	m_streaming_mixer.PushSamples(samples, num_samples);
+}
 
-	return;
+void CMixer::SetPaused(bool paused)
+{
+	m_paused.store(paused);
+	while (paused && m_mixing.load())
+		Common::YieldCPU();
 }
 
+// Shows new underruns and overruns on screen, at most every XRUN_MESSAGE_INTERVAL ms
+void CMixer::ReportXruns()
+{
+	u32 underruns = GetUnderruns(), overruns = GetOverruns();
+	if (underruns + overruns == m_reportedXruns)
+		return;
+
+	u32 now = Common::Timer::GetTimeMs();
+	if (m_reportedXruns != 0 && now - m_lastXrunReport < XRUN_MESSAGE_INTERVAL)
+		return;
+
+	Core::DisplayMessage(StringFromFormat("Audio buffer underruns: %u, overruns: %u", underruns, overruns), 3000);
+	m_reportedXruns = underruns + overruns;
+	m_lastXrunReport = now;
+}
@@ -4,40 +4,31 @@
 
 #pragma once
 
-#include "AudioCommon/WaveFile.h"
-#include "Common/StdMutex.h"
+#include <atomic>
+#include <memory>
+
+#include "AudioCommon/AudioDumper.h"
+#include "AudioCommon/Resampler.h"
 
 // 16 bit Stereo
-#define MAX_SAMPLES     (1024 * 2) // 64ms
+#define MAX_SAMPLES     (1024 * 4) // 128ms at 32000 Hz
 #define INDEX_MASK      (MAX_SAMPLES * 2 - 1)
 
-#define LOW_WATERMARK   1280 // 40 ms
+// Defaults of the buffer watermarks, in ms. The mixer adjusts its rate to keep
+// the buffer at the low one, and the audio throttle blocks above the high one.
+#define LOW_WATERMARK   40
+#define HIGH_WATERMARK  64
 #define MAX_FREQ_SHIFT  200  // per 32000 Hz
 #define CONTROL_FACTOR  0.2  // in freq_shift per fifo size offset
 #define CONTROL_AVG     32
 
+// Least time between two underrun/overrun messages on screen, in ms
+#define XRUN_MESSAGE_INTERVAL 5000
+
 class CMixer {
 
 public:
-	CMixer(unsigned int AISampleRate = 48000, unsigned int DACSampleRate = 48000, unsigned int BackendSampleRate = 32000)
-		: m_aiSampleRate(AISampleRate)
-		, m_dacSampleRate(DACSampleRate)
-		, m_bits(16)
-		, m_channels(2)
-		, m_HLEready(false)
-		, m_logAudio(0)
-		, m_indexW(0)
-		, m_indexR(0)
-		, m_numLeftI(0.0f)
-	{
-		// AyuanX: The internal (Core & DSP) sample rate is fixed at 32KHz
-		// So when AI/DAC sample rate differs than 32KHz, we have to do re-sampling
-		m_sampleRate = BackendSampleRate;
-
-		memset(m_buffer, 0, sizeof(m_buffer));
-
-		INFO_LOG(AUDIO_INTERFACE, "Mixer is initialized (AISampleRate:%i, DACSampleRate:%i)", AISampleRate, DACSampleRate);
-	}
+	CMixer(unsigned int AISampleRate = 48000, unsigned int DACSampleRate = 48000, unsigned int BackendSampleRate = 32000);
 
 	virtual ~CMixer() {}
 
@@ -47,6 +38,8 @@ public:
 
 	// Called from main thread
 	virtual void PushSamples(const short* samples, unsigned int num_samples);
+	// DTK music, in the same format as the DSP's samples
+	void PushStreamingSamples(const short* samples, unsigned int num_samples);
 	unsigned int GetSampleRate() const {return m_sampleRate;}
 
 	void SetThrottle(bool use) { m_throttle = use;}
@@ -57,12 +50,14 @@ public:
 	// ---------------------
 
 
-	virtual void StartLogAudio(const char *filename) {
+	// format is one of AUDIO_DUMP_*
+	virtual void StartLogAudio(const char *filename, int format = AUDIO_DUMP_WAV) {
 		if (! m_logAudio) {
-			m_logAudio = true;
-			g_wave_writer.Start(filename, GetSampleRate());
-			g_wave_writer.SetSkipSilence(false);
-			NOTICE_LOG(DSPHLE, "Starting Audio logging");
+			if (m_dumper.Start(filename, GetSampleRate(), format))
+			{
+				m_logAudio = true;
+				NOTICE_LOG(DSPHLE, "Starting Audio logging");
+			}
 		} else {
 			WARN_LOG(DSPHLE, "Audio logging has already been started");
 		}
@@ -71,38 +66,87 @@ public:
 	virtual void StopLogAudio() {
 		if (m_logAudio) {
 			m_logAudio = false;
-			g_wave_writer.Stop();
+			m_dumper.Stop();
 			NOTICE_LOG(DSPHLE, "Stopping Audio logging");
 		} else {
 			WARN_LOG(DSPHLE, "Audio logging has already been stopped");
 		}
 	}
 
-	std::mutex& MixerCritical() { return m_csMixing; }
+	// Keeps the audio thread out of Mix (and so away from the emulated
+	// state Premix reads) until unpaused. Waits for a running Mix to finish.
+	void SetPaused(bool paused);
+
+	// Times the audio thread ran out of DSP samples and DSP samples were
+	// dropped because the buffer was full. The DTK stream isn't counted: it
+	// runs dry whenever a track stops and overflows above 100% speed.
+	u32 GetUnderruns() const { return m_dma_mixer.GetUnderruns(); }
+	u32 GetOverruns() const { return m_dma_mixer.GetOverruns(); }
 
 	float GetCurrentSpeed() const { return m_speed; }
 	void UpdateSpeed(volatile float val) { m_speed = val; }
 
 protected:
+	// A single producer, single consumer ring of samples at one input rate,
+	// resampled to the output rate without taking any locks. The CPU thread
+	// pushes, the audio thread mixes.
+	class MixerFifo {
+	public:
+		MixerFifo(CMixer *mixer);
+
+		// Returns false and drops the samples if they don't fit
+		bool PushSamples(const short* samples, unsigned int num_samples);
+		// Writes up to numSamples frames at the output rate, returns how many
+		unsigned int Mix(short* samples, unsigned int numSamples, unsigned int input_rate, bool consider_framelimit);
+
+		u32 NumFrames() const;
+		u32 GetUnderruns() const { return m_underruns.load(std::memory_order_relaxed); }
+		u32 GetOverruns() const { return m_overruns.load(std::memory_order_relaxed); }
+
+	private:
+		CMixer *m_mixer;
+		short m_buffer[MAX_SAMPLES * 2];
+		// Only the CPU thread writes m_indexW and only the audio thread m_indexR.
+		std::atomic<u32> m_indexW;
+		std::atomic<u32> m_indexR;
+		std::unique_ptr<Resampler> m_resampler;
+		float m_numLeftI;
+		bool m_playing;
+		std::atomic<u32> m_underruns;
+		std::atomic<u32> m_overruns;
+	};
+
+	void ReportXruns();
+
 	unsigned int m_sampleRate;
 	unsigned int m_aiSampleRate;
 	unsigned int m_dacSampleRate;
 	int m_bits;
 	int m_channels;
 
-	WaveFileWriter g_wave_writer;
+	// Written to from the audio thread, so it never waits on the disk
+	AudioDumper m_dumper;
 
 	bool m_HLEready;
-	bool m_logAudio;
+	std::atomic<bool> m_logAudio;
 
 	bool m_throttle;
 
-	short m_buffer[MAX_SAMPLES * 2];
-	volatile u32 m_indexW;
-	volatile u32 m_indexR;
+	MixerFifo m_dma_mixer;
+	MixerFifo m_streaming_mixer;
+
+	std::atomic<bool> m_paused;
+	std::atomic<bool> m_mixing;
+	// Pads the output when the DSP samples run out, audio thread only
+	short m_lastFrame[2];
+
+	// in ms
+	unsigned int m_lowWatermark;
+	unsigned int m_highWatermark;
 
-	std::mutex m_csMixing;
-	float m_numLeftI;
+	// Counts last shown on screen, CPU thread only
+	u32 m_reportedXruns;
+	u32 m_lastXrunReport;
 
 	volatile float m_speed; // Current rate of the emulation (1.0 = 100% speed)
 private:
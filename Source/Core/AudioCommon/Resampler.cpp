@@ -0,0 +1,209 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+
+#include "AudioCommon/Resampler.h"
+
+#if _M_X86
+#include <emmintrin.h>
+#endif
+
+// Cutoff relative to the input rate and Kaiser window shape of the sinc filter
+#define SINC_CUTOFF 0.45
+#define SINC_BETA   6.0
+
+Resampler* Resampler::Create(int type)
+{
+	if (type == RESAMPLER_SINC)
+		return new SincResampler();
+	return new LinearResampler();
+}
+
+unsigned int LinearResampler::Resample(const short* ring, u32 mask, u32& index, u32 end,
+                                       short* out, unsigned int num_frames, u32 ratio)
+{
+	u32 indexR = index;
+	u32 frac = m_frac;
+	unsigned int i = 0;
+
+	for (; i < num_frames && ((end - indexR) & mask) > 2; ++i)
+	{
+		u32 indexR2 = indexR + 2; //next sample
+
+		s16 l1 = Common::swap16(ring[indexR & mask]); //current
+		s16 l2 = Common::swap16(ring[indexR2 & mask]); //next
+		int sampleL = ((l1 << 16) + (l2 - l1) * (u16)frac) >> 16;
+		out[i * 2 + 1] = sampleL;
+
+		s16 r1 = Common::swap16(ring[(indexR + 1) & mask]); //current
+		s16 r2 = Common::swap16(ring[(indexR2 + 1) & mask]); //next
+		int sampleR = ((r1 << 16) + (r2 - r1) * (u16)frac) >> 16;
+		out[i * 2] = sampleR;
+
+		frac += ratio;
+		indexR += 2 * (u16)(frac >> 16);
+		frac &= 0xffff;
+	}
+
+	index = indexR;
+	m_frac = frac;
+	return i;
+}
+
+// Zeroth order modified Bessel function of the first kind
+static double BesselI0(double x)
+{
+	double sum = 1.0, term = 1.0;
+	for (int k = 1; k < 32; ++k)
+	{
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+SincResampler::SincResampler()
+	: m_held(0)
+	, m_frac(0)
+{
+	const double pi = 3.14159265358979323846;
+	const double half = SINC_TAPS / 2;
+
+	// Tap k of phase p weighs the input frame at k - (SINC_TAPS / 2 - 1) - p / SINC_PHASES
+	// relative to the output position.
+	for (int p = 0; p <= SINC_PHASES; ++p)
+	{
+		double sum = 0.0;
+		double coefs[SINC_TAPS];
+		for (int k = 0; k < SINC_TAPS; ++k)
+		{
+			double x = k - (half - 1) - (double)p / SINC_PHASES;
+			double sinc = x == 0.0 ? 1.0 : sin(2 * pi * SINC_CUTOFF * x) / (2 * pi * SINC_CUTOFF * x);
+			double w = x / half;
+			double window = w * w < 1.0 ? BesselI0(SINC_BETA * sqrt(1.0 - w * w)) / BesselI0(SINC_BETA) : 0.0;
+			coefs[k] = sinc * window;
+			sum += coefs[k];
+		}
+		// Unity gain at DC for every phase
+		for (int k = 0; k < SINC_TAPS; ++k)
+			m_coefs[p][k] = (float)(coefs[k] / sum);
+	}
+
+	memset(m_stage, 0, sizeof(m_stage));
+}
+
+// Converts count big endian frames to one float array per channel.
+static void ConvertFrames(const short* src, float* ch0, float* ch1, u32 count)
+{
+	u32 i = 0;
+
+#if _M_X86
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i v = _mm_loadu_si128((const __m128i*)(src + i * 2));
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		_mm_storeu_ps(ch0 + i, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(v, 16), 16)));
+		_mm_storeu_ps(ch1 + i, _mm_cvtepi32_ps(_mm_srai_epi32(v, 16)));
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		ch0[i] = (s16)Common::swap16(src[i * 2]);
+		ch1[i] = (s16)Common::swap16(src[i * 2 + 1]);
+	}
+}
+
+// Filters one output frame with the filter t of the way from coefs to the next
+// phase. first/second become out[0]/out[1].
+static inline void FilterFrame(const float* first, const float* second, const float* coefs, float t, short* out)
+{
+#if _M_X86
+	const __m128 weight = _mm_set1_ps(t);
+	__m128 sum_first = _mm_setzero_ps();
+	__m128 sum_second = _mm_setzero_ps();
+	for (int k = 0; k < SINC_TAPS; k += 4)
+	{
+		__m128 c = _mm_load_ps(coefs + k);
+		c = _mm_add_ps(c, _mm_mul_ps(_mm_sub_ps(_mm_load_ps(coefs + SINC_TAPS + k), c), weight));
+		sum_first = _mm_add_ps(sum_first, _mm_mul_ps(_mm_loadu_ps(first + k), c));
+		sum_second = _mm_add_ps(sum_second, _mm_mul_ps(_mm_loadu_ps(second + k), c));
+	}
+
+	// Sum both vectors at once, then round and saturate like packssdw does
+	__m128 sum = _mm_add_ps(_mm_unpacklo_ps(sum_first, sum_second), _mm_unpackhi_ps(sum_first, sum_second));
+	sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	__m128i result = _mm_cvtps_epi32(sum);
+	result = _mm_packs_epi32(result, result);
+	u32 frame = _mm_cvtsi128_si32(result);
+	memcpy(out, &frame, sizeof(frame));
+#else
+	float sum_first = 0.0f, sum_second = 0.0f;
+	for (int k = 0; k < SINC_TAPS; ++k)
+	{
+		float c = coefs[k] + (coefs[SINC_TAPS + k] - coefs[k]) * t;
+		sum_first += first[k] * c;
+		sum_second += second[k] * c;
+	}
+	out[0] = (s16)std::min(std::max(lrintf(sum_first), -32768L), 32767L);
+	out[1] = (s16)std::min(std::max(lrintf(sum_second), -32768L), 32767L);
+#endif
+}
+
+unsigned int SincResampler::Resample(const short* ring, u32 mask, u32& index, u32 end,
+                                     short* out, unsigned int num_frames, u32 ratio)
+{
+	const u32 max_count = (u32)(((u64)(SINC_STAGE - SINC_TAPS - 1) << 16) / std::max<u32>(ratio, 1));
+	unsigned int written = 0;
+
+	while (written < num_frames)
+	{
+		// Frames the next count outputs need in the staging buffer
+		u32 count = std::min<u32>(num_frames - written, std::max<u32>(max_count, 1));
+		u32 needed = (u32)((m_frac + (u64)(count - 1) * ratio) >> 16) + SINC_TAPS;
+		u32 avail = ((end - index) & mask) / 2;
+		u32 fetch = needed > m_held ? std::min(needed - m_held, avail) : 0;
+		bool starved = needed > m_held && fetch < needed - m_held;
+
+		// Copy them out of the ring in up to two runs
+		u32 fetched = 0;
+		while (fetched < fetch)
+		{
+			u32 pos = index & mask;
+			u32 run = std::min(fetch - fetched, (mask + 1 - pos) / 2);
+			ConvertFrames(ring + pos, &m_stage[0][m_held + fetched], &m_stage[1][m_held + fetched], run);
+			fetched += run;
+			index += run * 2;
+		}
+
+		const u32 total = m_held + fetch;
+		u32 pos = 0;
+		u32 frac = m_frac;
+		u32 done = 0;
+		for (; done < count && pos + SINC_TAPS <= total; ++done)
+		{
+			u32 phase = frac * SINC_PHASES;
+			FilterFrame(&m_stage[1][pos], &m_stage[0][pos], m_coefs[phase >> 16],
+			            (phase & 0xffff) * (1.0f / 65536), &out[(written + done) * 2]);
+			frac += ratio;
+			pos += frac >> 16;
+			frac &= 0xffff;
+		}
+		m_frac = frac;
+		written += done;
+
+		// Keep the frames the next output still needs as history
+		pos = std::min(pos, total);
+		m_held = total - pos;
+		memmove(&m_stage[0][0], &m_stage[0][pos], m_held * sizeof(float));
+		memmove(&m_stage[1][0], &m_stage[1][pos], m_held * sizeof(float));
+
+		if (starved || done == 0)
+			break;
+	}
+
+	return written;
+}
@@ -0,0 +1,73 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Resampling stages of CMixer. They read the mixer's ring of big endian stereo
+// frames and write native endian stereo frames with the channels swapped, the
+// way CMixer::Mix always produced them.
+
+#pragma once
+
+#include "Common/Common.h"
+
+#define SINC_TAPS   16
+#define SINC_PHASES 256
+#define SINC_STAGE  1024 // frames
+
+enum
+{
+	RESAMPLER_LINEAR = 0,
+	RESAMPLER_SINC,
+};
+
+class Resampler
+{
+public:
+	virtual ~Resampler() {}
+
+	// Reads the frames in ring[index & mask] .. ring[end & mask] (index, end
+	// and mask count shorts) and writes up to num_frames output frames,
+	// stepping through the input by ratio (16.16) per output frame.
+	// Advances index past the input used up and returns the frames written.
+	virtual unsigned int Resample(const short* ring, u32 mask, u32& index, u32 end,
+	                              short* out, unsigned int num_frames, u32 ratio) = 0;
+
+	// Input frames the stage holds back on top of what is left in the ring.
+	virtual unsigned int GetDelay() const = 0;
+
+	static Resampler* Create(int type);
+};
+
+// 16.16 fixed point linear interpolation between neighbouring frames.
+class LinearResampler : public Resampler
+{
+public:
+	LinearResampler() : m_frac(0) {}
+
+	virtual unsigned int Resample(const short* ring, u32 mask, u32& index, u32 end,
+	                              short* out, unsigned int num_frames, u32 ratio) override;
+	virtual unsigned int GetDelay() const override { return 0; }
+
+private:
+	u32 m_frac;
+};
+
+// Kaiser windowed sinc with SINC_TAPS taps. The filter for a fractional
+// position is interpolated between the two nearest of SINC_PHASES filters.
+// Input frames are converted to float into a staging buffer first, which keeps
+// the filter history of the previous call at its start.
+class SincResampler : public Resampler
+{
+public:
+	SincResampler();
+
+	virtual unsigned int Resample(const short* ring, u32 mask, u32& index, u32 end,
+	                              short* out, unsigned int num_frames, u32 ratio) override;
+	virtual unsigned int GetDelay() const override { return m_held; }
+
+private:
+	GC_ALIGNED16(float m_coefs[SINC_PHASES + 1][SINC_TAPS]);
+	float m_stage[2][SINC_STAGE];
+	u32 m_held;
+	u32 m_frac;
+};
@@ -0,0 +1,177 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+// a bounded lockless thread-safe queue backed by a fixed ring of slots,
+// single reader, single or multiple writers
+//
+// Unlike FifoQueue nothing is allocated per element, so it's meant for the
+// queues which see a lot of traffic (input reports).
+// Push fails instead of growing when the ring is full.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+
+template <typename T, size_t Capacity, bool MultiProducer = false>
+class RingQueue
+{
+	static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "RingQueue capacity must be a power of two");
+
+public:
+	RingQueue() : m_write(0), m_read(0)
+	{
+		// slot i is ready to be read when its sequence is i + 1
+		for (size_t i = 0; i < Capacity; ++i)
+			m_slots[i].sequence.store(0, std::memory_order_relaxed);
+	}
+
+	size_t Size() const
+	{
+		const size_t read = m_read.load(std::memory_order_acquire);
+		const size_t write = m_write.load(std::memory_order_acquire);
+		return std::min<size_t>(write - read, Capacity);
+	}
+
+	static size_t MaxSize() { return Capacity; }
+
+	bool Empty() const
+	{
+		const size_t read = m_read.load(std::memory_order_relaxed);
+		return m_slots[read & MASK].sequence.load(std::memory_order_acquire) != read + 1;
+	}
+
+	// only valid if !Empty()
+	T& Front()
+	{
+		const size_t read = m_read.load(std::memory_order_relaxed);
+		return m_slots[read & MASK].value;
+	}
+
+	// returns false if the queue is full
+	template <typename Arg>
+	bool Push(Arg&& t)
+	{
+		size_t pos;
+		if (!Reserve(1, pos))
+			return false;
+
+		Slot& slot = m_slots[pos & MASK];
+		slot.value = std::forward<Arg>(t);
+		slot.sequence.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// pushes up to count elements, returns how many fit
+	size_t PushBulk(const T* items, size_t count)
+	{
+		size_t pos;
+		const size_t n = Reserve(count, pos);
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			Slot& slot = m_slots[(pos + i) & MASK];
+			slot.value = items[i];
+			slot.sequence.store(pos + i + 1, std::memory_order_release);
+		}
+		return n;
+	}
+
+	void Pop()
+	{
+		const size_t read = m_read.load(std::memory_order_relaxed);
+		m_slots[read & MASK].value = T();
+		m_read.store(read + 1, std::memory_order_release);
+	}
+
+	bool Pop(T& t)
+	{
+		if (Empty())
+			return false;
+
+		const size_t read = m_read.load(std::memory_order_relaxed);
+		t = std::move(m_slots[read & MASK].value);
+		m_read.store(read + 1, std::memory_order_release);
+		return true;
+	}
+
+	// pops up to count elements, returns how many were available
+	size_t PopBulk(T* items, size_t count)
+	{
+		const size_t read = m_read.load(std::memory_order_relaxed);
+		size_t n = 0;
+		for (; n < count; ++n)
+		{
+			Slot& slot = m_slots[(read + n) & MASK];
+			if (slot.sequence.load(std::memory_order_acquire) != read + n + 1)
+				break;
+			items[n] = std::move(slot.value);
+		}
+		m_read.store(read + n, std::memory_order_release);
+		return n;
+	}
+
+	// not thread-safe
+	void Clear()
+	{
+		while (!Empty())
+			Pop();
+	}
+
+private:
+	enum { MASK = Capacity - 1, CACHE_LINE_SIZE = 64 };
+
+	// Claims up to count consecutive slots starting at pos, returns how many.
+	// The reader frees slots in order, so comparing against m_read is enough to know they're unused.
+	size_t Reserve(size_t count, size_t& pos)
+	{
+		pos = m_write.load(std::memory_order_relaxed);
+		while (true)
+		{
+			const size_t used = pos - m_read.load(std::memory_order_acquire);
+			if (used > Capacity)
+			{
+				// another writer moved on and the reader already passed our stale position
+				pos = m_write.load(std::memory_order_relaxed);
+				continue;
+			}
+
+			const size_t n = std::min(count, Capacity - used);
+			if (n == 0)
+				return 0;
+
+			if (!MultiProducer)
+			{
+				m_write.store(pos + n, std::memory_order_relaxed);
+				return n;
+			}
+
+			if (m_write.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed))
+				return n;
+		}
+	}
+
+	struct Slot
+	{
+		T value;
+		std::atomic<size_t> sequence;
+	};
+
+	// keep the writer and reader positions on separate cache lines
+	std::atomic<size_t> m_write;
+	char m_write_pad[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+	std::atomic<size_t> m_read;
+	char m_read_pad[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>)];
+
+	Slot m_slots[Capacity];
+};
+
+}
@@ -32,6 +32,25 @@ u32 Timer::GetTimeMs()
 #endif
 }
 
+u64 Timer::GetTimeUs()
+{
+#ifdef _WIN32
+	LARGE_INTEGER freq, count;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (u64)(count.QuadPart / freq.QuadPart) * 1000000 +
+	       (u64)(count.QuadPart % freq.QuadPart) * 1000000 / freq.QuadPart;
+#elif defined __APPLE__
+	struct timeval t;
+	(void)gettimeofday(&t, NULL);
+	return (u64)t.tv_sec * 1000000 + t.tv_usec;
+#else
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (u64)t.tv_sec * 1000000 + t.tv_nsec / 1000;
+#endif
+}
+
 // --------------------------------------------
 // Initiate, Start, Stop, and Update the time
 // --------------------------------------------
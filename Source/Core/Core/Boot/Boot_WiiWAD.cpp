@@ -3,10 +3,12 @@
 // Refer to the license.txt file included.
 
 #include <memory>
+#include <vector>
 
 #include "Common/CommonPaths.h"
 #include "Common/FileUtil.h"
 #include "Common/NandPaths.h"
+#include "Common/Timer.h"
 
 #include "Core/ConfigManager.h"
 #include "Core/PatchEngine.h"
@@ -47,6 +49,9 @@ typedef struct {
 
 bool CBoot::Boot_WiiWAD(const char* _pFilename)
 {
+	// For the time to the first instruction
+	u32 start_time = Common::Timer::GetTimeMs();
+	DiscIO::SNANDContentStats start_stats = DiscIO::GetNANDContentStats();
 
 	std::string state_filename(Common::GetTitleDataPath(TITLEID_SYSMENU) + WII_STATE);
 
@@ -98,7 +103,8 @@ bool CBoot::Boot_WiiWAD(const char* _pFilename)
 	std::unique_ptr<CDolLoader> pDolLoader;
 	if (pContent->m_pData)
 	{
-		pDolLoader.reset(new CDolLoader(pContent->m_pData, pContent->m_Size));
+		std::vector<u8> data = pContent->m_pData->Get();
+		pDolLoader.reset(new CDolLoader(data.data(), (u32)data.size()));
 	}
 	else
 	{
@@ -107,6 +113,11 @@ bool CBoot::Boot_WiiWAD(const char* _pFilename)
 	pDolLoader->Load();
 	PC = pDolLoader->GetEntryPoint() | 0x80000000;
 
+	DiscIO::SNANDContentStats stats = DiscIO::GetNANDContentStats();
+	NOTICE_LOG(BOOT, "WAD ready to run after %u ms: decrypted %u chunks (%u KiB), %u cache hits",
+		Common::Timer::GetTimeMs() - start_time, stats.chunks_decrypted - start_stats.chunks_decrypted,
+		(u32)((stats.bytes_read - start_stats.bytes_read) / 1024), stats.cache_hits - start_stats.cache_hits);
+
 	// Pass the "#002 check"
 	// Apploader should write the IOS version and revision to 0x3140, and compare it
 	// to 0x3188 to pass the check, but we don't do it, and i don't know where to read the IOS rev...
@@ -2,6 +2,7 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include "AudioCommon/Mixer.h"
 #include "Common/Common.h"
 #include "Common/CommonPaths.h"
 #include "Common/FileUtil.h"
@@ -232,6 +233,7 @@ void SConfig::SaveSettings()
 	ini.Set("Core", "CPUThread",        m_LocalCoreStartupParameter.bCPUThread);
 	ini.Set("Core", "DSPThread",        m_LocalCoreStartupParameter.bDSPThread);
 	ini.Set("Core", "DSPHLE",           m_LocalCoreStartupParameter.bDSPHLE);
+	ini.Set("Core", "DSPHLEThread",     m_LocalCoreStartupParameter.bDSPHLEThread);
 	ini.Set("Core", "SkipIdle",         m_LocalCoreStartupParameter.bSkipIdle);
 	ini.Set("Core", "DefaultGCM",       m_LocalCoreStartupParameter.m_strDefaultGCM);
 	ini.Set("Core", "DVDRoot",          m_LocalCoreStartupParameter.m_strDVDRoot);
@@ -242,6 +244,7 @@ void SConfig::SaveSettings()
 	ini.Set("Core", "Latency",          m_LocalCoreStartupParameter.iLatency);
 	ini.Set("Core", "MemcardAPath",     m_strMemoryCardA);
 	ini.Set("Core", "MemcardBPath",     m_strMemoryCardB);
+	ini.Set("Core", "MemcardMMap",      m_MemcardMMap);
 	ini.Set("Core", "SlotA",            m_EXIDevice[0]);
 	ini.Set("Core", "SlotB",            m_EXIDevice[1]);
 	ini.Set("Core", "SerialPort1",      m_EXIDevice[2]);
@@ -252,6 +255,7 @@ void SConfig::SaveSettings()
 	}
 	ini.Set("Core", "WiiSDCard", m_WiiSDCard);
 	ini.Set("Core", "WiiKeyboard", m_WiiKeyboard);
+	ini.Set("Core", "NANDOverlay", m_NANDOverlay);
 	ini.Set("Core", "WiimoteContinuousScanning", m_WiimoteContinuousScanning);
 	ini.Set("Core", "WiimoteEnableSpeaker", m_WiimoteEnableSpeaker);
 	ini.Set("Core", "RunCompareServer", m_LocalCoreStartupParameter.bRunCompareServer);
@@ -269,8 +273,12 @@ void SConfig::SaveSettings()
 	// DSP
 	ini.Set("DSP", "EnableJIT", m_DSPEnableJIT);
 	ini.Set("DSP", "DumpAudio", m_DumpAudio);
+	ini.Set("DSP", "DumpAudioFormat", m_DumpAudioFormat);
 	ini.Set("DSP", "Backend", sBackend);
 	ini.Set("DSP", "Volume", m_Volume);
+	ini.Set("DSP", "Resampler", m_Resampler);
+	ini.Set("DSP", "MixerLowWatermark", m_MixerLowWatermark);
+	ini.Set("DSP", "MixerHighWatermark", m_MixerHighWatermark);
 
 	// Fifo Player
 	ini.Set("FifoPlayer", "LoopReplay", m_LocalCoreStartupParameter.bLoopFifoReplay);
@@ -387,6 +395,7 @@ void SConfig::LoadSettings()
 		ini.Get("Core", "Fastmem",           &m_LocalCoreStartupParameter.bFastmem,      true);
 		ini.Get("Core", "DSPThread",         &m_LocalCoreStartupParameter.bDSPThread,    false);
 		ini.Get("Core", "DSPHLE",            &m_LocalCoreStartupParameter.bDSPHLE,       true);
+		ini.Get("Core", "DSPHLEThread",      &m_LocalCoreStartupParameter.bDSPHLEThread, false);
 		ini.Get("Core", "CPUThread",         &m_LocalCoreStartupParameter.bCPUThread,    true);
 		ini.Get("Core", "SkipIdle",          &m_LocalCoreStartupParameter.bSkipIdle,     true);
 		ini.Get("Core", "DefaultGCM",        &m_LocalCoreStartupParameter.m_strDefaultGCM);
@@ -398,6 +407,7 @@ void SConfig::LoadSettings()
 		ini.Get("Core", "Latency",           &m_LocalCoreStartupParameter.iLatency, 2);
 		ini.Get("Core", "MemcardAPath",      &m_strMemoryCardA);
 		ini.Get("Core", "MemcardBPath",      &m_strMemoryCardB);
+		ini.Get("Core", "MemcardMMap",       &m_MemcardMMap,     false);
 		ini.Get("Core", "SlotA",       (int*)&m_EXIDevice[0], EXIDEVICE_MEMORYCARD);
 		ini.Get("Core", "SlotB",       (int*)&m_EXIDevice[1], EXIDEVICE_NONE);
 		ini.Get("Core", "SerialPort1", (int*)&m_EXIDevice[2], EXIDEVICE_NONE);
@@ -410,6 +420,7 @@ void SConfig::LoadSettings()
 		}
 		ini.Get("Core", "WiiSDCard",                 &m_WiiSDCard,                                   false);
 		ini.Get("Core", "WiiKeyboard",               &m_WiiKeyboard,                                 false);
+		ini.Get("Core", "NANDOverlay",               &m_NANDOverlay,                                 false);
 		ini.Get("Core", "WiimoteContinuousScanning", &m_WiimoteContinuousScanning,                   false);
 		ini.Get("Core", "WiimoteEnableSpeaker",      &m_WiimoteEnableSpeaker,                        true);
 		ini.Get("Core", "RunCompareServer",          &m_LocalCoreStartupParameter.bRunCompareServer, false);
@@ -434,6 +445,7 @@ void SConfig::LoadSettings()
 		// DSP
 		ini.Get("DSP", "EnableJIT", &m_DSPEnableJIT, true);
 		ini.Get("DSP", "DumpAudio", &m_DumpAudio, false);
+		ini.Get("DSP", "DumpAudioFormat", &m_DumpAudioFormat, AUDIO_DUMP_WAV);
 	#if defined __linux__ && HAVE_ALSA
 		ini.Get("DSP", "Backend", &sBackend, BACKEND_ALSA);
 	#elif defined __APPLE__
@@ -446,6 +458,9 @@ void SConfig::LoadSettings()
 		ini.Get("DSP", "Backend", &sBackend, BACKEND_NULLSOUND);
 	#endif
 		ini.Get("DSP", "Volume", &m_Volume, 100);
+		ini.Get("DSP", "Resampler", &m_Resampler, RESAMPLER_LINEAR);
+		ini.Get("DSP", "MixerLowWatermark", &m_MixerLowWatermark, LOW_WATERMARK);
+		ini.Get("DSP", "MixerHighWatermark", &m_MixerHighWatermark, HIGH_WATERMARK);
 
 		ini.Get("FifoPlayer", "LoopReplay", &m_LocalCoreStartupParameter.bLoopFifoReplay, true);
 	}
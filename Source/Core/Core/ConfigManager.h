@@ -27,6 +27,7 @@ struct SConfig : NonCopyable
 	// Wii Devices
 	bool m_WiiSDCard;
 	bool m_WiiKeyboard;
+	bool m_NANDOverlay;
 	bool m_WiimoteContinuousScanning;
 	bool m_WiimoteEnableSpeaker;
 
@@ -42,6 +43,7 @@ struct SConfig : NonCopyable
 
 	std::string m_strMemoryCardA;
 	std::string m_strMemoryCardB;
+	bool m_MemcardMMap;
 	TEXIDevices m_EXIDevice[3];
 	SIDevices m_SIDevice[4];
 	std::string m_bba_mac;
@@ -81,8 +83,12 @@ struct SConfig : NonCopyable
 	// DSP settings
 	bool m_DSPEnableJIT;
 	bool m_DumpAudio;
+	int m_DumpAudioFormat; // AUDIO_DUMP_*
 	int m_Volume;
 	std::string sBackend;
+	int m_Resampler;
+	unsigned int m_MixerLowWatermark;
+	unsigned int m_MixerHighWatermark;
 
 	SysConf* m_SYSCONF;
 
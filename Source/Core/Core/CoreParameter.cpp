@@ -33,7 +33,7 @@ SCoreStartupParameter::SCoreStartupParameter()
   bJITBranchOff(false),
   bJITILTimeProfiling(false), bJITILOutputIR(false),
   bEnableFPRF(false),
-  bCPUThread(true), bDSPThread(false), bDSPHLE(true),
+  bCPUThread(true), bDSPThread(false), bDSPHLE(true), bDSPHLEThread(false),
   bSkipIdle(true), bNTSC(false), bForceNTSCJ(false),
   bHLE_BS2(true), bEnableCheats(false),
   bMergeBlocks(false), bEnableMemcardSaving(true),
@@ -120,6 +120,7 @@ struct SCoreStartupParameter
 	bool bCPUThread;
 	bool bDSPThread;
 	bool bDSPHLE;
+	bool bDSPHLEThread; // mix AX command lists on a worker thread
 	bool bSkipIdle;
 	bool bNTSC;
 	bool bForceNTSCJ;
@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include "Core/DSP/DSPAnalyzer.h"
+#include "Core/DSP/DSPCore.h"
 #include "Core/DSP/DSPInterpreter.h"
 #include "Core/DSP/DSPMemoryMap.h"
 #include "Core/DSP/DSPTables.h"
@@ -60,9 +61,236 @@ const u16 idle_skip_sigs[NUM_IDLE_SIGS][MAX_IDLE_SIG_SIZE + 1] =
 	  0, 0 }
 };
 
+// Longest loop body (in words) the data flow pass looks at.
+#define MAX_IDLE_LOOP_SIZE 8
+
+static int num_sig_idle_loops;
+static int num_flow_idle_loops;
+
 void Reset()
 {
 	memset(code_flags, 0, sizeof(code_flags));
+	num_sig_idle_loops = 0;
+	num_flow_idle_loops = 0;
+}
+
+// Reading these doesn't change anything, so a loop polling them can only see
+// a different value after something outside the DSP code happened (a mail,
+// a DMA, an interrupt handler writing to DRAM...).
+static bool IsSideEffectFreeLoad(u16 addr)
+{
+	if (addr < DSP_DRAM_SIZE)
+		return true;
+
+	if ((addr & 0xff00) != 0xff00)
+		return false;
+
+	switch (addr & 0xff)
+	{
+	case DSP_DSCR:
+	case DSP_ACSAH:
+	case DSP_ACSAL:
+	case DSP_ACEAH:
+	case DSP_ACEAL:
+	case DSP_ACCAH:
+	case DSP_ACCAL:
+	case DSP_DMBH:
+	case DSP_CMBH:
+		return true;
+	default:
+		// Mostly the accelerator data and low mailbox halves, which get
+		// consumed by the read.
+		return false;
+	}
+}
+
+static u32 RegBit(int reg)
+{
+	return 1u << reg;
+}
+
+static u32 AccBits(int acc)
+{
+	return RegBit(DSP_REG_ACH0 + acc) | RegBit(DSP_REG_ACM0 + acc) | RegBit(DSP_REG_ACL0 + acc);
+}
+
+// Register effects of one instruction of a polling loop. Only the few
+// instructions such loops are made of are known, anything else (stores,
+// calls, stack accesses...) makes the loop not idle.
+static bool GetIdleLoopEffects(u16 addr, u32& reads, u32& writes, bool& load)
+{
+	UDSPInstruction inst = dsp_imem_read(addr);
+	const DSPOPCTemplate *opcode = GetOpTemplate(inst);
+	reads = writes = 0;
+	load = false;
+
+	// The extension part of an instruction could load or store.
+	if (opcode->extended && (inst & 0x00fc) != 0)
+		return false;
+
+	switch (opcode->opcode)
+	{
+	case 0x0000: // NOP
+		return true;
+
+	case 0x00c0: // LR
+	case 0x2000: // LRS
+	{
+		int dreg;
+		u16 src;
+		if (opcode->opcode == 0x00c0)
+		{
+			dreg = inst & 0x1f;
+			src = dsp_imem_read(addr + 1);
+		}
+		else
+		{
+			// ucodes always keep $cr at 0xff, the signatures rely on that too
+			dreg = DSP_REG_AXL0 + ((inst >> 8) & 0x7);
+			src = 0xff00 | (inst & 0xff);
+			reads |= RegBit(DSP_REG_CR);
+		}
+
+		if (!IsSideEffectFreeLoad(src))
+			return false;
+		// these change more than a register
+		if ((dreg >= DSP_REG_ST0 && dreg <= DSP_REG_ST3) || dreg == DSP_REG_CR || dreg == DSP_REG_SR)
+			return false;
+
+		writes |= RegBit(dreg);
+		// $acX.m is extended to the whole accumulator in 40-bit mode
+		if (dreg == DSP_REG_ACM0 || dreg == DSP_REG_ACM1)
+			writes |= AccBits(dreg - DSP_REG_ACM0);
+		load = true;
+		return true;
+	}
+
+	case 0x02a0: // ANDF
+	case 0x02c0: // ANDCF
+		reads |= RegBit(DSP_REG_ACM0 + ((inst >> 8) & 1));
+		writes |= RegBit(DSP_REG_SR);
+		return true;
+
+	case 0x0240: // ANDI
+		reads |= RegBit(DSP_REG_ACM0 + ((inst >> 8) & 1));
+		writes |= RegBit(DSP_REG_ACM0 + ((inst >> 8) & 1)) | RegBit(DSP_REG_SR);
+		return true;
+
+	case 0x0280: // CMPI
+	case 0x0600: // CMPIS
+		reads |= AccBits((inst >> 8) & 1);
+		writes |= RegBit(DSP_REG_SR);
+		return true;
+
+	case 0xb100: // TST
+		reads |= AccBits((inst >> 11) & 1);
+		writes |= RegBit(DSP_REG_SR);
+		return true;
+
+	case 0x8600: // TSTAXH
+		reads |= RegBit(DSP_REG_AXH0 + ((inst >> 8) & 1));
+		writes |= RegBit(DSP_REG_SR);
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+// Checks whether [start_addr, end_addr) is the body of a loop which only
+// polls external state: every iteration has to recompute the exit condition
+// from scratch out of side-effect-free loads. Any value carried over from the
+// previous iteration (a counter, a pointer) means the loop makes progress by
+// itself and skipping its cycles would change the result.
+static bool IsIdleLoopBody(u16 start_addr, u16 end_addr)
+{
+	u32 loop_writes = 0;
+	for (u16 addr = start_addr; addr < end_addr;)
+	{
+		const DSPOPCTemplate *opcode = GetOpTemplate(dsp_imem_read(addr));
+		if (!opcode || !(code_flags[addr] & CODE_START_OF_INST) ||
+		    (code_flags[addr] & (CODE_LOOP_START | CODE_LOOP_END)))
+			return false;
+
+		u32 reads, writes;
+		bool load;
+		if (!GetIdleLoopEffects(addr, reads, writes, load))
+			return false;
+		loop_writes |= writes;
+		addr += opcode->size;
+	}
+
+	u32 defined = 0;
+	u32 external = 0;
+	for (u16 addr = start_addr; addr < end_addr;)
+	{
+		const DSPOPCTemplate *opcode = GetOpTemplate(dsp_imem_read(addr));
+
+		u32 reads, writes;
+		bool load;
+		GetIdleLoopEffects(addr, reads, writes, load);
+
+		if (reads & loop_writes & ~defined)
+			return false;
+
+		if (load || (reads & external))
+			external |= writes;
+		else
+			external &= ~writes;
+		defined |= writes;
+		addr += opcode->size;
+	}
+
+	// The branch back has to depend on what was loaded.
+	return (external & RegBit(DSP_REG_SR)) != 0;
+}
+
+static bool IsConditionalJump(UDSPInstruction inst)
+{
+	return inst >= 0x0290 && inst <= 0x029e;
+}
+
+// Looks for small loops polling the mailboxes, the DMA or the accelerator and
+// marks their first instruction for idle skipping. Two shapes are recognized:
+//   loop: ...; Jcc loop
+//   loop: ...; Jcc exit; JMP loop
+static void FindIdleLoops(int start_addr, int end_addr)
+{
+	for (int addr = start_addr; addr < end_addr; addr++)
+	{
+		if (!(code_flags[addr] & CODE_START_OF_INST))
+			continue;
+
+		UDSPInstruction inst = dsp_imem_read(addr);
+		if (!IsConditionalJump(inst) && inst != 0x029f)
+			continue;
+
+		u16 loop_start = dsp_imem_read(addr + 1);
+		if (loop_start > addr || loop_start < start_addr || addr - loop_start > MAX_IDLE_LOOP_SIZE)
+			continue;
+		if (code_flags[loop_start] & CODE_IDLE_SKIP)
+			continue;
+
+		u16 body_end = addr;
+		if (inst == 0x029f)
+		{
+			// the exit has to be the last instruction before jumping back
+			if (addr - loop_start < 2 || !IsConditionalJump(dsp_imem_read(addr - 2)) ||
+			    !(code_flags[addr - 2] & CODE_START_OF_INST))
+				continue;
+			u16 exit_addr = dsp_imem_read(addr - 1);
+			if (exit_addr >= loop_start && exit_addr <= addr)
+				continue;
+			body_end = addr - 2;
+		}
+
+		if (!IsIdleLoopBody(loop_start, body_end))
+			continue;
+
+		INFO_LOG(DSPLLE, "Idle loop found at %04x-%04x", loop_start, addr);
+		code_flags[loop_start] |= CODE_IDLE_SKIP;
+		num_flow_idle_loops++;
+	}
 }
 
 void AnalyzeRange(int start_addr, int end_addr)
@@ -72,7 +300,6 @@ void AnalyzeRange(int start_addr, int end_addr)
 
 	// This may not be 100% accurate in case of jump tables!
 	// It could get desynced, which would be bad. We'll see if that's an issue.
-	u16 last_arithmetic = 0;
 	for (int addr = start_addr; addr < end_addr;)
 	{
 		UDSPInstruction inst = dsp_imem_read(addr);
@@ -98,18 +325,6 @@ void AnalyzeRange(int start_addr, int end_addr)
 			code_flags[addr + 1] |= CODE_LOOP_END;
 		}
 
-		// Mark the last arithmetic/multiplier instruction before a branch.
-		// We must update the SR reg at these instructions
-		if (opcode->updates_sr)
-		{
-			last_arithmetic = addr;
-		}
-
-		if (opcode->branch && !opcode->uncond_branch)
-		{
-			code_flags[last_arithmetic] |= CODE_UPDATE_SR;
-		}
-
 		// If an instruction potentially raises exceptions, mark the following
 		// instruction as needing to check for exceptions
 		if (opcode->opcode == 0x00c0 ||
@@ -143,10 +358,14 @@ void AnalyzeRange(int start_addr, int end_addr)
 			if (found)
 			{
 				INFO_LOG(DSPLLE, "Idle skip location found at %02x (sigNum:%d)", addr, s+1);
+				if (!(code_flags[addr] & CODE_IDLE_SKIP))
+					num_sig_idle_loops++;
 				code_flags[addr] |= CODE_IDLE_SKIP;
 			}
 		}
 	}
+
+	FindIdleLoops(start_addr, end_addr);
 	INFO_LOG(DSPLLE, "Finished analysis.");
 }
 
@@ -155,6 +374,8 @@ void Analyze()
 	Reset();
 	AnalyzeRange(0x0000, 0x1000);  // IRAM
 	AnalyzeRange(0x8000, 0x9000);  // IROM
+	NOTICE_LOG(DSPLLE, "Idle skipping %d loops (%d matched a signature, %d found by data flow)",
+		num_sig_idle_loops + num_flow_idle_loops, num_sig_idle_loops, num_flow_idle_loops);
 }
 
 }  // namespace
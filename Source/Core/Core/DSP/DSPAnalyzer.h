@@ -20,7 +20,6 @@ enum
 	CODE_IDLE_SKIP     = 2,
 	CODE_LOOP_START    = 4,
 	CODE_LOOP_END      = 8,
-	CODE_UPDATE_SR     = 16,
 	CODE_CHECK_INT     = 32,
 };
 
@@ -4,6 +4,8 @@
 
 #include <cstring>
 
+#include "Common/Hash.h"
+
 #include "Core/DSP/DSPAnalyzer.h"
 #include "Core/DSP/DSPCore.h"
 #include "Core/DSP/DSPEmitter.h"
@@ -11,12 +13,17 @@
 #include "Core/DSP/DSPInterpreter.h"
 #include "Core/DSP/DSPMemoryMap.h"
 
-#define MAX_BLOCK_SIZE 250
 #define DSP_IDLE_SKIP_CYCLES 0x1000
 
 using namespace Gen;
 
-DSPEmitter::DSPEmitter() : gpr(*this), storeIndex(-1), storeIndex2(-1)
+// Only these ranges of instruction memory contain code that can be compiled.
+static const u16 s_code_ranges[][2] = {
+	{ 0x0000, DSP_IRAM_SIZE },
+	{ 0x8000, 0x8000 + DSP_IROM_SIZE },
+};
+
+DSPEmitter::DSPEmitter() : gpr(*this), m_iram_hash(0), storeIndex(-1), storeIndex2(-1)
 {
 	m_compiledCode = NULL;
 
@@ -50,16 +57,84 @@ DSPEmitter::~DSPEmitter()
 	FreeCodeSpace();
 }
 
+void DSPEmitter::ClearBlock(u16 addr)
+{
+	blocks[addr] = (DSPCompiledCode)stubEntryPoint;
+	blockLinks[addr] = 0;
+	blockSize[addr] = 0;
+	unresolvedJumps[addr].clear();
+}
+
+void DSPEmitter::SaveUCodeBlocks(CachedUCode& ucode)
+{
+	ucode.iram.swap(m_iram_image);
+	ucode.blocks.clear();
+	ucode.blockLinks.clear();
+	ucode.blockSize.clear();
+	ucode.unresolvedJumps.clear();
+
+	for (auto& range : s_code_ranges)
+	{
+		ucode.blocks.insert(ucode.blocks.end(), blocks + range[0], blocks + range[1]);
+		ucode.blockLinks.insert(ucode.blockLinks.end(), blockLinks + range[0], blockLinks + range[1]);
+		ucode.blockSize.insert(ucode.blockSize.end(), blockSize + range[0], blockSize + range[1]);
+
+		for (u32 addr = range[0]; addr < range[1]; ++addr)
+		{
+			if (!unresolvedJumps[addr].empty())
+				ucode.unresolvedJumps.push_back(std::make_pair((u16)addr, unresolvedJumps[addr]));
+		}
+	}
+}
+
+void DSPEmitter::LoadUCodeBlocks(const CachedUCode& ucode)
+{
+	size_t i = 0;
+	for (auto& range : s_code_ranges)
+	{
+		for (u32 addr = range[0]; addr < range[1]; ++addr, ++i)
+		{
+			blocks[addr] = ucode.blocks[i];
+			blockLinks[addr] = ucode.blockLinks[i];
+			blockSize[addr] = ucode.blockSize[i];
+			unresolvedJumps[addr].clear();
+		}
+	}
+
+	for (auto& jumps : ucode.unresolvedJumps)
+		unresolvedJumps[jumps.first] = jumps.second;
+}
+
 void DSPEmitter::ClearIRAM()
 {
-	for(int i = 0x0000; i < 0x1000; i++)
+	// Remember what was compiled for the previous ucode. ROM blocks are kept
+	// with it since they may be linked to its IRAM blocks.
+	if (m_iram_hash)
+		SaveUCodeBlocks(m_ucode_cache[m_iram_hash]);
+
+	m_iram_hash = HashEctor((const u8*)g_dsp.iram, DSP_IRAM_BYTE_SIZE);
+	m_iram_image.assign(g_dsp.iram, g_dsp.iram + DSP_IRAM_SIZE);
+
+	auto cached = m_ucode_cache.find(m_iram_hash);
+	if (cached != m_ucode_cache.end() && GetSpaceLeft() >= CODE_CACHE_MIN_SPACE_LEFT &&
+	    cached->second.iram.size() == DSP_IRAM_SIZE &&
+	    !memcmp(&cached->second.iram[0], g_dsp.iram, DSP_IRAM_BYTE_SIZE))
 	{
-		blocks[i] = (DSPCompiledCode)stubEntryPoint;
-		blockLinks[i] = 0;
-		blockSize[i] = 0;
-		unresolvedJumps[i].clear();
+		NOTICE_LOG(DSPLLE, "Reusing compiled blocks for IRAM hash %08x", m_iram_hash);
+		LoadUCodeBlocks(cached->second);
+		return;
+	}
+
+	for (auto& range : s_code_ranges)
+	{
+		for (u32 addr = range[0]; addr < range[1]; ++addr)
+			ClearBlock(addr);
 	}
-	g_dsp.reset_dspjit_codespace = true;
+
+	// The blocks currently running can't be freed here, the code space is
+	// reset once we're back in DSPCore_RunCycles.
+	if (GetSpaceLeft() < CODE_CACHE_MIN_SPACE_LEFT)
+		g_dsp.reset_dspjit_codespace = true;
 }
 
 void DSPEmitter::ClearIRAMandDSPJITCodespaceReset()
@@ -69,12 +144,10 @@ void DSPEmitter::ClearIRAMandDSPJITCodespaceReset()
 	stubEntryPoint = CompileStub();
 
 	for(int i = 0x0000; i < 0x10000; i++)
-	{
-		blocks[i] = (DSPCompiledCode)stubEntryPoint;
-		blockLinks[i] = 0;
-		blockSize[i] = 0;
-		unresolvedJumps[i].clear();
-	}
+		ClearBlock(i);
+
+	// All cached blocks pointed into the code space we just threw away.
+	m_ucode_cache.clear();
 	g_dsp.reset_dspjit_codespace = false;
 }
 
@@ -102,12 +175,97 @@ void DSPEmitter::checkExceptions(u32 retval)
 bool DSPEmitter::FlagsNeeded()
 {
 	if (!(DSPAnalyzer::code_flags[compilePC] & DSPAnalyzer::CODE_START_OF_INST) ||
-		(DSPAnalyzer::code_flags[compilePC] & DSPAnalyzer::CODE_UPDATE_SR))
+		m_flags_needed[compilePC - startAddr])
 		return true;
 	else
 		return false;
 }
 
+// The opcodes whose flags come from Update_SR_Register64_Carry(2). Those can
+// set the sticky overflow bit.
+static const dspJitFunc s_sticky_overflow_ops[] = {
+	&DSPEmitter::add, &DSPEmitter::addax, &DSPEmitter::addaxl, &DSPEmitter::addi,
+	&DSPEmitter::addis, &DSPEmitter::addp, &DSPEmitter::addpaxz, &DSPEmitter::addr,
+	&DSPEmitter::cmp, &DSPEmitter::cmpar, &DSPEmitter::cmpi, &DSPEmitter::cmpis,
+	&DSPEmitter::dec, &DSPEmitter::decm, &DSPEmitter::inc, &DSPEmitter::incm,
+	&DSPEmitter::sub, &DSPEmitter::subax, &DSPEmitter::subp, &DSPEmitter::subr,
+};
+
+// Only the SR writes of the Update_SR_* helpers are skipped, so this only
+// needs to know about the bits those write.
+static u16 GetWrittenFlags(const DSPOPCTemplate *opcode)
+{
+	if (!opcode->updates_sr)
+		return 0;
+	// ANDCF and ANDF only touch the logic zero bit.
+	if (opcode->opcode == 0x02a0 || opcode->opcode == 0x02c0)
+		return SR_LOGIC_ZERO;
+	for (auto func : s_sticky_overflow_ops)
+	{
+		if (opcode->jitFunc == func)
+			return SR_CMP_MASK | SR_OVERFLOW_STICKY;
+	}
+	return SR_CMP_MASK;
+}
+
+static bool ReadsSR(UDSPInstruction inst, const DSPOPCTemplate *opcode)
+{
+	for (int i = 0; i < opcode->param_count; i++)
+	{
+		const param2_t &param = opcode->params[i];
+		if (param.type == P_REG && param.loc == 0 && param.lshift >= 0 &&
+		    ((inst & param.mask) >> param.lshift) == DSP_REG_SR)
+			return true;
+	}
+	return false;
+}
+
+// Flags are only computed where they can be observed: by a later instruction
+// of the block that reads SR or branches on it, or by whatever runs after the
+// block is left. Flags overwritten before that are skipped.
+// The walk mirrors the termination rules of Compile().
+void DSPEmitter::AnalyzeBlockFlags(u16 start_addr)
+{
+	u16 addrs[MAX_BLOCK_SIZE];
+	int count = 0;
+
+	u16 addr = start_addr;
+	while (addr < start_addr + MAX_BLOCK_SIZE)
+	{
+		const DSPOPCTemplate *opcode = GetOpTemplate(dsp_imem_read(addr));
+		addrs[count++] = addr;
+		addr += opcode->size;
+
+		if (opcode->branch && opcode->uncond_branch)
+			break;
+		if (DSPAnalyzer::code_flags[addr] & DSPAnalyzer::CODE_IDLE_SKIP)
+			break;
+	}
+
+	// Everything is live when the block is left.
+	u16 live = 0xffff;
+	for (int i = count - 1; i >= 0; i--)
+	{
+		UDSPInstruction inst = dsp_imem_read(addrs[i]);
+		const DSPOPCTemplate *opcode = GetOpTemplate(inst);
+		u16 next = addrs[i] + opcode->size;
+
+		// Branches, loop ends and interpreter fallbacks can leave the block.
+		if (opcode->branch || !opcode->jitFunc ||
+		    (DSPAnalyzer::code_flags[(u16)(next - 1)] & DSPAnalyzer::CODE_LOOP_END))
+			live = 0xffff;
+
+		u16 written = GetWrittenFlags(opcode);
+		m_flags_needed[addrs[i] - start_addr] = (written & live) != 0;
+		// The sticky overflow bit is never cleared, so it can't be dead.
+		live &= ~written;
+		live |= SR_OVERFLOW_STICKY;
+
+		if (!opcode->jitFunc || ReadsSR(inst, opcode))
+			live = 0xffff;
+	}
+}
+
 void DSPEmitter::Default(UDSPInstruction inst)
 {
 	if (opTable[inst]->reads_pc)
@@ -219,6 +377,8 @@ void DSPEmitter::Compile(u16 start_addr)
 
 	blockLinkEntry = GetCodePtr();
 
+	AnalyzeBlockFlags(start_addr);
+
 	compilePC = start_addr;
 	bool fixup_pc = false;
 	blockSize[start_addr] = 0;
@@ -5,6 +5,9 @@
 #pragma once
 
 #include <list>
+#include <map>
+#include <utility>
+#include <vector>
 
 #include "Common/x64ABI.h"
 #include "Common/x64Emitter.h"
@@ -14,6 +17,11 @@
 
 #define COMPILED_CODE_SIZE 2097152
 #define MAX_BLOCKS         0x10000
+#define MAX_BLOCK_SIZE     250
+
+// Blocks of previously seen ucodes are kept around until less than this
+// much code space is left.
+#define CODE_CACHE_MIN_SPACE_LEFT 0x40000
 
 typedef u32 (*DSPCompiledCode)();
 typedef const u8 *Block;
@@ -27,6 +35,8 @@ public:
 	Block m_compiledCode;
 
 	void EmitInstruction(UDSPInstruction inst);
+	// Called when new code was loaded into IRAM. Switches to the blocks
+	// compiled for that ucode if it was seen before.
 	void ClearIRAM();
 	void ClearIRAMandDSPJITCodespaceReset();
 
@@ -254,10 +264,39 @@ public:
 
 	DSPJitRegCache gpr;
 private:
+	// The compiled state of all instruction memory for one ucode. The code
+	// itself stays in the code space, this only keeps the references to it.
+	struct CachedUCode
+	{
+		// IRAM contents the blocks were compiled from, to rule out hash
+		// collisions.
+		std::vector<u16> iram;
+		std::vector<DSPCompiledCode> blocks;
+		std::vector<Block> blockLinks;
+		std::vector<u16> blockSize;
+		std::vector<std::pair<u16, std::list<u16>>> unresolvedJumps;
+	};
+
+	// Keyed by the hash of the whole IRAM. This isn't g_dsp.iram_crc, which
+	// only covers the chunk written by the last IRAM DMA.
+	std::map<u32, CachedUCode> m_ucode_cache;
+	u32 m_iram_hash;
+	// IRAM contents of the current ucode, saved with its blocks.
+	std::vector<u16> m_iram_image;
+
+	void SaveUCodeBlocks(CachedUCode& ucode);
+	void LoadUCodeBlocks(const CachedUCode& ucode);
+	void ClearBlock(u16 addr);
+	void AnalyzeBlockFlags(u16 start_addr);
+
 	DSPCompiledCode *blocks;
 	Block blockLinkEntry;
 	u16 compileSR;
 
+	// Whether the SR flags computed by each instruction of the block being
+	// compiled can be observed, indexed by compilePC - startAddr.
+	bool m_flags_needed[MAX_BLOCK_SIZE];
+
 	// The index of the last stored ext value (compile time).
 	int storeIndex;
 	int storeIndex2;
@@ -69,10 +69,14 @@ void DSPEmitter::Update_SR_Register64(Gen::X64Reg val)
 
 // In: (val): s64 _Value
 // In: (carry_ovfl): 1 = carry, 2 = overflow
-// Clobbers RDX
+// Clobbers RDX, sign extends (val) from 40 bits
 void DSPEmitter::Update_SR_Register64_Carry(X64Reg val, X64Reg carry_ovfl)
 {
 #if _M_X86_64
+	//	res = dsp_get_long_acc(dreg);
+	SHL(64, R(val), Imm8(64 - 40));
+	SAR(64, R(val), Imm8(64 - 40));
+
 	OpArg sr_reg;
 	gpr.getReg(DSP_REG_SR,sr_reg);
 	//	g_dsp.r[DSP_REG_SR] &= ~SR_CMP_MASK;
@@ -106,10 +110,14 @@ void DSPEmitter::Update_SR_Register64_Carry(X64Reg val, X64Reg carry_ovfl)
 
 // In: (val): s64 _Value
 // In: (carry_ovfl): 1 = carry, 2 = overflow
-// Clobbers RDX
+// Clobbers RDX, sign extends (val) from 40 bits
 void DSPEmitter::Update_SR_Register64_Carry2(X64Reg val, X64Reg carry_ovfl)
 {
 #if _M_X86_64
+	//	res = dsp_get_long_acc(dreg);
+	SHL(64, R(val), Imm8(64 - 40));
+	SAR(64, R(val), Imm8(64 - 40));
+
 	OpArg sr_reg;
 	gpr.getReg(DSP_REG_SR,sr_reg);
 	//	g_dsp.r[DSP_REG_SR] &= ~SR_CMP_MASK;
@@ -77,6 +77,8 @@ static void *reg_ptr(int reg)
 
 #define STATIC_REG_ACCS
 //#undef STATIC_REG_ACCS
+#define STATIC_REG_AX
+//#undef STATIC_REG_AX
 
 DSPJitRegCache::DSPJitRegCache(DSPEmitter &_emitter)
 	: emitter(_emitter), temporary(false), merged(false)
@@ -109,8 +111,13 @@ DSPJitRegCache::DSPJitRegCache(DSPEmitter &_emitter)
 	xregs[R8].guest_reg = DSP_REG_NONE;
 	xregs[R9].guest_reg = DSP_REG_NONE;
 #endif
+#ifdef STATIC_REG_AX
+	xregs[R10].guest_reg = DSP_REG_STATIC; //ax0
+	xregs[R11].guest_reg = DSP_REG_STATIC; //ax1
+#else
 	xregs[R10].guest_reg = DSP_REG_NONE;
 	xregs[R11].guest_reg = DSP_REG_NONE;
+#endif
 	xregs[R12].guest_reg = DSP_REG_NONE;
 	xregs[R13].guest_reg = DSP_REG_NONE;
 	xregs[R14].guest_reg = DSP_REG_NONE;
@@ -139,6 +146,10 @@ DSPJitRegCache::DSPJitRegCache(DSPEmitter &_emitter)
 #ifdef STATIC_REG_ACCS
 	regs[DSP_REG_ACC0_64].host_reg = R8;
 	regs[DSP_REG_ACC1_64].host_reg = R9;
+#endif
+#ifdef STATIC_REG_AX
+	regs[DSP_REG_AX0_32].host_reg = R10;
+	regs[DSP_REG_AX1_32].host_reg = R11;
 #endif
 	for(unsigned int i = 0; i < 2; i++)
 	{
@@ -391,12 +402,21 @@ void DSPJitRegCache::flushRegs()
 	             xregs[R9].guest_reg == DSP_REG_NONE,
 	             "wrong xreg state for %d", R9);
 #endif
+#ifdef STATIC_REG_AX
+	_assert_msg_(DSPLLE,
+	             xregs[R10].guest_reg == DSP_REG_STATIC,
+	             "wrong xreg state for %d", R10);
+	_assert_msg_(DSPLLE,
+	             xregs[R11].guest_reg == DSP_REG_STATIC,
+	             "wrong xreg state for %d", R11);
+#else
 	_assert_msg_(DSPLLE,
 	             xregs[R10].guest_reg == DSP_REG_NONE,
 	             "wrong xreg state for %d", R10);
 	_assert_msg_(DSPLLE,
 	             xregs[R11].guest_reg == DSP_REG_NONE,
 	             "wrong xreg state for %d", R11);
+#endif
 	_assert_msg_(DSPLLE,
 	             xregs[R12].guest_reg == DSP_REG_NONE,
 	             "wrong xreg state for %d", R12);
@@ -0,0 +1,224 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "Common/Common.h"
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "Common/Timer.h"
+
+#include "Core/FifoPlayer/FifoBenchmark.h"
+#include "Core/FifoPlayer/FifoDataFile.h"
+#include "Core/FifoPlayer/FifoPlayer.h"
+
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/VideoBackendBase.h"
+
+namespace FifoBenchmark
+{
+
+static const struct
+{
+	const char* name;
+	int Statistics::ThisFrame::*counter;
+} s_counters[] = {
+	{ "bp_loads",           &Statistics::ThisFrame::numBPLoads },
+	{ "cp_loads",           &Statistics::ThisFrame::numCPLoads },
+	{ "xf_loads",           &Statistics::ThisFrame::numXFLoads },
+	{ "prims",              &Statistics::ThisFrame::numPrims },
+	{ "dl_prims",           &Statistics::ThisFrame::numDLPrims },
+	{ "dls_called",         &Statistics::ThisFrame::numDListsCalled },
+	{ "shader_changes",     &Statistics::ThisFrame::numShaderChanges },
+	{ "primitive_joins",    &Statistics::ThisFrame::numPrimitiveJoins },
+	{ "draw_calls",         &Statistics::ThisFrame::numDrawCalls },
+	{ "indexed_draw_calls", &Statistics::ThisFrame::numIndexedDrawCalls },
+	{ "buffer_splits",      &Statistics::ThisFrame::numBufferSplits },
+	{ "vertex_bytes",       &Statistics::ThisFrame::bytesVertexStreamed },
+	{ "index_bytes",        &Statistics::ThisFrame::bytesIndexStreamed },
+	{ "uniform_bytes",      &Statistics::ThisFrame::bytesUniformStreamed },
+	{ "uniform_uploads",    &Statistics::ThisFrame::numUniformUploads },
+};
+
+struct Sample
+{
+	u32 pass;
+	u32 frame;
+	u64 time_us;
+	// Draws, going by the FIFO player's analysis, so the same for all backends
+	u32 objects;
+	u32 fifo_bytes;
+	u32 memory_updates;
+	u32 memory_bytes;
+	int counters[ArraySize(s_counters)];
+};
+
+static u32 s_first_frame;
+static u32 s_end_frame;
+static std::vector<Sample> s_samples;
+
+static u64 s_frame_start;
+static Statistics::ThisFrame s_counters_start;
+
+static void FileLoaded()
+{
+	FifoPlayer& player = FifoPlayer::GetInstance();
+	if (!player.GetFile())
+		return;
+
+	player.SetFrameRangeStart(s_first_frame);
+	player.SetFrameRangeEnd(s_end_frame);
+	s_samples.reserve(s_samples.size() + player.GetFrameRangeEnd() - player.GetFrameRangeStart());
+}
+
+static void FrameStarting()
+{
+	stats.GetTotals(s_counters_start);
+	s_frame_start = Common::Timer::GetTimeUs();
+}
+
+static void FrameFinished()
+{
+	u64 frame_end = Common::Timer::GetTimeUs();
+	Statistics::ThisFrame counters_end;
+	stats.GetTotals(counters_end);
+
+	FifoPlayer& player = FifoPlayer::GetInstance();
+	u32 frame_num = player.GetCurrentFrameNum();
+	std::shared_ptr<const FifoFrameInfo> frame = player.GetFile()->GetFrame(frame_num);
+
+	Sample sample;
+	sample.pass = player.GetPass();
+	sample.frame = frame_num;
+	sample.time_us = frame_end - s_frame_start;
+	sample.objects = (u32)player.GetAnalyzedFrameInfo(frame_num).objectStarts.size();
+	sample.fifo_bytes = frame->fifoDataSize;
+	sample.memory_updates = (u32)frame->memoryUpdates.size();
+	sample.memory_bytes = 0;
+	for (const MemoryUpdate& update : frame->memoryUpdates)
+		sample.memory_bytes += update.size;
+	for (size_t i = 0; i < ArraySize(s_counters); i++)
+		sample.counters[i] = counters_end.*s_counters[i].counter - s_counters_start.*s_counters[i].counter;
+	s_samples.push_back(sample);
+}
+
+void Start(u32 first_frame, u32 end_frame, u32 passes)
+{
+	s_first_frame = first_frame;
+	s_end_frame = end_frame;
+	s_samples.clear();
+
+	FifoPlayer& player = FifoPlayer::GetInstance();
+	player.SetPassCount(std::max(passes, 1u));
+	player.SetFileLoadedCallback(FileLoaded);
+	player.SetFrameWrittenCallback(FrameStarting);
+	player.SetFrameFinishedCallback(FrameFinished);
+}
+
+void Stop()
+{
+	FifoPlayer& player = FifoPlayer::GetInstance();
+	player.SetPassCount(0);
+	player.SetFileLoadedCallback(nullptr);
+	player.SetFrameWrittenCallback(nullptr);
+	player.SetFrameFinishedCallback(nullptr);
+}
+
+static std::string EscapeJSON(const std::string& str)
+{
+	std::string result;
+	for (char c : str)
+	{
+		if (c == '"' || c == '\\')
+			result += '\\';
+		if ((u8)c < 0x20)
+			result += StringFromFormat("\\u%04x", c);
+		else
+			result += c;
+	}
+	return result;
+}
+
+static void WriteCSV(std::ofstream& out)
+{
+	out << "pass,frame,time_us,objects,fifo_bytes,memory_updates,memory_bytes";
+	for (const auto& counter : s_counters)
+		out << ',' << counter.name;
+	out << '\n';
+
+	for (const Sample& sample : s_samples)
+	{
+		out << sample.pass << ',' << sample.frame << ',' << sample.time_us << ',' << sample.objects << ','
+		    << sample.fifo_bytes << ',' << sample.memory_updates << ',' << sample.memory_bytes;
+		for (int value : sample.counters)
+			out << ',' << value;
+		out << '\n';
+	}
+}
+
+static void WriteJSON(std::ofstream& out)
+{
+	FifoPlayer& player = FifoPlayer::GetInstance();
+	out << "{\n";
+	out << "\t\"backend\": \"" << EscapeJSON(g_video_backend->GetName()) << "\",\n";
+	out << "\t\"first_frame\": " << s_first_frame << ",\n";
+	out << "\t\"end_frame\": " << s_end_frame << ",\n";
+	out << "\t\"passes\": " << player.GetPass() << ",\n";
+	out << "\t\"frames\": [";
+	for (size_t i = 0; i < s_samples.size(); i++)
+	{
+		const Sample& sample = s_samples[i];
+		out << (i ? ",\n\t\t{" : "\n\t\t{");
+		out << "\"pass\": " << sample.pass << ", \"frame\": " << sample.frame
+		    << ", \"time_us\": " << sample.time_us << ", \"objects\": " << sample.objects
+		    << ", \"fifo_bytes\": " << sample.fifo_bytes << ", \"memory_updates\": " << sample.memory_updates
+		    << ", \"memory_bytes\": " << sample.memory_bytes;
+		for (size_t j = 0; j < ArraySize(s_counters); j++)
+			out << ", \"" << s_counters[j].name << "\": " << sample.counters[j];
+		out << '}';
+	}
+	out << "\n\t]\n}\n";
+}
+
+bool WriteReport(const std::string& path)
+{
+	std::ofstream out;
+	OpenFStream(out, path, std::ios_base::out | std::ios_base::trunc);
+	if (!out.is_open())
+		return false;
+
+	std::string extension;
+	SplitPath(path, nullptr, nullptr, &extension);
+	if (!strcasecmp(extension.c_str(), ".json"))
+		WriteJSON(out);
+	else
+		WriteCSV(out);
+
+	return out.good();
+}
+
+std::string GetSummary()
+{
+	if (s_samples.empty())
+		return "No frames played";
+
+	std::vector<u64> times;
+	u64 total = 0;
+	for (const Sample& sample : s_samples)
+	{
+		times.push_back(sample.time_us);
+		total += sample.time_us;
+	}
+	std::sort(times.begin(), times.end());
+
+	double mean = (double)total / times.size();
+	return StringFromFormat("%u frames in %u passes: mean %.1f us (%.1f fps), median %llu us, min %llu us, max %llu us",
+		(u32)times.size(), FifoPlayer::GetInstance().GetPass(), mean, mean > 0 ? 1000000.0 / mean : 0.0,
+		(unsigned long long)times[times.size() / 2], (unsigned long long)times.front(), (unsigned long long)times.back());
+}
+
+}
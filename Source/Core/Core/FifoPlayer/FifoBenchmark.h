@@ -0,0 +1,30 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+
+#include "Common/CommonTypes.h"
+
+// Times the playback of a FIFO log frame by frame, with the video statistics
+// counters of every frame, so changes to the GPU emulation can be compared
+// on the same recording. The times only include the GPU emulation in single
+// core mode, where it runs on the thread that writes the FIFO.
+namespace FifoBenchmark
+{
+
+// Call before booting the .dff. Plays frames first to end - 1 passes times,
+// with the range clamped to the file like in the FIFO player dialog.
+void Start(u32 first_frame, u32 end_frame, u32 passes);
+void Stop();
+
+// Writes one row per frame and pass, as JSON if path ends in .json and CSV
+// otherwise
+bool WriteReport(const std::string& path);
+
+// Frame time statistics over all passes, for the console
+std::string GetSummary();
+
+}
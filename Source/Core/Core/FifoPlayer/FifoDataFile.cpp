@@ -2,7 +2,13 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <cstring>
+#include <zlib.h>
+
 #include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "Common/Thread.h"
+#include "Common/Timer.h"
 
 #include "Core/FifoPlayer/FifoDataFile.h"
 #include "Core/FifoPlayer/FifoFileStruct.h"
@@ -10,20 +16,43 @@
 using namespace FifoFileStruct;
 using namespace std;
 
+namespace
+{
+
+// Keeps the data a frame's pointers point into alive as long as the frame
+struct LoadedFrame
+{
+	FifoFrameInfo info;
+	std::vector<u8> data;
+};
+
+}
+
 FifoDataFile::FifoDataFile() :
-	m_Flags(0)
+	m_Flags(0),
+	m_FifoDataSize(0),
+	m_MemoryUpdatesSize(0),
+	m_StorageIsTemp(false),
+	m_Compressing(false),
+	m_QuitCompressThread(false)
 {
 }
 
 FifoDataFile::~FifoDataFile()
 {
-	for (auto& frame : m_Frames)
+	if (m_CompressThread.joinable())
 	{
-		for (auto& update : frame.memoryUpdates)
-			delete []update.data;
-
-		delete []frame.fifoData;
+		{
+			std::lock_guard<std::mutex> lk(m_Mutex);
+			m_QuitCompressThread = true;
+			m_PendingEvent.notify_one();
+		}
+		m_CompressThread.join();
 	}
+
+	m_Storage.Close();
+	if (m_StorageIsTemp)
+		File::Delete(m_StoragePath);
 }
 
 void FifoDataFile::SetIsWii(bool isWii)
@@ -38,89 +67,244 @@ bool FifoDataFile::GetIsWii() const
 
 void FifoDataFile::AddFrame(const FifoFrameInfo &frameInfo)
 {
-	m_Frames.push_back(frameInfo);
+	FrameEntry entry;
+	entry.compressed = true;
+	entry.fifoDataOffset = 0;
+	entry.compressedSize = 0;
+	entry.fifoDataSize = frameInfo.fifoDataSize;
+	entry.fifoStart = frameInfo.fifoStart;
+	entry.fifoEnd = frameInfo.fifoEnd;
+	entry.memoryUpdatesOffset = frameInfo.fifoDataSize;
+	entry.numMemoryUpdates = (u32)frameInfo.memoryUpdates.size();
+
+	PendingFrame pending;
+	pending.data = BuildFrameData(frameInfo, &entry.memoryUpdatesSize);
+	entry.uncompressedSize = (u32)pending.data.size();
+
+	std::unique_lock<std::mutex> lk(m_Mutex);
+
+	if (!m_CompressThread.joinable())
+	{
+		m_StoragePath = StringFromFormat("%sfifo_%llx.tmp", File::GetUserPath(D_CACHE_IDX).c_str(),
+			(unsigned long long)Common::Timer::GetTimeUs());
+		File::CreateFullPath(m_StoragePath);
+		if (!m_Storage.Open(m_StoragePath, "w+b"))
+			ERROR_LOG(VIDEO, "Couldn't create %s for the FIFO recording", m_StoragePath.c_str());
+		m_StorageIsTemp = true;
+		m_CompressThread = std::thread(&FifoDataFile::CompressThread, this);
+	}
+
+	m_CompressedEvent.wait(lk, [this] { return m_Pending.size() < MAX_PENDING_FRAMES; });
+
+	pending.index = m_Frames.size();
+	m_Frames.push_back(entry);
+	m_FifoDataSize += entry.fifoDataSize;
+	m_MemoryUpdatesSize += entry.memoryUpdatesSize;
+
+	m_Pending.push_back(std::move(pending));
+	m_PendingEvent.notify_one();
 }
 
-bool FifoDataFile::Save(const char *filename)
+std::shared_ptr<const FifoFrameInfo> FifoDataFile::GetFrame(size_t frame) const
 {
-	File::IOFile file;
-	if (!file.Open(filename, "wb"))
-		return false;
+	std::unique_lock<std::mutex> lk(m_Mutex);
 
-	// Add space for header
-	PadFile(sizeof(FileHeader), file);
+	for (auto it = m_Cache.begin(); it != m_Cache.end(); ++it)
+	{
+		if (it->first == frame)
+		{
+			m_Cache.splice(m_Cache.begin(), m_Cache, it);
+			return it->second;
+		}
+	}
 
-	// Add space for frame list
-	u64 frameListOffset = file.Tell();
-	for (size_t i = 0; i < m_Frames.size(); i++)
-		PadFile(sizeof(FileFrameInfo), file);
+	WaitForPending(lk);
 
-	u64 bpMemOffset = file.Tell();
-	file.WriteArray(m_BPMem, BP_MEM_SIZE);
+	const FrameEntry &entry = m_Frames[frame];
+	std::shared_ptr<LoadedFrame> loaded = std::make_shared<LoadedFrame>();
+	FifoFrameInfo &info = loaded->info;
+	info.fifoData = nullptr;
+	info.fifoDataSize = 0;
+	info.fifoStart = entry.fifoStart;
+	info.fifoEnd = entry.fifoEnd;
 
-	u64 cpMemOffset = file.Tell();
-	file.WriteArray(m_CPMem, CP_MEM_SIZE);
+	std::vector<u8> &data = loaded->data;
+	u64 listOffset = entry.compressed ? entry.memoryUpdatesOffset : entry.fifoDataSize;
+	u64 listEnd = listOffset + (u64)entry.numMemoryUpdates * sizeof(FileMemoryUpdate);
+	if (!ReadFrameData(entry, data) || entry.fifoDataSize > data.size() || listEnd > data.size())
+	{
+		ERROR_LOG(VIDEO, "FIFO log frame %u is damaged", (u32)frame);
+		data.clear();
+	}
+	else
+	{
+		info.fifoData = data.data();
+		info.fifoDataSize = entry.fifoDataSize;
+
+		for (u32 i = 0; i < entry.numMemoryUpdates; ++i)
+		{
+			FileMemoryUpdate srcUpdate;
+			memcpy(&srcUpdate, &data[listOffset + i * sizeof(FileMemoryUpdate)], sizeof(FileMemoryUpdate));
+			if (srcUpdate.dataOffset + srcUpdate.dataSize > data.size())
+			{
+				ERROR_LOG(VIDEO, "FIFO log frame %u has a damaged memory update", (u32)frame);
+				break;
+			}
+
+			MemoryUpdate dstUpdate;
+			dstUpdate.address = srcUpdate.address;
+			dstUpdate.fifoPosition = srcUpdate.fifoPosition;
+			dstUpdate.size = srcUpdate.dataSize;
+			dstUpdate.data = &data[(size_t)srcUpdate.dataOffset];
+			dstUpdate.type = (MemoryUpdate::Type)srcUpdate.type;
+			info.memoryUpdates.push_back(dstUpdate);
+		}
+	}
 
-	u64 xfMemOffset = file.Tell();
-	file.WriteArray(m_XFMem, XF_MEM_SIZE);
+	std::shared_ptr<const FifoFrameInfo> result(loaded, &loaded->info);
+	m_Cache.emplace_front(frame, result);
+	if (m_Cache.size() > FRAME_CACHE_SIZE)
+		m_Cache.pop_back();
 
-	u64 xfRegsOffset = file.Tell();
-	file.WriteArray(m_XFRegs, XF_REGS_SIZE);
+	return result;
+}
+
+size_t FifoDataFile::GetFrameCount() const
+{
+	std::lock_guard<std::mutex> lk(m_Mutex);
+	return m_Frames.size();
+}
+
+u64 FifoDataFile::GetFifoDataSize() const
+{
+	std::lock_guard<std::mutex> lk(m_Mutex);
+	return m_FifoDataSize;
+}
+
+u64 FifoDataFile::GetMemoryUpdatesSize() const
+{
+	std::lock_guard<std::mutex> lk(m_Mutex);
+	return m_MemoryUpdatesSize;
+}
+
+bool FifoDataFile::Save(const char *filename)
+{
+	std::unique_lock<std::mutex> lk(m_Mutex);
+	WaitForPending(lk);
+
+	// Written next to the destination first, which may be the file the frames
+	// are read from
+	const std::string tempFilename = std::string(filename) + ".tmp";
+	File::IOFile file;
+	if (!file.Open(tempFilename, "wb"))
+		return false;
 
-	// Write header
 	FileHeader header;
+	memset(&header, 0, sizeof(header));
 	header.fileId = FILE_ID;
 	header.file_version = VERSION_NUMBER;
 	header.min_loader_version = MIN_LOADER_VERSION;
 
-	header.bpMemOffset = bpMemOffset;
+	header.frameListOffset = sizeof(FileHeader);
+	header.frameCount = (u32)m_Frames.size();
+
+	header.bpMemOffset = header.frameListOffset + m_Frames.size() * sizeof(FileFrameInfo);
 	header.bpMemSize = BP_MEM_SIZE;
 
-	header.cpMemOffset = cpMemOffset;
+	header.cpMemOffset = header.bpMemOffset + sizeof(m_BPMem);
 	header.cpMemSize = CP_MEM_SIZE;
 
-	header.xfMemOffset = xfMemOffset;
+	header.xfMemOffset = header.cpMemOffset + sizeof(m_CPMem);
 	header.xfMemSize = XF_MEM_SIZE;
 
-	header.xfRegsOffset = xfRegsOffset;
+	header.xfRegsOffset = header.xfMemOffset + sizeof(m_XFMem);
 	header.xfRegsSize = XF_REGS_SIZE;
 
-	header.frameListOffset = frameListOffset;
-	header.frameCount = (u32)m_Frames.size();
-
 	header.flags = m_Flags;
 
-	file.Seek(0, SEEK_SET);
 	file.WriteBytes(&header, sizeof(FileHeader));
 
-	// Write frames list
-	for (unsigned int i = 0; i < m_Frames.size(); ++i)
-	{
-		const FifoFrameInfo &srcFrame = m_Frames[i];
+	// The frame list is written at the end
+	std::vector<FileFrameInfo> frameList(m_Frames.size());
+	memset(frameList.data(), 0, frameList.size() * sizeof(FileFrameInfo));
+	file.WriteArray(frameList.data(), frameList.size());
 
-		// Write FIFO data
-		file.Seek(0, SEEK_END);
-		u64 dataOffset = file.Tell();
-		file.WriteBytes(srcFrame.fifoData, srcFrame.fifoDataSize);
+	file.WriteArray(m_BPMem, BP_MEM_SIZE);
+	file.WriteArray(m_CPMem, CP_MEM_SIZE);
+	file.WriteArray(m_XFMem, XF_MEM_SIZE);
+	file.WriteArray(m_XFRegs, XF_REGS_SIZE);
 
-		u64 memoryUpdatesOffset = WriteMemoryUpdates(srcFrame.memoryUpdates, file);
+	std::vector<FrameEntry> savedFrames(m_Frames);
+	std::vector<u8> data, compressed;
+	for (size_t i = 0; i < m_Frames.size(); ++i)
+	{
+		const FrameEntry &srcFrame = m_Frames[i];
+		FrameEntry &savedFrame = savedFrames[i];
+
+		// Compressed frames are copied as they are
+		bool good;
+		if (srcFrame.compressed)
+		{
+			good = ReadCompressedFrame(srcFrame, compressed);
+		}
+		else
+		{
+			good = ReadFrameData(srcFrame, data) && Compress(data, compressed);
+			savedFrame.compressed = true;
+			savedFrame.memoryUpdatesOffset = srcFrame.fifoDataSize;
+			savedFrame.compressedSize = (u32)compressed.size();
+		}
+
+		if (!good)
+		{
+			ERROR_LOG(VIDEO, "Couldn't read FIFO log frame %u", (u32)i);
+			file.Close();
+			File::Delete(tempFilename);
+			return false;
+		}
+
+		savedFrame.fifoDataOffset = file.Tell();
+		file.WriteBytes(compressed.data(), compressed.size());
+
+		FileFrameInfo &dstFrame = frameList[i];
+		dstFrame.fifoDataOffset = savedFrame.fifoDataOffset;
+		dstFrame.fifoDataSize = savedFrame.fifoDataSize;
+		dstFrame.fifoStart = savedFrame.fifoStart;
+		dstFrame.fifoEnd = savedFrame.fifoEnd;
+		dstFrame.memoryUpdatesOffset = savedFrame.memoryUpdatesOffset;
+		dstFrame.numMemoryUpdates = savedFrame.numMemoryUpdates;
+		dstFrame.compressedSize = savedFrame.compressedSize;
+		dstFrame.uncompressedSize = savedFrame.uncompressedSize;
+		dstFrame.memoryUpdatesSize = savedFrame.memoryUpdatesSize;
+	}
 
-		FileFrameInfo dstFrame;
-		dstFrame.fifoDataSize = srcFrame.fifoDataSize;
-		dstFrame.fifoDataOffset = dataOffset;
-		dstFrame.fifoStart = srcFrame.fifoStart;
-		dstFrame.fifoEnd = srcFrame.fifoEnd;
-		dstFrame.memoryUpdatesOffset = memoryUpdatesOffset;
-		dstFrame.numMemoryUpdates = (u32)srcFrame.memoryUpdates.size();
+	file.Seek(header.frameListOffset, SEEK_SET);
+	file.WriteArray(frameList.data(), frameList.size());
 
-		// Write frame info
-		u64 frameOffset = frameListOffset + (i * sizeof(FileFrameInfo));
-		file.Seek(frameOffset, SEEK_SET);
-		file.WriteBytes(&dstFrame, sizeof(FileFrameInfo));
+	if (!file.Close())
+	{
+		File::Delete(tempFilename);
+		return false;
 	}
 
-	if (!file.Close())
+	// The old file can't stay open while it is replaced
+	const bool replacingStorage = !m_StorageIsTemp && m_Storage.IsOpen() && m_StoragePath == filename;
+	if (replacingStorage)
+		m_Storage.Close();
+
+	if (!File::Rename(tempFilename, filename))
+	{
+		File::Delete(tempFilename);
+		if (replacingStorage)
+			m_Storage.Open(m_StoragePath, "rb");
 		return false;
+	}
+
+	if (replacingStorage)
+	{
+		m_Storage.Open(m_StoragePath, "rb");
+		m_Frames.swap(savedFrames);
+	}
 
 	return true;
 }
@@ -167,41 +351,62 @@ FifoDataFile *FifoDataFile::Load(const std::string &filename, bool flagsOnly)
 	file.Seek(header.xfRegsOffset, SEEK_SET);
 	file.ReadArray(dataFile->m_XFRegs, size);
 
-	// Read frames
-	for (u32 i = 0; i < header.frameCount; ++i)
-	{
-		u64 frameOffset = header.frameListOffset + (i * sizeof(FileFrameInfo));
-		file.Seek(frameOffset, SEEK_SET);
-		FileFrameInfo srcFrame;
-		file.ReadBytes(&srcFrame, sizeof(FileFrameInfo));
+	// Read the frame list
+	std::vector<FileFrameInfo> frameList(header.frameCount);
+	file.Seek(header.frameListOffset, SEEK_SET);
+	file.ReadArray(frameList.data(), frameList.size());
 
-		FifoFrameInfo dstFrame;
-		dstFrame.fifoData = new u8[srcFrame.fifoDataSize];
+	const bool compressed = header.file_version >= 2;
+	dataFile->m_Frames.resize(frameList.size());
+	for (size_t i = 0; i < frameList.size(); ++i)
+	{
+		const FileFrameInfo &srcFrame = frameList[i];
+		FrameEntry &dstFrame = dataFile->m_Frames[i];
+		dstFrame.compressed = compressed;
+		dstFrame.fifoDataOffset = srcFrame.fifoDataOffset;
 		dstFrame.fifoDataSize = srcFrame.fifoDataSize;
 		dstFrame.fifoStart = srcFrame.fifoStart;
 		dstFrame.fifoEnd = srcFrame.fifoEnd;
+		dstFrame.memoryUpdatesOffset = srcFrame.memoryUpdatesOffset;
+		dstFrame.numMemoryUpdates = srcFrame.numMemoryUpdates;
+
+		if (compressed)
+		{
+			dstFrame.compressedSize = srcFrame.compressedSize;
+			dstFrame.uncompressedSize = srcFrame.uncompressedSize;
+			dstFrame.memoryUpdatesSize = srcFrame.memoryUpdatesSize;
+		}
+		else
+		{
+			// Only the memory update list has to be read for the sizes
+			std::vector<FileMemoryUpdate> updates(srcFrame.numMemoryUpdates);
+			file.Seek(srcFrame.memoryUpdatesOffset, SEEK_SET);
+			file.ReadArray(updates.data(), updates.size());
+
+			dstFrame.compressedSize = 0;
+			dstFrame.memoryUpdatesSize = 0;
+			for (const FileMemoryUpdate &update : updates)
+				dstFrame.memoryUpdatesSize += update.dataSize;
+			dstFrame.uncompressedSize = dstFrame.fifoDataSize + (u32)(updates.size() * sizeof(FileMemoryUpdate)) +
+				dstFrame.memoryUpdatesSize;
+		}
+
+		dataFile->m_FifoDataSize += dstFrame.fifoDataSize;
+		dataFile->m_MemoryUpdatesSize += dstFrame.memoryUpdatesSize;
+	}
 
-		file.Seek(srcFrame.fifoDataOffset, SEEK_SET);
-		file.ReadBytes(dstFrame.fifoData, srcFrame.fifoDataSize);
-
-		ReadMemoryUpdates(srcFrame.memoryUpdatesOffset, srcFrame.numMemoryUpdates, dstFrame.memoryUpdates, file);
-
-		dataFile->AddFrame(dstFrame);
+	if (!file.IsGood())
+	{
+		delete dataFile;
+		return NULL;
 	}
 
-	file.Close();
+	dataFile->m_Storage.Swap(file);
+	dataFile->m_StoragePath = filename;
 
 	return dataFile;
 }
 
-void FifoDataFile::PadFile(u32 numBytes, File::IOFile &file)
-{
-	FILE *handle = file.GetHandle();
-
-	for (u32 i = 0; i < numBytes; ++i)
-		fputc(0, handle);
-}
-
 void FifoDataFile::SetFlag(u32 flag, bool set)
 {
 	if (set)
@@ -215,56 +420,145 @@ bool FifoDataFile::GetFlag(u32 flag) const
 	return !!(m_Flags & flag);
 }
 
-u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate> &memUpdates, File::IOFile &file)
+void FifoDataFile::WaitForPending(std::unique_lock<std::mutex> &lk) const
+{
+	m_CompressedEvent.wait(lk, [this] { return m_Pending.empty() && !m_Compressing; });
+}
+
+bool FifoDataFile::ReadCompressedFrame(const FrameEntry &entry, std::vector<u8> &compressed) const
 {
-	// Add space for memory update list
-	u64 updateListOffset = file.Tell();
-	for (size_t i = 0; i < memUpdates.size(); i++)
-		PadFile(sizeof(FileMemoryUpdate), file);
+	if (!m_Storage.IsOpen())
+		return false;
+
+	compressed.resize(entry.compressedSize);
+	m_Storage.Clear();
+	m_Storage.Seek(entry.fifoDataOffset, SEEK_SET);
+	return m_Storage.ReadBytes(compressed.data(), compressed.size());
+}
 
-	for (unsigned int i = 0; i < memUpdates.size(); ++i)
+bool FifoDataFile::ReadFrameData(const FrameEntry &entry, std::vector<u8> &data) const
+{
+	data.resize(entry.uncompressedSize);
+
+	if (entry.compressed)
 	{
-		const MemoryUpdate &srcUpdate = memUpdates[i];
+		std::vector<u8> compressed;
+		if (!ReadCompressedFrame(entry, compressed))
+			return false;
 
-		// Write memory
-		file.Seek(0, SEEK_END);
-		u64 dataOffset = file.Tell();
-		file.WriteBytes(srcUpdate.data, srcUpdate.size);
+		uLongf destSize = (uLongf)data.size();
+		return uncompress(data.data(), &destSize, compressed.data(), (uLong)compressed.size()) == Z_OK &&
+			destSize == data.size();
+	}
 
-		FileMemoryUpdate dstUpdate;
-		dstUpdate.address = srcUpdate.address;
-		dstUpdate.dataOffset = dataOffset;
-		dstUpdate.dataSize = srcUpdate.size;
-		dstUpdate.fifoPosition = srcUpdate.fifoPosition;
-		dstUpdate.type = srcUpdate.type;
+	// Version 1 frames are scattered over the file
+	if (!m_Storage.IsOpen())
+		return false;
+
+	m_Storage.Clear();
+	m_Storage.Seek(entry.fifoDataOffset, SEEK_SET);
+	m_Storage.ReadBytes(data.data(), entry.fifoDataSize);
+
+	std::vector<FileMemoryUpdate> updates(entry.numMemoryUpdates);
+	m_Storage.Seek(entry.memoryUpdatesOffset, SEEK_SET);
+	m_Storage.ReadArray(updates.data(), updates.size());
+
+	u64 dataOffset = entry.fifoDataSize + updates.size() * sizeof(FileMemoryUpdate);
+	for (FileMemoryUpdate &update : updates)
+	{
+		if (dataOffset + update.dataSize > data.size())
+			return false;
 
-		u64 updateOffset = updateListOffset + (i * sizeof(FileMemoryUpdate));
-		file.Seek(updateOffset, SEEK_SET);
-		file.WriteBytes(&dstUpdate, sizeof(FileMemoryUpdate));
+		m_Storage.Seek(update.dataOffset, SEEK_SET);
+		m_Storage.ReadBytes(&data[(size_t)dataOffset], update.dataSize);
+		update.dataOffset = dataOffset;
+		dataOffset += update.dataSize;
 	}
 
-	return updateListOffset;
+	if (!updates.empty())
+		memcpy(&data[entry.fifoDataSize], updates.data(), updates.size() * sizeof(FileMemoryUpdate));
+
+	return m_Storage.IsGood();
+}
+
+void FifoDataFile::CompressThread()
+{
+	Common::SetCurrentThreadName("FIFO log compressor");
+
+	std::unique_lock<std::mutex> lk(m_Mutex);
+	while (true)
+	{
+		m_PendingEvent.wait(lk, [this] { return m_QuitCompressThread || !m_Pending.empty(); });
+		if (m_QuitCompressThread)
+			break;
+
+		PendingFrame pending = std::move(m_Pending.front());
+		m_Pending.pop_front();
+		m_Compressing = true;
+		lk.unlock();
+
+		std::vector<u8> compressed;
+		bool good = Compress(pending.data, compressed);
+
+		lk.lock();
+		FrameEntry &entry = m_Frames[pending.index];
+		m_Storage.Seek(0, SEEK_END);
+		entry.fifoDataOffset = m_Storage.Tell();
+		if (good && m_Storage.WriteBytes(compressed.data(), compressed.size()))
+			entry.compressedSize = (u32)compressed.size();
+		else
+			ERROR_LOG(VIDEO, "Couldn't store FIFO log frame %u", (u32)pending.index);
+
+		m_Compressing = false;
+		m_CompressedEvent.notify_all();
+	}
 }
 
-void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates, std::vector<MemoryUpdate> &memUpdates, File::IOFile &file)
+std::vector<u8> FifoDataFile::BuildFrameData(const FifoFrameInfo &frameInfo, u32 *memoryUpdatesSize)
 {
-	memUpdates.resize(numUpdates);
+	const std::vector<MemoryUpdate> &memUpdates = frameInfo.memoryUpdates;
 
-	for (u32 i = 0; i < numUpdates; ++i)
+	u32 updatesSize = 0;
+	for (const MemoryUpdate &update : memUpdates)
+		updatesSize += update.size;
+	*memoryUpdatesSize = updatesSize;
+
+	u32 listOffset = frameInfo.fifoDataSize;
+	u32 dataOffset = listOffset + (u32)(memUpdates.size() * sizeof(FileMemoryUpdate));
+	std::vector<u8> data(dataOffset + updatesSize);
+
+	if (frameInfo.fifoDataSize)
+		memcpy(data.data(), frameInfo.fifoData, frameInfo.fifoDataSize);
+
+	for (size_t i = 0; i < memUpdates.size(); ++i)
 	{
-		u64 updateOffset = fileOffset + (i * sizeof(FileMemoryUpdate));
-		file.Seek(updateOffset, SEEK_SET);
-		FileMemoryUpdate srcUpdate;
-		file.ReadBytes(&srcUpdate, sizeof(FileMemoryUpdate));
+		const MemoryUpdate &srcUpdate = memUpdates[i];
 
-		MemoryUpdate &dstUpdate = memUpdates[i];
+		FileMemoryUpdate dstUpdate;
+		memset(&dstUpdate, 0, sizeof(dstUpdate));
 		dstUpdate.address = srcUpdate.address;
+		dstUpdate.dataOffset = dataOffset;
+		dstUpdate.dataSize = srcUpdate.size;
 		dstUpdate.fifoPosition = srcUpdate.fifoPosition;
-		dstUpdate.size = srcUpdate.dataSize;
-		dstUpdate.data = new u8[srcUpdate.dataSize];
-		dstUpdate.type = (MemoryUpdate::Type)srcUpdate.type;
+		dstUpdate.type = srcUpdate.type;
+		memcpy(&data[listOffset + i * sizeof(FileMemoryUpdate)], &dstUpdate, sizeof(FileMemoryUpdate));
 
-		file.Seek(srcUpdate.dataOffset, SEEK_SET);
-		file.ReadBytes(dstUpdate.data, srcUpdate.dataSize);
+		if (srcUpdate.size)
+			memcpy(&data[dataOffset], srcUpdate.data, srcUpdate.size);
+		dataOffset += srcUpdate.size;
 	}
+
+	return data;
+}
+
+bool FifoDataFile::Compress(const std::vector<u8> &data, std::vector<u8> &compressed)
+{
+	// Fast is good enough, FIFO data compresses well anyway
+	uLongf size = compressBound((uLong)data.size());
+	compressed.resize(size);
+	if (compress2(compressed.data(), &size, data.data(), (uLong)data.size(), 1) != Z_OK)
+		return false;
+
+	compressed.resize(size);
+	return true;
 }
@@ -4,14 +4,17 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include "Common/Common.h"
-
-namespace File
-{
-	class IOFile;
-}
+#include "Common/FileUtil.h"
 
 struct MemoryUpdate
 {
@@ -64,12 +67,25 @@ public:
 	u32 *GetXFMem() { return m_XFMem; }
 	u32 *GetXFRegs() { return m_XFRegs; }
 
+	// Copies the frame, which is then compressed and written to a temporary
+	// file in the background. Only a few frames wait for that in memory, so
+	// recording blocks if compression falls behind. Not for loaded files.
 	void AddFrame(const FifoFrameInfo &frameInfo);
-	const FifoFrameInfo &GetFrame(size_t frame) const { return m_Frames[frame]; }
-	size_t GetFrameCount() { return m_Frames.size(); }
+
+	// Frames are read and decompressed when asked for. The most recently
+	// used ones are kept around, the others only as long as the returned
+	// pointers.
+	std::shared_ptr<const FifoFrameInfo> GetFrame(size_t frame) const;
+	size_t GetFrameCount() const;
+
+	// Over all frames, without loading any
+	u64 GetFifoDataSize() const;
+	u64 GetMemoryUpdatesSize() const;
 
 	bool Save(const char *filename);
 
+	// Only reads the header and the frame list. The frames are read from the
+	// file, which stays open, when they are needed.
 	static FifoDataFile *Load(const std::string &filename, bool flagsOnly);
 
 private:
@@ -78,13 +94,49 @@ private:
 		FLAG_IS_WII = 1
 	};
 
-	void PadFile(u32 numBytes, File::IOFile &file);
+	enum
+	{
+		// Decompressed frames kept around
+		FRAME_CACHE_SIZE = 4,
+		// Frames waiting to be compressed
+		MAX_PENDING_FRAMES = 4,
+	};
+
+	struct FrameEntry
+	{
+		// Where the frame is in m_Storage. Version 1 frames aren't compressed,
+		// and their memoryUpdatesOffset is a file offset too.
+		bool compressed;
+		u64 fifoDataOffset;
+		u32 compressedSize;
+		u32 uncompressedSize;
+		u32 fifoDataSize;
+		u32 fifoStart;
+		u32 fifoEnd;
+		u64 memoryUpdatesOffset;
+		u32 numMemoryUpdates;
+		u32 memoryUpdatesSize;
+	};
+
+	struct PendingFrame
+	{
+		size_t index;
+		std::vector<u8> data;
+	};
 
 	void SetFlag(u32 flag, bool set);
 	bool GetFlag(u32 flag) const;
 
-	u64 WriteMemoryUpdates(const std::vector<MemoryUpdate> &memUpdates, File::IOFile &file);
-	static void ReadMemoryUpdates(u64 fileOffset, u32 numUpdates, std::vector<MemoryUpdate> &memUpdates, File::IOFile &file);
+	// These need m_Mutex
+	void WaitForPending(std::unique_lock<std::mutex> &lk) const;
+	bool ReadCompressedFrame(const FrameEntry &entry, std::vector<u8> &compressed) const;
+	// In the version 2 layout, with the memory update list after the FIFO data
+	bool ReadFrameData(const FrameEntry &entry, std::vector<u8> &data) const;
+
+	void CompressThread();
+
+	static std::vector<u8> BuildFrameData(const FifoFrameInfo &frameInfo, u32 *memoryUpdatesSize);
+	static bool Compress(const std::vector<u8> &data, std::vector<u8> &compressed);
 
 	u32 m_BPMem[BP_MEM_SIZE];
 	u32 m_CPMem[CP_MEM_SIZE];
@@ -93,5 +145,24 @@ private:
 
 	u32 m_Flags;
 
-	std::vector<FifoFrameInfo> m_Frames;
+	// Guards everything below
+	mutable std::mutex m_Mutex;
+
+	std::vector<FrameEntry> m_Frames;
+	u64 m_FifoDataSize;
+	u64 m_MemoryUpdatesSize;
+
+	// The loaded file, or the temporary file of a recording
+	mutable File::IOFile m_Storage;
+	std::string m_StoragePath;
+	bool m_StorageIsTemp;
+
+	mutable std::list<std::pair<size_t, std::shared_ptr<const FifoFrameInfo>>> m_Cache;
+
+	std::deque<PendingFrame> m_Pending;
+	bool m_Compressing;
+	bool m_QuitCompressThread;
+	mutable std::condition_variable m_PendingEvent;
+	mutable std::condition_variable m_CompressedEvent;
+	std::thread m_CompressThread;
 };
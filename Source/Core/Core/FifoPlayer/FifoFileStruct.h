@@ -12,10 +12,22 @@ namespace FifoFileStruct
 enum
 {
 	FILE_ID            = 0x0d01f1f0,
-	VERSION_NUMBER     = 1,
-	MIN_LOADER_VERSION = 1,
+	VERSION_NUMBER     = 2,
+	MIN_LOADER_VERSION = 2,
 };
 
+// Version 1 files store each frame's FIFO data, memory update list and
+// memory update data uncompressed, wherever the offsets point.
+//
+// Since version 2, each frame is one zlib stream at fifoDataOffset of
+// compressedSize bytes, which inflates to uncompressedSize bytes of
+//   FIFO data (fifoDataSize bytes)
+//   the memory update list, at memoryUpdatesOffset
+//   the memory update data
+// with all the offsets relative to the start of the inflated data. The
+// frame list works as an index, so a frame can be loaded without touching
+// the others.
+
 #pragma pack(push, 4)
 
 union FileHeader
@@ -50,6 +62,11 @@ union FileFrameInfo
 		u32 fifoEnd;
 		u64 memoryUpdatesOffset;
 		u32 numMemoryUpdates;
+		// Version 2 and up
+		u32 compressedSize;
+		u32 uncompressedSize;
+		// Sum of the memory updates' dataSize
+		u32 memoryUpdatesSize;
 	};
 	u32 rawData[16];
 };
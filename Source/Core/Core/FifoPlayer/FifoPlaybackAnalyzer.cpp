@@ -24,12 +24,13 @@ struct CmdData
 	u8 *ptr;
 };
 
-FifoPlaybackAnalyzer::FifoPlaybackAnalyzer()
+FifoPlaybackAnalyzer::FifoPlaybackAnalyzer() :
+	m_Error(false)
 {
 	FifoAnalyzer::Init();
 }
 
-void FifoPlaybackAnalyzer::AnalyzeFrames(FifoDataFile *file, std::vector<AnalyzedFrameInfo> &frameInfo)
+void FifoPlaybackAnalyzer::Init(FifoDataFile *file)
 {
 	// Load BP memory
 	u32 *bpMem = file->GetBPMem();
@@ -46,72 +47,75 @@ void FifoPlaybackAnalyzer::AnalyzeFrames(FifoDataFile *file, std::vector<Analyze
 		FifoAnalyzer::LoadCPReg(0x90 + i, cpMem[0x90 + i], m_CpMem);
 	}
 
-	frameInfo.clear();
-	frameInfo.resize(file->GetFrameCount());
+	m_WrittenMemory.clear();
+	m_Error = false;
+}
 
-	for (size_t frameIdx = 0; frameIdx < file->GetFrameCount(); ++frameIdx)
-	{
-		const FifoFrameInfo& frame = file->GetFrame(frameIdx);
-		AnalyzedFrameInfo& analyzed = frameInfo[frameIdx];
+void FifoPlaybackAnalyzer::AnalyzeFrame(const FifoFrameInfo &frame, AnalyzedFrameInfo &analyzed)
+{
+	if (m_Error)
+		return;
 
-		m_DrawingObject = false;
+	m_DrawingObject = false;
 
-		u32 cmdStart = 0;
-		u32 nextMemUpdate = 0;
+	u32 cmdStart = 0;
+	u32 nextMemUpdate = 0;
 
 #if LOG_FIFO_CMDS
-		// Debugging
-		vector<CmdData> prevCmds;
+	// Debugging
+	vector<CmdData> prevCmds;
 #endif
 
-		while (cmdStart < frame.fifoDataSize)
+	while (cmdStart < frame.fifoDataSize)
+	{
+		// Add memory updates that have occurred before this point in the frame
+		while (nextMemUpdate < frame.memoryUpdates.size() && frame.memoryUpdates[nextMemUpdate].fifoPosition <= cmdStart)
 		{
-			// Add memory updates that have occurred before this point in the frame
-			while (nextMemUpdate < frame.memoryUpdates.size() && frame.memoryUpdates[nextMemUpdate].fifoPosition <= cmdStart)
-			{
-				AddMemoryUpdate(frame.memoryUpdates[nextMemUpdate], analyzed);
-				++nextMemUpdate;
-			}
+			const MemoryUpdate &update = frame.memoryUpdates[nextMemUpdate];
+			AnalyzedMemoryUpdate memUpdate = { update.fifoPosition, update.address, update.size, nextMemUpdate, 0 };
+			AddMemoryUpdate(memUpdate, analyzed);
+			++nextMemUpdate;
+		}
 
-			bool wasDrawing = m_DrawingObject;
+		bool wasDrawing = m_DrawingObject;
 
-			u32 cmdSize = DecodeCommand(&frame.fifoData[cmdStart]);
+		u32 cmdSize = DecodeCommand(&frame.fifoData[cmdStart]);
 
 #if LOG_FIFO_CMDS
-			CmdData cmdData;
-			cmdData.offset = cmdStart;
-			cmdData.ptr = &frame.fifoData[cmdStart];
-			cmdData.size = cmdSize;
-			prevCmds.push_back(cmdData);
+		CmdData cmdData;
+		cmdData.offset = cmdStart;
+		cmdData.ptr = &frame.fifoData[cmdStart];
+		cmdData.size = cmdSize;
+		prevCmds.push_back(cmdData);
 #endif
 
-			// Check for error
-			if (cmdSize == 0)
-			{
-				// Clean up frame analysis
-				analyzed.objectStarts.clear();
-				analyzed.objectEnds.clear();
-
-				return;
-			}
+		// Check for error
+		if (cmdSize == 0)
+		{
+			// Clean up frame analysis
+			analyzed.objectStarts.clear();
+			analyzed.objectEnds.clear();
 
-			if (wasDrawing != m_DrawingObject)
-			{
-				if (m_DrawingObject)
-					analyzed.objectStarts.push_back(cmdStart);
-				else
-					analyzed.objectEnds.push_back(cmdStart);
-			}
+			m_Error = true;
+			return;
+		}
 
-			cmdStart += cmdSize;
+		if (wasDrawing != m_DrawingObject)
+		{
+			if (m_DrawingObject)
+				analyzed.objectStarts.push_back(cmdStart);
+			else
+				analyzed.objectEnds.push_back(cmdStart);
 		}
 
-		if (analyzed.objectEnds.size() < analyzed.objectStarts.size())
-			analyzed.objectEnds.push_back(cmdStart);
+		cmdStart += cmdSize;
 	}
+
+	if (analyzed.objectEnds.size() < analyzed.objectStarts.size())
+		analyzed.objectEnds.push_back(cmdStart);
 }
 
-void FifoPlaybackAnalyzer::AddMemoryUpdate(MemoryUpdate memUpdate, AnalyzedFrameInfo &frameInfo)
+void FifoPlaybackAnalyzer::AddMemoryUpdate(AnalyzedMemoryUpdate memUpdate, AnalyzedFrameInfo &frameInfo)
 {
 	u32 begin = memUpdate.address;
 	u32 end = memUpdate.address + memUpdate.size;
@@ -134,7 +138,7 @@ void FifoPlaybackAnalyzer::AddMemoryUpdate(MemoryUpdate memUpdate, AnalyzedFrame
 				}
 
 				u32 bytesToRangeEnd = range.end - memUpdate.address;
-				memUpdate.data += bytesToRangeEnd;
+				memUpdate.offset += bytesToRangeEnd;
 				memUpdate.size = postSize;
 				memUpdate.address = range.end;
 			}
@@ -10,11 +10,23 @@
 #include "Core/FifoPlayer/FifoAnalyzer.h"
 #include "Core/FifoPlayer/FifoDataFile.h"
 
+// The part of a frame's memory update the GP doesn't overwrite itself.
+// Points into the frame by index, as frames aren't kept loaded.
+struct AnalyzedMemoryUpdate
+{
+	u32 fifoPosition;
+	u32 address;
+	u32 size;
+	// Index into the frame's memoryUpdates and offset into its data
+	u32 update;
+	u32 offset;
+};
+
 struct AnalyzedFrameInfo
 {
 	std::vector<u32> objectStarts;
 	std::vector<u32> objectEnds;
-	std::vector<MemoryUpdate> memoryUpdates;
+	std::vector<AnalyzedMemoryUpdate> memoryUpdates;
 };
 
 class FifoPlaybackAnalyzer
@@ -22,7 +34,9 @@ class FifoPlaybackAnalyzer
 public:
 	FifoPlaybackAnalyzer();
 
-	void AnalyzeFrames(FifoDataFile *file, std::vector<AnalyzedFrameInfo> &frameInfo);
+	// Frames have to be analyzed in order, starting with the first
+	void Init(FifoDataFile *file);
+	void AnalyzeFrame(const FifoFrameInfo &frame, AnalyzedFrameInfo &analyzed);
 
 private:
 	struct MemoryRange
@@ -31,7 +45,7 @@ private:
 		u32 end;
 	};
 
-	void AddMemoryUpdate(MemoryUpdate memUpdate, AnalyzedFrameInfo &frameInfo);
+	void AddMemoryUpdate(AnalyzedMemoryUpdate memUpdate, AnalyzedFrameInfo &frameInfo);
 
 	u32 DecodeCommand(u8 *data);
 	void LoadBP(u32 value0);
@@ -40,6 +54,8 @@ private:
 	void StoreWrittenRegion(u32 address, u32 size);
 
 	bool m_DrawingObject;
+	// A frame couldn't be decoded, the ones after it are left empty
+	bool m_Error;
 
 	std::vector<MemoryRange> m_WrittenMemory;
 
@@ -30,8 +30,11 @@ bool FifoPlayer::Open(const std::string& filename)
 
 	if (m_File)
 	{
-		FifoPlaybackAnalyzer analyzer;
-		analyzer.AnalyzeFrames(m_File, m_FrameInfo);
+		std::lock_guard<std::mutex> lk(m_AnalyzerMutex);
+		m_Analyzer.reset(new FifoPlaybackAnalyzer);
+		m_Analyzer->Init(m_File);
+		m_AnalyzedFrames = 0;
+		m_FrameInfo.resize(m_File->GetFrameCount());
 
 		m_FrameRangeEnd = m_File->GetFrameCount();
 	}
@@ -47,6 +50,13 @@ void FifoPlayer::Close()
 	delete m_File;
 	m_File = NULL;
 
+	{
+		std::lock_guard<std::mutex> lk(m_AnalyzerMutex);
+		m_Analyzer.reset();
+		m_AnalyzedFrames = 0;
+		m_FrameInfo.clear();
+	}
+
 	m_FrameRangeStart = 0;
 	m_FrameRangeEnd = 0;
 }
@@ -60,6 +70,7 @@ bool FifoPlayer::Play()
 		return false;
 
 	m_CurrentFrame = m_FrameRangeStart;
+	m_Pass = 0;
 
 	LoadMemory();
 
@@ -70,7 +81,8 @@ bool FifoPlayer::Play()
 		{
 			if (m_CurrentFrame >= m_FrameRangeEnd)
 			{
-				if (m_Loop)
+				++m_Pass;
+				if (m_PassCount ? m_Pass < m_PassCount : m_Loop)
 				{
 					m_CurrentFrame = m_FrameRangeStart;
 
@@ -85,13 +97,21 @@ bool FifoPlayer::Play()
 			}
 			else
 			{
-				if (m_FrameWrittenCb)
-					m_FrameWrittenCb();
+				// Loading and analyzing the frame isn't part of playing it, so it
+				// happens before the callback which starts the benchmark timer
+				std::shared_ptr<const FifoFrameInfo> frame = m_File->GetFrame(m_CurrentFrame);
+				const AnalyzedFrameInfo& info = GetAnalyzedFrameInfo(m_CurrentFrame);
 
 				if (m_EarlyMemoryUpdates && m_CurrentFrame == m_FrameRangeStart)
 					WriteAllMemoryUpdates();
 
-				WriteFrame(m_File->GetFrame(m_CurrentFrame), m_FrameInfo[m_CurrentFrame]);
+				if (m_FrameWrittenCb)
+					m_FrameWrittenCb();
+
+				WriteFrame(*frame, info);
+
+				if (m_FrameFinishedCb)
+					m_FrameFinishedCb();
 
 				++m_CurrentFrame;
 			}
@@ -105,12 +125,28 @@ u32 FifoPlayer::GetFrameObjectCount()
 {
 	if (m_CurrentFrame < m_FrameInfo.size())
 	{
-		return (u32)(m_FrameInfo[m_CurrentFrame].objectStarts.size());
+		return (u32)(GetAnalyzedFrameInfo(m_CurrentFrame).objectStarts.size());
 	}
 
 	return 0;
 }
 
+const AnalyzedFrameInfo& FifoPlayer::GetAnalyzedFrameInfo(u32 frame)
+{
+	std::lock_guard<std::mutex> lk(m_AnalyzerMutex);
+
+	// Frames are analyzed in order, as each depends on what the ones before
+	// left in GP memory
+	while (m_AnalyzedFrames <= frame)
+	{
+		std::shared_ptr<const FifoFrameInfo> fifoFrame = m_File->GetFrame(m_AnalyzedFrames);
+		m_Analyzer->AnalyzeFrame(*fifoFrame, m_FrameInfo[m_AnalyzedFrames]);
+		++m_AnalyzedFrames;
+	}
+
+	return m_FrameInfo[frame];
+}
+
 void FifoPlayer::SetFrameRangeStart(u32 start)
 {
 	if (m_File)
@@ -157,10 +193,14 @@ FifoPlayer::FifoPlayer() :
 	m_FrameRangeEnd(0),
 	m_ObjectRangeStart(0),
 	m_ObjectRangeEnd(10000),
+	m_PassCount(0),
+	m_Pass(0),
 	m_EarlyMemoryUpdates(false),
 	m_FileLoadedCb(NULL),
 	m_FrameWrittenCb(NULL),
-	m_File(NULL)
+	m_FrameFinishedCb(NULL),
+	m_File(NULL),
+	m_AnalyzedFrames(0)
 {
 	m_Loop = SConfig::GetInstance().m_LocalCoreStartupParameter.bLoopFifoReplay;
 }
@@ -183,7 +223,7 @@ void FifoPlayer::WriteFrame(const FifoFrameInfo &frame, const AnalyzedFrameInfo
 	// Skip memory updates during frame if true
 	if (m_EarlyMemoryUpdates)
 	{
-		memoryUpdate = (u32)(frame.memoryUpdates.size());
+		memoryUpdate = (u32)(info.memoryUpdates.size());
 	}
 
 	if (numObjects > 0)
@@ -228,9 +268,15 @@ void FifoPlayer::WriteFramePart(u32 dataStart, u32 dataEnd, u32 &nextMemUpdate,
 {
 	u8 *data = frame.fifoData;
 
-	while (nextMemUpdate < frame.memoryUpdates.size() && dataStart < dataEnd)
+	while (nextMemUpdate < info.memoryUpdates.size() && dataStart < dataEnd)
 	{
-		const MemoryUpdate &memUpdate = info.memoryUpdates[nextMemUpdate];
+		const AnalyzedMemoryUpdate &analyzedUpdate = info.memoryUpdates[nextMemUpdate];
+
+		MemoryUpdate memUpdate = frame.memoryUpdates[analyzedUpdate.update];
+		memUpdate.fifoPosition = analyzedUpdate.fifoPosition;
+		memUpdate.address = analyzedUpdate.address;
+		memUpdate.size = analyzedUpdate.size;
+		memUpdate.data += analyzedUpdate.offset;
 
 		if (memUpdate.fifoPosition < dataEnd)
 		{
@@ -261,8 +307,8 @@ void FifoPlayer::WriteAllMemoryUpdates()
 
 	for (size_t frameNum = 0; frameNum < m_File->GetFrameCount(); ++frameNum)
 	{
-		const FifoFrameInfo &frame = m_File->GetFrame(frameNum);
-		for (auto& update : frame.memoryUpdates)
+		std::shared_ptr<const FifoFrameInfo> frame = m_File->GetFrame(frameNum);
+		for (auto& update : frame->memoryUpdates)
 		{
 			WriteMemory(update);
 		}
@@ -311,16 +357,16 @@ void FifoPlayer::SetupFifo()
 	WriteCP(0x02, 0); // disable read, BP, interrupts
 	WriteCP(0x04, 7); // clear overflow, underflow, metrics
 
-	const FifoFrameInfo& frame = m_File->GetFrame(m_CurrentFrame);
+	std::shared_ptr<const FifoFrameInfo> frame = m_File->GetFrame(m_CurrentFrame);
 
 	// Set fifo bounds
-	WriteCP(0x20, frame.fifoStart);
-	WriteCP(0x22, frame.fifoStart >> 16);
-	WriteCP(0x24, frame.fifoEnd);
-	WriteCP(0x26, frame.fifoEnd >> 16);
+	WriteCP(0x20, frame->fifoStart);
+	WriteCP(0x22, frame->fifoStart >> 16);
+	WriteCP(0x24, frame->fifoEnd);
+	WriteCP(0x26, frame->fifoEnd >> 16);
 
 	// Set watermarks
-	u32 fifoSize = frame.fifoEnd - frame.fifoStart;
+	u32 fifoSize = frame->fifoEnd - frame->fifoStart;
 	WriteCP(0x28, fifoSize);
 	WriteCP(0x2a, fifoSize >> 16);
 	WriteCP(0x2c, 0);
@@ -329,19 +375,19 @@ void FifoPlayer::SetupFifo()
 	// Set R/W pointers to fifo start
 	WriteCP(0x30, 0);
 	WriteCP(0x32, 0);
-	WriteCP(0x34, frame.fifoStart);
-	WriteCP(0x36, frame.fifoStart >> 16);
-	WriteCP(0x38, frame.fifoStart);
-	WriteCP(0x3a, frame.fifoStart >> 16);
+	WriteCP(0x34, frame->fifoStart);
+	WriteCP(0x36, frame->fifoStart >> 16);
+	WriteCP(0x38, frame->fifoStart);
+	WriteCP(0x3a, frame->fifoStart >> 16);
 
 	// Set fifo bounds
-	WritePI(12, frame.fifoStart);
-	WritePI(16, frame.fifoEnd);
+	WritePI(12, frame->fifoStart);
+	WritePI(16, frame->fifoEnd);
 
 	// Set write pointer
-	WritePI(20, frame.fifoStart);
+	WritePI(20, frame->fifoStart);
 	FlushWGP();
-	WritePI(20, frame.fifoStart);
+	WritePI(20, frame->fifoStart);
 
 	WriteCP(0x02, 17); // enable read & GP link
 }
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -31,7 +33,8 @@ public:
 	u32 GetFrameObjectCount();
 	u32 GetCurrentFrameNum() const { return m_CurrentFrame; }
 
-	const AnalyzedFrameInfo& GetAnalyzedFrameInfo(u32 frame) const { return m_FrameInfo[frame]; }
+	// Frames are analyzed when first asked for, along with the ones before
+	const AnalyzedFrameInfo& GetAnalyzedFrameInfo(u32 frame);
 
 	// Frame range
 	u32 GetFrameRangeStart() const { return m_FrameRangeStart; }
@@ -47,13 +50,23 @@ public:
 	u32 GetObjectRangeEnd() const { return m_ObjectRangeEnd; }
 	void SetObjectRangeEnd(u32 end)  { m_ObjectRangeEnd = end; }
 
+	// Plays the frame range this many times and stops. 0 leaves it to the
+	// loop setting.
+	void SetPassCount(u32 count) { m_PassCount = count; }
+	// Number of times the frame range was played through so far
+	u32 GetPass() const { return m_Pass; }
+
 	// If enabled then all memory updates happen at once before the first frame
 	// Default is disabled
 	void SetEarlyMemoryUpdates(bool enabled) { m_EarlyMemoryUpdates = enabled; }
 
 	// Callbacks
 	void SetFileLoadedCallback(CallbackFunc callback) { m_FileLoadedCb = callback; }
+	// Called before each frame is written, despite the name
 	void SetFrameWrittenCallback(CallbackFunc callback) { m_FrameWrittenCb = callback; }
+	// Called after each frame is written, with GetCurrentFrameNum() still
+	// returning that frame
+	void SetFrameFinishedCallback(CallbackFunc callback) { m_FrameFinishedCb = callback; }
 
 	static FifoPlayer &GetInstance();
 
@@ -95,6 +108,9 @@ private:
 	u32 m_ObjectRangeStart;
 	u32 m_ObjectRangeEnd;
 
+	u32 m_PassCount;
+	u32 m_Pass;
+
 	bool m_EarlyMemoryUpdates;
 
 	u64 m_CyclesPerFrame;
@@ -103,8 +119,12 @@ private:
 
 	CallbackFunc m_FileLoadedCb;
 	CallbackFunc m_FrameWrittenCb;
+	CallbackFunc m_FrameFinishedCb;
 
 	FifoDataFile *m_File;
 
+	std::mutex m_AnalyzerMutex;
+	std::unique_ptr<FifoPlaybackAnalyzer> m_Analyzer;
+	u32 m_AnalyzedFrames;
 	std::vector<AnalyzedFrameInfo> m_FrameInfo;
 };
@@ -83,15 +83,20 @@ void FifoRecorder::WriteGPCommand(u8 *data, u32 size)
 
 	if (m_FrameEnded && m_FifoData.size() > 0)
 	{
-		size_t dataSize = m_FifoData.size();
-		m_CurrentFrame.fifoDataSize = (u32)dataSize;
-		m_CurrentFrame.fifoData = new u8[dataSize];
-		memcpy(m_CurrentFrame.fifoData, m_FifoData.data(), dataSize);
+		m_CurrentFrame.fifoDataSize = (u32)m_FifoData.size();
+		m_CurrentFrame.fifoData = m_FifoData.data();
+
+		// The update data was only appended so far, as the arena may move
+		u8 *updateData = m_UpdateData.data();
+		for (auto& update : m_CurrentFrame.memoryUpdates)
+		{
+			update.data = updateData;
+			updateData += update.size;
+		}
 
 		sMutex.lock();
 
-		// Copy frame to file
-		// The file will be responsible for freeing the memory allocated for each frame's fifoData
+		// The file makes its own copy of the frame
 		m_File->AddFrame(m_CurrentFrame);
 
 		if (m_FinishedCb && m_RequestedRecordingEnd)
@@ -100,6 +105,7 @@ void FifoRecorder::WriteGPCommand(u8 *data, u32 size)
 		sMutex.unlock();
 
 		m_CurrentFrame.memoryUpdates.clear();
+		m_UpdateData.clear();
 		m_FifoData.clear();
 		m_FrameEnded = false;
 	}
@@ -107,10 +113,8 @@ void FifoRecorder::WriteGPCommand(u8 *data, u32 size)
 	m_SkipNextData = m_SkipFutureData;
 }
 
-void FifoRecorder::WriteMemory(u32 address, u32 size, MemoryUpdate::Type type)
+void FifoRecorder::GetMemoryPointers(u32 address, u8 *&curData, u8 *&newData)
 {
-	u8 *curData;
-	u8 *newData;
 	if (address & 0x10000000)
 	{
 		curData = &m_ExRam[address & Memory::EXRAM_MASK];
@@ -121,20 +125,60 @@ void FifoRecorder::WriteMemory(u32 address, u32 size, MemoryUpdate::Type type)
 		curData = &m_Ram[address & Memory::RAM_MASK];
 		newData = &Memory::m_pRAM[address & Memory::RAM_MASK];
 	}
+}
+
+bool FifoRecorder::CleanBlocks(u32 address, u32 size)
+{
+	const u32 blockSize = Memory::WRITE_TRACKING_BLOCK_SIZE;
+	const u32 end = address + size;
+
+	bool dirty = false;
+	for (u32 block = address & ~(blockSize - 1); block < end; block += blockSize)
+	{
+		if (!Memory::CleanBlock(block))
+			continue;
+		dirty = true;
+
+		// Only the range gets compared, so the block stays dirty if the rest
+		// of it differs from what was recorded
+		u8 *curData, *newData;
+		u32 before = address > block ? address - block : 0;
+		u32 after = end < block + blockSize ? block + blockSize - end : 0;
+		GetMemoryPointers(block, curData, newData);
+		if (before && memcmp(curData, newData, before) != 0)
+			Memory::MarkBlockDirty(block);
+		GetMemoryPointers(end, curData, newData);
+		if (after && memcmp(curData, newData, after) != 0)
+			Memory::MarkBlockDirty(block);
+	}
+
+	return dirty;
+}
+
+void FifoRecorder::WriteMemory(u32 address, u32 size, MemoryUpdate::Type type)
+{
+	// Blocks nobody wrote to since they were last compared can't have changed
+	if (Memory::IsWriteTrackingEnabled() && !CleanBlocks(address, size))
+		return;
+
+	u8 *curData;
+	u8 *newData;
+	GetMemoryPointers(address, curData, newData);
 
 	if (memcmp(curData, newData, size) != 0)
 	{
 		// Update current memory
 		memcpy(curData, newData, size);
 
-		// Record memory update
+		// Record memory update. The data is kept in one buffer for the
+		// whole frame and pointed to when the frame ends.
 		MemoryUpdate memUpdate;
 		memUpdate.address = address;
 		memUpdate.fifoPosition = (u32)(m_FifoData.size());
 		memUpdate.size = size;
 		memUpdate.type = type;
-		memUpdate.data = new u8[size];
-		memcpy(memUpdate.data, newData, size);
+		memUpdate.data = NULL;
+		m_UpdateData.insert(m_UpdateData.end(), newData, newData + size);
 
 		m_CurrentFrame.memoryUpdates.push_back(memUpdate);
 	}
@@ -165,6 +209,9 @@ void FifoRecorder::EndFrame(u32 fifoStart, u32 fifoEnd)
 	{
 		m_WasRecording = true;
 
+		// Without it, everything gets compared
+		Memory::EnableWriteTracking(true);
+
 		// Skip the first data which will be the frame copy command
 		m_SkipNextData = true;
 		m_SkipFutureData = false;
@@ -181,6 +228,8 @@ void FifoRecorder::EndFrame(u32 fifoStart, u32 fifoEnd)
 		m_SkipFutureData = true;
 		// Signal video backend that it should not call this function when the next frame ends
 		m_IsRecording = false;
+
+		Memory::EnableWriteTracking(false);
 	}
 
 	sMutex.unlock();
@@ -39,6 +39,10 @@ public:
 	static FifoRecorder &GetInstance();
 
 private:
+	void GetMemoryPointers(u32 address, u8 *&curData, u8 *&newData);
+	// Cleans the write tracked blocks of the range, true if any was dirty
+	bool CleanBlocks(u32 address, u32 size);
+
 	// Accessed from both GUI and video threads
 
 	// True if video thread should send data
@@ -58,6 +62,8 @@ private:
 	bool m_FrameEnded;
 	FifoFrameInfo m_CurrentFrame;
 	std::vector<u8> m_FifoData;
+	// Data of the current frame's memory updates, reused between frames
+	std::vector<u8> m_UpdateData;
 	u8 *m_Ram;
 	u8 *m_ExRam;
 	FifoRecordAnalyzer m_RecordAnalyzer;
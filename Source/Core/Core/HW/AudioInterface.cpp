@@ -50,12 +50,13 @@ This file mainly deals with the [Drive I/F], however [AIDFR] controls
   TODO maybe the files should be merged?
 */
 
+#include "AudioCommon/AudioCommon.h"
+#include "AudioCommon/Mixer.h"
 #include "Common/Common.h"
 #include "Common/MathUtil.h"
 
 #include "Core/CoreTiming.h"
 #include "Core/HW/AudioInterface.h"
-#include "Core/HW/CPU.h"
 #include "Core/HW/DVDInterface.h"
 #include "Core/HW/MMIO.h"
 #include "Core/HW/ProcessorInterface.h"
@@ -84,6 +85,13 @@ enum
 	AID_48KHz = 0
 };
 
+// Streamed audio is decoded this many ADPCM blocks (about 9 ms) at a time
+enum
+{
+	STREAM_BATCH_BLOCKS  = 16,
+	STREAM_BATCH_SAMPLES = STREAM_BATCH_BLOCKS * NGCADPCM::SAMPLES_PER_BLOCK
+};
+
 // AI Control Register
 union AICR
 {
@@ -145,9 +153,11 @@ void DoState(PointerWrap &p)
 static void GenerateAudioInterrupt();
 static void UpdateInterrupts();
 static void IncreaseSampleCount(const u32 _uAmount);
-void ReadStreamBlock(s16* _pPCM);
+void ReadStreamBlocks(s16* _pPCM, u32 _numBlocks);
+static void StreamingCallback(u64 userdata, int cyclesLate);
 u64 GetAIPeriod();
 int et_AI;
+static int et_Streaming;
 
 void Init()
 {
@@ -164,6 +174,7 @@ void Init()
 	g_AIDSampleRate = 32000;
 
 	et_AI = CoreTiming::RegisterEvent("AICallback", Update);
+	et_Streaming = CoreTiming::RegisterEvent("AIStreaming", StreamingCallback);
 }
 
 void Shutdown()
@@ -210,6 +221,10 @@ void RegisterMMIO(MMIO::Mapping* mmio, u32 base)
 
 				CoreTiming::RemoveEvent(et_AI);
 				CoreTiming::ScheduleEvent(((int)GetAIPeriod() / 2), et_AI);
+
+				CoreTiming::RemoveEvent(et_Streaming);
+				if (m_Control.PSTAT)
+					CoreTiming::ScheduleEvent(0, et_Streaming);
 			}
 
 			// AI Interrupt
@@ -278,121 +293,43 @@ void Callback_GetSampleRate(unsigned int &_AISampleRate, unsigned int &_DACSampl
 	_DACSampleRate = g_AIDSampleRate;
 }
 
-// Callback for the disc streaming
-// WARNING - called from audio thread
-unsigned int Callback_GetStreaming(short* _pDestBuffer, unsigned int _numSamples, unsigned int _sampleRate)
+// Decodes the next batch of disc streaming audio and hands it to the mixer,
+// which mixes it in on the audio thread.
+static void StreamingCallback(u64 userdata, int cyclesLate)
 {
-	if (m_Control.PSTAT && !CCPU::IsStepping())
-	{
-		static int pos = 0;
-		static short pcm[NGCADPCM::SAMPLES_PER_BLOCK*2];
-		const int lvolume = m_Volume.left;
-		const int rvolume = m_Volume.right;
-
-		if (g_AISSampleRate == 48000 && _sampleRate == 32000)
-		{
-			_dbg_assert_msg_(AUDIO_INTERFACE, !(_numSamples & 1), "Number of Samples: %i must be even!", _numSamples);
-			_numSamples = _numSamples * 3 / 2;
-		}
-
-		int pcm_l = 0, pcm_r = 0;
-		for (unsigned int i = 0; i < _numSamples; i++)
-		{
-			if (pos == 0)
-				ReadStreamBlock(pcm);
-
-			if (g_AISSampleRate == 48000 && _sampleRate == 32000) //downsample 48>32
-			{
-				if (i % 3)
-				{
-					pcm_l = (((pcm_l + (int)pcm[pos*2]) / 2  * lvolume) >> 8) + (int)(*_pDestBuffer);
-					MathUtil::Clamp(&pcm_l, -32767, 32767);
-					*_pDestBuffer++ = pcm_l;
-
-					pcm_r = (((pcm_r + (int)pcm[pos*2+1]) / 2 * rvolume) >> 8) + (int)(*_pDestBuffer);
-					MathUtil::Clamp(&pcm_r, -32767, 32767);
-					*_pDestBuffer++ = pcm_r;
-				}
-				pcm_l = pcm[pos*2];
-				pcm_r = pcm[pos*2+1];
-
-				pos++;
-			}
-			else if (g_AISSampleRate == 32000 && _sampleRate == 48000) //upsample 32>48
-			{
-				//starts with one sample of 0
-				const u32 ratio = (u32)( 65536.0f * 32000.0f / (float)_sampleRate );
-				static u32 frac = 0;
-
-				static s16 l1 = 0;
-				static s16 l2 = 0;
-
-				if (frac >= 0x10000 || frac == 0)
-				{
-					frac &= 0xffff;
-
-					l1 = l2;           //current
-					l2 = pcm[pos * 2]; //next
-				}
+	if (!m_Control.PSTAT)
+		return;
 
-				pcm_l = ((l1 << 16) + (l2 - l1) * (u16)frac)  >> 16;
-				pcm_r = ((l1 << 16) + (l2 - l1) * (u16)frac)  >> 16;
+	s16 pcm[STREAM_BATCH_SAMPLES*2];
+	ReadStreamBlocks(pcm, STREAM_BATCH_BLOCKS);
 
-
-				pcm_l = (pcm_l * lvolume >> 8) + (int)(*_pDestBuffer);
-				MathUtil::Clamp(&pcm_l, -32767, 32767);
-				*_pDestBuffer++ = pcm_l;
-
-				pcm_r = (pcm_r * lvolume >> 8) + (int)(*_pDestBuffer);
-				MathUtil::Clamp(&pcm_r, -32767, 32767);
-				*_pDestBuffer++ = pcm_r;
-
-				frac += ratio;
-				pos += frac >> 16;
-
-			}
-			else //1:1 no resampling
-			{
-				pcm_l = (((int)pcm[pos*2] * lvolume) >> 8) + (int)(*_pDestBuffer);
-				MathUtil::Clamp(&pcm_l, -32767, 32767);
-				*_pDestBuffer++ = pcm_l;
-
-				pcm_r = (((int)pcm[pos*2+1] * rvolume) >> 8) + (int)(*_pDestBuffer);
-				MathUtil::Clamp(&pcm_r, -32767, 32767);
-				*_pDestBuffer++ = pcm_r;
-
-				pos++;
-			}
-
-			if (pos == NGCADPCM::SAMPLES_PER_BLOCK)
-				pos = 0;
-		}
-	}
-	else
+	if (soundStream && soundStream->GetMixer())
 	{
-		// Don't overwrite existed sample data
-		/*
-		for (unsigned int i = 0; i < _numSamples * 2; i++)
+		// Same layout as the DSP's samples: big endian, right channel first
+		short samples[STREAM_BATCH_SAMPLES*2];
+		for (int i = 0; i < STREAM_BATCH_SAMPLES; i++)
 		{
-			_pDestBuffer[i] = 0; //silence!
+			samples[i * 2] = Common::swap16((u16)((pcm[i * 2 + 1] * m_Volume.right) >> 8));
+			samples[i * 2 + 1] = Common::swap16((u16)((pcm[i * 2] * m_Volume.left) >> 8));
 		}
-		*/
+		soundStream->GetMixer()->PushStreamingSamples(samples, STREAM_BATCH_SAMPLES);
 	}
 
-	return _numSamples;
+	CoreTiming::ScheduleEvent((int)(SystemTimers::GetTicksPerSecond() / g_AISSampleRate * STREAM_BATCH_SAMPLES) - cyclesLate, et_Streaming);
 }
 
-// WARNING - called from audio thread
-void ReadStreamBlock(s16 *_pPCM)
+void ReadStreamBlocks(s16 *_pPCM, u32 _numBlocks)
 {
+	// The drive reads ahead, so this only copies the blocks out of its buffer
+	// most of the time. Each block is still read before decoding it, as the
+	// stream looping resets the decoder.
 	u8 tempADPCM[NGCADPCM::ONE_BLOCK_SIZE];
-	if (DVDInterface::DVDReadADPCM(tempADPCM, NGCADPCM::ONE_BLOCK_SIZE))
-	{
-		NGCADPCM::DecodeBlock(_pPCM, tempADPCM);
-	}
-	else
+	for (u32 i = 0; i < _numBlocks; i++, _pPCM += NGCADPCM::SAMPLES_PER_BLOCK*2)
 	{
-		memset(_pPCM, 0, NGCADPCM::SAMPLES_PER_BLOCK*2);
+		if (DVDInterface::DVDReadADPCM(tempADPCM, NGCADPCM::ONE_BLOCK_SIZE))
+			NGCADPCM::DecodeBlock(_pPCM, tempADPCM);
+		else
+			memset(_pPCM, 0, NGCADPCM::SAMPLES_PER_BLOCK*2*sizeof(s16));
 	}
 
 	// our whole streaming code is "faked" ... so it shouldn't increase the sample counter
@@ -416,6 +353,11 @@ unsigned int GetAIDSampleRate()
 	return g_AIDSampleRate;
 }
 
+unsigned int GetAISSampleRate()
+{
+	return g_AISSampleRate;
+}
+
 void Update(u64 userdata, int cyclesLate)
 {
 	if (m_Control.PSTAT)
@@ -24,10 +24,10 @@ void Update(u64 userdata, int cyclesLate);
 
 // Called by DSP emulator
 void Callback_GetSampleRate(unsigned int &_AISampleRate, unsigned int &_DACSampleRate);
-unsigned int Callback_GetStreaming(short* _pDestBuffer, unsigned int _numSamples, unsigned int _sampleRate = 48000);
 
 // Get the audio rates (48000 or 32000 only)
 unsigned int GetAIDSampleRate();
+unsigned int GetAISSampleRate();
 
 void GenerateAISInterrupt();
 
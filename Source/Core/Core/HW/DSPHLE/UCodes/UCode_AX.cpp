@@ -6,6 +6,8 @@
 #include "Common/MathUtil.h"
 
 #include "Core/ConfigManager.h"
+#include "Core/Movie.h"
+#include "Core/NetPlayProto.h"
 #include "Core/HW/DSP.h"
 #include "Core/HW/DSPHLE/UCodes/UCode_AX.h"
 
@@ -16,7 +18,10 @@ CUCode_AX::CUCode_AX(DSPHLE* dsp_hle, u32 crc)
 	: IUCode(dsp_hle, crc)
 	, m_work_available(false)
 	, m_cmdlist_size(0)
-	, m_run_on_thread(false)
+	, m_run_on_thread(SConfig::GetInstance().m_LocalCoreStartupParameter.bDSPHLEThread)
+	, m_cmdlist_mixed(false)
+	, m_thread_busy(false)
+	, m_thread_exit(false)
 {
 	WARN_LOG(DSPHLE, "Instantiating CUCode_AX: crc=%08x", crc);
 	m_rMailHandler.PushMail(DSP_INIT);
@@ -24,9 +29,6 @@ CUCode_AX::CUCode_AX(DSPHLE* dsp_hle, u32 crc)
 
 	LoadResamplingCoefficients();
 
-	// DSP HLE on thread is always disabled because it causes audio
-	// issues/glitching (different timing characteristics). m_run_on_thread is
-	// always false.
 	if (m_run_on_thread)
 		m_axthread = std::thread(SpawnAXThread, this);
 }
@@ -35,8 +37,11 @@ CUCode_AX::~CUCode_AX()
 {
 	if (m_run_on_thread)
 	{
-		m_cmdlist_size = (u16)-1; // Special value to signal end
-		NotifyAXThread();
+		{
+			std::lock_guard<std::mutex> lk(m_cmdlist_mutex);
+			m_thread_exit = true;
+		}
+		m_cmdlist_cv.notify_one();
 		m_axthread.join();
 	}
 
@@ -91,18 +96,22 @@ void CUCode_AX::AXThread()
 	{
 		{
 			std::unique_lock<std::mutex> lk(m_cmdlist_mutex);
-			while (m_cmdlist_size == 0)
+			while (!m_thread_busy && !m_thread_exit)
 				m_cmdlist_cv.wait(lk);
-		}
 
-		if (m_cmdlist_size == (u16)-1) // End of thread signal
-			break;
+			if (m_thread_exit)
+				break;
+		}
 
-		m_processing.lock();
+		// Only works on the memory captured by MixCommandList, RAM is written
+		// by Update() on the CPU thread.
 		HandleCommandList();
-		m_cmdlist_size = 0;
-		SignalWorkEnd();
-		m_processing.unlock();
+
+		{
+			std::lock_guard<std::mutex> lk(m_cmdlist_mutex);
+			m_thread_busy = false;
+		}
+		m_cmdlist_done_cv.notify_one();
 	}
 }
 
@@ -113,18 +122,195 @@ void CUCode_AX::SignalWorkEnd()
 	DSP::GenerateDSPInterruptFromDSPEmu(DSP::INT_DSP);
 }
 
-void CUCode_AX::NotifyAXThread()
+bool CUCode_AX::UseAXThread() const
 {
-	std::unique_lock<std::mutex> lk(m_cmdlist_mutex);
-	m_cmdlist_cv.notify_one();
+	return m_run_on_thread && !NetPlay::IsNetPlayRunning()
+		&& !Movie::IsRecordingInput() && !Movie::IsPlayingInput();
 }
 
-void CUCode_AX::StartWorking()
+void CUCode_AX::MixCommandList(bool on_thread)
 {
-	if (m_run_on_thread)
-		NotifyAXThread();
+	ClearCommandListMemory();
+	CaptureCommandListInputs();
+	m_cmdlist_mixed = true;
+
+	if (on_thread)
+	{
+		{
+			std::lock_guard<std::mutex> lk(m_cmdlist_mutex);
+			m_thread_busy = true;
+		}
+		m_cmdlist_cv.notify_one();
+	}
 	else
-		m_work_available = true;
+	{
+		HandleCommandList();
+	}
+}
+
+void CUCode_AX::WaitForAXThread()
+{
+	if (!m_run_on_thread)
+		return;
+
+	std::unique_lock<std::mutex> lk(m_cmdlist_mutex);
+	while (m_thread_busy)
+		m_cmdlist_done_cv.wait(lk);
+}
+
+void CUCode_AX::ClearCommandListMemory()
+{
+	m_input_ranges.clear();
+	m_input_data.clear();
+	m_output_ranges.clear();
+	m_output_data.clear();
+}
+
+void CUCode_AX::CaptureInput(u32 addr, u32 size)
+{
+	if (!size || IsInputCaptured(addr))
+		return;
+
+	MemoryRange range = { addr, size, (u32)m_input_data.size() };
+	m_input_ranges.push_back(range);
+
+	const u8* src = (const u8*)HLEMemory_Get_Pointer(addr);
+	m_input_data.insert(m_input_data.end(), src, src + size);
+}
+
+bool CUCode_AX::IsInputCaptured(u32 addr) const
+{
+	for (const MemoryRange& range : m_input_ranges)
+	{
+		if (range.addr == addr)
+			return true;
+	}
+	return false;
+}
+
+const u8* CUCode_AX::ReadInput(u32 addr, u32 size)
+{
+	// The latest write wins, like it would in RAM
+	for (auto it = m_output_ranges.rbegin(); it != m_output_ranges.rend(); ++it)
+	{
+		if (addr >= it->addr && addr + size <= it->addr + it->size)
+			return &m_output_data[it->offset + addr - it->addr];
+	}
+
+	for (const MemoryRange& range : m_input_ranges)
+	{
+		if (addr >= range.addr && addr + size <= range.addr + range.size)
+			return &m_input_data[range.offset + addr - range.addr];
+	}
+
+	if (size)
+		WARN_LOG(DSPHLE, "AX command list reads %08x (%d bytes) which wasn't captured", addr, size);
+	return (const u8*)HLEMemory_Get_Pointer(addr);
+}
+
+u8* CUCode_AX::WriteOutput(u32 addr, u32 size)
+{
+	MemoryRange range = { addr, size, (u32)m_output_data.size() };
+	m_output_ranges.push_back(range);
+	m_output_data.resize(m_output_data.size() + size);
+	return &m_output_data[range.offset];
+}
+
+void CUCode_AX::CommitOutput()
+{
+	for (const MemoryRange& range : m_output_ranges)
+		memcpy(HLEMemory_Get_Pointer(range.addr), &m_output_data[range.offset], range.size);
+
+	ClearCommandListMemory();
+}
+
+static u32 ReadAddr(const u16* args)
+{
+	return (args[0] << 16) | args[1];
+}
+
+void CUCode_AX::CaptureCommandListInputs()
+{
+	// Sizes of the buffers read by the commands below, in bytes
+	const u32 buffer_size = 5 * 32 * sizeof (int);
+
+	u16 cmdlist[sizeof (m_cmdlist) / sizeof (u16)];
+	for (u32 i = 0; i < m_cmdlist_size && i < sizeof (m_cmdlist) / sizeof (u16); ++i)
+		cmdlist[i] = m_cmdlist[i];
+
+	u32 pb_addr = 0;
+	u32 curr_idx = 0;
+	u32 num_lists = 0;
+	while (curr_idx < sizeof (cmdlist) / sizeof (u16) - 12)
+	{
+		u16 cmd = cmdlist[curr_idx++];
+		const u16* args = &cmdlist[curr_idx];
+
+		switch (cmd)
+		{
+		case CMD_SETUP: CaptureInput(ReadAddr(args), 0x20 * sizeof (u16)); curr_idx += 2; break;
+		case CMD_DL_AND_VOL_MIX: CaptureInput(ReadAddr(args), 3 * buffer_size); curr_idx += 5; break;
+		case CMD_PB_ADDR: pb_addr = ReadAddr(args); curr_idx += 2; break;
+		case CMD_PROCESS: CapturePBList(pb_addr); break;
+		case CMD_MIX_AUXA:
+		case CMD_MIX_AUXB: CaptureInput(ReadAddr(args + 2), 3 * buffer_size); curr_idx += 4; break;
+		case CMD_UPLOAD_LRS: curr_idx += 2; break;
+		case CMD_SET_LR: CaptureInput(ReadAddr(args), buffer_size); curr_idx += 2; break;
+		case CMD_UNK_08: curr_idx += 10; break;
+		case CMD_MIX_AUXB_NOWRITE: CaptureInput(ReadAddr(args), 3 * buffer_size); curr_idx += 2; break;
+		case CMD_COMPRESSOR_TABLE_ADDR: curr_idx += 2; break;
+		case CMD_UNK_0B: break;
+		case CMD_UNK_0C: break;
+		case CMD_OUTPUT: curr_idx += 4; break;
+		case CMD_MIX_AUXB_LR: CaptureInput(ReadAddr(args + 2), 2 * buffer_size); curr_idx += 4; break;
+		case CMD_SET_OPPOSITE_LR: CaptureInput(ReadAddr(args), buffer_size); curr_idx += 2; break;
+		case CMD_UNK_12: curr_idx += 4; break;
+
+		case CMD_SEND_AUX_AND_MIX:
+			for (u32 i = 2; i < 6; ++i)
+				CaptureInput(ReadAddr(args + 2 * i), buffer_size);
+			curr_idx += 12;
+			break;
+
+		case CMD_MORE:
+		{
+			u32 addr = ReadAddr(args);
+			u16 size = args[2];
+			if (size >= sizeof (cmdlist) / sizeof (u16) || ++num_lists > 64)
+				return;
+
+			CaptureInput(addr, size * sizeof (u16));
+			const u16* next = (const u16*)ReadInput(addr, size * sizeof (u16));
+			for (u32 i = 0; i < size; ++i)
+				cmdlist[i] = Common::swap16(next[i]);
+			curr_idx = 0;
+			break;
+		}
+
+		default: // CMD_END or unknown
+			return;
+		}
+	}
+}
+
+void CUCode_AX::CapturePBList(u32 pb_addr)
+{
+	// Follows next_pb as it is in RAM. Should an update change it, the PBs
+	// that are only reachable that way are read from RAM when mixing.
+	AXPB pb;
+	for (u32 count = 0; pb_addr && count < 1024 && !IsInputCaptured(pb_addr); ++count)
+	{
+		CaptureInput(pb_addr, sizeof (pb));
+		if (!ReadPB(ReadInput(pb_addr, sizeof (pb)), pb))
+			break;
+
+		u32 num_updates = 0;
+		for (u16 n : pb.updates.num_updates)
+			num_updates += n;
+		CaptureInput(HILO_TO_32(pb.updates.data), num_updates * 2 * sizeof (u16));
+
+		pb_addr = HILO_TO_32(pb.next_pb);
+	}
 }
 
 void CUCode_AX::HandleCommandList()
@@ -304,7 +490,7 @@ void CUCode_AX::HandleCommandList()
 	}
 }
 
-void CUCode_AX::ApplyUpdatesForMs(int curr_ms, u16* pb, u16* num_updates, u16* updates)
+void CUCode_AX::ApplyUpdatesForMs(int curr_ms, u16* pb, const u16* num_updates, const u16* updates)
 {
 	u32 start_idx = 0;
 	for (int i = 0; i < curr_ms; ++i)
@@ -371,8 +557,9 @@ void CUCode_AX::SetupProcessing(u32 init_addr)
 {
 	u16 init_data[0x20];
 
+	const u16* src = (const u16*)ReadInput(init_addr, sizeof (init_data));
 	for (u32 i = 0; i < 0x20; ++i)
-		init_data[i] = HLEMemory_Read_U16(init_addr + 2 * i);
+		init_data[i] = Common::swap16(src[i]);
 
 	// List of all buffers we have to initialize
 	int* buffers[] = {
@@ -420,7 +607,7 @@ void CUCode_AX::DownloadAndMixWithVolume(u32 addr, u16 vol_main, u16 vol_auxa, u
 
 	for (u32 i = 0; i < 3; ++i)
 	{
-		int* ptr = (int*)HLEMemory_Get_Pointer(addr);
+		const int* ptr = (const int*)ReadInput(addr, 3 * 5 * 32 * sizeof (int));
 		u16 volume = volumes[i];
 		for (u32 j = 0; j < 3; ++j)
 		{
@@ -457,11 +644,14 @@ void CUCode_AX::ProcessPBList(u32 pb_addr)
 			m_samples_auxB_surround
 		}};
 
-		if (!ReadPB(pb_addr, pb))
+		if (!ReadPB(ReadInput(pb_addr, sizeof (pb)), pb))
 			break;
 
+		u32 num_updates = 0;
+		for (u16 n : pb.updates.num_updates)
+			num_updates += n;
 		u32 updates_addr = HILO_TO_32(pb.updates.data);
-		u16* updates = (u16*)HLEMemory_Get_Pointer(updates_addr);
+		const u16* updates = (const u16*)ReadInput(updates_addr, num_updates * 2 * sizeof (u16));
 
 		for (int curr_ms = 0; curr_ms < 5; ++curr_ms)
 		{
@@ -475,7 +665,7 @@ void CUCode_AX::ProcessPBList(u32 pb_addr)
 				buffers.ptrs[i] += spms;
 		}
 
-		WritePB(pb_addr, pb);
+		WritePB(WriteOutput(pb_addr, sizeof (pb)), pb);
 		pb_addr = HILO_TO_32(pb.next_pb);
 	}
 }
@@ -502,7 +692,7 @@ void CUCode_AX::MixAUXSamples(int aux_id, u32 write_addr, u32 read_addr)
 	// First, we need to send the contents of our AUX buffers to the CPU.
 	if (write_addr)
 	{
-		int* ptr = (int*)HLEMemory_Get_Pointer(write_addr);
+		int* ptr = (int*)WriteOutput(write_addr, 3 * 5 * 32 * sizeof (int));
 		for (auto& buffer : buffers)
 			for (u32 j = 0; j < 5 * 32; ++j)
 				*ptr++ = Common::swap32(buffer[j]);
@@ -510,7 +700,7 @@ void CUCode_AX::MixAUXSamples(int aux_id, u32 write_addr, u32 read_addr)
 
 	// Then, we read the new temp from the CPU and add to our current
 	// temp.
-	int* ptr = (int*)HLEMemory_Get_Pointer(read_addr);
+	const int* ptr = (const int*)ReadInput(read_addr, 3 * 5 * 32 * sizeof (int));
 	for (auto& sample : m_samples_left)
 		sample += (int)Common::swap32(*ptr++);
 	for (auto& sample : m_samples_right)
@@ -529,12 +719,12 @@ void CUCode_AX::UploadLRS(u32 dst_addr)
 		buffers[1][i] = Common::swap32(m_samples_right[i]);
 		buffers[2][i] = Common::swap32(m_samples_surround[i]);
 	}
-	memcpy(HLEMemory_Get_Pointer(dst_addr), buffers, sizeof (buffers));
+	memcpy(WriteOutput(dst_addr, sizeof (buffers)), buffers, sizeof (buffers));
 }
 
 void CUCode_AX::SetMainLR(u32 src_addr)
 {
-	int* ptr = (int*)HLEMemory_Get_Pointer(src_addr);
+	const int* ptr = (const int*)ReadInput(src_addr, 5 * 32 * sizeof (int));
 	for (u32 i = 0; i < 5 * 32; ++i)
 	{
 		int samp = (int)Common::swap32(*ptr++);
@@ -550,7 +740,7 @@ void CUCode_AX::OutputSamples(u32 lr_addr, u32 surround_addr)
 
 	for (u32 i = 0; i < 5 * 32; ++i)
 		surround_buffer[i] = Common::swap32(m_samples_surround[i]);
-	memcpy(HLEMemory_Get_Pointer(surround_addr), surround_buffer, sizeof (surround_buffer));
+	memcpy(WriteOutput(surround_addr, sizeof (surround_buffer)), surround_buffer, sizeof (surround_buffer));
 
 	// 32 samples per ms, 5 ms, 2 channels
 	short buffer[5 * 32 * 2];
@@ -568,20 +758,20 @@ void CUCode_AX::OutputSamples(u32 lr_addr, u32 surround_addr)
 		buffer[2 * i + 1] = Common::swap16(left);
 	}
 
-	memcpy(HLEMemory_Get_Pointer(lr_addr), buffer, sizeof (buffer));
+	memcpy(WriteOutput(lr_addr, sizeof (buffer)), buffer, sizeof (buffer));
 }
 
 void CUCode_AX::MixAUXBLR(u32 ul_addr, u32 dl_addr)
 {
 	// Upload AUXB L/R
-	int* ptr = (int*)HLEMemory_Get_Pointer(ul_addr);
+	int* up_ptr = (int*)WriteOutput(ul_addr, 2 * 5 * 32 * sizeof (int));
 	for (auto& sample : m_samples_auxB_left)
-		*ptr++ = Common::swap32(sample);
+		*up_ptr++ = Common::swap32(sample);
 	for (auto& sample : m_samples_auxB_right)
-		*ptr++ = Common::swap32(sample);
+		*up_ptr++ = Common::swap32(sample);
 
 	// Mix AUXB L/R to MAIN L/R, and replace AUXB L/R
-	ptr = (int*)HLEMemory_Get_Pointer(dl_addr);
+	const int* ptr = (const int*)ReadInput(dl_addr, 2 * 5 * 32 * sizeof (int));
 	for (u32 i = 0; i < 5 * 32; ++i)
 	{
 		int samp = Common::swap32(*ptr++);
@@ -598,7 +788,7 @@ void CUCode_AX::MixAUXBLR(u32 ul_addr, u32 dl_addr)
 
 void CUCode_AX::SetOppositeLR(u32 src_addr)
 {
-	int* ptr = (int*)HLEMemory_Get_Pointer(src_addr);
+	const int* ptr = (const int*)ReadInput(src_addr, 5 * 32 * sizeof (int));
 	for (u32 i = 0; i < 5 * 32; ++i)
 	{
 		int inp = Common::swap32(*ptr++);
@@ -619,13 +809,13 @@ void CUCode_AX::SendAUXAndMix(u32 main_auxa_up, u32 auxb_s_up, u32 main_l_dl,
 	};
 
 	// Upload AUXA LRS
-	int* ptr = (int*)HLEMemory_Get_Pointer(main_auxa_up);
+	int* ptr = (int*)WriteOutput(main_auxa_up, 3 * 32 * 5 * sizeof (int));
 	for (auto& up_buffer : up_buffers)
 		for (u32 j = 0; j < 32 * 5; ++j)
 			*ptr++ = Common::swap32(up_buffer[j]);
 
 	// Upload AUXB S
-	ptr = (int*)HLEMemory_Get_Pointer(auxb_s_up);
+	ptr = (int*)WriteOutput(auxb_s_up, 32 * 5 * sizeof (int));
 	for (auto& sample : m_samples_auxB_surround)
 		*ptr++ = Common::swap32(sample);
 
@@ -646,7 +836,7 @@ void CUCode_AX::SendAUXAndMix(u32 main_auxa_up, u32 auxb_s_up, u32 main_l_dl,
 	// Download and mix
 	for (u32 i = 0; i < sizeof (dl_buffers) / sizeof (dl_buffers[0]); ++i)
 	{
-		int* dl_src = (int*)HLEMemory_Get_Pointer(dl_addrs[i]);
+		const int* dl_src = (const int*)ReadInput(dl_addrs[i], 32 * 5 * sizeof (int));
 		for (u32 j = 0; j < 32 * 5; ++j)
 			dl_buffers[i][j] += (int)Common::swap32(*dl_src++);
 	}
@@ -663,13 +853,25 @@ void CUCode_AX::HandleMail(u32 mail)
 	// Wait for DSP processing to be done before answering any mail. This is
 	// safe to do because it matches what the DSP does on real hardware: there
 	// is no interrupt when a mail from CPU is received.
-	m_processing.lock();
+	WaitForAXThread();
 
 	if (next_is_cmdlist)
 	{
+		// Output of a list which didn't get to Update() yet
+		if (m_cmdlist_mixed)
+			CommitOutput();
+		else
+			ClearCommandListMemory();
+		m_cmdlist_mixed = false;
+
+		CaptureInput(mail, cmdlist_size * sizeof (u16));
 		CopyCmdList(mail, cmdlist_size);
-		StartWorking();
-		NotifyAXThread();
+		m_work_available = true;
+
+		// Inline, the list is mixed in Update(), when the DSP would be done
+		// with it.
+		if (UseAXThread())
+			MixCommandList(true);
 	}
 	else if (m_UploadSetupInProgress)
 	{
@@ -706,7 +908,6 @@ void CUCode_AX::HandleMail(u32 mail)
 		ERROR_LOG(DSPHLE, "Unknown mail sent to AX::HandleMail: %08x", mail);
 	}
 
-	m_processing.unlock();
 	next_is_cmdlist = set_next_is_cmdlist;
 }
 
@@ -718,8 +919,9 @@ void CUCode_AX::CopyCmdList(u32 addr, u16 size)
 		return;
 	}
 
-	for (u32 i = 0; i < size; ++i, addr += 2)
-		m_cmdlist[i] = HLEMemory_Read_U16(addr);
+	const u16* src = (const u16*)ReadInput(addr, size * sizeof (u16));
+	for (u32 i = 0; i < size; ++i)
+		m_cmdlist[i] = Common::swap16(src[i]);
 	m_cmdlist_size = size;
 }
 
@@ -739,7 +941,16 @@ void CUCode_AX::Update(int cycles)
 	}
 	else if (m_work_available)
 	{
-		HandleCommandList();
+		// On the AX thread, the list was mixed when it was received. Only now
+		// make the output visible to the game.
+		WaitForAXThread();
+
+		// Inline, or no new list since the last update
+		if (!m_cmdlist_mixed)
+			MixCommandList(false);
+
+		CommitOutput();
+		m_cmdlist_mixed = false;
 		m_cmdlist_size = 0;
 		SignalWorkEnd();
 	}
@@ -752,6 +963,18 @@ u32 CUCode_AX::GetUpdateMs()
 
 void CUCode_AX::DoAXState(PointerWrap& p)
 {
+	// A list which has been mixed but not written back yet is saved with its
+	// output, so it isn't mixed again after loading. Its captured inputs are
+	// not needed anymore.
+	p.Do(m_cmdlist_mixed);
+	p.Do(m_output_ranges);
+	p.Do(m_output_data);
+	if (p.GetMode() == PointerWrap::MODE_READ)
+	{
+		m_input_ranges.clear();
+		m_input_data.clear();
+	}
+
 	p.Do(m_cmdlist);
 	p.Do(m_cmdlist_size);
 
@@ -768,7 +991,7 @@ void CUCode_AX::DoAXState(PointerWrap& p)
 
 void CUCode_AX::DoState(PointerWrap& p)
 {
-	std::lock_guard<std::mutex> lk(m_processing);
+	WaitForAXThread();
 
 	DoStateShared(p);
 	DoAXState(p);
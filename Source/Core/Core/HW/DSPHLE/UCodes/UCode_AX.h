@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "Core/HW/DSPHLE/UCodes/UCode_AXStructs.h"
 #include "Core/HW/DSPHLE/UCodes/UCodes.h"
 
@@ -97,13 +99,66 @@ protected:
 	volatile u16 m_cmdlist[512];
 	volatile u32 m_cmdlist_size;
 
+	// If set, command lists are mixed on m_axthread as soon as they are
+	// received, instead of inline in Update(). Either way the completion mail
+	// is only sent from Update(), which waits for the thread first.
 	bool m_run_on_thread;
 
+	// Set once a received command list has been mixed and its output is
+	// waiting to be written back by Update().
+	bool m_cmdlist_mixed;
+
 	// Sync objects
-	std::mutex m_processing;
 	std::condition_variable m_cmdlist_cv;
+	std::condition_variable m_cmdlist_done_cv;
 	std::mutex m_cmdlist_mutex;
 
+	// Protected by m_cmdlist_mutex. m_thread_busy is set while the AX thread
+	// owns the command list.
+	bool m_thread_busy;
+	bool m_thread_exit;
+
+	// RAM as seen by the command list being mixed. Everything the list reads
+	// is copied when it is received and everything it writes is held back
+	// until Update(). The game never sees a partially mixed list, and what
+	// the list reads doesn't depend on when the AX thread gets to run.
+	struct MemoryRange
+	{
+		u32 addr;
+		u32 size;
+		u32 offset; // into the matching data buffer
+	};
+	std::vector<MemoryRange> m_input_ranges;
+	std::vector<u8> m_input_data;
+	std::vector<MemoryRange> m_output_ranges;
+	std::vector<u8> m_output_data;
+
+	// Copies [addr, addr + size) from RAM for the command list. CPU thread only.
+	void CaptureInput(u32 addr, u32 size);
+	bool IsInputCaptured(u32 addr) const;
+	// Returns the list's view of [addr, addr + size): earlier writes of the
+	// list, or the captured input. Falls back to RAM for ranges that were not
+	// captured.
+	const u8* ReadInput(u32 addr, u32 size);
+	// Returns a buffer which is written to [addr, addr + size) by Update().
+	// Only valid until the next call.
+	u8* WriteOutput(u32 addr, u32 size);
+	void CommitOutput();
+	void ClearCommandListMemory();
+
+	// Walks the command list in m_cmdlist and captures all the memory it
+	// reads (further command lists, PBs, updates and sample buffers).
+	virtual void CaptureCommandListInputs();
+	void CapturePBList(u32 pb_addr);
+
+	// The thread reads sample data while the CPU thread may still change it,
+	// so it is only used when nothing has to be deterministic.
+	bool UseAXThread() const;
+
+	// Captures the inputs of the list in m_cmdlist and mixes it, inline or on
+	// the AX thread.
+	void MixCommandList(bool on_thread);
+
 	std::thread m_axthread;
 
 	// Table of coefficients for polyphase sample rate conversion.
@@ -123,15 +178,12 @@ protected:
 	AXMixControl ConvertMixerControl(u32 mixer_control);
 
 	// Apply updates to a PB. Generic, used in AX GC and AX Wii.
-	void ApplyUpdatesForMs(int curr_ms, u16* pb, u16* num_updates, u16* updates);
-
-	// Signal that we should start handling a command list. Dispatches to the
-	// AX thread if using a thread, else just sets a boolean flag.
-	void StartWorking();
+	void ApplyUpdatesForMs(int curr_ms, u16* pb, const u16* num_updates, const u16* updates);
 
-	// Send a notification to the AX thread to tell it a new cmdlist addr is
-	// available for processing.
-	void NotifyAXThread();
+	// Blocks until the AX thread is done with the current command list.
+	// Must be called before touching any state the command list processing
+	// uses from the CPU thread.
+	void WaitForAXThread();
 
 	void AXThread();
 
@@ -30,6 +30,97 @@ CUCode_AXWii::CUCode_AXWii(DSPHLE *dsp_hle, u32 l_CRC)
 
 CUCode_AXWii::~CUCode_AXWii()
 {
+	// HandleCommandList is overridden, so the AX thread must not be running
+	// it anymore once this part of the object is gone.
+	WaitForAXThread();
+}
+
+static u32 ReadAddr(const volatile u16* args)
+{
+	return (args[0] << 16) | args[1];
+}
+
+void CUCode_AXWii::CaptureCommandListInputs()
+{
+	// Sizes of the buffers read by the commands below, in bytes
+	const u32 buffer_size = 3 * 32 * sizeof (int);
+
+	// The old command set has PB_ADDR, which shifts all the following ids by one
+	u16 shift = m_old_axwii ? 1 : 0;
+	u32 pb_addr = 0;
+
+	u32 curr_idx = 0;
+	while (curr_idx < sizeof (m_cmdlist) / sizeof (u16) - 13)
+	{
+		u16 cmd = m_cmdlist[curr_idx++];
+		const volatile u16* args = &m_cmdlist[curr_idx];
+
+		if (m_old_axwii && cmd == CMD_PB_ADDR_OLD)
+		{
+			pb_addr = ReadAddr(args);
+			curr_idx += 2;
+			continue;
+		}
+		if (cmd > CMD_PROCESS)
+			cmd -= shift;
+
+		switch (cmd)
+		{
+		case CMD_SETUP: CaptureInput(ReadAddr(args), 60 * sizeof (u16)); curr_idx += 2; break;
+		case CMD_ADD_TO_LR:
+		case CMD_SUB_TO_LR: CaptureInput(ReadAddr(args), buffer_size); curr_idx += 2; break;
+		case CMD_ADD_SUB_TO_LR: CaptureInput(ReadAddr(args), 2 * buffer_size); curr_idx += 2; break;
+
+		case CMD_PROCESS:
+			if (!m_old_axwii)
+			{
+				pb_addr = ReadAddr(args);
+				curr_idx += 2;
+			}
+			CaptureWiiPBList(pb_addr);
+			break;
+
+		case CMD_MIX_AUXA:
+		case CMD_MIX_AUXB:
+		case CMD_MIX_AUXC: CaptureInput(ReadAddr(args + 3), 3 * buffer_size); curr_idx += 5; break;
+
+		case CMD_UPL_AUXA_MIX_LRSC:
+		case CMD_UPL_AUXB_MIX_LRSC:
+			for (u32 i = 2; i < 6; ++i)
+				CaptureInput(ReadAddr(args + 1 + 2 * i), buffer_size);
+			curr_idx += 13;
+			break;
+
+		case CMD_UNK_0A: curr_idx += 4; break;
+		case CMD_OUTPUT:
+		case CMD_OUTPUT_DPL2: curr_idx += m_old_axwii ? 4 : 5; break;
+		case CMD_WM_OUTPUT: curr_idx += 8; break;
+
+		default: // CMD_END or unknown
+			return;
+		}
+	}
+}
+
+void CUCode_AXWii::CaptureWiiPBList(u32 pb_addr)
+{
+	AXPBWii pb;
+	for (u32 count = 0; pb_addr && count < 1024 && !IsInputCaptured(pb_addr); ++count)
+	{
+		CaptureInput(pb_addr, sizeof (pb));
+		if (!ReadPB(ReadInput(pb_addr, sizeof (pb)), pb))
+			break;
+
+		// Old versions keep the updates fields at the same place as AX GC
+		if (m_old_axwii)
+		{
+			const u16* pb_mem = (const u16*)&pb;
+			u32 updates_count = pb_mem[41] + pb_mem[42] + pb_mem[43];
+			CaptureInput((pb_mem[44] << 16) | pb_mem[45], updates_count * 2 * sizeof (u16));
+		}
+
+		pb_addr = HILO_TO_32(pb.next_pb);
+	}
 }
 
 void CUCode_AXWii::HandleCommandList()
@@ -249,8 +340,9 @@ void CUCode_AXWii::SetupProcessing(u32 init_addr)
 	// TODO: should be easily factorizable with AX
 	s16 init_data[60];
 
+	const u16* src = (const u16*)ReadInput(init_addr, sizeof (init_data));
 	for (u32 i = 0; i < 60; ++i)
-		init_data[i] = HLEMemory_Read_U16(init_addr + 2 * i);
+		init_data[i] = Common::swap16(src[i]);
 
 	// List of all buffers we have to initialize
 	struct {
@@ -305,7 +397,7 @@ void CUCode_AXWii::SetupProcessing(u32 init_addr)
 
 void CUCode_AXWii::AddToLR(u32 val_addr, bool neg)
 {
-	int* ptr = (int*)HLEMemory_Get_Pointer(val_addr);
+	const int* ptr = (const int*)ReadInput(val_addr, 32 * 3 * sizeof (int));
 	for (int i = 0; i < 32 * 3; ++i)
 	{
 		int val = (int)Common::swap32(*ptr++);
@@ -319,7 +411,7 @@ void CUCode_AXWii::AddToLR(u32 val_addr, bool neg)
 
 void CUCode_AXWii::AddSubToLR(u32 val_addr)
 {
-	int* ptr = (int*)HLEMemory_Get_Pointer(val_addr);
+	const int* ptr = (const int*)ReadInput(val_addr, 2 * 32 * 3 * sizeof (int));
 	for (int i = 0; i < 32 * 3; ++i)
 	{
 		int val = (int)Common::swap32(*ptr++);
@@ -385,13 +477,13 @@ bool CUCode_AXWii::ExtractUpdatesFields(AXPBWii& pb, u16* num_updates, u16* upda
 	u16 addr_hi = pb_mem[44];
 	u16 addr_lo = pb_mem[45];
 	u32 addr = HILO_TO_32(addr);
-	u16* ptr = (u16*)HLEMemory_Get_Pointer(addr);
+	u32 updates_count = num_updates[0] + num_updates[1] + num_updates[2];
+	const u16* ptr = (const u16*)ReadInput(addr, updates_count * 2 * sizeof (u16));
 
 	*updates_addr = addr;
 
 	// Copy the updates data and change the offset to match a PB without
 	// updates data.
-	u32 updates_count = num_updates[0] + num_updates[1] + num_updates[2];
 	for (u32 i = 0; i < updates_count; ++i)
 	{
 		u16 update_off = Common::swap16(ptr[2 * i]);
@@ -454,7 +546,7 @@ void CUCode_AXWii::ProcessPBList(u32 pb_addr)
 			m_samples_aux3
 		}};
 
-		if (!ReadPB(pb_addr, pb))
+		if (!ReadPB(ReadInput(pb_addr, sizeof (pb)), pb))
 			break;
 
 		u16 num_updates[3];
@@ -482,7 +574,7 @@ void CUCode_AXWii::ProcessPBList(u32 pb_addr)
 			             m_coeffs_available ? m_coeffs : NULL);
 		}
 
-		WritePB(pb_addr, pb);
+		WritePB(WriteOutput(pb_addr, sizeof (pb)), pb);
 		pb_addr = HILO_TO_32(pb.next_pb);
 	}
 }
@@ -524,14 +616,14 @@ void CUCode_AXWii::MixAUXSamples(int aux_id, u32 write_addr, u32 read_addr, u16
 	// Send the content of AUX buffers to the CPU
 	if (write_addr)
 	{
-		int* ptr = (int*)HLEMemory_Get_Pointer(write_addr);
+		int* ptr = (int*)WriteOutput(write_addr, 3 * 3 * 32 * sizeof (int));
 		for (auto& buffer : buffers)
 			for (u32 j = 0; j < 3 * 32; ++j)
 				*ptr++ = Common::swap32(buffer[j]);
 	}
 
 	// Then read the buffers from the CPU and add to our main buffers.
-	int* ptr = (int*)HLEMemory_Get_Pointer(read_addr);
+	const int* ptr = (const int*)ReadInput(read_addr, 3 * 3 * 32 * sizeof (int));
 	for (auto& main_buffer : main_buffers)
 		for (u32 j = 0; j < 3 * 32; ++j)
 		{
@@ -548,7 +640,7 @@ void CUCode_AXWii::UploadAUXMixLRSC(int aux_id, u32* addresses, u16 volume)
 	int* aux_surround = aux_id ? m_samples_auxB_surround : m_samples_auxA_surround;
 	int* auxc_buffer = aux_id ? m_samples_auxC_surround : m_samples_auxC_right;
 
-	int* upload_ptr = (int*)HLEMemory_Get_Pointer(addresses[0]);
+	int* upload_ptr = (int*)WriteOutput(addresses[0], 3 * 96 * sizeof (int));
 	for (u32 i = 0; i < 96; ++i)
 		*upload_ptr++ = Common::swap32(aux_left[i]);
 	for (u32 i = 0; i < 96; ++i)
@@ -556,7 +648,7 @@ void CUCode_AXWii::UploadAUXMixLRSC(int aux_id, u32* addresses, u16 volume)
 	for (u32 i = 0; i < 96; ++i)
 		*upload_ptr++ = Common::swap32(aux_surround[i]);
 
-	upload_ptr = (int*)HLEMemory_Get_Pointer(addresses[1]);
+	upload_ptr = (int*)WriteOutput(addresses[1], 96 * sizeof (int));
 	for (u32 i = 0; i < 96; ++i)
 		*upload_ptr++ = Common::swap32(auxc_buffer[i]);
 
@@ -572,7 +664,7 @@ void CUCode_AXWii::UploadAUXMixLRSC(int aux_id, u32* addresses, u16 volume)
 	};
 	for (u32 mix_i = 0; mix_i < 4; ++mix_i)
 	{
-		int* dl_ptr = (int*)HLEMemory_Get_Pointer(addresses[2 + mix_i]);
+		const int* dl_ptr = (const int*)ReadInput(addresses[2 + mix_i], 96 * sizeof (int));
 		for (u32 i = 0; i < 96; ++i)
 			aux_left[i] = Common::swap32(dl_ptr[i]);
 
@@ -596,14 +688,14 @@ void CUCode_AXWii::OutputSamples(u32 lr_addr, u32 surround_addr, u16 volume,
 
 	for (u32 i = 0; i < 3 * 32; ++i)
 		upload_buffer[i] = Common::swap32(m_samples_surround[i]);
-	memcpy(HLEMemory_Get_Pointer(surround_addr), upload_buffer, sizeof (upload_buffer));
+	memcpy(WriteOutput(surround_addr, sizeof (upload_buffer)), upload_buffer, sizeof (upload_buffer));
 
 	if (upload_auxc)
 	{
 		surround_addr += sizeof (upload_buffer);
 		for (u32 i = 0; i < 3 * 32; ++i)
 			upload_buffer[i] = Common::swap32(m_samples_auxC_left[i]);
-		memcpy(HLEMemory_Get_Pointer(surround_addr), upload_buffer, sizeof (upload_buffer));
+		memcpy(WriteOutput(surround_addr, sizeof (upload_buffer)), upload_buffer, sizeof (upload_buffer));
 	}
 
 	short buffer[3 * 32 * 2];
@@ -631,7 +723,7 @@ void CUCode_AXWii::OutputSamples(u32 lr_addr, u32 surround_addr, u16 volume,
 		buffer[2 * i + 1] = Common::swap16(m_samples_left[i]);
 	}
 
-	memcpy(HLEMemory_Get_Pointer(lr_addr), buffer, sizeof (buffer));
+	memcpy(WriteOutput(lr_addr, sizeof (buffer)), buffer, sizeof (buffer));
 
 	// There should be a DSP_SYNC message sent here. However, it looks like not
 	// sending it does not cause any issue, and sending it actually causes some
@@ -650,7 +742,7 @@ void CUCode_AXWii::OutputWMSamples(u32* addresses)
 	for (u32 i = 0; i < 4; ++i)
 	{
 		int* in = buffers[i];
-		u16* out = (u16*)HLEMemory_Get_Pointer(addresses[i]);
+		u16* out = (u16*)WriteOutput(addresses[i], 3 * 6 * sizeof (u16));
 		for (u32 j = 0; j < 3 * 6; ++j)
 		{
 			int sample = in[j];
@@ -667,7 +759,7 @@ u32 CUCode_AXWii::GetUpdateMs()
 
 void CUCode_AXWii::DoState(PointerWrap &p)
 {
-	std::lock_guard<std::mutex> lk(m_processing);
+	WaitForAXThread();
 
 	DoStateShared(p);
 	DoAXState(p);
@@ -55,6 +55,9 @@ protected:
 	// but this gives better precision and nicer code.
 	void GenerateVolumeRamp(u16* output, u16 vol1, u16 vol2, size_t nvals);
 
+	virtual void CaptureCommandListInputs() override;
+	void CaptureWiiPBList(u32 pb_addr);
+
 	virtual void HandleCommandList() override;
 
 	void SetupProcessing(u32 init_addr);
@@ -0,0 +1,106 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "Common/Common.h"
+#include "Core/HW/DSPHLE/UCodes/UCode_AX_Mix.h"
+
+#if _M_X86
+#include <emmintrin.h>
+#endif
+
+namespace AXMix
+{
+
+static inline s16 Scale(s16 sample, u16 volume)
+{
+	return (s16)(((s32)sample * volume) >> 15);
+}
+
+#if _M_X86
+// Volumes of 8 consecutive samples
+static inline __m128i VolumeRamp(u16 volume, u16 volume_delta)
+{
+	u16 v[8];
+	for (int i = 0; i < 8; ++i)
+		v[i] = volume + i * volume_delta;
+	return _mm_loadu_si128((const __m128i*)v);
+}
+
+// (s16)((samples * volumes) >> 15) as two vectors of 4 s32.
+// The 16x16 products are exact in 32 bits. mulhi treats the u16 volume as signed,
+// so add back samples << 16 where the volume's top bit is set.
+static inline void Scale8(__m128i samples, __m128i volumes, __m128i& lo, __m128i& hi)
+{
+	const __m128i prod_lo = _mm_mullo_epi16(samples, volumes);
+	__m128i prod_hi = _mm_mulhi_epi16(samples, volumes);
+	prod_hi = _mm_add_epi16(prod_hi, _mm_and_si128(_mm_srai_epi16(volumes, 15), samples));
+
+	lo = _mm_srai_epi32(_mm_unpacklo_epi16(prod_lo, prod_hi), 15);
+	hi = _mm_srai_epi32(_mm_unpackhi_epi16(prod_lo, prod_hi), 15);
+
+	// truncate to s16
+	lo = _mm_srai_epi32(_mm_slli_epi32(lo, 16), 16);
+	hi = _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16);
+}
+#endif
+
+void MixAdd(int* out, const s16* input, u32 count, u16& volume, u16 volume_delta, s16* dpop)
+{
+	u32 i = 0;
+
+#if _M_X86
+	if (count >= 8)
+	{
+		__m128i volumes = VolumeRamp(volume, volume_delta);
+		const __m128i step = _mm_set1_epi16((s16)(volume_delta * 8));
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i lo, hi;
+			Scale8(_mm_loadu_si128((const __m128i*)(input + i)), volumes, lo, hi);
+			_mm_storeu_si128((__m128i*)(out + i), _mm_add_epi32(_mm_loadu_si128((const __m128i*)(out + i)), lo));
+			_mm_storeu_si128((__m128i*)(out + i + 4), _mm_add_epi32(_mm_loadu_si128((const __m128i*)(out + i + 4)), hi));
+			volumes = _mm_add_epi16(volumes, step);
+		}
+		volume += (u16)(i * volume_delta);
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		out[i] += Scale(input[i], volume);
+		volume += volume_delta;
+	}
+
+	if (count)
+		*dpop = Scale(input[count - 1], volume - volume_delta);
+}
+
+void ApplyVolume(s16* samples, u32 count, u16& volume, u16 volume_delta)
+{
+	u32 i = 0;
+
+#if _M_X86
+	if (count >= 8)
+	{
+		__m128i volumes = VolumeRamp(volume, volume_delta);
+		const __m128i step = _mm_set1_epi16((s16)(volume_delta * 8));
+		for (; i + 8 <= count; i += 8)
+		{
+			__m128i lo, hi;
+			Scale8(_mm_loadu_si128((const __m128i*)(samples + i)), volumes, lo, hi);
+			_mm_storeu_si128((__m128i*)(samples + i), _mm_packs_epi32(lo, hi));
+			volumes = _mm_add_epi16(volumes, step);
+		}
+		volume += (u16)(i * volume_delta);
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		samples[i] = Scale(samples[i], volume);
+		volume += volume_delta;
+	}
+}
+
+}
@@ -0,0 +1,24 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Sample processing kernels shared by AX GC and AX Wii. They have to stay bit
+// exact with the scalar versions: every product is shifted right by 15 and
+// truncated to 16 bits, and volumes wrap around like the u16 they are.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+
+namespace AXMix
+{
+
+// out[i] += (s16)((input[i] * volume) >> 15), with volume += volume_delta after
+// each sample. *dpop is set to the last mixed sample (if count != 0).
+void MixAdd(int* out, const s16* input, u32 count, u16& volume, u16 volume_delta, s16* dpop);
+
+// samples[i] = (s16)((samples[i] * volume) >> 15), with volume += volume_delta
+// after each sample.
+void ApplyVolume(s16* samples, u32 count, u16& volume, u16 volume_delta);
+
+}
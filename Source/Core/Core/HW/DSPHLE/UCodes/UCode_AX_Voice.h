@@ -12,13 +12,14 @@
 #error UCode_AX_Voice.h included without specifying version
 #endif
 
-#include <functional>
+#include <algorithm>
 
 #include "Common/Common.h"
 #include "Common/MathUtil.h"
 #include "Core/HW/DSP.h"
 #include "Core/HW/Memmap.h"
 #include "Core/HW/DSPHLE/UCodes/UCode_AX.h"
+#include "Core/HW/DSPHLE/UCodes/UCode_AX_Mix.h"
 #include "Core/HW/DSPHLE/UCodes/UCode_AXStructs.h"
 
 #ifdef AX_GC
@@ -77,11 +78,11 @@ union AXBuffers
 #endif
 };
 
-// Read a PB from MRAM/ARAM
-bool ReadPB(u32 addr, PB_TYPE& pb)
+// Read a PB from its big endian copy in MRAM/ARAM
+bool ReadPB(const u8* mem, PB_TYPE& pb)
 {
 	u16* dst = (u16*)&pb;
-	const u16* src = (const u16*)Memory::GetPointer(addr);
+	const u16* src = (const u16*)mem;
 	if (!src)
 		return false;
 
@@ -92,10 +93,10 @@ bool ReadPB(u32 addr, PB_TYPE& pb)
 }
 
 // Write a PB back to MRAM/ARAM
-bool WritePB(u32 addr, const PB_TYPE& pb)
+bool WritePB(u8* mem, const PB_TYPE& pb)
 {
 	const u16* src = (const u16*)&pb;
-	u16* dst = (u16*)Memory::GetPointer(addr);
+	u16* dst = (u16*)mem;
 	if (!dst)
 		return false;
 
@@ -143,13 +144,11 @@ void AcceleratorSetup(PB_TYPE* pb, u32* cur_addr)
 	acc_end_reached = false;
 }
 
-// Reads a sample from the simulated accelerator. Also handles looping and
-// disabling streams that reached the end (this is done by an exception raised
-// by the accelerator on real hardware).
-u16 AcceleratorGetSample()
+// Handles looping and disabling streams that reached the end (this is done by
+// an exception raised by the accelerator on real hardware). Returns false if
+// there is nothing left to read.
+inline bool AcceleratorCheckEnd()
 {
-	u16 ret;
-
 	// Have we reached the end address?
 	//
 	// On real hardware, this would raise an interrupt that is handled by the
@@ -190,10 +189,15 @@ u16 AcceleratorGetSample()
 	}
 
 	// See above for explanations about acc_end_reached.
-	if (acc_end_reached)
-		return 0;
+	return !acc_end_reached;
+}
 
-	switch (acc_pb->audio_addr.sample_format)
+// Decodes the next sample of the given format, the end has to be checked before.
+template <u16 format>
+inline u16 AcceleratorDecodeSample()
+{
+	u16 ret = 0;
+	switch (format)
 	{
 		case 0x00: // ADPCM
 		{
@@ -240,13 +244,82 @@ u16 AcceleratorGetSample()
 			acc_pb->adpcm.yn1 = ret;
 			*acc_cur_addr += 1;
 			break;
+	}
+	return ret;
+}
+
+template <u16 format>
+void AcceleratorDecodeSamples(s16* samples, u32 count)
+{
+	for (u32 i = 0; i < count; ++i)
+		samples[i] = AcceleratorCheckEnd() ? AcceleratorDecodeSample<format>() : 0;
+}
 
+// Reads <count> samples from the simulated accelerator. The format is only
+// looked at once per block instead of once per sample.
+void AcceleratorGetSamples(s16* samples, u32 count)
+{
+	switch (acc_pb->audio_addr.sample_format)
+	{
+		case 0x00:
+			AcceleratorDecodeSamples<0x00>(samples, count);
+			break;
+		case 0x0A:
+			AcceleratorDecodeSamples<0x0A>(samples, count);
+			break;
+		case 0x19:
+			AcceleratorDecodeSamples<0x19>(samples, count);
+			break;
 		default:
-			ERROR_LOG(DSPHLE, "Unknown sample format: %d", acc_pb->audio_addr.sample_format);
-			return 0;
+			for (u32 i = 0; i < count; ++i)
+			{
+				if (AcceleratorCheckEnd())
+					ERROR_LOG(DSPHLE, "Unknown sample format: %d", acc_pb->audio_addr.sample_format);
+				samples[i] = 0;
+			}
+			break;
 	}
+}
 
-	return ret;
+// Feeds the resampler from the accelerator. Samples are decoded in blocks, but
+// never more than the resampler is going to consume: decoding has side effects
+// on the PB (ADPCM history, looping, end of stream).
+class AcceleratorReader
+{
+public:
+	explicit AcceleratorReader(u32 count) : m_remaining(count), m_pos(0), m_avail(0) {}
+
+	s16 Next()
+	{
+		if (m_pos == m_avail)
+			Refill();
+		return m_buffer[m_pos++];
+	}
+
+private:
+	enum { BLOCK_SIZE = 256 };
+
+	void Refill()
+	{
+		// m_remaining is exact, but never hand out uninitialized data
+		m_avail = m_remaining ? std::min<u32>(m_remaining, BLOCK_SIZE) : 1;
+		m_remaining -= std::min(m_remaining, m_avail);
+		m_pos = 0;
+		AcceleratorGetSamples(m_buffer, m_avail);
+	}
+
+	u32 m_remaining;
+	u32 m_pos;
+	u32 m_avail;
+	s16 m_buffer[BLOCK_SIZE];
+};
+
+// Returns how many input samples ResampleAudio will read.
+u32 ResampleInputCount(u32 count, u32 curr_pos, u32 ratio, int srctype)
+{
+	if (srctype == SRCTYPE_LINEAR || srctype == SRCTYPE_POLYPHASE)
+		return (u32)(((u64)curr_pos + (u64)ratio * count) >> 16);
+	return count;
 }
 
 // Reads samples from the input callback, resamples them to <count> samples at
@@ -269,7 +342,8 @@ u16 AcceleratorGetSample()
 // We start getting samples not from sample 0, but 0.<curr_pos_frac>. This
 // avoids discontinuities in the audio stream, especially with very low ratios
 // which interpolate a lot of values between two "real" samples.
-u32 ResampleAudio(std::function<s16(u32)> input_callback, s16* output, u32 count,
+template <typename F>
+u32 ResampleAudio(F input_callback, s16* output, u32 count,
                   s16* last_samples, u32 curr_pos, u32 ratio, int srctype,
                   const s16* coeffs)
 {
@@ -394,7 +468,8 @@ void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
 
 	if (coeffs)
 		coeffs += pb.coef_select * 0x200;
-	u32 curr_pos = ResampleAudio([](u32) { return AcceleratorGetSample(); },
+	AcceleratorReader reader(ResampleInputCount(count, pb.src.cur_addr_frac, HILO_TO_32(pb.src.ratio), pb.src_type));
+	u32 curr_pos = ResampleAudio([&reader](u32) { return reader.Next(); },
 	                             samples, count, pb.src.last_samples,
 	                             pb.src.cur_addr_frac, HILO_TO_32(pb.src.ratio),
 	                             pb.src_type, coeffs);
@@ -406,28 +481,12 @@ void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
 }
 
 // Add samples to an output buffer, with optional volume ramping.
-void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
+inline void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
 {
-	u16& volume = pvol[0];
-	u16 volume_delta = pvol[1];
-
-	// If volume ramping is disabled, set volume_delta to 0. That way, the
+	// If volume ramping is disabled, use a volume_delta of 0. That way, the
 	// mixing loop can avoid testing if volume ramping is enabled at each step,
 	// and just add volume_delta.
-	if (!ramp)
-		volume_delta = 0;
-
-	for (u32 i = 0; i < count; ++i)
-	{
-		s64 sample = input[i];
-		sample *= volume;
-		sample >>= 15;
-
-		out[i] += (s16)sample;
-		volume += volume_delta;
-
-		*dpop = (s16)sample;
-	}
+	AXMix::MixAdd(out, input, count, pvol[0], ramp ? pvol[1] : 0, dpop);
 }
 
 // Execute a low pass filter on the samples using one history value. Returns
@@ -452,11 +511,7 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
 	GetInputSamples(pb, samples, count, coeffs);
 
 	// Apply a global volume ramp using the volume envelope parameters.
-	for (u32 i = 0; i < count; ++i)
-	{
-		samples[i] = ((s32)samples[i] * pb.vol_env.cur_volume) >> 15;
-		pb.vol_env.cur_volume += pb.vol_env.cur_volume_delta;
-	}
+	AXMix::ApplyVolume(samples, count, pb.vol_env.cur_volume, pb.vol_env.cur_volume_delta);
 
 	// Optionally, execute a low pass filter
 	// TODO: LPF code is currently broken, causing Super Monkey Ball sound
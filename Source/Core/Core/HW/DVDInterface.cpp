@@ -25,6 +25,11 @@ static const u32 DISC_TRANSFER_RATE_GC = 5 * 1024 * 1024;
 // Disc access time measured in milliseconds
 static const u32 DISC_ACCESS_TIME_MS = 1;
 
+// Streamed audio is read from the disc this many bytes at a time, so that
+// every 32 byte ADPCM block doesn't need a read of its own (about 1.2 seconds
+// of audio)
+static const u32 ADPCM_READ_AHEAD = 64 * 1024;
+
 namespace DVDInterface
 {
 
@@ -208,6 +213,11 @@ static unsigned char media_buffer[0x40];
 // (both requests can happen at the same time, audio takes precedence)
 static std::mutex dvdread_section;
 
+// Streamed audio read ahead of AudioPos, protected by dvdread_section
+static u8 s_adpcm_cache[ADPCM_READ_AHEAD];
+static u32 s_adpcm_cache_start;
+static u32 s_adpcm_cache_length;
+
 static int ejectDisc;
 static int insertDisc;
 
@@ -218,6 +228,12 @@ void UpdateInterrupts();
 void GenerateDIInterrupt(DI_InterruptType _DVDInterrupt);
 void ExecuteCommand(UDICR& _DICR);
 
+static void InvalidateADPCMCache()
+{
+	std::lock_guard<std::mutex> lk(dvdread_section);
+	s_adpcm_cache_length = 0;
+}
+
 void DoState(PointerWrap &p)
 {
 	p.DoPOD(m_DISR);
@@ -239,6 +255,9 @@ void DoState(PointerWrap &p)
 
 	p.Do(CurrentStart);
 	p.Do(CurrentLength);
+
+	if (p.GetMode() == PointerWrap::MODE_READ)
+		InvalidateADPCMCache();
 }
 
 void TransferComplete(u64 userdata, int cyclesLate)
@@ -268,6 +287,7 @@ void Init()
 	CurrentLength = 0;
 
 	g_bStream = false;
+	InvalidateADPCMCache();
 
 	ejectDisc = CoreTiming::RegisterEvent("EjectDisc", EjectDiscCallback);
 	insertDisc = CoreTiming::RegisterEvent("InsertDisc", InsertDiscCallback);
@@ -299,6 +319,7 @@ void EjectDiscCallback(u64 userdata, int cyclesLate)
 	SetDiscInside(false);
 	SetLidOpen();
 	VolumeHandler::EjectVolume();
+	InvalidateADPCMCache();
 }
 
 void InsertDiscCallback(u64 userdata, int cyclesLate)
@@ -370,7 +391,29 @@ bool DVDReadADPCM(u8* _pDestBuffer, u32 _iNumSamples)
 	else
 	{
 		std::lock_guard<std::mutex> lk(dvdread_section);
-		VolumeHandler::ReadToPtr(_pDestBuffer, AudioPos, _iNumSamples);
+		if (_iNumSamples > ADPCM_READ_AHEAD)
+		{
+			VolumeHandler::ReadToPtr(_pDestBuffer, AudioPos, _iNumSamples);
+		}
+		else
+		{
+			if (AudioPos < s_adpcm_cache_start || AudioPos + _iNumSamples > s_adpcm_cache_start + s_adpcm_cache_length)
+			{
+				// Read up to the end of the stream, or at least what was asked for
+				u32 length = ADPCM_READ_AHEAD;
+				if (AudioPos < CurrentStart + CurrentLength)
+					length = std::min(length, (CurrentStart + CurrentLength - AudioPos + 31) & ~31);
+				length = std::max(length, _iNumSamples);
+
+				s_adpcm_cache_start = AudioPos;
+				s_adpcm_cache_length = VolumeHandler::ReadToPtr(s_adpcm_cache, AudioPos, length) ? length : 0;
+			}
+
+			if (s_adpcm_cache_length)
+				memcpy(_pDestBuffer, &s_adpcm_cache[AudioPos - s_adpcm_cache_start], _iNumSamples);
+			else
+				memset(_pDestBuffer, 0, _iNumSamples);
+		}
 	}
 
 	// loop check
@@ -2,6 +2,8 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "Common/Common.h"
 #include "Common/FileUtil.h"
 #include "Common/StringUtil.h"
@@ -16,6 +18,12 @@
 #include "Core/HW/GCMemcard.h"
 #include "Core/HW/Sram.h"
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
 #define MC_STATUS_BUSY              0x80
 #define MC_STATUS_UNLOCKED          0x40
 #define MC_STATUS_SLEEP             0x20
@@ -45,6 +53,10 @@ void CEXIMemoryCard::CmdDoneCallback(u64 userdata, int cyclesLate)
 CEXIMemoryCard::CEXIMemoryCard(const int index)
 	: card_index(index)
 	, m_bDirty(false)
+	, m_mapped(false)
+	, m_flush_busy(false)
+	, m_flush_exiting(false)
+	, m_flush_quit(false)
 {
 	m_strFilename = (card_index == 0) ? SConfig::GetInstance().m_strMemoryCardA : SConfig::GetInstance().m_strMemoryCardB;
 	if (Movie::IsPlayingInput() && Movie::IsConfigSaved() && Movie::IsUsingMemcard() && Movie::IsStartingFromClearSave())
@@ -81,12 +93,20 @@ CEXIMemoryCard::CEXIMemoryCard(const int index)
 		// Measure size of the memcard file.
 		memory_card_size = (int)pFile.GetSize();
 		nintendo_card_id = memory_card_size / SIZE_TO_Mb;
-		memory_card_content = new u8[memory_card_size];
-		memset(memory_card_content, 0xFF, memory_card_size);
-
-		INFO_LOG(EXPANSIONINTERFACE, "Reading memory card %s", m_strFilename.c_str());
-		pFile.ReadBytes(memory_card_content, memory_card_size);
+		m_mapped = MapFile();
+		if (m_mapped)
+		{
+			INFO_LOG(EXPANSIONINTERFACE, "Mapped memory card %s", m_strFilename.c_str());
+		}
+		else
+		{
+			memory_card_content = new u8[memory_card_size];
+			memset(memory_card_content, 0xFF, memory_card_size);
 
+			INFO_LOG(EXPANSIONINTERFACE, "Reading memory card %s", m_strFilename.c_str());
+			pFile.ReadBytes(memory_card_content, memory_card_size);
+		}
+		m_dirty_blocks.assign((memory_card_size + MC_BLOCK_SIZE - 1) / MC_BLOCK_SIZE, false);
 	}
 	else
 	{
@@ -98,65 +118,187 @@ CEXIMemoryCard::CEXIMemoryCard(const int index)
 		GCMemcard::Format(memory_card_content, m_strFilename.find(".JAP.raw") != std::string::npos, nintendo_card_id);
 		memset(memory_card_content+MC_HDR_SIZE, 0xFF, memory_card_size-MC_HDR_SIZE);
 		WARN_LOG(EXPANSIONINTERFACE, "No memory card found. Will create a new one.");
+
+		// The first flush writes all of it
+		m_dirty_blocks.assign(memory_card_size / MC_BLOCK_SIZE, true);
 	}
 	SetCardFlashID(memory_card_content, card_index);
+
+	m_flush_thread = std::thread(&CEXIMemoryCard::FlushThread, this);
 }
 
-void innerFlush(FlushData* data)
+bool CEXIMemoryCard::MapFile()
 {
-	File::IOFile pFile(data->filename, "r+b");
-	if (!pFile)
+#ifndef _WIN32
+	// Changes to a mapped card reach the file right away, so only map it if
+	// they are meant to, and not when savestates can replace the contents.
+	if (!SConfig::GetInstance().m_MemcardMMap || !Core::g_CoreStartupParameter.bEnableMemcardSaving ||
+	    Movie::IsRecordingInput() || Movie::IsPlayingInput() || memory_card_size <= 0)
+		return false;
+
+	int fd = open(m_strFilename.c_str(), O_RDWR);
+	if (fd < 0)
+		return false;
+
+	void* base = mmap(nullptr, memory_card_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED)
 	{
-		std::string dir;
-		SplitPath(data->filename, &dir, 0, 0);
-		if (!File::IsDirectory(dir))
-			File::CreateFullPath(dir);
-		pFile.Open(data->filename, "wb");
+		WARN_LOG(EXPANSIONINTERFACE, "Couldn't map memory card %s, reading it instead", m_strFilename.c_str());
+		return false;
 	}
 
-	if (!pFile) // Note - pFile changed inside above if
+	memory_card_content = (u8*)base;
+	return true;
+#else
+	return false;
+#endif
+}
+
+void CEXIMemoryCard::SetDirty(u32 offset, u32 size)
+{
+	offset &= memory_card_size - 1;
+	u32 end = std::min(offset + size, (u32)memory_card_size);
+	for (u32 block = offset / MC_BLOCK_SIZE; block * MC_BLOCK_SIZE < end; block++)
+		m_dirty_blocks[block] = true;
+}
+
+void CEXIMemoryCard::FlushThread()
+{
+	Common::SetCurrentThreadName(card_index ? "Memcard B flush" : "Memcard A flush");
+
+	std::unique_lock<std::mutex> lk(m_flush_mutex);
+	while (true)
 	{
-		PanicAlertT("Could not write memory card file %s.\n\n"
-			"Are you running Dolphin from a CD/DVD, or is the save file maybe write protected?\n\n"
-			"Are you receiving this after moving the emulator directory?\nIf so, then you may "
-			"need to re-specify your memory card location in the options.", data->filename.c_str());
-		return;
-	}
+		m_flush_event.wait(lk, [this] { return m_flush_quit || !m_flush_ranges.empty(); });
+		if (m_flush_ranges.empty())
+			break;
+
+		std::vector<FlushRange> ranges;
+		ranges.swap(m_flush_ranges);
+		bool exiting = m_flush_exiting;
+		m_flush_busy = true;
+		lk.unlock();
+
+		bool written = true;
+		size_t done = 0;
+		if (m_mapped)
+		{
+#ifndef _WIN32
+			for (; written && done < ranges.size(); done++)
+				written = msync(memory_card_content + ranges[done].offset, ranges[done].size, MS_SYNC) == 0;
+#endif
+		}
+		else
+		{
+			File::IOFile pFile(m_strFilename, "r+b");
+			if (!pFile)
+			{
+				std::string dir;
+				SplitPath(m_strFilename, &dir, 0, 0);
+				if (!File::IsDirectory(dir))
+					File::CreateFullPath(dir);
+				pFile.Open(m_strFilename, "wb");
+			}
 
-	pFile.WriteBytes(data->memcardContent, data->memcardSize);
+			if (!pFile) // Note - pFile changed inside above if
+			{
+				PanicAlertT("Could not write memory card file %s.\n\n"
+					"Are you running Dolphin from a CD/DVD, or is the save file maybe write protected?\n\n"
+					"Are you receiving this after moving the emulator directory?\nIf so, then you may "
+					"need to re-specify your memory card location in the options.", m_strFilename.c_str());
+				written = false;
+			}
+
+			// Only the blocks that changed, each run of them with one write
+			for (; written && done < ranges.size(); done++)
+				written = pFile.Seek(ranges[done].offset, SEEK_SET) && pFile.WriteBytes(ranges[done].data.data(), ranges[done].size);
+		}
 
-	if (!data->bExiting)
-		Core::DisplayMessage(StringFromFormat("Wrote memory card %c contents to %s",
-			data->memcardIndex ? 'B' : 'A', data->filename.c_str()).c_str(), 4000);
-	return;
+		if (written && !exiting)
+			Core::DisplayMessage(StringFromFormat("Wrote memory card %c contents to %s",
+				card_index ? 'B' : 'A', m_strFilename.c_str()).c_str(), 4000);
+		else if (!written)
+			ERROR_LOG(EXPANSIONINTERFACE, "Couldn't write memory card %c to %s, will retry with the next flush",
+				card_index ? 'B' : 'A', m_strFilename.c_str());
+
+		lk.lock();
+		if (!written)
+		{
+			// done is one past the range that failed, or 0 if the file
+			// couldn't be opened
+			for (size_t i = done ? done - 1 : 0; i < ranges.size(); i++)
+			{
+				ranges[i].data.clear();
+				m_failed_ranges.push_back(std::move(ranges[i]));
+			}
+		}
+		m_flush_busy = false;
+		m_flush_done_event.notify_all();
+	}
+}
+
+void CEXIMemoryCard::WaitForFlush()
+{
+	std::unique_lock<std::mutex> lk(m_flush_mutex);
+	m_flush_done_event.wait(lk, [this] { return m_flush_ranges.empty() && !m_flush_busy; });
 }
 
 // Flush memory card contents to disc
 void CEXIMemoryCard::Flush(bool exiting)
 {
-	if(!m_bDirty)
+	bool failed;
+	{
+		std::lock_guard<std::mutex> lk(m_flush_mutex);
+		failed = !m_failed_ranges.empty();
+	}
+	if(!m_bDirty && !failed)
 		return;
 
 	if (!Core::g_CoreStartupParameter.bEnableMemcardSaving)
 		return;
 
-	if (flushThread.joinable())
-	{
-		flushThread.join();
-	}
-
 	if(!exiting)
 		Core::DisplayMessage(StringFromFormat("Writing to memory card %c", card_index ? 'B' : 'A'), 1000);
 
-	flushData.filename = m_strFilename;
-	flushData.memcardContent = memory_card_content;
-	flushData.memcardIndex = card_index;
-	flushData.memcardSize = memory_card_size;
-	flushData.bExiting = exiting;
+	// A file that went missing has to be written in full
+	if (!m_mapped && !File::Exists(m_strFilename))
+		SetDirty(0, memory_card_size);
+
+	{
+		// The blocks are copied, so the card can change while they're written
+		std::lock_guard<std::mutex> lk(m_flush_mutex);
+		for (const FlushRange& range : m_failed_ranges)
+			SetDirty(range.offset, range.size);
+		m_failed_ranges.clear();
+
+		size_t block = 0;
+		while (block < m_dirty_blocks.size())
+		{
+			if (!m_dirty_blocks[block])
+			{
+				block++;
+				continue;
+			}
+
+			size_t end = block;
+			while (end < m_dirty_blocks.size() && m_dirty_blocks[end])
+				m_dirty_blocks[end++] = false;
+
+			FlushRange range;
+			range.offset = (u32)(block * MC_BLOCK_SIZE);
+			range.size = (u32)std::min<size_t>(end * MC_BLOCK_SIZE, memory_card_size) - range.offset;
+			if (!m_mapped)
+				range.data.assign(memory_card_content + range.offset, memory_card_content + range.offset + range.size);
+			m_flush_ranges.push_back(std::move(range));
+			block = end;
+		}
+		m_flush_exiting = exiting;
+		m_flush_event.notify_one();
+	}
 
-	flushThread = std::thread(innerFlush, &flushData);
 	if (exiting)
-		flushThread.join();
+		WaitForFlush();
 
 	m_bDirty = false;
 }
@@ -165,13 +307,21 @@ CEXIMemoryCard::~CEXIMemoryCard()
 {
 	CoreTiming::RemoveEvent(et_this_card);
 	Flush(true);
-	delete[] memory_card_content;
-	memory_card_content = NULL;
 
-	if (flushThread.joinable())
 	{
-		flushThread.join();
+		std::lock_guard<std::mutex> lk(m_flush_mutex);
+		m_flush_quit = true;
+		m_flush_event.notify_one();
 	}
+	m_flush_thread.join();
+
+#ifndef _WIN32
+	if (m_mapped)
+		munmap(memory_card_content, memory_card_size);
+	else
+#endif
+		delete[] memory_card_content;
+	memory_card_content = NULL;
 }
 
 bool CEXIMemoryCard::IsPresent()
@@ -196,12 +346,6 @@ void CEXIMemoryCard::CmdDoneLater(u64 cycles)
 
 void CEXIMemoryCard::SetCS(int cs)
 {
-	// So that memory card won't be invalidated during flushing
-	if (flushThread.joinable())
-	{
-		flushThread.join();
-	}
-
 	if (cs)  // not-selected to selected
 	{
 		m_uPosition = 0;
@@ -214,6 +358,7 @@ void CEXIMemoryCard::SetCS(int cs)
 			if (m_uPosition > 2)
 			{
 				memset(memory_card_content + (address & (memory_card_size-1)), 0xFF, 0x2000);
+				SetDirty(address, 0x2000);
 				status |= MC_STATUS_BUSY;
 				status &= ~MC_STATUS_READY;
 
@@ -227,6 +372,7 @@ void CEXIMemoryCard::SetCS(int cs)
 			if (m_uPosition > 2)
 			{
 				memset(memory_card_content, 0xFF, memory_card_size);
+				SetDirty(0, memory_card_size);
 				status &= ~MC_STATUS_BUSY;
 				m_bDirty = true;
 			}
@@ -238,6 +384,7 @@ void CEXIMemoryCard::SetCS(int cs)
 				int count = m_uPosition - 5;
 				int i=0;
 				status &= ~0x80;
+				SetDirty(address & ~0x1FF, 0x200);
 
 				while (count--)
 				{
@@ -443,11 +590,8 @@ void CEXIMemoryCard::PauseAndLock(bool doLock, bool unpauseOnUnlock)
 	if (doLock)
 	{
 		// we don't exactly have anything to pause,
-		// but let's make sure the flush thread isn't running.
-		if (flushThread.joinable())
-		{
-			flushThread.join();
-		}
+		// but let's make sure the flush thread isn't writing.
+		WaitForFlush();
 	}
 }
 
@@ -476,6 +620,9 @@ void CEXIMemoryCard::DoState(PointerWrap &p)
 		p.Do(memory_card_size);
 		p.DoArray(memory_card_content, memory_card_size);
 		p.Do(card_index);
+
+		if (p.GetMode() == PointerWrap::MODE_READ)
+			SetDirty(0, memory_card_size);
 	}
 }
 
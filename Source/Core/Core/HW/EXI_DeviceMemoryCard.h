@@ -4,16 +4,12 @@
 
 #pragma once
 
+#include <vector>
+
 #include "Common/Thread.h"
 
-// Data structure to be passed to the flushing thread.
-struct FlushData
-{
-	bool bExiting;
-	std::string filename;
-	u8 *memcardContent;
-	int memcardSize, memcardIndex;
-};
+// The card is written back to its file in units of erase blocks
+#define MC_BLOCK_SIZE 0x2000
 
 class CEXIMemoryCard : public IEXIDevice
 {
@@ -36,9 +32,19 @@ private:
 	// Scheduled when a command that required delayed end signaling is done.
 	static void CmdDoneCallback(u64 userdata, int cyclesLate);
 
-	// Flushes the memory card contents to disk.
+	// Hands the blocks changed since the last flush to the flush thread.
+	// Waits for them to be written if exiting is set.
 	void Flush(bool exiting = false);
 
+	// Body of the flush thread, which lives as long as the card
+	void FlushThread();
+	// Waits until the flush thread has written everything it was given
+	void WaitForFlush();
+
+	void SetDirty(u32 offset, u32 size);
+	// Maps the card file into memory_card_content, if configured and possible
+	bool MapFile();
+
 	// Signals that the command that was previously executed is now done.
 	void CmdDone();
 
@@ -83,9 +89,32 @@ private:
 	unsigned int address;
 	int memory_card_size; //! in bytes, must be power of 2.
 	u8 *memory_card_content;
+	// memory_card_content is a shared mapping of the card file
+	bool m_mapped;
+
+	// One flag per MC_BLOCK_SIZE block, set when it changes
+	std::vector<bool> m_dirty_blocks;
+
+	// A run of dirty blocks for the flush thread. data holds a copy of
+	// them, or is empty when the card is mapped.
+	struct FlushRange
+	{
+		u32 offset;
+		u32 size;
+		std::vector<u8> data;
+	};
 
-	FlushData flushData;
-	std::thread flushThread;
+	// Guarded by m_flush_mutex
+	std::mutex m_flush_mutex;
+	std::condition_variable m_flush_event;
+	std::condition_variable m_flush_done_event;
+	std::vector<FlushRange> m_flush_ranges;
+	// Ranges the flush thread couldn't write, which the next flush retries
+	std::vector<FlushRange> m_failed_ranges;
+	bool m_flush_busy;
+	bool m_flush_exiting;
+	bool m_flush_quit;
+	std::thread m_flush_thread;
 
 protected:
 	virtual void TransferByte(u8 &byte) override;
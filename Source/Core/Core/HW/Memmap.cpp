@@ -8,6 +8,8 @@
 // However, if a JITed instruction (for example lwz) wants to access a bad memory area that call
 // may be redirected here (for example to Read_U32()).
 
+#include <mutex>
+
 #include "Common/ChunkFile.h"
 #include "Common/Common.h"
 #include "Common/MemArena.h"
@@ -15,6 +17,7 @@
 
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
+#include "Core/MemTools.h"
 #include "Core/Debugger/Debugger_SymbolMap.h"
 #include "Core/HLE/HLE.h"
 #include "Core/HW/AudioInterface.h"
@@ -179,6 +182,7 @@ void DoState(PointerWrap &p)
 
 void Shutdown()
 {
+	EnableWriteTracking(false);
 	m_IsInitialized = false;
 	u32 flags = 0;
 	if (SConfig::GetInstance().m_LocalCoreStartupParameter.bWii) flags |= MV_WII_ONLY;
@@ -380,4 +384,197 @@ bool IsRAMAddress(const u32 addr, bool allow_locked_cache, bool allow_fake_vmem)
 	}
 }
 
+// Write tracking
+
+#if _M_X86_64 && (defined(_WIN32) || ((defined(__linux__) || defined(__FreeBSD__)) && !defined(ANDROID)))
+#define WRITE_TRACKING_SUPPORTED
+#endif
+
+enum
+{
+	RAM_BLOCKS = RAM_SIZE / WRITE_TRACKING_BLOCK_SIZE,
+	NUM_BLOCKS = RAM_BLOCKS + EXRAM_SIZE / WRITE_TRACKING_BLOCK_SIZE,
+
+	// Blocks that were dirty this many times in a row stay unprotected, as
+	// the faults would cost more than comparing them. They are protected
+	// again every HOT_BLOCK_RETRY cleans to see if that changed.
+	HOT_BLOCK_STREAK = 4,
+	HOT_BLOCK_RETRY = 64,
+};
+
+static u8** const s_ram_views[] = { &m_pRAM, &m_pPhysicalRAM, &m_pVirtualCachedRAM, &m_pVirtualUncachedRAM };
+static u8** const s_exram_views[] = { &m_pEXRAM, &m_pPhysicalEXRAM, &m_pVirtualCachedEXRAM, &m_pVirtualUncachedEXRAM };
+
+static volatile bool s_write_tracking = false;
+// Set from the fault handler, on whatever thread wrote
+static volatile u8 s_dirty_blocks[NUM_BLOCKS];
+static u32 s_dirty_streaks[NUM_BLOCKS];
+// Held while blocks are protected, and by HostWriteScopes
+static std::recursive_mutex s_write_tracking_mutex;
+
+static int GetBlock(u32 address)
+{
+	if (address & 0x10000000)
+		return m_pEXRAM ? RAM_BLOCKS + (address & EXRAM_MASK) / WRITE_TRACKING_BLOCK_SIZE : -1;
+	return (address & RAM_MASK) / WRITE_TRACKING_BLOCK_SIZE;
+}
+
+// The block a pointer into any of the views is in, or -1
+static int GetHostBlock(const u8* ptr)
+{
+	for (u8** view : s_ram_views)
+	{
+		if (*view && ptr >= *view && ptr < *view + RAM_SIZE)
+			return (int)((ptr - *view) / WRITE_TRACKING_BLOCK_SIZE);
+	}
+	for (u8** view : s_exram_views)
+	{
+		if (*view && ptr >= *view && ptr < *view + EXRAM_SIZE)
+			return RAM_BLOCKS + (int)((ptr - *view) / WRITE_TRACKING_BLOCK_SIZE);
+	}
+	return -1;
+}
+
+static void SetBlockProtection(int block, bool protect)
+{
+	u8** const* block_views = block < RAM_BLOCKS ? s_ram_views : s_exram_views;
+	u32 offset = (block < RAM_BLOCKS ? block : block - RAM_BLOCKS) * WRITE_TRACKING_BLOCK_SIZE;
+	for (int i = 0; i < 4; i++)
+	{
+		if (!*block_views[i])
+			continue;
+
+		if (protect)
+			WriteProtectMemory(*block_views[i] + offset, WRITE_TRACKING_BLOCK_SIZE);
+		else
+			UnWriteProtectMemory(*block_views[i] + offset, WRITE_TRACKING_BLOCK_SIZE);
+	}
+}
+
+static void MarkHostBlockDirty(int block)
+{
+	// Unprotected before it's marked, so a clean racing with this leaves the
+	// block dirty
+	SetBlockProtection(block, false);
+	s_dirty_blocks[block] = 1;
+}
+
+bool EnableWriteTracking(bool enable)
+{
+#ifdef WRITE_TRACKING_SUPPORTED
+	std::lock_guard<std::recursive_mutex> lk(s_write_tracking_mutex);
+
+	if (enable)
+	{
+		if (!m_IsInitialized)
+			return false;
+
+		// Everything starts out dirty, also when tracking restarts
+		for (int block = 0; block < NUM_BLOCKS; block++)
+		{
+			s_dirty_blocks[block] = 1;
+			s_dirty_streaks[block] = 0;
+		}
+
+		if (!s_write_tracking)
+		{
+			EMM::InstallExceptionHandler();
+			s_write_tracking = true;
+		}
+	}
+	else if (s_write_tracking)
+	{
+		// The handler has to keep working until nothing is protected
+		for (int block = 0; block < NUM_BLOCKS; block++)
+		{
+			if (block < RAM_BLOCKS || m_pEXRAM)
+				SetBlockProtection(block, false);
+		}
+		s_write_tracking = false;
+	}
+
+	return true;
+#else
+	return !enable;
+#endif
+}
+
+bool IsWriteTrackingEnabled()
+{
+	return s_write_tracking;
+}
+
+bool CleanBlock(const u32 _Address)
+{
+	int block = GetBlock(_Address);
+	if (!s_write_tracking || block < 0)
+		return true;
+
+	if (!s_dirty_blocks[block])
+	{
+		s_dirty_streaks[block] = 0;
+		return false;
+	}
+
+	u32 streak = ++s_dirty_streaks[block];
+	if (streak > HOT_BLOCK_STREAK && streak % HOT_BLOCK_RETRY != 0)
+		return true;
+
+	std::lock_guard<std::recursive_mutex> lk(s_write_tracking_mutex);
+	s_dirty_blocks[block] = 0;
+	SetBlockProtection(block, true);
+	return true;
+}
+
+void MarkBlockDirty(const u32 _Address)
+{
+	int block = GetBlock(_Address);
+	if (s_write_tracking && block >= 0)
+		s_dirty_blocks[block] = 1;
+}
+
+bool HandleWriteTrackingFault(const u64 host_address)
+{
+	if (!s_write_tracking)
+		return false;
+
+	int block = GetHostBlock((const u8*)host_address);
+	if (block < 0)
+		return false;
+
+	MarkHostBlockDirty(block);
+	return true;
+}
+
+HostWriteScope::HostWriteScope(const void* ptr, size_t size) :
+	m_locked(false)
+{
+	if (!s_write_tracking)
+		return;
+
+	// Going page by page, as pages never straddle blocks
+	const u8* end = (const u8*)ptr + size;
+	int last_block = -1;
+	for (const u8* page = (const u8*)ptr; page < end; page = (const u8*)(((uintptr_t)page + 0x1000) & ~(uintptr_t)0xfff))
+	{
+		int block = GetHostBlock(page);
+		if (block < 0 || block == last_block)
+			continue;
+
+		if (!m_locked)
+		{
+			s_write_tracking_mutex.lock();
+			m_locked = true;
+		}
+		MarkHostBlockDirty(block);
+		last_block = block;
+	}
+}
+
+HostWriteScope::~HostWriteScope()
+{
+	if (m_locked)
+		s_write_tracking_mutex.unlock();
+}
+
 }  // namespace
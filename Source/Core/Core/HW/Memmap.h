@@ -174,4 +174,35 @@ void GenerateISIException(u32 _EffectiveAdress);
 extern u32 pagetable_base;
 extern u32 pagetable_hashmask;
 
+// Write tracking, for the FIFO recorder. RAM and EXRAM are split into
+// blocks, which are write protected when they are cleaned. The first write
+// to a clean block, from any thread, faults and marks it dirty again.
+// Only supported where the fault handler sees every thread, elsewhere
+// EnableWriteTracking fails and everything counts as dirty.
+enum
+{
+	WRITE_TRACKING_BLOCK_SIZE = 0x10000,
+};
+
+bool EnableWriteTracking(bool enable);
+bool IsWriteTrackingEnabled();
+// Whether the block at the physical address was written since it was last
+// cleaned. Cleans it in any case.
+bool CleanBlock(const u32 _Address);
+void MarkBlockDirty(const u32 _Address);
+// From the fault handler. True if the fault was a write to a clean block.
+bool HandleWriteTrackingFault(const u64 host_address);
+
+// The OS can't write to a write protected block, so file and socket reads
+// straight into emulated memory have to be done inside one of these
+class HostWriteScope : NonCopyable
+{
+public:
+	HostWriteScope(const void* ptr, size_t size);
+	~HostWriteScope();
+
+private:
+	bool m_locked;
+};
+
 };
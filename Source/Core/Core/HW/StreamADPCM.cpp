@@ -13,28 +13,22 @@ static s32 histl2;
 static s32 histr1;
 static s32 histr2;
 
-s16 ADPDecodeSample(s32 bits, s32 q, s32& hist1, s32& hist2)
+// Predictor coefficients for hist1 and hist2, selected by the top nibble of the
+// block's header byte. Filters above 3 don't predict at all.
+static const s32 s_coefs[16][2] =
 {
-	s32 hist = 0;
-	switch (q >> 4)
-	{
-	case 0:
-		hist = 0;
-		break;
-	case 1:
-		hist = (hist1 * 0x3c);
-		break;
-	case 2:
-		hist = (hist1 * 0x73) - (hist2 * 0x34);
-		break;
-	case 3:
-		hist = (hist1 * 0x62) - (hist2 * 0x37);
-		break;
-	}
-	hist = (hist + 0x20) >> 6;
+	{ 0x00,  0x00 },
+	{ 0x3c,  0x00 },
+	{ 0x73, -0x34 },
+	{ 0x62, -0x37 },
+};
+
+static inline s16 ADPDecodeSample(s32 bits, s32 shift, s32 coef1, s32 coef2, s32& hist1, s32& hist2)
+{
+	s32 hist = (hist1 * coef1 + hist2 * coef2 + 0x20) >> 6;
 	MathUtil::Clamp(&hist, -0x200000, 0x1fffff);
 
-	s32 cur = (((s16)(bits << 12) >> (q & 0xf)) << 6) + hist;
+	s32 cur = (((s16)(bits << 12) >> shift) << 6) + hist;
 
 	hist2 = hist1;
 	hist1 = cur;
@@ -55,9 +49,18 @@ void NGCADPCM::InitFilter()
 
 void NGCADPCM::DecodeBlock(s16 *pcm, const u8 *adpcm)
 {
+	// Each sample depends on the two before it, so only the per block setup
+	// can be taken out of the loop.
+	const s32 shiftl = adpcm[0] & 0xf, shiftr = adpcm[1] & 0xf;
+	const s32 *coefl = s_coefs[adpcm[0] >> 4];
+	const s32 *coefr = s_coefs[adpcm[1] >> 4];
+	const u8 *data = adpcm + (ONE_BLOCK_SIZE - SAMPLES_PER_BLOCK);
+
+	s32 l1 = histl1, l2 = histl2, r1 = histr1, r2 = histr2;
 	for (int i = 0; i < SAMPLES_PER_BLOCK; i++)
 	{
-		pcm[i * 2]     = ADPDecodeSample(adpcm[i + (ONE_BLOCK_SIZE - SAMPLES_PER_BLOCK)] & 0xf, adpcm[0], histl1, histl2);
-		pcm[i * 2 + 1] = ADPDecodeSample(adpcm[i + (ONE_BLOCK_SIZE - SAMPLES_PER_BLOCK)] >> 4,  adpcm[1], histr1, histr2);
+		pcm[i * 2]     = ADPDecodeSample(data[i] & 0xf, shiftl, coefl[0], coefl[1], l1, l2);
+		pcm[i * 2 + 1] = ADPDecodeSample(data[i] >> 4,  shiftr, coefr[0], coefr[1], r1, r2);
 	}
+	histl1 = l1; histl2 = l2; histr1 = r1; histr2 = r2;
 }
@@ -42,6 +42,7 @@ Wiimote::Wiimote()
 	, m_channel(0)
 	, m_rumble_state()
 	, m_need_prepare()
+	, m_dropped_data_reports(0)
 {
 	InitInternal();
 }
@@ -195,6 +196,10 @@ void Wiimote::InterruptChannel(const u16 channel, const void* const _data, const
 
 bool Wiimote::Read()
 {
+	// Reports which didn't fit in the queue before
+	while (!m_pending_read_reports.empty() && m_read_reports.Push(std::move(m_pending_read_reports.front())))
+		m_pending_read_reports.pop_front();
+
 	Report rpt(MAX_PAYLOAD);
 	auto const result = IORead(rpt.data());
 
@@ -208,7 +213,7 @@ bool Wiimote::Read()
 
 		// Add it to queue
 		rpt.resize(result);
-		m_read_reports.Push(std::move(rpt));
+		QueueReadReport(std::move(rpt));
 		return true;
 	}
 	else if (0 == result)
@@ -255,6 +260,31 @@ bool IsDataReport(const Report& rpt)
 	return rpt.size() >= 2 && rpt[1] >= WM_REPORT_CORE;
 }
 
+// to be called from Wiimote thread
+void Wiimote::QueueReadReport(Report rpt)
+{
+	// The queue fills up while emulation is paused. A data report only
+	// matters until the next one arrives, but acks and status replies have
+	// to get through, in order.
+	if (m_pending_read_reports.empty() && m_read_reports.Push(std::move(rpt)))
+	{
+		if (m_dropped_data_reports)
+		{
+			WARN_LOG(WIIMOTE, "Wiimote %d dropped %u data reports while its read queue was full.", index + 1, m_dropped_data_reports);
+			m_dropped_data_reports = 0;
+		}
+	}
+	else if (IsDataReport(rpt))
+	{
+		if (!m_dropped_data_reports++)
+			WARN_LOG(WIIMOTE, "Wiimote %d read queue is full, dropping data reports.", index + 1);
+	}
+	else
+	{
+		m_pending_read_reports.push_back(std::move(rpt));
+	}
+}
+
 // Returns the next report that should be sent
 const Report& Wiimote::ProcessReadQueue()
 {
@@ -4,11 +4,13 @@
 
 #pragma once
 
+#include <deque>
 #include <functional>
 #include <vector>
 
 #include "Common/ChunkFile.h"
 #include "Common/FifoQueue.h"
+#include "Common/RingQueue.h"
 #include "Common/Thread.h"
 #include "Common/Timer.h"
 
@@ -101,6 +103,7 @@ protected:
 
 private:
 	void ClearReadQueue();
+	void QueueReadReport(Report rpt);
 	void WriteReport(Report rpt);
 
 	int IORead(u8* buf);
@@ -123,7 +126,12 @@ private:
 	std::mutex                m_thread_ready_mutex;
 	std::condition_variable   m_thread_ready_cond;
 
-	Common::FifoQueue<Report> m_read_reports;
+	Common::RingQueue<Report, 256> m_read_reports;
+	// Wiimote thread only. Reports other than data reports which didn't fit
+	// in m_read_reports, and how many data reports were dropped instead.
+	std::deque<Report> m_pending_read_reports;
+	u32 m_dropped_data_reports;
+	// Unbounded, the CPU thread must never lose an output report
 	Common::FifoQueue<Report> m_write_reports;
 
 	Common::Timer m_last_audio_report;
@@ -0,0 +1,372 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "Common/Common.h"
+#include "Common/CommonPaths.h"
+#include "Common/FileSearch.h"
+#include "Common/FileUtil.h"
+#include "Common/StringUtil.h"
+#include "Common/Thread.h"
+
+#include "Core/ConfigManager.h"
+#include "Core/IPC_HLE/NANDOverlay.h"
+
+namespace NANDOverlay
+{
+
+struct Node
+{
+	Node(bool dir, bool loaded_) : is_dir(dir), loaded(loaded_) {}
+
+	bool is_dir;
+	// Directories only: the host entries were read into children
+	bool loaded;
+	std::map<std::string, std::unique_ptr<Node>> children;
+};
+
+enum OpType
+{
+	OP_CREATE_FILE,
+	OP_CREATE_DIR,
+	OP_DELETE,
+	OP_RENAME,
+};
+
+struct Op
+{
+	OpType type;
+	std::string path;
+	std::string new_path;
+};
+
+static bool s_enabled = false;
+static std::string s_root_path;
+static std::unique_ptr<Node> s_root;
+
+// Changes for the writer thread, guarded by s_mutex
+static std::mutex s_mutex;
+static std::condition_variable s_work_event;
+static std::condition_variable s_done_event;
+static std::deque<Op> s_ops;
+static bool s_writing = false;
+static bool s_quit = false;
+static std::thread s_thread;
+
+static void ApplyOp(const Op& op)
+{
+	switch (op.type)
+	{
+	case OP_CREATE_FILE:
+		File::CreateFullPath(op.path);
+		if (!File::CreateEmptyFile(op.path))
+			ERROR_LOG(WII_IPC_FILEIO, "NAND overlay: Couldn't create %s", op.path.c_str());
+		break;
+
+	case OP_CREATE_DIR:
+		File::CreateFullPath(op.path + DIR_SEP);
+		break;
+
+	case OP_DELETE:
+		if (!File::Delete(op.path) && !File::DeleteDir(op.path))
+			ERROR_LOG(WII_IPC_FILEIO, "NAND overlay: Couldn't delete %s", op.path.c_str());
+		break;
+
+	case OP_RENAME:
+		File::CreateFullPath(op.new_path);
+		if (File::Exists(op.path) && File::Exists(op.new_path))
+			File::Delete(op.new_path);
+		if (!File::Rename(op.path, op.new_path))
+			ERROR_LOG(WII_IPC_FILEIO, "NAND overlay: Couldn't rename %s to %s", op.path.c_str(), op.new_path.c_str());
+		break;
+	}
+}
+
+static void WriterThread()
+{
+	Common::SetCurrentThreadName("NAND overlay writer");
+
+	std::unique_lock<std::mutex> lk(s_mutex);
+	while (true)
+	{
+		s_work_event.wait(lk, [] { return s_quit || !s_ops.empty(); });
+		if (s_ops.empty())
+			break;
+
+		Op op = std::move(s_ops.front());
+		s_ops.pop_front();
+		s_writing = true;
+		lk.unlock();
+
+		ApplyOp(op);
+
+		lk.lock();
+		s_writing = false;
+		if (s_ops.empty())
+			s_done_event.notify_all();
+	}
+}
+
+static void QueueOp(OpType type, const std::string& path, const std::string& new_path = "")
+{
+	Op op = { type, path, new_path };
+	std::lock_guard<std::mutex> lk(s_mutex);
+	s_ops.push_back(std::move(op));
+	s_work_event.notify_one();
+}
+
+// The names below the NAND root, empty components dropped
+static std::vector<std::string> GetComponents(const std::string& path)
+{
+	std::vector<std::string> components;
+	std::string relative = path.compare(0, s_root_path.size(), s_root_path) ? path : path.substr(s_root_path.size());
+	SplitString(relative, DIR_SEP_CHR, components);
+	components.erase(std::remove(components.begin(), components.end(), ""), components.end());
+	return components;
+}
+
+static std::string GetHostPath(const std::vector<std::string>& components, size_t count)
+{
+	std::string path = s_root_path;
+	for (size_t i = 0; i < count; i++)
+		path += DIR_SEP + components[i];
+	return path;
+}
+
+static void LoadDir(Node* node, const std::string& host_path)
+{
+	if (node->loaded)
+		return;
+
+	// The host has to catch up before it can be read
+	Flush();
+
+	CFileSearch::XStringVector directories(1, host_path);
+	CFileSearch::XStringVector extensions(1, "*.*");
+	CFileSearch search(extensions, directories);
+	for (const std::string& entry : search.GetFileNames())
+	{
+		std::string name, ext;
+		SplitPath(entry, nullptr, &name, &ext);
+		node->children[name + ext].reset(new Node(File::IsDirectory(entry), false));
+	}
+	node->loaded = true;
+}
+
+// The node at the first count components, or nullptr
+static Node* Lookup(const std::vector<std::string>& components, size_t count)
+{
+	Node* node = s_root.get();
+	for (size_t i = 0; i < count; i++)
+	{
+		if (!node->is_dir)
+			return nullptr;
+		LoadDir(node, GetHostPath(components, i));
+
+		auto it = node->children.find(components[i]);
+		if (it == node->children.end())
+			return nullptr;
+		node = it->second.get();
+	}
+	return node;
+}
+
+// Like Lookup, but creates missing directories. nullptr if a file is in
+// the way.
+static Node* MakeDirs(const std::vector<std::string>& components, size_t count)
+{
+	Node* node = s_root.get();
+	for (size_t i = 0; i < count; i++)
+	{
+		if (!node->is_dir)
+			return nullptr;
+		LoadDir(node, GetHostPath(components, i));
+
+		std::unique_ptr<Node>& child = node->children[components[i]];
+		if (!child)
+			child.reset(new Node(true, true));
+		node = child.get();
+	}
+	if (!node->is_dir)
+		return nullptr;
+	LoadDir(node, GetHostPath(components, count));
+	return node;
+}
+
+void Init()
+{
+	s_enabled = SConfig::GetInstance().m_NANDOverlay;
+	if (!s_enabled)
+		return;
+
+	s_root_path = File::GetUserPath(D_WIIROOT_IDX);
+	s_root.reset(new Node(true, false));
+	s_quit = false;
+	s_thread = std::thread(WriterThread);
+}
+
+void Shutdown()
+{
+	if (!s_enabled)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lk(s_mutex);
+		s_quit = true;
+		s_work_event.notify_one();
+	}
+	s_thread.join();
+	s_root.reset();
+	s_enabled = false;
+}
+
+bool IsEnabled()
+{
+	return s_enabled;
+}
+
+EntryType GetType(const std::string& path)
+{
+	std::vector<std::string> components = GetComponents(path);
+	Node* node = Lookup(components, components.size());
+	if (!node)
+		return ENTRY_NONE;
+	return node->is_dir ? ENTRY_DIR : ENTRY_FILE;
+}
+
+bool ReadDir(const std::string& path, std::vector<std::string>& names)
+{
+	std::vector<std::string> components = GetComponents(path);
+	Node* node = Lookup(components, components.size());
+	if (!node || !node->is_dir)
+		return false;
+
+	LoadDir(node, GetHostPath(components, components.size()));
+	names.clear();
+	for (const auto& child : node->children)
+		names.push_back(child.first);
+	return true;
+}
+
+bool MakeFile(const std::string& path)
+{
+	std::vector<std::string> components = GetComponents(path);
+	if (components.empty() || Lookup(components, components.size()))
+		return false;
+
+	Node* parent = MakeDirs(components, components.size() - 1);
+	if (!parent)
+		return false;
+
+	parent->children[components.back()].reset(new Node(false, true));
+	QueueOp(OP_CREATE_FILE, GetHostPath(components, components.size()));
+	return true;
+}
+
+bool MakeDir(const std::string& path)
+{
+	std::vector<std::string> components = GetComponents(path);
+	if (!MakeDirs(components, components.size()))
+		return false;
+
+	QueueOp(OP_CREATE_DIR, GetHostPath(components, components.size()));
+	return true;
+}
+
+bool Delete(const std::string& path)
+{
+	std::vector<std::string> components = GetComponents(path);
+	if (components.empty())
+		return false;
+
+	// Like File::Delete, a file that isn't there counts as deleted
+	Node* parent = Lookup(components, components.size() - 1);
+	Node* node = Lookup(components, components.size());
+	if (!node)
+		return true;
+
+	const std::string host_path = GetHostPath(components, components.size());
+	if (node->is_dir)
+	{
+		LoadDir(node, host_path);
+		if (!node->children.empty())
+			return false;
+	}
+
+	parent->children.erase(components.back());
+	QueueOp(OP_DELETE, host_path);
+	return true;
+}
+
+bool Rename(const std::string& from, const std::string& to)
+{
+	std::vector<std::string> src = GetComponents(from);
+	std::vector<std::string> dst = GetComponents(to);
+	if (src.empty() || dst.empty())
+		return false;
+	if (src == dst)
+		return Lookup(src, src.size()) != nullptr;
+
+	// The host version creates the parent directories of to first, even if
+	// the rename then fails
+	Node* dst_parent = MakeDirs(dst, dst.size() - 1);
+	if (!dst_parent)
+		return false;
+
+	Node* src_parent = Lookup(src, src.size() - 1);
+	Node* node = Lookup(src, src.size());
+	bool possible = node != nullptr;
+
+	// A directory can't move into itself
+	if (dst.size() > src.size() && std::equal(src.begin(), src.end(), dst.begin()))
+		possible = false;
+
+	auto existing = dst_parent->children.find(dst.back());
+	if (possible && existing != dst_parent->children.end() && existing->second->is_dir)
+	{
+		// Only an empty directory can be replaced, and only by a directory
+		LoadDir(existing->second.get(), GetHostPath(dst, dst.size()));
+		possible = node->is_dir && existing->second->children.empty();
+	}
+
+	if (!possible)
+	{
+		QueueOp(OP_CREATE_DIR, GetHostPath(dst, dst.size() - 1));
+		return false;
+	}
+
+	std::unique_ptr<Node> moved = std::move(src_parent->children[src.back()]);
+	src_parent->children.erase(src.back());
+	dst_parent->children[dst.back()] = std::move(moved);
+
+	QueueOp(OP_RENAME, GetHostPath(src, src.size()), GetHostPath(dst, dst.size()));
+	return true;
+}
+
+void Flush()
+{
+	if (!s_enabled)
+		return;
+
+	std::unique_lock<std::mutex> lk(s_mutex);
+	s_done_event.wait(lk, [] { return s_ops.empty() && !s_writing; });
+}
+
+void Reset()
+{
+	if (!s_enabled)
+		return;
+
+	Flush();
+	s_root.reset(new Node(true, false));
+}
+
+}
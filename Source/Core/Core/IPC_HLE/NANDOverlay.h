@@ -0,0 +1,52 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+// An in-memory copy of the NAND directory tree, so /dev/fs can answer
+// metadata requests without touching the host. Directories are read from
+// the host the first time something looks into them. Changes go to the tree
+// right away and to the host from a writer thread, in the order they were
+// made.
+//
+// Everything but Init and Shutdown is called from the CPU thread, with host
+// paths as built by HLE_IPC_BuildFilename. Code that changes the NAND on
+// the host behind /dev/fs' back calls Reset first.
+namespace NANDOverlay
+{
+
+enum EntryType
+{
+	ENTRY_NONE = 0,
+	ENTRY_FILE,
+	ENTRY_DIR,
+};
+
+// Only enabled with [Core] NANDOverlay
+void Init();
+void Shutdown();
+bool IsEnabled();
+
+EntryType GetType(const std::string& path);
+// Host names of the entries of a directory. False if path isn't one.
+bool ReadDir(const std::string& path, std::vector<std::string>& names);
+
+// All of these create missing parent directories like the host functions
+// they replace. MakeFile fails if path exists.
+bool MakeFile(const std::string& path);
+bool MakeDir(const std::string& path);
+// Deletes a file or an empty directory. Succeeds if path doesn't exist.
+bool Delete(const std::string& path);
+// Replaces a file at to
+bool Rename(const std::string& from, const std::string& to);
+
+// Waits until the host has all the changes made so far
+void Flush();
+// Flushes and forgets the tree, which is then read again as needed
+void Reset();
+
+}
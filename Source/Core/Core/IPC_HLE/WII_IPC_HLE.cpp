@@ -37,6 +37,7 @@ They will also generate a true or false return for UpdateInterrupts() in WII_IPC
 #include "Core/HW/SystemTimers.h"
 #include "Core/HW/WII_IPC.h"
 
+#include "Core/IPC_HLE/NANDOverlay.h"
 #include "Core/IPC_HLE/WII_IPC_HLE.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_DI.h"
@@ -92,6 +93,7 @@ void Init()
 {
 	_dbg_assert_msg_(WII_IPC_HLE, g_DeviceMap.empty(), "DeviceMap isn't empty on init");
 	CWII_IPC_HLE_Device_es::m_ContentFile = "";
+	NANDOverlay::Init();
 	u32 i;
 	for (i=0; i<IPC_MAX_FDS; i++)
 	{
@@ -184,6 +186,8 @@ void Reset(bool _bHard)
 void Shutdown()
 {
 	Reset(true);
+	// Writes out what is still queued
+	NANDOverlay::Shutdown();
 }
 
 void SetDefaultContentFile(const std::string& _rFilename)
@@ -259,6 +263,9 @@ void DoState(PointerWrap &p)
 {
 	std::lock_guard<std::mutex> lk(s_reply_queue);
 
+	// Save data the FileIO devices still buffer goes to disk first
+	CWII_IPC_HLE_Device_FileIO::CloseAllFiles();
+
 	p.Do(request_queue);
 	p.Do(reply_queue);
 	p.Do(last_reply_time);
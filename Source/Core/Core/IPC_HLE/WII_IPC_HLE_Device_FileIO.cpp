@@ -3,6 +3,8 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
+#include <list>
 
 #include "Common/ChunkFile.h"
 #include "Common/Common.h"
@@ -10,12 +12,20 @@
 #include "Common/NandPaths.h"
 #include "Common/StringUtil.h"
 
+#include "Core/IPC_HLE/NANDOverlay.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_FileIO.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_fs.h"
 
 
 static Common::replace_v replacements;
 
+// Host file handles kept open at once, and the size of their buffers
+#define FILEIO_MAX_OPEN_FILES 16
+#define FILEIO_BUFFER_SIZE    0x4000
+
+// Devices with an open host file, most recently used first
+static std::list<CWII_IPC_HLE_Device_FileIO*> s_open_files;
+
 // This is used by several of the FileIO and /dev/fs functions
 std::string HLE_IPC_BuildFilename(std::string path_wii, int _size)
 {
@@ -70,17 +80,25 @@ CWII_IPC_HLE_Device_FileIO::CWII_IPC_HLE_Device_FileIO(u32 _DeviceID, const std:
 	: IWII_IPC_HLE_Device(_DeviceID, _rDeviceName, false) // not a real hardware
 	, m_Mode(0)
 	, m_SeekPos(0)
+	, m_FileSize(0)
+	, m_SizeStale(false)
+	, m_BufferPos(0)
+	, m_BufferValid(0)
+	, m_DirtyStart(0)
+	, m_DirtyEnd(0)
 {
 	Common::ReadReplacements(replacements);
 }
 
 CWII_IPC_HLE_Device_FileIO::~CWII_IPC_HLE_Device_FileIO()
 {
+	CloseHostFile();
 }
 
 bool CWII_IPC_HLE_Device_FileIO::Close(u32 _CommandAddress, bool _bForce)
 {
 	INFO_LOG(WII_IPC_FILEIO, "FileIO: Close %s (DeviceID=%08x)", m_Name.c_str(), m_DeviceID);
+	CloseHostFile();
 	m_Mode = 0;
 
 	// Close always return 0 for success
@@ -107,7 +125,8 @@ bool CWII_IPC_HLE_Device_FileIO::Open(u32 _CommandAddress, u32 _Mode)
 
 	// The file must exist before we can open it
 	// It should be created by ISFS_CreateFile, not here
-	if (File::Exists(m_filepath))
+	bool exists = NANDOverlay::IsEnabled() ? NANDOverlay::GetType(m_filepath) != NANDOverlay::ENTRY_NONE : File::Exists(m_filepath);
+	if (exists)
 	{
 		INFO_LOG(WII_IPC_FILEIO, "FileIO: Open %s (%s == %08X)", m_Name.c_str(), Modes[_Mode], _Mode);
 		ReturnValue = m_DeviceID;
@@ -124,8 +143,15 @@ bool CWII_IPC_HLE_Device_FileIO::Open(u32 _CommandAddress, u32 _Mode)
 	return true;
 }
 
-File::IOFile CWII_IPC_HLE_Device_FileIO::OpenFile()
+bool CWII_IPC_HLE_Device_FileIO::OpenHostFile()
 {
+	auto it = std::find(s_open_files.begin(), s_open_files.end(), this);
+	if (it != s_open_files.end())
+	{
+		s_open_files.splice(s_open_files.begin(), s_open_files, it);
+		return true;
+	}
+
 	const char* open_mode = "";
 
 	switch (m_Mode)
@@ -141,10 +167,200 @@ File::IOFile CWII_IPC_HLE_Device_FileIO::OpenFile()
 
 	default:
 		PanicAlertT("FileIO: Unknown open mode : 0x%02x", m_Mode);
-		break;
+		return false;
+	}
+
+	// The file may have been created or moved through the overlay just now
+	NANDOverlay::Flush();
+	if (!m_file.Open(m_filepath, open_mode))
+		return false;
+
+	// Buffered here, the stdio buffer would only add a copy
+	setvbuf(m_file.GetHandle(), nullptr, _IONBF, 0);
+
+	// Read once other devices on the file wrote back their data
+	m_SizeStale = true;
+	m_BufferValid = 0;
+	m_DirtyStart = m_DirtyEnd = 0;
+	if (m_Buffer.empty())
+		m_Buffer.resize(FILEIO_BUFFER_SIZE);
+
+	if (s_open_files.size() >= FILEIO_MAX_OPEN_FILES)
+		s_open_files.back()->CloseHostFile();
+	s_open_files.push_front(this);
+	return true;
+}
+
+void CWII_IPC_HLE_Device_FileIO::CloseHostFile()
+{
+	auto it = std::find(s_open_files.begin(), s_open_files.end(), this);
+	if (it == s_open_files.end())
+		return;
+
+	FlushBuffer();
+	m_file.Close();
+	m_BufferValid = 0;
+	s_open_files.erase(it);
+}
+
+void CWII_IPC_HLE_Device_FileIO::CloseAllFiles()
+{
+	while (!s_open_files.empty())
+		s_open_files.front()->CloseHostFile();
+}
+
+bool CWII_IPC_HLE_Device_FileIO::PrepareAccess(bool writing)
+{
+	if (!OpenHostFile())
+		return false;
+
+	// Games may have the same file open twice. Whatever the others have
+	// buffered must reach the file first, and a write outdates their buffers.
+	for (CWII_IPC_HLE_Device_FileIO* other : s_open_files)
+	{
+		if (other == this || other->m_filepath != m_filepath)
+			continue;
+
+		other->FlushBuffer();
+		if (writing)
+		{
+			other->m_BufferValid = 0;
+			other->m_SizeStale = true;
+		}
+	}
+
+	if (m_SizeStale)
+	{
+		m_FileSize = (u32)m_file.GetSize();
+		m_SizeStale = false;
+	}
+	return true;
+}
+
+bool CWII_IPC_HLE_Device_FileIO::FillBuffer(u32 pos)
+{
+	FlushBuffer();
+
+	m_BufferPos = pos & ~(FILEIO_BUFFER_SIZE - 1);
+	m_BufferValid = 0;
+	const u32 size = std::min<u32>(FILEIO_BUFFER_SIZE, m_FileSize - m_BufferPos);
+	m_file.Seek(m_BufferPos, SEEK_SET);
+	const u32 read = (u32)fread(&m_Buffer[0], 1, size, m_file.GetHandle());
+	if (read != size && ferror(m_file.GetHandle()))
+	{
+		m_file.Clear();
+		return false;
 	}
 
-	return File::IOFile(m_filepath, open_mode);
+	m_BufferValid = read;
+	return true;
+}
+
+void CWII_IPC_HLE_Device_FileIO::FlushBuffer()
+{
+	if (m_DirtyEnd == m_DirtyStart)
+		return;
+
+	m_file.Seek(m_BufferPos + m_DirtyStart, SEEK_SET);
+	if (!m_file.WriteBytes(&m_Buffer[m_DirtyStart], m_DirtyEnd - m_DirtyStart))
+	{
+		ERROR_LOG(WII_IPC_FILEIO, "FileIO: Failed to write back 0x%x bytes to %s", m_DirtyEnd - m_DirtyStart, m_Name.c_str());
+		m_file.Clear();
+	}
+	m_DirtyStart = m_DirtyEnd = 0;
+}
+
+s32 CWII_IPC_HLE_Device_FileIO::ReadBuffered(u8* dest, u32 size)
+{
+	u32 pos = m_SeekPos;
+	if (pos >= m_FileSize)
+		return 0;
+	size = std::min(size, m_FileSize - pos);
+
+	u32 done = 0;
+	while (done < size)
+	{
+		if (pos < m_BufferPos || pos >= m_BufferPos + m_BufferValid)
+		{
+			// Big reads go straight to memory
+			if (size - done >= FILEIO_BUFFER_SIZE)
+			{
+				FlushBuffer();
+				m_file.Seek(pos, SEEK_SET);
+				Memory::HostWriteScope write_scope(dest + done, size - done);
+				const u32 read = (u32)fread(dest + done, 1, size - done, m_file.GetHandle());
+				if (read != size - done && ferror(m_file.GetHandle()))
+				{
+					m_file.Clear();
+					return -1;
+				}
+				return done + read;
+			}
+
+			if (!FillBuffer(pos))
+				return -1;
+			if (pos >= m_BufferPos + m_BufferValid)
+				break;
+		}
+
+		const u32 offset = pos - m_BufferPos;
+		const u32 count = std::min(size - done, m_BufferValid - offset);
+		memcpy(dest + done, &m_Buffer[offset], count);
+		done += count;
+		pos += count;
+	}
+
+	return done;
+}
+
+bool CWII_IPC_HLE_Device_FileIO::WriteBuffered(const u8* src, u32 size)
+{
+	u32 pos = m_SeekPos;
+	u32 done = 0;
+	while (done < size)
+	{
+		// Big writes, and writes past the end that leave a gap, go straight
+		// to the file
+		if (size - done >= FILEIO_BUFFER_SIZE || pos > m_FileSize)
+		{
+			FlushBuffer();
+			m_BufferValid = 0;
+			m_file.Seek(pos, SEEK_SET);
+			if (!m_file.WriteBytes(src + done, size - done))
+			{
+				m_file.Clear();
+				return false;
+			}
+			m_FileSize = std::max(m_FileSize, pos + size - done);
+			return true;
+		}
+
+		if (pos < m_BufferPos || pos > m_BufferPos + m_BufferValid || pos == m_BufferPos + FILEIO_BUFFER_SIZE)
+		{
+			if (!FillBuffer(pos))
+				return false;
+		}
+
+		const u32 offset = pos - m_BufferPos;
+		const u32 count = std::min(size - done, FILEIO_BUFFER_SIZE - offset);
+		memcpy(&m_Buffer[offset], src + done, count);
+		if (m_DirtyEnd == m_DirtyStart)
+		{
+			m_DirtyStart = offset;
+			m_DirtyEnd = offset + count;
+		}
+		else
+		{
+			m_DirtyStart = std::min(m_DirtyStart, offset);
+			m_DirtyEnd = std::max(m_DirtyEnd, offset + count);
+		}
+		m_BufferValid = std::max(m_BufferValid, offset + count);
+		done += count;
+		pos += count;
+		m_FileSize = std::max(m_FileSize, pos);
+	}
+
+	return true;
 }
 
 bool CWII_IPC_HLE_Device_FileIO::Seek(u32 _CommandAddress)
@@ -153,11 +369,11 @@ bool CWII_IPC_HLE_Device_FileIO::Seek(u32 _CommandAddress)
 	const s32 SeekPosition = Memory::Read_U32(_CommandAddress + 0xC);
 	const s32 Mode = Memory::Read_U32(_CommandAddress + 0x10);
 
-	if (auto file = OpenFile())
+	if (PrepareAccess(false))
 	{
 		ReturnValue = FS_RESULT_FATAL;
 
-		const s32 fileSize = (s32) file.GetSize();
+		const s32 fileSize = (s32)m_FileSize;
 		INFO_LOG(WII_IPC_FILEIO, "FileIO: Seek Pos: 0x%08x, Mode: %i (%s, Length=0x%08x)", SeekPosition, Mode, m_Name.c_str(), fileSize);
 
 		switch (Mode)
@@ -218,7 +434,7 @@ bool CWII_IPC_HLE_Device_FileIO::Read(u32 _CommandAddress)
 	const u32 Size    = Memory::Read_U32(_CommandAddress + 0x10);
 
 
-	if (auto file = OpenFile())
+	if (PrepareAccess(false))
 	{
 		if (m_Mode == ISFS_OPEN_WRITE)
 		{
@@ -227,14 +443,14 @@ bool CWII_IPC_HLE_Device_FileIO::Read(u32 _CommandAddress)
 		else
 		{
 			INFO_LOG(WII_IPC_FILEIO, "FileIO: Read 0x%x bytes to 0x%08x from %s", Size, Address, m_Name.c_str());
-			file.Seek(m_SeekPos, SEEK_SET);
-			ReturnValue = (u32)fread(Memory::GetPointer(Address), 1, Size, file.GetHandle());
-			if (ReturnValue != Size && ferror(file.GetHandle()))
+			s32 read = ReadBuffered(Memory::GetPointer(Address), Size);
+			if (read < 0)
 			{
 				ReturnValue = FS_EACCESS;
 			}
 			else
 			{
+				ReturnValue = read;
 				m_SeekPos += Size;
 			}
 
@@ -256,7 +472,7 @@ bool CWII_IPC_HLE_Device_FileIO::Write(u32 _CommandAddress)
 	const u32 Address = Memory::Read_U32(_CommandAddress + 0xC); // Write data from this memory address
 	const u32 Size    = Memory::Read_U32(_CommandAddress + 0x10);
 
-	if (auto file = OpenFile())
+	if (PrepareAccess(true))
 	{
 		if (m_Mode == ISFS_OPEN_READ)
 		{
@@ -265,8 +481,7 @@ bool CWII_IPC_HLE_Device_FileIO::Write(u32 _CommandAddress)
 		else
 		{
 			INFO_LOG(WII_IPC_FILEIO, "FileIO: Write 0x%04x bytes from 0x%08x to %s", Size, Address, m_Name.c_str());
-			file.Seek(m_SeekPos, SEEK_SET);
-			if (file.WriteBytes(Memory::GetPointer(Address), Size))
+			if (WriteBuffered(Memory::GetPointer(Address), Size))
 			{
 				ReturnValue = Size;
 				m_SeekPos += Size;
@@ -296,9 +511,9 @@ bool CWII_IPC_HLE_Device_FileIO::IOCtl(u32 _CommandAddress)
 	{
 	case ISFS_IOCTL_GETFILESTATS:
 		{
-			if (auto file = OpenFile())
+			if (PrepareAccess(false))
 			{
-				u32 m_FileLength = (u32)file.GetSize();
+				u32 m_FileLength = m_FileSize;
 
 				const u32 BufferOut = Memory::Read_U32(_CommandAddress + 0x18);
 				INFO_LOG(WII_IPC_FILEIO, "  File: %s, Length: %i, Pos: %i", m_Name.c_str(), m_FileLength, m_SeekPos);
@@ -328,6 +543,9 @@ bool CWII_IPC_HLE_Device_FileIO::IOCtl(u32 _CommandAddress)
 
 void CWII_IPC_HLE_Device_FileIO::DoState(PointerWrap &p)
 {
+	// The file is reopened on the next access, with the loaded mode
+	CloseHostFile();
+
 	DoStateShared(p);
 
 	p.Do(m_Mode);
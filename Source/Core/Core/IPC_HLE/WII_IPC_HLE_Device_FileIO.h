@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "Common/FileUtil.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device.h"
 
@@ -25,7 +27,9 @@ public:
 	bool IOCtl(u32 _CommandAddress);
 	void DoState(PointerWrap &p);
 
-	File::IOFile OpenFile();
+	// Writes back and closes the host files of all FileIO devices, so /dev/fs
+	// can work on the files by path.
+	static void CloseAllFiles();
 
 private:
 	enum
@@ -68,8 +72,33 @@ private:
 		ISFS_IOCTL_SHUTDOWN       = 13
 	};
 
+	// Opens the host file if it isn't yet, closing the least recently used
+	// one if too many are open
+	bool OpenHostFile();
+	void CloseHostFile();
+	// Opens the host file and brings other devices on the same file in sync
+	bool PrepareAccess(bool writing);
+
+	bool FillBuffer(u32 pos);
+	void FlushBuffer();
+	// At m_SeekPos. Reads return the number of bytes read or -1.
+	s32 ReadBuffered(u8* dest, u32 size);
+	bool WriteBuffered(const u8* src, u32 size);
+
 	u32 m_Mode;
 	u32 m_SeekPos;
 
 	std::string m_filepath;
+
+	// Kept open from the first access until Close or eviction
+	File::IOFile m_file;
+	u32 m_FileSize;
+	bool m_SizeStale;
+
+	// One aligned window of the file, read ahead and written back in one go
+	std::vector<u8> m_Buffer;
+	u32 m_BufferPos;
+	u32 m_BufferValid;
+	u32 m_DirtyStart;
+	u32 m_DirtyEnd;
 };
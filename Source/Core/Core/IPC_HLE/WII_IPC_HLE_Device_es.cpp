@@ -49,6 +49,7 @@
 #include "Core/Movie.h"
 #include "Core/VolumeHandler.h"
 #include "Core/Boot/Boot_DOL.h"
+#include "Core/IPC_HLE/NANDOverlay.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_es.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_usb.h"
 #include "Core/PowerPC/PowerPC.h"
@@ -406,10 +407,14 @@ bool CWII_IPC_HLE_Device_es::IOCtlV(u32 _CommandAddress)
 			{
 				if (pDest)
 				{
+					// Contents are read from files straight into RAM
+					Memory::HostWriteScope write_scope(pDest, Size);
 					if (rContent.m_pContent->m_pData)
 					{
-						u8* pSrc = &rContent.m_pContent->m_pData[rContent.m_Position];
-						memcpy(pDest, pSrc, Size);
+						if (!rContent.m_pContent->m_pData->Read(rContent.m_Position, Size, pDest))
+						{
+							ERROR_LOG(WII_IPC_ES, "ES: couldn't read content; returning uninitialized data!");
+						}
 					}
 					else
 					{
@@ -761,6 +766,7 @@ bool CWII_IPC_HLE_Device_es::IOCtlV(u32 _CommandAddress)
 		{
 			u64 TitleID = Memory::Read_U64(Buffer.InBuffer[0].m_Address);
 			INFO_LOG(WII_IPC_ES, "IOCTL_ES_DELETETICKET: title: %08x/%08x", (u32)(TitleID >> 32), (u32)TitleID);
+			NANDOverlay::Reset();
 			if (File::Delete(Common::GetTicketFileName(TitleID)))
 			{
 				Memory::Write_U32(0, _CommandAddress + 0x4);
@@ -918,7 +924,8 @@ bool CWII_IPC_HLE_Device_es::IOCtlV(u32 _CommandAddress)
 						std::unique_ptr<CDolLoader> pDolLoader;
 						if (pContent->m_pData)
 						{
-							pDolLoader.reset(new CDolLoader(pContent->m_pData, pContent->m_Size));
+							std::vector<u8> data = pContent->m_pData->Get();
+							pDolLoader.reset(new CDolLoader(data.data(), (u32)data.size()));
 						}
 						else
 						{
@@ -1103,6 +1110,8 @@ u32 CWII_IPC_HLE_Device_es::ES_DIVerify(u8* _pTMD, u32 _sz)
 	}
 	std::string tmdPath  = Common::GetTMDFileName(tmdTitleID);
 
+	// The title and save directories change on the host below
+	NANDOverlay::Reset();
 	File::CreateFullPath(tmdPath);
 	File::CreateFullPath(Common::GetTitleDataPath(tmdTitleID));
 
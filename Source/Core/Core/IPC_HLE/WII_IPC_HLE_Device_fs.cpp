@@ -14,11 +14,48 @@
 #include "Core/HW/SystemTimers.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_FileIO.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device_fs.h"
+#include "Core/IPC_HLE/NANDOverlay.h"
 
 #define MAX_NAME  12
 
 static Common::replace_v replacements;
 
+// The metadata requests go to the NAND overlay when it is enabled, and to
+// the host otherwise
+static NANDOverlay::EntryType GetEntryType(const std::string& path)
+{
+	if (NANDOverlay::IsEnabled())
+		return NANDOverlay::GetType(path);
+	if (File::IsDirectory(path))
+		return NANDOverlay::ENTRY_DIR;
+	return File::Exists(path) ? NANDOverlay::ENTRY_FILE : NANDOverlay::ENTRY_NONE;
+}
+
+// Host names of the entries of a directory
+static std::vector<std::string> ListDirectory(const std::string& path)
+{
+	std::vector<std::string> names;
+	if (NANDOverlay::IsEnabled())
+	{
+		NANDOverlay::ReadDir(path, names);
+		return names;
+	}
+
+	CFileSearch::XStringVector Directories;
+	Directories.push_back(path);
+
+	CFileSearch::XStringVector Extensions;
+	Extensions.push_back("*.*");
+
+	CFileSearch FileSearch(Extensions, Directories);
+	for (const std::string& entry : FileSearch.GetFileNames())
+	{
+		std::string name, ext;
+		SplitPath(entry, NULL, &name, &ext);
+		names.push_back(name + ext);
+	}
+	return names;
+}
 
 CWII_IPC_HLE_Device_fs::CWII_IPC_HLE_Device_fs(u32 _DeviceID, const std::string& _rDeviceName)
 	: IWII_IPC_HLE_Device(_DeviceID, _rDeviceName)
@@ -33,6 +70,7 @@ bool CWII_IPC_HLE_Device_fs::Open(u32 _CommandAddress, u32 _Mode)
 {
 	// clear tmp folder
 	{
+		NANDOverlay::Reset();
 		std::string Path = File::GetUserPath(D_WIIUSER_IDX) + "tmp";
 		File::DeleteDirRecursively(Path);
 		File::CreateDir(Path.c_str());
@@ -90,13 +128,14 @@ bool CWII_IPC_HLE_Device_fs::IOCtlV(u32 _CommandAddress)
 
 			INFO_LOG(WII_IPC_FILEIO, "FS: IOCTL_READ_DIR %s", DirName.c_str());
 
-			if (!File::Exists(DirName))
+			NANDOverlay::EntryType Type = GetEntryType(DirName);
+			if (Type == NANDOverlay::ENTRY_NONE)
 			{
 				WARN_LOG(WII_IPC_FILEIO, "FS: Search not found: %s", DirName.c_str());
 				ReturnValue = FS_FILE_NOT_EXIST;
 				break;
 			}
-			else if (!File::IsDirectory(DirName))
+			else if (Type != NANDOverlay::ENTRY_DIR)
 			{
 				// It's not a directory, so error.
 				// Games don't usually seem to care WHICH error they get, as long as it's <
@@ -106,19 +145,12 @@ bool CWII_IPC_HLE_Device_fs::IOCtlV(u32 _CommandAddress)
 				break;
 			}
 
-			// make a file search
-			CFileSearch::XStringVector Directories;
-			Directories.push_back(DirName);
-
-			CFileSearch::XStringVector Extensions;
-			Extensions.push_back("*.*");
-
-			CFileSearch FileSearch(Extensions, Directories);
+			std::vector<std::string> FileNames = ListDirectory(DirName);
 
 			// it is one
 			if ((CommandBuffer.InBuffer.size() == 1) && (CommandBuffer.PayloadBuffer.size() == 1))
 			{
-				size_t numFile = FileSearch.GetFileNames().size();
+				size_t numFile = FileNames.size();
 				INFO_LOG(WII_IPC_FILEIO, "\t%lu files found", (unsigned long)numFile);
 
 				Memory::Write_U32((u32)numFile, CommandBuffer.PayloadBuffer[0].m_Address);
@@ -132,14 +164,12 @@ bool CWII_IPC_HLE_Device_fs::IOCtlV(u32 _CommandAddress)
 				size_t numFiles = 0;
 				char* pFilename = (char*)Memory::GetPointer((u32)(CommandBuffer.PayloadBuffer[0].m_Address));
 
-				for (size_t i=0; i<FileSearch.GetFileNames().size(); i++)
+				for (size_t i=0; i<FileNames.size(); i++)
 				{
 					if (i >= MaxEntries)
 						break;
 
-					std::string name, ext;
-					SplitPath(FileSearch.GetFileNames()[i], NULL, &name, &ext);
-					std::string FileName = name + ext;
+					std::string FileName = FileNames[i];
 
 					// Decode entities of invalid file system characters so that
 					// games (such as HP:HBP) will be able to find what they expect.
@@ -179,6 +209,9 @@ bool CWII_IPC_HLE_Device_fs::IOCtlV(u32 _CommandAddress)
 			u32 iNodes = 0;
 
 			INFO_LOG(WII_IPC_FILEIO, "IOCTL_GETUSAGE %s", path.c_str());
+			// The sizes come from the host, which needs everything written
+			NANDOverlay::Flush();
+			CWII_IPC_HLE_Device_FileIO::CloseAllFiles();
 			if (File::IsDirectory(path))
 			{
 				// LPFaint99: After I found that setting the number of inodes to the number of children + 1 for the directory itself
@@ -292,6 +325,13 @@ s32 CWII_IPC_HLE_Device_fs::ExecuteCommand(u32 _Parameter, u32 _BufferIn, u32 _B
 
 			INFO_LOG(WII_IPC_FILEIO, "FS: CREATE_DIR %s, OwnerID %#x, GroupID %#x, Attributes %#x", DirName.c_str(), OwnerID, GroupID, Attribs);
 
+			if (NANDOverlay::IsEnabled())
+			{
+				if (!NANDOverlay::MakeDir(DirName))
+					ERROR_LOG(WII_IPC_FILEIO, "FS: CREATE_DIR %s failed", DirName.c_str());
+				return FS_RESULT_OK;
+			}
+
 			DirName += DIR_SEP;
 			File::CreateFullPath(DirName);
 			_dbg_assert_msg_(WII_IPC_FILEIO, File::IsDirectory(DirName), "FS: CREATE_DIR %s failed", DirName.c_str());
@@ -337,13 +377,14 @@ s32 CWII_IPC_HLE_Device_fs::ExecuteCommand(u32 _Parameter, u32 _BufferIn, u32 _B
 			u8 GroupPerm = 0x3;   // read/write
 			u8 OtherPerm = 0x3;   // read/write
 			u8 Attributes = 0x00; // no attributes
-			if (File::IsDirectory(Filename))
+			NANDOverlay::EntryType Type = GetEntryType(Filename);
+			if (Type == NANDOverlay::ENTRY_DIR)
 			{
 				INFO_LOG(WII_IPC_FILEIO, "FS: GET_ATTR Directory %s - all permission flags are set", Filename.c_str());
 			}
 			else
 			{
-				if (File::Exists(Filename))
+				if (Type == NANDOverlay::ENTRY_FILE)
 				{
 					INFO_LOG(WII_IPC_FILEIO, "FS: GET_ATTR %s - all permission flags are set", Filename.c_str());
 				}
@@ -379,7 +420,18 @@ s32 CWII_IPC_HLE_Device_fs::ExecuteCommand(u32 _Parameter, u32 _BufferIn, u32 _B
 
 			std::string Filename = HLE_IPC_BuildFilename((const char*)Memory::GetPointer(_BufferIn+Offset), 64);
 			Offset += 64;
-			if (File::Delete(Filename))
+
+			// The FileIO devices let go of the file before it goes away
+			CWII_IPC_HLE_Device_FileIO::CloseAllFiles();
+
+			if (NANDOverlay::IsEnabled())
+			{
+				if (NANDOverlay::Delete(Filename))
+					INFO_LOG(WII_IPC_FILEIO, "FS: Delete %s", Filename.c_str());
+				else
+					WARN_LOG(WII_IPC_FILEIO, "FS: DeleteFile %s - failed!!!", Filename.c_str());
+			}
+			else if (File::Delete(Filename))
 			{
 				INFO_LOG(WII_IPC_FILEIO, "FS: DeleteFile %s", Filename.c_str());
 			}
@@ -407,6 +459,20 @@ s32 CWII_IPC_HLE_Device_fs::ExecuteCommand(u32 _Parameter, u32 _BufferIn, u32 _B
 			std::string FilenameRename = HLE_IPC_BuildFilename((const char*)Memory::GetPointer(_BufferIn+Offset), 64);
 			Offset += 64;
 
+			// The FileIO devices let go of both files before they move
+			CWII_IPC_HLE_Device_FileIO::CloseAllFiles();
+
+			if (NANDOverlay::IsEnabled())
+			{
+				if (!NANDOverlay::Rename(Filename, FilenameRename))
+				{
+					ERROR_LOG(WII_IPC_FILEIO, "FS: Rename %s to %s - failed", Filename.c_str(), FilenameRename.c_str());
+					return FS_FILE_NOT_EXIST;
+				}
+				INFO_LOG(WII_IPC_FILEIO, "FS: Rename %s to %s", Filename.c_str(), FilenameRename.c_str());
+				return FS_RESULT_OK;
+			}
+
 			// try to make the basis directory
 			File::CreateFullPath(FilenameRename);
 
@@ -453,15 +519,23 @@ s32 CWII_IPC_HLE_Device_fs::ExecuteCommand(u32 _Parameter, u32 _BufferIn, u32 _B
 			DEBUG_LOG(WII_IPC_FILEIO, "    Attributes: 0x%02x", Attributes);
 
 			// check if the file already exist
-			if (File::Exists(Filename))
+			if (GetEntryType(Filename) != NANDOverlay::ENTRY_NONE)
 			{
 				WARN_LOG(WII_IPC_FILEIO, "\tresult = FS_RESULT_EXISTS");
 				return FS_FILE_EXIST;
 			}
 
 			// create the file
-			File::CreateFullPath(Filename);  // just to be sure
-			bool Result = File::CreateEmptyFile(Filename);
+			bool Result;
+			if (NANDOverlay::IsEnabled())
+			{
+				Result = NANDOverlay::MakeFile(Filename);
+			}
+			else
+			{
+				File::CreateFullPath(Filename);  // just to be sure
+				Result = File::CreateEmptyFile(Filename);
+			}
 			if (!Result)
 			{
 				ERROR_LOG(WII_IPC_FILEIO, "CWII_IPC_HLE_Device_fs: couldn't create new file");
@@ -501,6 +575,9 @@ void CWII_IPC_HLE_Device_fs::DoState(PointerWrap& p)
 
 	// handle /tmp
 
+	// /tmp is saved from and loaded to the host, behind the overlay's back
+	NANDOverlay::Reset();
+
 	std::string Path = File::GetUserPath(D_WIIUSER_IDX) + "tmp";
 	if (p.GetMode() == PointerWrap::MODE_READ)
 	{
@@ -54,6 +54,14 @@ void CWII_IPC_HLE_Device_hid::handleUsbUpdates(struct libusb_transfer *transfer)
 	if (transfer->status == LIBUSB_TRANSFER_COMPLETED)
 	{
 		ret = transfer->length;
+
+		// Interrupt input arrives in a host buffer, see IOCtl
+		if (transfer->type == LIBUSB_TRANSFER_TYPE_INTERRUPT && (transfer->endpoint & LIBUSB_ENDPOINT_IN))
+		{
+			u32 BufferIn = Memory::Read_U32(replyAddress + 0x10);
+			u32 data = Memory::Read_U32(BufferIn + 0x1C);
+			memcpy(Memory::GetPointer(data), transfer->buffer, transfer->actual_length);
+		}
 	}
 
 	Memory::Write_U32(8, replyAddress);
@@ -231,7 +239,16 @@ bool CWII_IPC_HLE_Device_hid::IOCtl(u32 _CommandAddress)
 
 		struct libusb_transfer *transfer = libusb_alloc_transfer(0);
 		transfer->flags |= LIBUSB_TRANSFER_FREE_TRANSFER;
-		libusb_fill_interrupt_transfer(transfer, dev_handle, endpoint, Memory::GetPointer(data), length,
+
+		// The kernel can't write to RAM blocks write tracking protects, so
+		// input goes through a buffer handleUsbUpdates copies to RAM
+		u8 * buffer = Memory::GetPointer(data);
+		if (endpoint & LIBUSB_ENDPOINT_IN)
+		{
+			buffer = (u8*)malloc(length);
+			transfer->flags |= LIBUSB_TRANSFER_FREE_BUFFER;
+		}
+		libusb_fill_interrupt_transfer(transfer, dev_handle, endpoint, buffer, length,
 									   handleUsbUpdates, (void*)(size_t)_CommandAddress, 0);
 		libusb_submit_transfer(transfer);
 
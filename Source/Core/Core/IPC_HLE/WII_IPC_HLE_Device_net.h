@@ -7,6 +7,7 @@
 #include "Common/FileUtil.h"
 #include "Common/Timer.h"
 
+#include "Core/IPC_HLE/NANDOverlay.h"
 #include "Core/IPC_HLE/WII_IPC_HLE_Device.h"
 
 #ifdef _WIN32
@@ -179,6 +180,7 @@ public:
 	{
 		int i;
 
+		NANDOverlay::Reset();
 		if (File::Exists(path))
 			File::Delete(path);
 
@@ -210,6 +212,7 @@ public:
 
 	void WriteConfig()
 	{
+		NANDOverlay::Reset();
 		if (!File::Exists(path))
 		{
 			if (!File::CreateFullPath(File::GetUserPath(D_WIIWC24_IDX)))
@@ -329,6 +332,7 @@ public:
 
 	void ResetConfig()
 	{
+		NANDOverlay::Reset();
 		if (File::Exists(path))
 			File::Delete(path);
 
@@ -346,6 +350,7 @@ public:
 
 	void WriteConfig()
 	{
+		NANDOverlay::Reset();
 		if (!File::Exists(path))
 		{
 			if (!File::CreateFullPath(
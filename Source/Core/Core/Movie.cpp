@@ -12,6 +12,7 @@
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/Movie.h"
+#include "Core/MovieInputBuffer.h"
 #include "Core/NetPlayProto.h"
 #include "Core/State.h"
 #include "Core/HW/DVDInterface.h"
@@ -27,9 +28,6 @@
 
 #include "VideoCommon/VideoConfig.h"
 
-// The chunk to allocate movie data in multiples of.
-#define DTM_BASE_LENGTH (1024)
-
 std::mutex cs_frameSkip;
 
 namespace Movie {
@@ -45,8 +43,7 @@ u32 g_framesToSkip = 0, g_frameSkipCounter = 0;
 u8 g_numPads = 0;
 ControllerState g_padState;
 DTMHeader tmpHeader;
-u8* tmpInput = NULL;
-size_t tmpInputAllocated = 0;
+static InputBuffer s_input;
 u64 g_currentByte = 0, g_totalBytes = 0;
 u64 g_currentFrame = 0, g_totalFrames = 0; // VI
 u64 g_currentLagCount = 0, g_totalLagCount = 0; // just stats
@@ -74,25 +71,54 @@ std::string g_InputDisplay[8];
 
 ManipFunction mfunc = NULL;
 
-void EnsureTmpInputSize(size_t bound)
+static void GetHeader(DTMHeader& header);
+
+// While recording, the input log is streamed to this file so a crash doesn't
+// take it along. For recordings from a save state, the state is dtm.sav.
+static std::string GetStreamFilename()
+{
+	return File::GetUserPath(D_STATESAVES_IDX) + "recording.dtm";
+}
+
+static void StartStreaming()
 {
-	if (tmpInputAllocated >= bound)
+	if (s_input.IsStreaming())
 		return;
-	// The buffer expands in powers of two of DTM_BASE_LENGTH
-	// (standard exponential buffer growth).
-	size_t newAlloc = DTM_BASE_LENGTH;
-	while (newAlloc < bound)
-		newAlloc *= 2;
-
-	u8* newTmpInput = new u8[newAlloc];
-	tmpInputAllocated = newAlloc;
-	if (tmpInput != NULL)
-	{
-		if (g_totalBytes > 0)
-			memcpy(newTmpInput, tmpInput, (size_t)g_totalBytes);
-		delete[] tmpInput;
-	}
-	tmpInput = newTmpInput;
+
+	DTMHeader header;
+	GetHeader(header);
+	if (!s_input.StartStreaming(GetStreamFilename(), &header, sizeof(header)))
+		ERROR_LOG(COMMON, "Movie: Couldn't create %s", GetStreamFilename().c_str());
+}
+
+static void UpdateStreamHeader()
+{
+	if (!s_input.IsStreaming())
+		return;
+
+	DTMHeader header;
+	GetHeader(header);
+	s_input.SetStreamHeader(&header, sizeof(header));
+}
+
+static void StopStreaming()
+{
+	UpdateStreamHeader();
+	s_input.StopStreaming();
+}
+
+// Adds data at g_currentByte, dropping whatever came after it
+static void AppendInput(const u8* data, size_t size)
+{
+	s_input.Truncate(g_currentByte);
+
+	u64 chunks = s_input.GetSize() / InputBuffer::CHUNK_SIZE;
+	s_input.Append(data, size);
+	g_currentByte = g_totalBytes = s_input.GetSize();
+
+	// Keep the frame count in the streamed file close to the data
+	if (s_input.GetSize() / InputBuffer::CHUNK_SIZE != chunks)
+		UpdateStreamHeader();
 }
 
 std::string GetInputDisplay()
@@ -453,9 +479,10 @@ bool BeginRecordingInput(int controllers)
 	}
 	g_playMode = MODE_RECORDING;
 	author = SConfig::GetInstance().m_strMovieAuthor;
-	EnsureTmpInputSize(1);
+	s_input.Clear();
 
 	g_currentByte = g_totalBytes = 0;
+	StartStreaming();
 
 	Core::DisplayMessage("Starting movie recording", 2000);
 	return true;
@@ -646,10 +673,7 @@ void RecordInput(SPADStatus *PadStatus, int controllerID)
 		g_bDiscChange = false;
 	}
 
-	EnsureTmpInputSize((size_t)(g_currentByte + 8));
-	memcpy(&(tmpInput[g_currentByte]), &g_padState, 8);
-	g_currentByte += 8;
-	g_totalBytes = g_currentByte;
+	AppendInput((u8*)&g_padState, 8);
 }
 
 void CheckWiimoteStatus(int wiimote, u8 *data, const WiimoteEmu::ReportFeatures& rptf, int irMode)
@@ -670,11 +694,8 @@ void RecordWiimote(int wiimote, u8 *data, u8 size)
 		return;
 
 	InputUpdate();
-	EnsureTmpInputSize((size_t)(g_currentByte + size + 1));
-	tmpInput[g_currentByte++] = size;
-	memcpy(&(tmpInput[g_currentByte]), data, size);
-	g_currentByte += size;
-	g_totalBytes = g_currentByte;
+	AppendInput(&size, 1);
+	AppendInput(data, size);
 }
 
 void ReadHeader()
@@ -741,9 +762,8 @@ bool PlayInput(const char *filename)
 
 	g_playMode = MODE_PLAYING;
 
-	g_totalBytes = g_recordfd.GetSize() - 256;
-	EnsureTmpInputSize((size_t)g_totalBytes);
-	g_recordfd.ReadArray(tmpInput, (size_t)g_totalBytes);
+	s_input.LoadFromFile(g_recordfd, g_recordfd.GetSize() - 256);
+	g_totalBytes = s_input.GetSize();
 	g_currentByte = 0;
 	g_recordfd.Close();
 
@@ -819,15 +839,17 @@ void LoadInput(const char *filename)
 		afterEnd = true;
 	}
 
-	if (!g_bReadOnly || tmpInput == NULL)
+	if (!g_bReadOnly || s_input.IsEmpty())
 	{
 		g_totalFrames = tmpHeader.frameCount;
 		g_totalLagCount = tmpHeader.lagCount;
 		g_totalInputCount = tmpHeader.inputCount;
 
-		EnsureTmpInputSize((size_t)totalSavedBytes);
-		g_totalBytes = totalSavedBytes;
-		t_record.ReadArray(tmpInput, (size_t)g_totalBytes);
+		// Only the part after where the movies diverge changes, which is
+		// usually the branch that is being thrown away
+		s_input.LoadFromFile(t_record, totalSavedBytes);
+		g_totalBytes = s_input.GetSize();
+		UpdateStreamHeader();
 	}
 	else if (g_currentByte > 0)
 	{
@@ -842,11 +864,12 @@ void LoadInput(const char *filename)
 		{
 			// verify identical from movie start to the save's current frame
 			u32 len = (u32)g_currentByte;
-			u8* movInput = new u8[len];
-			t_record.ReadArray(movInput, (size_t)len);
+			std::vector<u8> movInput(len), curInput(len);
+			t_record.ReadArray(movInput.data(), (size_t)len);
+			s_input.Read(0, curInput.data(), len);
 			for (u32 i = 0; i < len; ++i)
 			{
-				if (movInput[i] != tmpInput[i])
+				if (movInput[i] != curInput[i])
 				{
 					// this is a "you did something wrong" alert for the user's benefit.
 					// we'll try to say what's going on in excruciating detail, otherwise the user might not believe us.
@@ -854,13 +877,13 @@ void LoadInput(const char *filename)
 					{
 						// TODO: more detail
 						PanicAlertT("Warning: You loaded a save whose movie mismatches on byte %d (0x%X). You should load another save before continuing, or load this state with read-only mode off. Otherwise you'll probably get a desync.", i+256, i+256);
-						memcpy(tmpInput, movInput, g_currentByte);
+						s_input.Write(0, movInput.data(), len);
 					}
 					else
 					{
 						int frame = i/8;
 						ControllerState curPadState;
-						memcpy(&curPadState, &(tmpInput[frame*8]), 8);
+						memcpy(&curPadState, &(curInput[frame*8]), 8);
 						ControllerState movPadState;
 						memcpy(&movPadState, &(movInput[frame*8]), 8);
 						PanicAlertT("Warning: You loaded a save whose movie mismatches on frame %d. You should load another save before continuing, or load this state with read-only mode off. Otherwise you'll probably get a desync.\n\n"
@@ -877,12 +900,11 @@ void LoadInput(const char *filename)
 							(int)frame,
 							(int)movPadState.Start, (int)movPadState.A, (int)movPadState.B, (int)movPadState.X, (int)movPadState.Y, (int)movPadState.Z, (int)movPadState.DPadUp, (int)movPadState.DPadDown, (int)movPadState.DPadLeft, (int)movPadState.DPadRight, (int)movPadState.L, (int)movPadState.R, (int)movPadState.TriggerL, (int)movPadState.TriggerR, (int)movPadState.AnalogStickX, (int)movPadState.AnalogStickY, (int)movPadState.CStickX, (int)movPadState.CStickY);
 
-						memcpy(tmpInput, movInput, g_currentByte);
+						s_input.Write(0, movInput.data(), len);
 					}
 					break;
 				}
 			}
-			delete [] movInput;
 		}
 	}
 	t_record.Close();
@@ -906,6 +928,7 @@ void LoadInput(const char *filename)
 				g_playMode = MODE_RECORDING;
 				Core::DisplayMessage("Switched to recording", 2000);
 			}
+			StartStreaming();
 		}
 	}
 	else
@@ -926,7 +949,7 @@ void PlayController(SPADStatus *PadStatus, int controllerID)
 {
 	// Correct playback is entirely dependent on the emulator polling the controllers
 	// in the same order done during recording
-	if (!IsPlayingInput() || !IsUsingPad(controllerID) || tmpInput == NULL)
+	if (!IsPlayingInput() || !IsUsingPad(controllerID) || s_input.IsEmpty())
 		return;
 
 	if (g_currentByte + 8 > g_totalBytes)
@@ -942,7 +965,7 @@ void PlayController(SPADStatus *PadStatus, int controllerID)
 	PadStatus->err = e;
 
 
-	memcpy(&g_padState, &(tmpInput[g_currentByte]), 8);
+	s_input.Read(g_currentByte, (u8*)&g_padState, 8);
 	g_currentByte += 8;
 
 	PadStatus->triggerLeft = g_padState.TriggerL;
@@ -1022,7 +1045,7 @@ void PlayController(SPADStatus *PadStatus, int controllerID)
 
 bool PlayWiimote(int wiimote, u8 *data, const WiimoteEmu::ReportFeatures& rptf, int irMode)
 {
-	if(!IsPlayingInput() || !IsUsingWiimote(wiimote) || tmpInput == NULL)
+	if(!IsPlayingInput() || !IsUsingWiimote(wiimote) || s_input.IsEmpty())
 		return false;
 
 	if (g_currentByte > g_totalBytes)
@@ -1037,7 +1060,8 @@ bool PlayWiimote(int wiimote, u8 *data, const WiimoteEmu::ReportFeatures& rptf,
 	u8* const irData = rptf.ir?(data+rptf.ir):NULL;
 	u8 size = rptf.size;
 
-	u8 sizeInMovie = tmpInput[g_currentByte];
+	u8 sizeInMovie = 0;
+	s_input.Read(g_currentByte, &sizeInMovie, 1);
 
 	if (size != sizeInMovie)
 	{
@@ -1056,7 +1080,7 @@ bool PlayWiimote(int wiimote, u8 *data, const WiimoteEmu::ReportFeatures& rptf,
 		return false;
 	}
 
-	memcpy(data, &(tmpInput[g_currentByte]), size);
+	s_input.Read(g_currentByte, data, size);
 	g_currentByte += size;
 
 	SetWiiInputDisplayString(wiimote, coreData, accelData, irData);
@@ -1073,9 +1097,11 @@ void EndPlayInput(bool cont)
 	{
 		g_playMode = MODE_RECORDING;
 		Core::DisplayMessage("Reached movie end. Resuming recording.", 2000);
+		StartStreaming();
 	}
 	else if(g_playMode != MODE_NONE)
 	{
+		StopStreaming();
 		g_rerecords = 0;
 		g_currentByte = 0;
 		g_playMode = MODE_NONE;
@@ -1083,16 +1109,12 @@ void EndPlayInput(bool cont)
 		g_bRecordingFromSaveState = false;
 		// we don't clear these things because otherwise we can't resume playback if we load a movie state later
 		//g_totalFrames = g_totalBytes = 0;
-		//delete tmpInput;
-		//tmpInput = NULL;
+		//s_input.Clear();
 	}
 }
 
-void SaveRecording(const char *filename)
+static void GetHeader(DTMHeader& header)
 {
-	File::IOFile save_record(filename, "wb");
-	// Create the real header now and write it
-	DTMHeader header;
 	memset(&header, 0, sizeof(DTMHeader));
 
 	header.filetype[0] = 'D'; header.filetype[1] = 'T'; header.filetype[2] = 'M'; header.filetype[3] = 0x1A;
@@ -1135,10 +1157,17 @@ void SaveRecording(const char *filename)
 	// TODO
 	header.uniqueID = 0;
 	// header.audioEmulator;
+}
 
+void SaveRecording(const char *filename)
+{
+	File::IOFile save_record(filename, "wb");
+	// Create the real header now and write it
+	DTMHeader header;
+	GetHeader(header);
 	save_record.WriteArray(&header, 1);
 
-	bool success = save_record.WriteArray(tmpInput, (size_t)g_totalBytes);
+	bool success = s_input.SaveToFile(save_record);
 
 	if (success && g_bRecordingFromSaveState)
 	{
@@ -1233,9 +1262,8 @@ void GetMD5()
 
 void Shutdown()
 {
+	StopStreaming();
 	g_currentInputCount = g_totalInputCount = g_totalFrames = g_totalBytes = 0;
-	delete [] tmpInput;
-	tmpInput = NULL;
-	tmpInputAllocated = 0;
+	s_input.Clear();
 }
 };
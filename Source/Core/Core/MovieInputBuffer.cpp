@@ -0,0 +1,266 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+
+#include "Common/Thread.h"
+
+#include "Core/MovieInputBuffer.h"
+
+namespace Movie
+{
+
+InputBuffer::InputBuffer()
+	: m_size(0), m_quit(false), m_header_dirty(false)
+	, m_complete(0), m_streamed(0), m_file_size(0), m_generation(0)
+{
+}
+
+InputBuffer::~InputBuffer()
+{
+	StopStreaming();
+}
+
+void InputBuffer::Append(const u8* data, size_t size)
+{
+	while (size)
+	{
+		size_t index = (size_t)(m_size / CHUNK_SIZE);
+		size_t start = (size_t)(m_size % CHUNK_SIZE);
+		if (index == m_chunks.size())
+		{
+			std::lock_guard<std::mutex> lk(m_mutex);
+			m_chunks.push_back(std::make_shared<Chunk>());
+		}
+
+		size_t count = std::min(size, CHUNK_SIZE - start);
+		memcpy(m_chunks[index]->data + start, data, count);
+		m_size += count;
+		data += count;
+		size -= count;
+
+		if (start + count == CHUNK_SIZE)
+		{
+			std::lock_guard<std::mutex> lk(m_mutex);
+			m_complete = m_size;
+			m_work_event.notify_one();
+		}
+	}
+}
+
+bool InputBuffer::Read(u64 offset, u8* data, size_t size) const
+{
+	if (offset + size > m_size)
+		return false;
+
+	while (size)
+	{
+		size_t start = (size_t)(offset % CHUNK_SIZE);
+		size_t count = std::min(size, CHUNK_SIZE - start);
+		memcpy(data, m_chunks[(size_t)(offset / CHUNK_SIZE)]->data + start, count);
+		offset += count;
+		data += count;
+		size -= count;
+	}
+	return true;
+}
+
+void InputBuffer::Write(u64 offset, const u8* data, size_t size)
+{
+	_assert_(offset <= m_size);
+
+	size_t overwrite = (size_t)std::min<u64>(size, m_size - offset);
+	if (overwrite)
+	{
+		// The writer mustn't pick up the chunks before they are changed
+		std::lock_guard<std::mutex> lk(m_mutex);
+		Unshare(offset, offset + overwrite);
+
+		for (size_t done = 0; done < overwrite; )
+		{
+			size_t start = (size_t)(offset % CHUNK_SIZE);
+			size_t count = std::min(overwrite - done, CHUNK_SIZE - start);
+			memcpy(m_chunks[(size_t)(offset / CHUNK_SIZE)]->data + start, data + done, count);
+			offset += count;
+			done += count;
+		}
+	}
+	Append(data + overwrite, size - overwrite);
+}
+
+void InputBuffer::Truncate(u64 size)
+{
+	if (size >= m_size)
+		return;
+
+	std::lock_guard<std::mutex> lk(m_mutex);
+	m_size = size;
+	m_chunks.resize((size_t)((size + CHUNK_SIZE - 1) / CHUNK_SIZE));
+	m_complete = std::min(m_complete, size - size % CHUNK_SIZE);
+	Unshare(size, size + 1);
+}
+
+// Called with m_mutex held before [begin, end) changes
+void InputBuffer::Unshare(u64 begin, u64 end)
+{
+	m_generation++;
+	m_streamed = std::min(m_streamed, begin - begin % CHUNK_SIZE);
+
+	size_t last = std::min((size_t)((end - 1) / CHUNK_SIZE) + 1, m_chunks.size());
+	for (size_t i = (size_t)(begin / CHUNK_SIZE); i < last; i++)
+	{
+		if (!m_chunks[i].unique())
+			m_chunks[i] = std::make_shared<Chunk>(*m_chunks[i]);
+	}
+
+	m_work_event.notify_one();
+}
+
+bool InputBuffer::LoadFromFile(File::IOFile& file, u64 size)
+{
+	std::vector<u8> block(CHUNK_SIZE);
+	bool same = true;
+	for (u64 offset = 0; offset < size; )
+	{
+		size_t count = (size_t)std::min<u64>(CHUNK_SIZE, size - offset);
+		if (!file.ReadBytes(block.data(), count))
+		{
+			Truncate(offset);
+			return false;
+		}
+
+		if (same && (offset + count > m_size || memcmp(m_chunks[(size_t)(offset / CHUNK_SIZE)]->data, block.data(), count)))
+		{
+			Truncate(offset);
+			same = false;
+		}
+		if (!same)
+			Append(block.data(), count);
+		offset += count;
+	}
+
+	Truncate(size);
+	return true;
+}
+
+bool InputBuffer::SaveToFile(File::IOFile& file) const
+{
+	for (size_t i = 0; i < m_chunks.size(); i++)
+	{
+		size_t count = (size_t)std::min<u64>(CHUNK_SIZE, m_size - (u64)i * CHUNK_SIZE);
+		if (!file.WriteBytes(m_chunks[i]->data, count))
+			return false;
+	}
+	return true;
+}
+
+bool InputBuffer::StartStreaming(const std::string& filename, const void* header, size_t header_size)
+{
+	StopStreaming();
+
+	if (!m_file.Open(filename, "wb"))
+		return false;
+
+	m_quit = false;
+	m_header.assign((const u8*)header, (const u8*)header + header_size);
+	m_header_dirty = true;
+	m_complete = m_size - m_size % CHUNK_SIZE;
+	m_streamed = 0;
+	m_file_size = 0;
+	m_generation++;
+	m_thread = std::thread(&InputBuffer::WriterThread, this);
+	return true;
+}
+
+void InputBuffer::SetStreamHeader(const void* header, size_t header_size)
+{
+	std::lock_guard<std::mutex> lk(m_mutex);
+	_assert_(header_size == m_header.size());
+	memcpy(m_header.data(), header, header_size);
+	m_header_dirty = true;
+	m_work_event.notify_one();
+}
+
+void InputBuffer::StopStreaming()
+{
+	if (!m_thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_complete = m_size;
+		m_quit = true;
+		m_work_event.notify_one();
+	}
+	m_thread.join();
+	m_file.Close();
+}
+
+void InputBuffer::WriterThread()
+{
+	Common::SetCurrentThreadName("Movie writer");
+
+	const u64 data_start = m_header.size();
+	bool reported = false;
+
+	std::unique_lock<std::mutex> lk(m_mutex);
+	while (true)
+	{
+		m_work_event.wait(lk, [this] {
+			return m_quit || m_header_dirty || m_streamed < m_complete || m_streamed < m_file_size;
+		});
+
+		if (m_streamed < m_file_size)
+		{
+			// Stale data past the end of the buffer has to go before anything
+			// else, or it might outlive a crash
+			m_file.Resize(data_start + m_streamed);
+			m_file_size = m_streamed;
+		}
+		else if (m_header_dirty)
+		{
+			std::vector<u8> header(m_header);
+			m_header_dirty = false;
+			lk.unlock();
+
+			m_file.Seek(0, SEEK_SET);
+			m_file.WriteBytes(header.data(), header.size());
+			m_file.Flush();
+
+			lk.lock();
+		}
+		else if (m_streamed < m_complete)
+		{
+			u64 offset = m_streamed;
+			std::shared_ptr<Chunk> chunk = m_chunks[(size_t)(offset / CHUNK_SIZE)];
+			size_t start = (size_t)(offset % CHUNK_SIZE);
+			size_t count = (size_t)std::min<u64>(CHUNK_SIZE - start, m_complete - offset);
+			u32 generation = m_generation;
+			lk.unlock();
+
+			m_file.Seek(data_start + offset, SEEK_SET);
+			m_file.WriteBytes(chunk->data + start, count);
+			m_file.Flush();
+			chunk.reset();
+
+			lk.lock();
+			m_file_size = std::max(m_file_size, offset + count);
+			if (generation == m_generation)
+				m_streamed = offset + count;
+		}
+		else
+		{
+			break;
+		}
+
+		if (!m_file.IsGood() && !reported)
+		{
+			ERROR_LOG(COMMON, "Movie: Couldn't write the input log, it won't survive a crash");
+			reported = true;
+		}
+	}
+}
+
+}
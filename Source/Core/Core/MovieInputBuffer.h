@@ -0,0 +1,91 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/Common.h"
+#include "Common/FileUtil.h"
+
+namespace Movie
+{
+
+// The input log of a movie. Data lives in fixed size chunks, so appending
+// never moves what is already there.
+//
+// While streaming, every chunk that fills up is written to a file by a
+// background thread, after a header the owner keeps up to date. Changes to
+// data that was already written make the thread write it again, and the file
+// shrinks with the buffer, so it always holds a prefix of the buffer.
+//
+// Only the writer thread runs concurrently with the owner, and it only reads
+// completed chunks. A chunk it is still writing is copied before it changes.
+class InputBuffer : NonCopyable
+{
+public:
+	enum { CHUNK_SIZE = 0x4000 };
+
+	InputBuffer();
+	~InputBuffer();
+
+	u64 GetSize() const { return m_size; }
+	bool IsEmpty() const { return m_size == 0; }
+
+	void Append(const u8* data, size_t size);
+	// False if the range goes past the end
+	bool Read(u64 offset, u8* data, size_t size) const;
+	// Overwrites data, appending what goes past the end
+	void Write(u64 offset, const u8* data, size_t size);
+	void Truncate(u64 size);
+	void Clear() { Truncate(0); }
+
+	// Makes the buffer hold the next size bytes of file. The part that is
+	// already the same stays, so only what differs is streamed again.
+	bool LoadFromFile(File::IOFile& file, u64 size);
+	bool SaveToFile(File::IOFile& file) const;
+
+	// Replaces filename with the header and everything appended so far.
+	bool StartStreaming(const std::string& filename, const void* header, size_t header_size);
+	bool IsStreaming() const { return m_thread.joinable(); }
+	// The header size can't change while streaming
+	void SetStreamHeader(const void* header, size_t header_size);
+	// Writes the incomplete last chunk too and closes the file
+	void StopStreaming();
+
+private:
+	struct Chunk
+	{
+		u8 data[CHUNK_SIZE];
+	};
+
+	void Unshare(u64 begin, u64 end);
+	void WriterThread();
+
+	std::vector<std::shared_ptr<Chunk>> m_chunks;
+	u64 m_size;
+
+	// Guards everything below, and changes to m_chunks while streaming
+	std::mutex m_mutex;
+	std::condition_variable m_work_event;
+	std::thread m_thread;
+	bool m_quit;
+	File::IOFile m_file;
+	std::vector<u8> m_header;
+	bool m_header_dirty;
+	// Bytes the writer may write, bytes in the file known to match the
+	// buffer and bytes in the file
+	u64 m_complete;
+	u64 m_streamed;
+	u64 m_file_size;
+	// Changed whenever data in the file becomes stale
+	u32 m_generation;
+};
+
+}
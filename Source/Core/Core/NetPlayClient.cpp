@@ -2,6 +2,8 @@
 // Licensed under GPLv2
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/Movie.h"
@@ -23,6 +25,15 @@ NetSettings g_NetPlaySettings;
 
 #define RPT_SIZE_HACK  (1 << 16)
 
+// Most polls of a controller sent together. Batches are also kept to a
+// quarter of the pad buffer, so they don't eat into the latency it hides.
+#define MAX_BATCH_POLLS  4
+
+static unsigned int GetBatchPolls(unsigned int buffer_size)
+{
+	return std::max(1u, std::min<unsigned int>(MAX_BATCH_POLLS, buffer_size / 4));
+}
+
 NetPad::NetPad()
 {
 	nHi = 0x00808080;
@@ -202,35 +213,30 @@ unsigned int NetPlayClient::OnData(sf::Packet& packet)
 		}
 		break;
 
-	case NP_MSG_PAD_DATA :
-		{
-			PadMapping map = 0;
-			NetPad np;
-			packet >> map >> np.nHi >> np.nLo;
-
-			// trusting server for good map value (>=0 && <4)
-			// add to pad buffer
-			m_pad_buffer[map].Push(np);
-		}
-		break;
-
-	case NP_MSG_WIIMOTE_DATA :
+	case NP_MSG_INPUT_DATA :
 		{
-			PadMapping map = 0;
-			NetWiimote nw;
-			u8 size;
-			packet >> map >> size;
-
-			nw.resize(size);
-			u8* data = new u8[size];
-			for (unsigned int i = 0; i < size; ++i)
-				packet >> data[i];
-			nw.assign(data,data+size);
-			delete[] data;
-
-			// trusting server for good map value (>=0 && <4)
-			// add to wiimote buffer
-			m_wiimote_buffer[(unsigned)map].Push(nw);
+			NetInputState state;
+			while (!packet.EndOfPacket())
+			{
+				if (!m_input_reader.Read(packet, state))
+				{
+					ERROR_LOG(NETPLAY, "Received malformed input data");
+					break;
+				}
+
+				// add to pad or wiimote buffer
+				if (state.is_wiimote)
+				{
+					m_wiimote_buffer[state.map].Push(state.wiimote);
+				}
+				else
+				{
+					NetPad np;
+					np.nHi = state.pad_hi;
+					np.nLo = state.pad_lo;
+					m_pad_buffer[state.map].Push(np);
+				}
+			}
 		}
 		break;
 
@@ -425,31 +431,33 @@ void NetPlayClient::SendChatMessage(const std::string& msg)
 // called from ---CPU--- thread
 void NetPlayClient::SendPadState(const PadMapping in_game_pad, const NetPad& np)
 {
-	// send to server
-	sf::Packet spac;
-	spac << (MessageId)NP_MSG_PAD_DATA;
-	spac << in_game_pad;
-	spac << np.nHi << np.nLo;
-
-	std::lock_guard<std::recursive_mutex> lks(m_crit.send);
-	m_socket.Send(spac);
+	m_input_writer.AddPad(in_game_pad, np.nHi, np.nLo);
+	if (m_input_writer.GetPolls() >= GetBatchPolls(m_target_buffer_size))
+		SendInput();
 }
 
 // called from ---CPU--- thread
 void NetPlayClient::SendWiimoteState(const PadMapping in_game_pad, const NetWiimote& nw)
 {
+	m_input_writer.AddWiimote(in_game_pad, nw);
+	if (m_input_writer.GetPolls() >= GetBatchPolls(m_target_buffer_size))
+		SendInput();
+}
+
+// called from ---CPU--- thread
+// Has to happen before waiting for other players, who might be waiting for
+// these states in turn
+void NetPlayClient::SendInput()
+{
+	if (m_input_writer.IsEmpty())
+		return;
+
 	// send to server
-	sf::Packet spac;
-	spac << (MessageId)NP_MSG_WIIMOTE_DATA;
-	spac << in_game_pad;
-	spac << (u8)nw.size();
-	for (auto it : nw)
-	{
-		spac << it;
-	}
+	SerializePacket(m_input_writer.GetPacket(), m_input_wire);
+	m_input_writer.Clear();
 
 	std::lock_guard<std::recursive_mutex> lks(m_crit.send);
-	m_socket.Send(spac);
+	m_socket.Send(m_input_wire.data(), m_input_wire.size());
 }
 
 // called from ---GUI--- thread
@@ -551,6 +559,8 @@ void NetPlayClient::ClearBuffers()
 		while (m_wiimote_buffer[i].Size())
 			m_wiimote_buffer[i].Pop();
 	}
+
+	m_input_writer.Reset();
 }
 
 // called from ---CPU--- thread
@@ -607,6 +617,7 @@ bool NetPlayClient::GetNetPads(const u8 pad_nb, const SPADStatus* const pad_stat
 	// to retrieve data for slot 1.
 	while (!m_pad_buffer[pad_nb].Pop(*netvalues))
 	{
+		SendInput();
 		if (!m_is_running)
 			return false;
 
@@ -684,6 +695,7 @@ bool NetPlayClient::WiimoteUpdate(int _number, u8* data, const u8 size)
 
 	while (previousSize[_number] == size && !m_wiimote_buffer[_number].Pop(nw))
 	{
+		SendInput();
 		// wait for receiving thread to push some data
 		Common::SleepCurrentThread(1);
 		if (false == m_is_running)
@@ -710,6 +722,7 @@ bool NetPlayClient::WiimoteUpdate(int _number, u8* data, const u8 size)
 		{
 			while (!m_wiimote_buffer[_number].Pop(nw))
 			{
+				SendInput();
 				Common::SleepCurrentThread(1);
 				if (false == m_is_running)
 					return false;
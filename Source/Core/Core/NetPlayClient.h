@@ -17,6 +17,7 @@
 #include "Common/Thread.h"
 #include "Common/Timer.h"
 
+#include "Core/NetPlayInput.h"
 #include "Core/NetPlayProto.h"
 
 #include "InputCommon/GCPadStatus.h"
@@ -122,10 +123,16 @@ private:
 	void UpdateDevices();
 	void SendPadState(const PadMapping in_game_pad, const NetPad& np);
 	void SendWiimoteState(const PadMapping in_game_pad, const NetWiimote& nw);
+	void SendInput();
 	unsigned int OnData(sf::Packet& packet);
 
 	PlayerId m_pid;
 	std::map<PlayerId, Player> m_players;
+
+	// Local states waiting to be sent, CPU thread only
+	NetInputWriter m_input_writer;
+	std::vector<char> m_input_wire;
+	NetInputReader m_input_reader;
 };
 
 void NetPlay_Enable(NetPlayClient* const np);
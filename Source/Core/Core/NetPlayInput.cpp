@@ -0,0 +1,167 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+
+#include "Core/NetPlayInput.h"
+
+// Wii Remote reports are at most 255 bytes
+#define MAX_MASK_SIZE  32
+
+static size_t GetIndex(u8 flags)
+{
+	return (flags & INPUT_MAP_MASK) | ((flags & INPUT_WIIMOTE) ? 4 : 0);
+}
+
+NetInputWriter::NetInputWriter()
+{
+	Reset();
+}
+
+void NetInputWriter::Reset()
+{
+	for (std::vector<u8>& previous : m_previous)
+		previous.clear();
+	Clear();
+}
+
+void NetInputWriter::Clear()
+{
+	m_packet.Clear();
+	m_packet << (MessageId)NP_MSG_INPUT_DATA;
+	memset(m_counts, 0, sizeof(m_counts));
+	m_polls = 0;
+}
+
+void NetInputWriter::AddPad(PadMapping map, u32 hi, u32 lo)
+{
+	const u8 data[8] = {
+		(u8)(hi >> 24), (u8)(hi >> 16), (u8)(hi >> 8), (u8)hi,
+		(u8)(lo >> 24), (u8)(lo >> 16), (u8)(lo >> 8), (u8)lo,
+	};
+	Add(map & INPUT_MAP_MASK, data, sizeof(data));
+}
+
+void NetInputWriter::AddWiimote(PadMapping map, const NetWiimote& nw)
+{
+	Add((map & INPUT_MAP_MASK) | INPUT_WIIMOTE, nw.data(), std::min<size_t>(nw.size(), 255));
+}
+
+void NetInputWriter::Add(u8 flags, const u8* data, size_t size)
+{
+	const size_t index = GetIndex(flags);
+	std::vector<u8>& previous = m_previous[index];
+
+	bool full = true;
+	if (size && previous.size() == size)
+	{
+		u8 mask[MAX_MASK_SIZE] = {};
+		size_t mask_size = (size + 7) / 8;
+		size_t changed = 0;
+		for (size_t i = 0; i < size; i++)
+		{
+			if (data[i] != previous[i])
+			{
+				mask[i / 8] |= 1 << (i % 8);
+				changed++;
+			}
+		}
+
+		if (!changed)
+		{
+			m_packet << (u8)(flags | INPUT_SAME);
+			full = false;
+		}
+		else if (mask_size + changed < size)
+		{
+			m_packet << (u8)(flags | INPUT_DELTA);
+			m_packet.Append(mask, mask_size);
+			for (size_t i = 0; i < size; i++)
+			{
+				if (data[i] != previous[i])
+					m_packet << data[i];
+			}
+			full = false;
+		}
+	}
+
+	if (full)
+	{
+		m_packet << flags;
+		if (flags & INPUT_WIIMOTE)
+			m_packet << (u8)size;
+		m_packet.Append(data, size);
+	}
+
+	previous.assign(data, data + size);
+	m_polls = std::max(m_polls, ++m_counts[index]);
+}
+
+bool NetInputReader::Read(sf::Packet& packet, NetInputState& state)
+{
+	u8 flags = 0;
+	if (!(packet >> flags))
+		return false;
+
+	std::vector<u8>& previous = m_previous[GetIndex(flags)];
+	if (flags & INPUT_SAME)
+	{
+		if (previous.empty())
+			return false;
+	}
+	else if (flags & INPUT_DELTA)
+	{
+		if (previous.empty())
+			return false;
+
+		u8 mask[MAX_MASK_SIZE];
+		size_t mask_size = (previous.size() + 7) / 8;
+		for (size_t i = 0; i < mask_size; i++)
+			packet >> mask[i];
+		for (size_t i = 0; i < previous.size(); i++)
+		{
+			if (mask[i / 8] & (1 << (i % 8)))
+				packet >> previous[i];
+		}
+	}
+	else
+	{
+		u8 size = 8;
+		if (flags & INPUT_WIIMOTE)
+			packet >> size;
+		previous.resize(size);
+		for (u8& value : previous)
+			packet >> value;
+	}
+
+	// Reading past the end of the packet invalidates it
+	if (!packet)
+		return false;
+
+	state.map = flags & INPUT_MAP_MASK;
+	state.is_wiimote = (flags & INPUT_WIIMOTE) != 0;
+	if (state.is_wiimote)
+	{
+		state.wiimote = previous;
+	}
+	else
+	{
+		state.pad_hi = ((u32)previous[0] << 24) | ((u32)previous[1] << 16) | ((u32)previous[2] << 8) | previous[3];
+		state.pad_lo = ((u32)previous[4] << 24) | ((u32)previous[5] << 16) | ((u32)previous[6] << 8) | previous[7];
+	}
+	return true;
+}
+
+void SerializePacket(const sf::Packet& packet, std::vector<char>& wire)
+{
+	const u32 size = (u32)packet.GetDataSize();
+	wire.resize(4 + size);
+	wire[0] = (char)(size >> 24);
+	wire[1] = (char)(size >> 16);
+	wire[2] = (char)(size >> 8);
+	wire[3] = (char)size;
+	if (size)
+		memcpy(&wire[4], packet.GetData(), size);
+}
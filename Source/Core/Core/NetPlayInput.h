@@ -0,0 +1,90 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include <SFML/Network.hpp>
+
+#include "Common/CommonTypes.h"
+
+#include "Core/NetPlayProto.h"
+
+// Controller states travel in NP_MSG_INPUT_DATA messages. Each one is a batch
+// of the states of all of a player's controllers over several polls:
+//
+//   MessageId  NP_MSG_INPUT_DATA
+//   then, until the end of the packet:
+//   u8         INPUT_MAP_MASK: in-game controller number
+//              INPUT_WIIMOTE: a Wii Remote report, else a pad state
+//              INPUT_SAME: the previous state of the controller repeats
+//              INPUT_DELTA: a bit per byte of the previous state, set for
+//                the bytes that changed, then the new values of those
+//              neither: pads 8 bytes, Wii Remotes u8 size and the report
+//
+// A pad state is nHi and nLo of NetPad in big endian. The first state of a
+// controller after NetInputWriter::Reset is always sent in full, so receivers
+// never need to reset in step with the sender.
+enum
+{
+	INPUT_MAP_MASK = 0x03,
+	INPUT_WIIMOTE  = 0x04,
+	INPUT_SAME     = 0x08,
+	INPUT_DELTA    = 0x10,
+};
+
+struct NetInputState
+{
+	PadMapping map;
+	bool is_wiimote;
+	u32 pad_hi;
+	u32 pad_lo;
+	NetWiimote wiimote;
+};
+
+class NetInputWriter
+{
+public:
+	NetInputWriter();
+
+	// Forgets the previous states, the next ones are sent in full
+	void Reset();
+
+	void AddPad(PadMapping map, u32 hi, u32 lo);
+	void AddWiimote(PadMapping map, const NetWiimote& nw);
+
+	bool IsEmpty() const { return m_polls == 0; }
+	// The most states of a single controller in the batch
+	u32 GetPolls() const { return m_polls; }
+	// The batch so far, as a complete message
+	const sf::Packet& GetPacket() const { return m_packet; }
+	// Starts the next batch
+	void Clear();
+
+private:
+	void Add(u8 flags, const u8* data, size_t size);
+
+	sf::Packet m_packet;
+	// Pads, then Wii Remotes
+	std::vector<u8> m_previous[8];
+	u32 m_counts[8];
+	u32 m_polls;
+};
+
+class NetInputReader
+{
+public:
+	// Reads the next state of an NP_MSG_INPUT_DATA message, check
+	// packet.EndOfPacket() first. False if the message is malformed.
+	bool Read(sf::Packet& packet, NetInputState& state);
+
+private:
+	std::vector<u8> m_previous[8];
+};
+
+// sf::SocketTCP::Send(sf::Packet&) sends the size and the data of a packet in
+// separate calls, which go out as separate segments. This puts both in wire,
+// to be sent as one to any number of sockets.
+void SerializePacket(const sf::Packet& packet, std::vector<char>& wire);
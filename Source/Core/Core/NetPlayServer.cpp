@@ -369,64 +369,31 @@ unsigned int NetPlayServer::OnData(sf::Packet& packet, sf::SocketTCP& socket)
 		}
 		break;
 
-	case NP_MSG_PAD_DATA :
+	case NP_MSG_INPUT_DATA :
 		{
-			// if this is pad data from the last game still being received, ignore it
-			if (player.current_game != m_current_game)
-				break;
-
-			PadMapping map = 0;
-			int hi, lo;
-			packet >> map >> hi >> lo;
-
-			// If the data is not from the correct player,
-			// then disconnect them.
-			if (m_pad_map[map] != player.pid)
-				return 1;
-
-			// Relay to clients
-			sf::Packet spac;
-			spac << (MessageId)NP_MSG_PAD_DATA;
-			spac << map << hi << lo;
-
-			std::lock_guard<std::recursive_mutex> lks(m_crit.send);
-			SendToClients(spac, player.pid);
-		}
-		break;
-
-		case NP_MSG_WIIMOTE_DATA :
-		{
-			// if this is wiimote data from the last game still being received, ignore it
-			if (player.current_game != m_current_game)
-				break;
-
-			PadMapping map = 0;
-			u8 size;
-			packet >> map >> size;
-			u8* data = new u8[size];
-			for (unsigned int i = 0; i < size; ++i)
-				packet >> data[i];
-
-			// If the data is not from the correct player,
-			// then disconnect them.
-			if (m_wiimote_map[map] != player.pid)
+			// Read even data from the last game, to stay in step with the
+			// client's delta encoding
+			const bool current = player.current_game == m_current_game;
+			NetInputState state;
+			while (!packet.EndOfPacket())
 			{
-				delete[] data;
-				return 1;
+				if (!player.input_reader.Read(packet, state))
+					return 1;
+
+				// If the data is not from the correct player,
+				// then disconnect them.
+				const PadMapping* map = state.is_wiimote ? m_wiimote_map : m_pad_map;
+				if (current && map[state.map] != player.pid)
+					return 1;
 			}
 
-			// relay to clients
-			sf::Packet spac;
-			spac << (MessageId)NP_MSG_WIIMOTE_DATA;
-			spac << map;
-			spac << size;
-			for (unsigned int i = 0; i < size; ++i)
-				spac << data[i];
-
-			delete[] data;
+			// if this is input from the last game still being received, ignore it
+			if (!current)
+				break;
 
+			// Relay to clients as is
 			std::lock_guard<std::recursive_mutex> lks(m_crit.send);
-			SendToClients(spac, player.pid);
+			SendToClients(packet, player.pid);
 		}
 		break;
 
@@ -552,12 +519,16 @@ bool NetPlayServer::StartGame(const std::string &path)
 // called from multiple threads
 void NetPlayServer::SendToClients(sf::Packet& packet, const PlayerId skip_pid)
 {
+	// serialize once for all clients
+	std::vector<char> wire;
+	SerializePacket(packet, wire);
+
 	std::map<sf::SocketTCP, Client>::iterator
 		i = m_players.begin(),
 		e = m_players.end();
 	for ( ; i!=e; ++i)
 		if (i->second.pid && (i->second.pid != skip_pid))
-			i->second.socket.Send(packet);
+			i->second.socket.Send(wire.data(), wire.size());
 }
 
 #ifdef USE_UPNP
@@ -16,6 +16,7 @@
 #include "Common/Thread.h"
 #include "Common/Timer.h"
 
+#include "Core/NetPlayInput.h"
 #include "Core/NetPlayProto.h"
 
 class NetPlayServer
@@ -58,6 +59,8 @@ private:
 		sf::SocketTCP socket;
 		u32 ping;
 		u32 current_game;
+
+		NetInputReader input_reader;
 	};
 
 	void SendToClients(sf::Packet& packet, const PlayerId skip_pid = 0);
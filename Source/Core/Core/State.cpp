@@ -61,7 +61,7 @@ static Common::Event g_compressAndDumpStateSyncEvent;
 static std::thread g_save_thread;
 
 // Don't forget to increase this after doing changes on the savestate system
-static const u32 STATE_VERSION = 22;
+static const u32 STATE_VERSION = 25;
 
 enum
 {
@@ -43,6 +43,10 @@ void print_trace(const char * msg)
 
 bool DoFault(u64 bad_address, SContext *ctx)
 {
+	// Writes to write tracked memory can come from anywhere
+	if (Memory::HandleWriteTrackingFault(bad_address))
+		return true;
+
 	if (!JitInterface::IsInCodeSpace((u8*) ctx->CTX_PC))
 	{
 		// Let's not prevent debugging.
@@ -5,8 +5,12 @@
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
+#include <algorithm>
 #include <functional>
+#include <list>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -19,6 +23,7 @@
 #include "Common/NandPaths.h"
 #include "Common/StringUtil.h"
 
+#include "DiscIO/Blob.h"
 #include "DiscIO/NANDContentLoader.h"
 #include "DiscIO/Volume.h"
 #include "DiscIO/WiiWad.h"
@@ -28,6 +33,129 @@ namespace DiscIO
 CSharedContent CSharedContent::m_Instance;
 cUIDsys cUIDsys::m_Instance;
 
+#define NAND_CONTENT_CHUNK_SIZE 0x4000
+// 4 MiB of decrypted chunks
+#define NAND_CONTENT_CACHE_CHUNKS 256
+
+struct SContentChunk
+{
+	u64 id;
+	u32 chunk;
+	u8 data[NAND_CONTENT_CHUNK_SIZE];
+};
+
+// The chunk cache, most recently used first. The mutex also guards the blob
+// readers, which can't be used from two threads at once.
+static std::mutex s_chunk_mutex;
+static std::list<std::unique_ptr<SContentChunk>> s_chunks;
+static std::map<std::pair<u64, u32>, std::list<std::unique_ptr<SContentChunk>>::iterator> s_chunk_map;
+static SNANDContentStats s_stats;
+static u64 s_next_content_id = 0;
+
+SNANDContentStats GetNANDContentStats()
+{
+	std::lock_guard<std::mutex> lk(s_chunk_mutex);
+	return s_stats;
+}
+
+CNANDContentData::CNANDContentData(IBlobReader& reader, u64 offset, u32 size, const u8* key, const u8* iv)
+	: m_reader(reader)
+	, m_offset(offset)
+	, m_size(size)
+{
+	memcpy(m_key, key, sizeof(m_key));
+	memcpy(m_iv, iv, sizeof(m_iv));
+
+	std::lock_guard<std::mutex> lk(s_chunk_mutex);
+	m_id = s_next_content_id++;
+}
+
+bool CNANDContentData::DecryptChunk(u32 chunk, u8* out) const
+{
+	u32 start = chunk * NAND_CONTENT_CHUNK_SIZE;
+	u32 size = std::min<u32>(NAND_CONTENT_CHUNK_SIZE, m_size - start);
+
+	// In CBC mode the IV of a chunk is the last block before it
+	u8 IV[16];
+	u8 encrypted[NAND_CONTENT_CHUNK_SIZE];
+	if (chunk == 0)
+		memcpy(IV, m_iv, sizeof(IV));
+	else if (!m_reader.Read(m_offset + start - sizeof(IV), sizeof(IV), IV))
+		return false;
+	if (!m_reader.Read(m_offset + start, size, encrypted))
+		return false;
+
+	aes_context AES_ctx;
+	aes_setkey_dec(&AES_ctx, m_key, 128);
+	aes_crypt_cbc(&AES_ctx, AES_DECRYPT, size, IV, encrypted, out);
+
+	s_stats.chunks_decrypted++;
+	s_stats.bytes_read += size;
+	return true;
+}
+
+bool CNANDContentData::Read(u32 offset, u32 size, u8* buffer) const
+{
+	if (offset > m_size || size > m_size - offset)
+		return false;
+
+	std::lock_guard<std::mutex> lk(s_chunk_mutex);
+	while (size)
+	{
+		u32 chunk = offset / NAND_CONTENT_CHUNK_SIZE;
+		u32 chunk_offset = offset % NAND_CONTENT_CHUNK_SIZE;
+		u32 copy = std::min(size, NAND_CONTENT_CHUNK_SIZE - chunk_offset);
+
+		auto key = std::make_pair(m_id, chunk);
+		auto found = s_chunk_map.find(key);
+		if (found != s_chunk_map.end())
+		{
+			s_chunks.splice(s_chunks.begin(), s_chunks, found->second);
+			s_stats.cache_hits++;
+		}
+		else
+		{
+			std::unique_ptr<SContentChunk> entry;
+			if (s_chunks.size() >= NAND_CONTENT_CACHE_CHUNKS)
+			{
+				// Reuse the least recently used one
+				entry = std::move(s_chunks.back());
+				s_chunks.pop_back();
+				s_chunk_map.erase(std::make_pair(entry->id, entry->chunk));
+			}
+			else
+			{
+				entry.reset(new SContentChunk);
+			}
+
+			if (!DecryptChunk(chunk, entry->data))
+			{
+				ERROR_LOG(DISCIO, "Couldn't read chunk %u of a WAD content", chunk);
+				return false;
+			}
+
+			entry->id = m_id;
+			entry->chunk = chunk;
+			s_chunks.push_front(std::move(entry));
+			s_chunk_map[key] = s_chunks.begin();
+		}
+
+		memcpy(buffer, s_chunks.front()->data + chunk_offset, copy);
+		buffer += copy;
+		offset += copy;
+		size -= copy;
+	}
+	return true;
+}
+
+std::vector<u8> CNANDContentData::Get() const
+{
+	std::vector<u8> data(m_size);
+	if (!Read(0, m_size, data.data()))
+		data.clear();
+	return data;
+}
+
 
 CSharedContent::CSharedContent()
 {
@@ -137,6 +265,8 @@ private:
 	u8 *m_TIK;
 	u8 m_Country;
 
+	// The contents of a WAD read from here as needed
+	std::unique_ptr<IBlobReader> m_WadReader;
 	std::vector<SNANDContent> m_Content;
 
 
@@ -166,7 +296,7 @@ CNANDContentLoader::~CNANDContentLoader()
 {
 	for (auto& content : m_Content)
 	{
-		delete [] content.m_pData;
+		delete content.m_pData;
 	}
 	m_Content.clear();
 	if (m_TIK)
@@ -194,7 +324,7 @@ bool CNANDContentLoader::Initialize(const std::string& _rName)
 		return false;
 	m_Path = _rName;
 	WiiWAD Wad(_rName);
-	u8* pDataApp = NULL;
+	u64 DataAppOffset = 0;
 	u8* pTMD = NULL;
 	u8 DecryptTitleKey[16];
 	u8 IV[16];
@@ -208,7 +338,13 @@ bool CNANDContentLoader::Initialize(const std::string& _rName)
 		u32 pTMDSize = Wad.GetTMDSize();
 		pTMD = new u8[pTMDSize];
 		memcpy(pTMD, Wad.GetTMD(), pTMDSize);
-		pDataApp = Wad.GetDataApp();
+		DataAppOffset = Wad.GetDataAppOffset();
+		m_WadReader.reset(CreateBlobReader(_rName.c_str()));
+		if (!m_WadReader)
+		{
+			delete [] pTMD;
+			return false;
+		}
 	}
 	else
 	{
@@ -261,14 +397,13 @@ bool CNANDContentLoader::Initialize(const std::string& _rName)
 
 		if (m_isWAD)
 		{
+			// Decrypted as it's read
 			u32 RoundedSize = ROUND_UP(rContent.m_Size, 0x40);
-			rContent.m_pData = new u8[RoundedSize];
-
 			memset(IV, 0, sizeof IV);
 			memcpy(IV, pTMD + 0x01e8 + 0x24*i, 2);
-			AESDecode(DecryptTitleKey, IV, pDataApp, RoundedSize, rContent.m_pData);
+			rContent.m_pData = new CNANDContentData(*m_WadReader, DataAppOffset, RoundedSize, DecryptTitleKey, IV);
 
-			pDataApp += RoundedSize;
+			DataAppOffset += RoundedSize;
 			continue;
 		}
 
@@ -514,7 +649,17 @@ u64 CNANDContentManager::Install_WiiWAD(std::string &fileName)
 				return 0;
 			}
 
-			pAPPFile.WriteBytes(Content.m_pData, Content.m_Size);
+			// A chunk at a time, instead of the whole content
+			std::vector<u8> buffer(NAND_CONTENT_CHUNK_SIZE);
+			for (u32 offset = 0; offset < Content.m_Size; offset += NAND_CONTENT_CHUNK_SIZE)
+			{
+				u32 size = std::min<u32>(NAND_CONTENT_CHUNK_SIZE, Content.m_Size - offset);
+				if (!Content.m_pData->Read(offset, size, buffer.data()) || !pAPPFile.WriteBytes(buffer.data(), size))
+				{
+					PanicAlertT("WAD installation failed: error writing %s", APPFileName);
+					return 0;
+				}
+			}
 		}
 		else
 		{
@@ -15,6 +15,41 @@
 namespace DiscIO
 {
 	bool Add_Ticket(u64 TitleID, const u8 *p_tik, u32 tikSize);
+
+class IBlobReader;
+
+// A content inside a WAD. It is decrypted 16 KiB at a time when it's first
+// read, into a cache of limited size that all contents share.
+class CNANDContentData
+{
+public:
+	CNANDContentData(IBlobReader& reader, u64 offset, u32 size, const u8* key, const u8* iv);
+
+	// Copies size bytes from offset to buffer. False if the WAD couldn't be read.
+	bool Read(u32 offset, u32 size, u8* buffer) const;
+	// All of it, for the DOL loader
+	std::vector<u8> Get() const;
+
+private:
+	bool DecryptChunk(u32 chunk, u8* out) const;
+
+	IBlobReader& m_reader;
+	u64 m_id; // Identifies the chunks in the cache
+	u64 m_offset; // In the WAD
+	u32 m_size; // Rounded up to whole AES blocks
+	u8 m_key[16];
+	u8 m_iv[16];
+};
+
+// How much decrypting WAD contents took so far, to log at boot
+struct SNANDContentStats
+{
+	u32 chunks_decrypted;
+	u32 cache_hits;
+	u64 bytes_read;
+};
+SNANDContentStats GetNANDContentStats();
+
 struct SNANDContent
 {
 	u32 m_ContentID;
@@ -25,7 +60,8 @@ struct SNANDContent
 	u8 m_Header[36]; //all of the above
 
 	std::string m_Filename;
-	u8* m_pData;
+	// Only for contents of WADs, others are read from m_Filename
+	CNANDContentData* m_pData;
 };
 
 // pure virtual interface so just the NANDContentManager can create these files only
@@ -31,7 +31,8 @@ public:
 	u8* GetCertificateChain() const { return m_pCertificateChain; }
 	u8* GetTicket() const { return m_pTicket; }
 	u8* GetTMD() const { return m_pTMD; }
-	u8* GetDataApp() const { return m_pDataApp; }
+	// The contents are large, so they're left in the file
+	u64 GetDataAppOffset() const { return m_DataAppOffset; }
 	u8* GetFooter() const { return m_pFooter; }
 
 	static bool IsWiiWAD(const std::string& _rName);
@@ -49,7 +50,7 @@ private:
 	u8* m_pCertificateChain;
 	u8* m_pTicket;
 	u8* m_pTMD;
-	u8* m_pDataApp;
+	u64 m_DataAppOffset;
 	u8* m_pFooter;
 
 	u8* CreateWADEntry(DiscIO::IBlobReader& _rReader, u32 _Size, u64 _Offset);
@@ -144,6 +144,7 @@ EVT_CHECKBOX(ID_NTSCJ, CConfigMain::CoreSettingsChanged)
 
 EVT_RADIOBOX(ID_DSPENGINE, CConfigMain::AudioSettingsChanged)
 EVT_CHECKBOX(ID_DSPTHREAD, CConfigMain::AudioSettingsChanged)
+EVT_CHECKBOX(ID_DSPHLETHREAD, CConfigMain::AudioSettingsChanged)
 EVT_CHECKBOX(ID_ENABLE_THROTTLE, CConfigMain::AudioSettingsChanged)
 EVT_CHECKBOX(ID_DUMP_AUDIO, CConfigMain::AudioSettingsChanged)
 EVT_CHECKBOX(ID_DPL2DECODER, CConfigMain::AudioSettingsChanged)
@@ -241,6 +242,7 @@ void CConfigMain::UpdateGUI()
 		// Disable stuff on AudioPage
 		DSPEngine->Disable();
 		DSPThread->Disable();
+		DSPHLEThread->Disable();
 		DPL2Decoder->Disable();
 		Latency->Disable();
 
@@ -375,6 +377,7 @@ void CConfigMain::InitializeGUIValues()
 	VolumeSlider->SetValue(SConfig::GetInstance().m_Volume);
 	VolumeText->SetLabel(wxString::Format(wxT("%d %%"), SConfig::GetInstance().m_Volume));
 	DSPThread->SetValue(startup_params.bDSPThread);
+	DSPHLEThread->SetValue(startup_params.bDSPHLEThread);
 	DumpAudio->SetValue(SConfig::GetInstance().m_DumpAudio ? true : false);
 	DPL2Decoder->Enable(std::string(SConfig::GetInstance().sBackend) == BACKEND_OPENAL);
 	DPL2Decoder->SetValue(startup_params.bDPL2Decoder);
@@ -522,6 +525,7 @@ void CConfigMain::InitializeGUITooltips()
 
 	// Audio tooltips
 	DSPThread->SetToolTip(_("Run DSP LLE on a dedicated thread (not recommended: might cause freezes)."));
+	DSPHLEThread->SetToolTip(_("Mix DSP HLE audio on a dedicated thread. Doesn't change the emulated timing, but isn't deterministic, so it isn't used while a movie is recorded or played or during NetPlay.\n\nIf unsure, leave this unchecked."));
 	BackendSelection->SetToolTip(_("Changing this will have no effect while the emulator is running!"));
 
 	// Gamecube - Devices
@@ -659,6 +663,7 @@ void CConfigMain::CreateGUIControls()
 	DSPEngine = new wxRadioBox(AudioPage, ID_DSPENGINE, _("DSP Emulator Engine"),
 				wxDefaultPosition, wxDefaultSize, arrayStringFor_DSPEngine, 0, wxRA_SPECIFY_ROWS);
 	DSPThread = new wxCheckBox(AudioPage, ID_DSPTHREAD, _("DSPLLE on Separate Thread"));
+	DSPHLEThread = new wxCheckBox(AudioPage, ID_DSPHLETHREAD, _("DSPHLE on Separate Thread"));
 	DumpAudio = new wxCheckBox(AudioPage, ID_DUMP_AUDIO, _("Dump Audio"),
 				wxDefaultPosition, wxDefaultSize, 0, wxDefaultValidator);
 	DPL2Decoder = new wxCheckBox(AudioPage, ID_DPL2DECODER, _("Dolby Pro Logic II decoder"));
@@ -684,6 +689,7 @@ void CConfigMain::CreateGUIControls()
 	wxStaticBoxSizer *sbAudioSettings = new wxStaticBoxSizer(wxVERTICAL, AudioPage, _("Sound Settings"));
 	sbAudioSettings->Add(DSPEngine, 0, wxALL | wxEXPAND, 5);
 	sbAudioSettings->Add(DSPThread, 0, wxALL, 5);
+	sbAudioSettings->Add(DSPHLEThread, 0, wxALL, 5);
 	sbAudioSettings->Add(DumpAudio, 0, wxALL, 5);
 	sbAudioSettings->Add(DPL2Decoder, 0, wxALL, 5);
 
@@ -971,6 +977,10 @@ void CConfigMain::AudioSettingsChanged(wxCommandEvent& event)
 		SConfig::GetInstance().m_LocalCoreStartupParameter.bDSPThread = DSPThread->IsChecked();
 		break;
 
+	case ID_DSPHLETHREAD:
+		SConfig::GetInstance().m_LocalCoreStartupParameter.bDSPHLEThread = DSPHLEThread->IsChecked();
+		break;
+
 	case ID_DPL2DECODER:
 		SConfig::GetInstance().m_LocalCoreStartupParameter.bDPL2Decoder = DPL2Decoder->IsChecked();
 		break;
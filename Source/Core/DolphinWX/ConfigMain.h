@@ -81,6 +81,7 @@ private:
 
 		ID_CPUENGINE,
 		ID_DSPTHREAD,
+		ID_DSPHLETHREAD,
 
 		ID_NTSCJ,
 
@@ -151,6 +152,7 @@ private:
 	// Advanced
 	wxRadioBox* CPUEngine;
 	wxCheckBox* DSPThread;
+	wxCheckBox* DSPHLEThread;
 	wxCheckBox* _NTSCJ;
 
 
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -488,7 +489,8 @@ void FifoPlayerDlg::OnBeginSearch(wxCommandEvent& event)
 	int const frame_idx = m_framesList->GetSelection();
 	FifoPlayer& player = FifoPlayer::GetInstance();
 	const AnalyzedFrameInfo& frame = player.GetAnalyzedFrameInfo(frame_idx);
-	const FifoFrameInfo& fifo_frame = player.GetFile()->GetFrame(frame_idx);
+	std::shared_ptr<const FifoFrameInfo> fifo_frame_ptr = player.GetFile()->GetFrame(frame_idx);
+	const FifoFrameInfo& fifo_frame = *fifo_frame_ptr;
 
 	// TODO: Support searching through the last object... How do we know were the cmd data ends?
 	// TODO: Support searching for bit patterns
@@ -650,7 +652,8 @@ void FifoPlayerDlg::OnObjectListSelectionChanged(wxCommandEvent& event)
 	if (frame_idx != -1 && object_idx != -1)
 	{
 		const AnalyzedFrameInfo& frame = player.GetAnalyzedFrameInfo(frame_idx);
-		const FifoFrameInfo& fifo_frame = player.GetFile()->GetFrame(frame_idx);
+		std::shared_ptr<const FifoFrameInfo> fifo_frame_ptr = player.GetFile()->GetFrame(frame_idx);
+		const FifoFrameInfo& fifo_frame = *fifo_frame_ptr;
 		const u8* objectdata_start = &fifo_frame.fifoData[frame.objectStarts[object_idx]];
 		const u8* objectdata_end = &fifo_frame.fifoData[frame.objectEnds[object_idx]];
 		u8* objectdata = (u8*)objectdata_start;
@@ -780,7 +783,8 @@ void FifoPlayerDlg::OnObjectCmdListSelectionChanged(wxCommandEvent& event)
 
 	FifoPlayer& player = FifoPlayer::GetInstance();
 	const AnalyzedFrameInfo& frame = player.GetAnalyzedFrameInfo(frame_idx);
-	const FifoFrameInfo& fifo_frame = player.GetFile()->GetFrame(frame_idx);
+	std::shared_ptr<const FifoFrameInfo> fifo_frame_ptr = player.GetFile()->GetFrame(frame_idx);
+	const FifoFrameInfo& fifo_frame = *fifo_frame_ptr;
 	const u8* cmddata = &fifo_frame.fifoData[frame.objectStarts[object_idx]] + m_objectCmdOffsets[event.GetInt()];
 
 	// TODO: Not sure whether we should bother translating the descriptions
@@ -924,9 +928,7 @@ wxString FifoPlayerDlg::CreateRecordingFifoSizeLabel() const
 
 	if (file)
 	{
-		size_t fifoBytes = 0;
-		for (size_t i = 0; i < file->GetFrameCount(); ++i)
-			fifoBytes += file->GetFrame(i).fifoDataSize;
+		size_t fifoBytes = (size_t)file->GetFifoDataSize();
 
 		return CreateIntegerLabel(fifoBytes, _("FIFO Byte"));
 	}
@@ -940,13 +942,7 @@ wxString FifoPlayerDlg::CreateRecordingMemSizeLabel() const
 
 	if (file)
 	{
-		size_t memBytes = 0;
-		for (size_t frameNum = 0; frameNum < file->GetFrameCount(); ++frameNum)
-		{
-			const vector<MemoryUpdate>& memUpdates = file->GetFrame(frameNum).memoryUpdates;
-			for (auto& memUpdate : memUpdates)
-				memBytes += memUpdate.size;
-		}
+		size_t memBytes = (size_t)file->GetMemoryUpdatesSize();
 
 		return CreateIntegerLabel(memBytes, _("Memory Byte"));
 	}
@@ -4,9 +4,11 @@
 
 #include <cstdarg>
 #include <cstddef>
+#include <cstdlib>
 #include <cstdio>
 #include <cstring>
 #include <getopt.h>
+#include <string>
 
 #include "Common/Common.h"
 #include "Common/LogManager.h"
@@ -16,6 +18,7 @@
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreParameter.h"
+#include "Core/FifoPlayer/FifoBenchmark.h"
 #include "Core/HW/Wiimote.h"
 #include "Core/PowerPC/PowerPC.h"
 
@@ -293,18 +296,38 @@ int main(int argc, char* argv[])
 #endif
 	int ch, help = 0;
 	struct option longopts[] = {
-		{ "exec",    no_argument, NULL, 'e' },
-		{ "help",    no_argument, NULL, 'h' },
-		{ "version", no_argument, NULL, 'v' },
-		{ NULL,      0,           NULL,  0  }
+		{ "exec",          no_argument,       NULL, 'e' },
+		{ "help",          no_argument,       NULL, 'h' },
+		{ "version",       no_argument,       NULL, 'v' },
+		{ "video_backend", required_argument, NULL, 'V' },
+		{ "fifo_report",   required_argument, NULL, 'R' },
+		{ "fifo_frames",   required_argument, NULL, 'F' },
+		{ "fifo_passes",   required_argument, NULL, 'P' },
+		{ NULL,            0,                 NULL,  0  }
 	};
+	std::string video_backend;
+	std::string fifo_report;
+	u32 fifo_first_frame = 0, fifo_end_frame = UINT32_MAX, fifo_passes = 1;
 
-	while ((ch = getopt_long(argc, argv, "eh?v", longopts, 0)) != -1)
+	while ((ch = getopt_long(argc, argv, "eh?vV:R:F:P:", longopts, 0)) != -1)
 	{
 		switch (ch)
 		{
 		case 'e':
 			break;
+		case 'V':
+			video_backend = optarg;
+			break;
+		case 'R':
+			fifo_report = optarg;
+			break;
+		case 'F':
+			if (sscanf(optarg, "%u:%u", &fifo_first_frame, &fifo_end_frame) < 1)
+				help = 1;
+			break;
+		case 'P':
+			fifo_passes = (u32)strtoul(optarg, NULL, 0);
+			break;
 		case 'h':
 		case '?':
 			help = 1;
@@ -319,20 +342,41 @@ int main(int argc, char* argv[])
 	{
 		fprintf(stderr, "%s\n\n", scm_rev_str);
 		fprintf(stderr, "A multi-platform Gamecube/Wii emulator\n\n");
-		fprintf(stderr, "Usage: %s [-e <file>] [-h] [-v]\n", argv[0]);
-		fprintf(stderr, "  -e, --exec   Load the specified file\n");
-		fprintf(stderr, "  -h, --help   Show this help message\n");
-		fprintf(stderr, "  -v, --help   Print version and exit\n");
+		fprintf(stderr, "Usage: %s [-e <file>] [-h] [-v] [-V <backend>]\n", argv[0]);
+		fprintf(stderr, "  -e, --exec            Load the specified file\n");
+		fprintf(stderr, "  -h, --help            Show this help message\n");
+		fprintf(stderr, "  -v, --help            Print version and exit\n");
+		fprintf(stderr, "  -V, --video_backend   Use the named video backend, Null to run\n"
+		                "                        without a window\n");
+		fprintf(stderr, "  -R, --fifo_report     Time the playback of a .dff file and write\n"
+		                "                        the frame times to the given .csv or .json\n");
+		fprintf(stderr, "  -F, --fifo_frames     Frames to time, as first[:end]\n");
+		fprintf(stderr, "  -P, --fifo_passes     Number of times to play them\n");
 		return 1;
 	}
 
 	LogManager::Init();
 	SConfig::Init();
 	VideoBackend::PopulateList();
+	if (!video_backend.empty())
+		SConfig::GetInstance().m_LocalCoreStartupParameter.m_strVideoBackend = video_backend;
 	VideoBackend::ActivateBackend(SConfig::GetInstance().
 		m_LocalCoreStartupParameter.m_strVideoBackend);
 	WiimoteReal::LoadSettings();
 
+	// The frame times only cover the GPU emulation if it runs on the thread
+	// writing the FIFO, and the frame limiter would pad them out
+	bool& cpu_thread = SConfig::GetInstance().m_LocalCoreStartupParameter.bCPUThread;
+	unsigned int& frame_limit = SConfig::GetInstance().m_Framelimit;
+	bool saved_cpu_thread = cpu_thread;
+	unsigned int saved_frame_limit = frame_limit;
+	if (!fifo_report.empty())
+	{
+		cpu_thread = false;
+		frame_limit = 0;
+		FifoBenchmark::Start(fifo_first_frame, fifo_end_frame, fifo_passes);
+	}
+
 #if USE_EGL
 	GLWin.platform = EGL_PLATFORM_NONE;
 #endif
@@ -341,7 +385,15 @@ int main(int argc, char* argv[])
 #endif
 
 	// No use running the loop when booting fails
-	if (BootManager::BootCore(argv[optind]))
+	bool booted = BootManager::BootCore(argv[optind]);
+	if (booted && g_video_backend->GetName() == "Null")
+	{
+		// Nothing to show and no window to take input from
+		while (running && PowerPC::GetState() != PowerPC::CPU_POWERDOWN)
+			Common::SleepCurrentThread(100);
+		Core::Stop();
+	}
+	else if (booted)
 	{
 #if USE_EGL
 		while (GLWin.platform == EGL_PLATFORM_NONE)
@@ -389,6 +441,16 @@ int main(int argc, char* argv[])
 #endif
 	}
 
+	if (!fifo_report.empty())
+	{
+		FifoBenchmark::Stop();
+		cpu_thread = saved_cpu_thread;
+		frame_limit = saved_frame_limit;
+		fprintf(stderr, "%s\n", FifoBenchmark::GetSummary().c_str());
+		if (!FifoBenchmark::WriteReport(fifo_report))
+			fprintf(stderr, "Couldn't write %s\n", fifo_report.c_str());
+	}
+
 	WiimoteReal::Shutdown();
 	VideoBackend::ClearList();
 	SConfig::Shutdown();
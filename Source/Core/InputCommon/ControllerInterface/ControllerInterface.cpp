@@ -60,10 +60,15 @@ void ControllerInterface::Initialize()
 #if USE_EGL
 if (GLWin.platform == EGL_PLATFORM_X11) {
 #endif
-	ciface::Xlib::Init(m_devices, m_hwnd);
+	// Keyboard and mouse are read from the render window, and headless
+	// backends like Null have none
+	if (m_hwnd)
+	{
+		ciface::Xlib::Init(m_devices, m_hwnd);
 	#ifdef CIFACE_USE_X11_XINPUT2
 		ciface::XInput2::Init(m_devices, m_hwnd);
 	#endif
+	}
 #if USE_EGL
 }
 #endif
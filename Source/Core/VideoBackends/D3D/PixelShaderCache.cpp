@@ -344,8 +344,12 @@ ID3D11Buffer* &PixelShaderCache::GetConstantBuffer()
 		memcpy(map.pData, &PixelShaderManager::constants, sizeof(PixelShaderConstants));
 		D3D::context->Unmap(pscbuf, 0);
 		PixelShaderManager::dirty = false;
+		// WRITE_DISCARD needs the whole buffer, so the dirty ranges don't help here
+		PixelShaderManager::dirty_regs.Clear();
 
 		ADDSTAT(stats.thisFrame.bytesUniformStreamed, sizeof(PixelShaderConstants));
+		ADDSTAT(stats.thisFrame.numUniformRanges, 1);
+		INCSTAT(stats.thisFrame.numUniformUploads);
 	}
 	return pscbuf;
 }
@@ -23,7 +23,7 @@ public:
 
 protected:
 	virtual void ResetBuffer(u32 stride);
-	u16* GetIndexBuffer() { return &LocalIBuffer[0]; }
+	u32* GetIndexBuffer() { return &LocalIBuffer[0]; }
 
 private:
 
@@ -46,7 +46,7 @@ private:
 	PointGeometryShader m_pointShader;
 
 	std::vector<u8> LocalVBuffer;
-	std::vector<u16> LocalIBuffer;
+	std::vector<u32> LocalIBuffer;
 };
 
 }  // namespace
@@ -47,8 +47,12 @@ ID3D11Buffer* &VertexShaderCache::GetConstantBuffer()
 		memcpy(map.pData, &VertexShaderManager::constants, sizeof(VertexShaderConstants));
 		D3D::context->Unmap(vscbuf, 0);
 		VertexShaderManager::dirty = false;
+		// WRITE_DISCARD needs the whole buffer, so the dirty ranges don't help here
+		VertexShaderManager::dirty_regs.Clear();
 
 		ADDSTAT(stats.thisFrame.bytesUniformStreamed, sizeof(VertexShaderConstants));
+		ADDSTAT(stats.thisFrame.numUniformRanges, 1);
+		INCSTAT(stats.thisFrame.numUniformUploads);
 	}
 	return vscbuf;
 }
@@ -90,6 +90,7 @@ void InitBackendInfo()
 	g_Config.backend_info.bSupportsPixelLighting = true;
 	g_Config.backend_info.bSupportsPrimitiveRestart = true;
 	g_Config.backend_info.bSupportsOversizedViewports = false;
+	g_Config.backend_info.bSupportsUberShaders = false; // the uber pixel shader is GLSL only
 
 	IDXGIFactory* factory;
 	IDXGIAdapter* ad;
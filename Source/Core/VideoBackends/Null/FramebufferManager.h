@@ -0,0 +1,39 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "VideoCommon/FramebufferManagerBase.h"
+
+namespace Null
+{
+
+struct XFBSource : public XFBSourceBase
+{
+	void Draw(const MathUtil::Rectangle<int> &sourcerc,
+		const MathUtil::Rectangle<float> &drawrc) const override {}
+	void DecodeToTexture(u32 xfbAddr, u32 fbWidth, u32 fbHeight) override {}
+	void CopyEFB(float Gamma) override {}
+};
+
+// Virtual XFBs are tracked as usual, but there is nothing to copy into them.
+// Real XFB copies leave RAM untouched.
+class FramebufferManager : public FramebufferManagerBase
+{
+private:
+	XFBSourceBase* CreateXFBSource(unsigned int target_width, unsigned int target_height) override
+	{
+		return new XFBSource;
+	}
+
+	void GetTargetSize(unsigned int *width, unsigned int *height, const EFBRectangle& sourceRc) override
+	{
+		*width = EFB_WIDTH;
+		*height = EFB_HEIGHT;
+	}
+
+	void CopyToRealXFB(u32 xfbAddr, u32 fbWidth, u32 fbHeight, const EFBRectangle& sourceRc, float Gamma) override {}
+};
+
+}
@@ -0,0 +1,151 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+// Null Backend Documentation
+
+// This backend runs the whole video pipeline of the hardware backends up to
+// the point where the host GPU would be involved: the FIFO is decoded, the
+// vertices are loaded, the shader constants are tracked and the textures are
+// decoded, but nothing is drawn and no window is needed. This makes it a
+// baseline for benchmarking the CPU side of the emulator on machines without
+// a GPU.
+
+#include "Common/CommonPaths.h"
+#include "Common/FileUtil.h"
+
+#include "Core/Host.h"
+
+#include "VideoBackends/Null/FramebufferManager.h"
+#include "VideoBackends/Null/Render.h"
+#include "VideoBackends/Null/TextureCache.h"
+#include "VideoBackends/Null/VertexManager.h"
+#include "VideoBackends/Null/VideoBackend.h"
+
+#include "VideoCommon/BPStructs.h"
+#include "VideoCommon/CommandProcessor.h"
+#include "VideoCommon/Fifo.h"
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/MainBase.h"
+#include "VideoCommon/OnScreenDisplay.h"
+#include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/PerfQueryBase.h"
+#include "VideoCommon/PixelEngine.h"
+#include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VertexShaderManager.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace Null
+{
+
+std::string VideoBackend::GetName()
+{
+	return "Null";
+}
+
+std::string VideoBackend::GetDisplayName()
+{
+	return "Null (no rendering)";
+}
+
+static void InitBackendInfo()
+{
+	g_Config.backend_info.APIType = API_NONE;
+	g_Config.backend_info.bUseRGBATextures = true;
+	g_Config.backend_info.bUseMinimalMipCount = false;
+	g_Config.backend_info.bSupports3DVision = false;
+	g_Config.backend_info.bSupportsDualSourceBlend = true;
+	g_Config.backend_info.bSupportsFormatReinterpretation = true;
+	g_Config.backend_info.bSupportsPixelLighting = true;
+	g_Config.backend_info.bSupportsPrimitiveRestart = true;
+	g_Config.backend_info.bSupportsSeparateAlphaFunction = true;
+	g_Config.backend_info.bSupportsEarlyZ = true;
+	g_Config.backend_info.bSupportsOversizedViewports = true;
+	g_Config.backend_info.bSupportsUberShaders = false;
+
+	const char* caamodes[] = {_trans("None")};
+	g_Config.backend_info.AAModes.assign(caamodes, caamodes + sizeof(caamodes)/sizeof(*caamodes));
+	g_Config.backend_info.PPShaders.clear();
+}
+
+bool VideoBackend::Initialize(void *&window_handle)
+{
+	InitializeShared();
+	InitBackendInfo();
+
+	frameCount = 0;
+
+	g_Config.Load((File::GetUserPath(D_CONFIG_IDX) + "gfx_null.ini").c_str());
+	g_Config.GameIniLoad();
+	g_Config.UpdateProjectionHack();
+	g_Config.VerifyValidity();
+	UpdateActiveConfig();
+
+	OSD::DoCallbacks(OSD::OSD_INIT);
+
+	s_BackendInitialized = true;
+
+	return true;
+}
+
+// This is called after Initialize() from the Core
+// Run from the graphics thread
+void VideoBackend::Video_Prepare()
+{
+	g_renderer = new Renderer;
+
+	s_efbAccessRequested = false;
+	s_FifoShuttingDown = false;
+	s_swapRequested = false;
+
+	CommandProcessor::Init();
+	PixelEngine::Init();
+
+	BPInit();
+	g_vertex_manager = new VertexManager;
+	g_perf_query = new PerfQueryBase;
+	Fifo_Init(); // must be done before OpcodeDecoder_Init()
+	OpcodeDecoder_Init();
+	IndexGenerator::Init();
+	VertexShaderManager::Init();
+	PixelShaderManager::Init();
+	g_texture_cache = new TextureCache;
+	VertexLoaderManager::Init();
+
+	// Notify the core that the video backend is ready
+	Host_Message(WM_USER_CREATE);
+}
+
+void VideoBackend::Shutdown()
+{
+	s_BackendInitialized = false;
+
+	OSD::DoCallbacks(OSD::OSD_SHUTDOWN);
+}
+
+void VideoBackend::Video_Cleanup()
+{
+	if (g_renderer)
+	{
+		s_efbAccessRequested = false;
+		s_FifoShuttingDown = false;
+		s_swapRequested = false;
+		Fifo_Shutdown();
+
+		VertexLoaderManager::Shutdown();
+		delete g_texture_cache;
+		g_texture_cache = nullptr;
+		VertexShaderManager::Shutdown();
+		PixelShaderManager::Shutdown();
+		delete g_perf_query;
+		g_perf_query = nullptr;
+		delete g_vertex_manager;
+		g_vertex_manager = nullptr;
+		OpcodeDecoder_Shutdown();
+		delete g_renderer;
+		g_renderer = nullptr;
+	}
+}
+
+}
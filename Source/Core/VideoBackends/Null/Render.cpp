@@ -0,0 +1,54 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "VideoBackends/Null/FramebufferManager.h"
+#include "VideoBackends/Null/Render.h"
+
+#include "VideoCommon/TextureCacheBase.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace Null
+{
+
+Renderer::Renderer()
+{
+	// Everything is at native resolution
+	s_target_width = EFB_WIDTH;
+	s_target_height = EFB_HEIGHT;
+	s_backbuffer_width = EFB_WIDTH;
+	s_backbuffer_height = EFB_HEIGHT;
+	s_LastEFBScale = g_ActiveConfig.iEFBScale;
+	UpdateDrawRectangle(s_backbuffer_width, s_backbuffer_height);
+
+	g_framebuffer_manager = new FramebufferManager;
+}
+
+Renderer::~Renderer()
+{
+	delete g_framebuffer_manager;
+	g_framebuffer_manager = nullptr;
+}
+
+TargetRectangle Renderer::ConvertEFBRectangle(const EFBRectangle& rc)
+{
+	TargetRectangle result;
+	result.left = rc.left;
+	result.top = rc.top;
+	result.right = rc.right;
+	result.bottom = rc.bottom;
+	return result;
+}
+
+void Renderer::SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbHeight, const EFBRectangle& rc, float Gamma)
+{
+	// Nothing to present, but the caches age and the config applies per frame
+	// like with a real backend
+	TextureCache::Cleanup();
+
+	g_Config.iSaveTargetId = 0;
+	UpdateActiveConfig();
+	TextureCache::OnConfigChanged(g_ActiveConfig);
+}
+
+}
@@ -0,0 +1,51 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "VideoCommon/RenderBase.h"
+
+namespace Null
+{
+
+class Renderer : public ::Renderer
+{
+public:
+	Renderer();
+	~Renderer();
+
+	void SetColorMask() override {}
+	void SetBlendMode(bool forceUpdate) override {}
+	void SetScissorRect(const EFBRectangle& rc) override {}
+	void SetGenerationMode() override {}
+	void SetDepthMode() override {}
+	void SetLogicOpMode() override {}
+	void SetDitherMode() override {}
+	void SetLineWidth() override {}
+	void SetSamplerState(int stage, int texindex) override {}
+	void SetInterlacingMode() override {}
+	void SetViewport() override {}
+
+	void ApplyState(bool bUseDstAlpha) override {}
+	void RestoreState() override {}
+
+	void RenderText(const char* pstr, int left, int top, u32 color) override {}
+
+	void ClearScreen(const EFBRectangle& rc, bool colorEnable, bool alphaEnable, bool zEnable, u32 color, u32 z) override {}
+	void ReinterpretPixelData(unsigned int convtype) override {}
+
+	// There is no EFB to read from
+	u32 AccessEFB(EFBAccessType type, u32 x, u32 y, u32 poke_data) override { return 0; }
+
+	void ResetAPIState() override {}
+	void RestoreAPIState() override {}
+
+	TargetRectangle ConvertEFBRectangle(const EFBRectangle& rc) override;
+
+	void SwapImpl(u32 xfbAddr, u32 fbWidth, u32 fbHeight, const EFBRectangle& rc, float Gamma) override;
+
+	bool SaveScreenshot(const std::string& filename, const TargetRectangle& rc) override { return false; }
+};
+
+}
@@ -0,0 +1,43 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "VideoCommon/TextureCacheBase.h"
+
+namespace Null
+{
+
+// Textures are still decoded and hashed by the common code, the entries just
+// don't upload them anywhere.
+class TextureCache : public ::TextureCache
+{
+private:
+	struct TCacheEntry : TCacheEntryBase
+	{
+		void Load(unsigned int width, unsigned int height,
+			unsigned int expanded_width, unsigned int level) override {}
+
+		void FromRenderTarget(u32 dstAddr, unsigned int dstFormat,
+			unsigned int srcFormat, const EFBRectangle& srcRect,
+			bool isIntensity, bool scaleByHalf, unsigned int cbufid,
+			const float *colmat) override {}
+
+		void Bind(unsigned int stage) override {}
+		bool Save(const std::string& filename, unsigned int level) override { return false; }
+	};
+
+	TCacheEntryBase* CreateTexture(unsigned int width, unsigned int height,
+		unsigned int expanded_width, unsigned int tex_levels, PC_TexFormat pcfmt) override
+	{
+		return new TCacheEntry;
+	}
+
+	TCacheEntryBase* CreateRenderTargetTexture(unsigned int scaled_tex_w, unsigned int scaled_tex_h) override
+	{
+		return new TCacheEntry;
+	}
+};
+
+}
@@ -0,0 +1,49 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include "VideoBackends/Null/VertexManager.h"
+
+#include "VideoCommon/IndexGenerator.h"
+#include "VideoCommon/PixelShaderManager.h"
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/VertexShaderManager.h"
+
+namespace Null
+{
+
+VertexManager::VertexManager()
+	: m_vertex_buffer(MAXVBUFFERSIZE)
+	, m_index_buffer(MAXIBUFFERSIZE)
+{
+}
+
+VertexManager::~VertexManager()
+{
+}
+
+NativeVertexFormat* VertexManager::CreateNativeVertexFormat()
+{
+	return new NullNativeVertexFormat;
+}
+
+void VertexManager::ResetBuffer(u32 stride)
+{
+	s_pCurBufferPointer = s_pBaseBufferPointer = m_vertex_buffer.data();
+	s_pEndBufferPointer = s_pBaseBufferPointer + m_vertex_buffer.size();
+	IndexGenerator::Start(m_index_buffer.data());
+}
+
+void VertexManager::vFlush(bool useDstAlpha)
+{
+	// The constants count as uploaded, so the dirty tracking stays as cheap
+	// as with a real backend
+	PixelShaderManager::dirty = false;
+	VertexShaderManager::dirty = false;
+	PixelShaderManager::dirty_regs.Clear();
+	VertexShaderManager::dirty_regs.Clear();
+
+	INCSTAT(stats.thisFrame.numIndexedDrawCalls);
+}
+
+}
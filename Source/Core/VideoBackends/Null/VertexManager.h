@@ -0,0 +1,42 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <vector>
+
+#include "VideoCommon/NativeVertexFormat.h"
+#include "VideoCommon/VertexManagerBase.h"
+
+namespace Null
+{
+
+class NullNativeVertexFormat : public NativeVertexFormat
+{
+public:
+	void Initialize(const PortableVertexDeclaration &vtx_decl) override { vertex_stride = vtx_decl.stride; }
+	void SetupVertexPointers() override {}
+};
+
+// The vertex loaders write to buffers in system memory, which flushing then
+// throws away.
+class VertexManager : public ::VertexManager
+{
+public:
+	VertexManager();
+	~VertexManager();
+
+	NativeVertexFormat* CreateNativeVertexFormat() override;
+
+protected:
+	void ResetBuffer(u32 stride) override;
+
+private:
+	void vFlush(bool useDstAlpha) override;
+
+	std::vector<u8> m_vertex_buffer;
+	std::vector<u32> m_index_buffer;
+};
+
+}
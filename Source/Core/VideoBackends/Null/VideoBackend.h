@@ -0,0 +1,26 @@
+#pragma once
+
+#include "VideoCommon/VideoBackendBase.h"
+
+namespace Null
+{
+
+// Decodes the FIFO and keeps all the GPU state like the hardware backends,
+// but never draws anything. For measuring the rest of the emulator on hosts
+// without a GPU.
+class VideoBackend : public VideoBackendHardware
+{
+	bool Initialize(void *&) override;
+	void Shutdown() override;
+
+	std::string GetName() override;
+	std::string GetDisplayName() override;
+
+	void Video_Prepare() override;
+	void Video_Cleanup() override;
+
+	void UpdateFPSDisplay(const char*) override {}
+	unsigned int PeekMessages() override { return true; }
+};
+
+}
@@ -637,6 +637,9 @@ PFNGLFRAMEBUFFERTEXTUREPROC glFramebufferTexture;
 PFNGLGETBUFFERPARAMETERI64VPROC glGetBufferParameteri64v;
 PFNGLGETINTEGER64I_VPROC glGetInteger64i_v;
 
+// ARB_copy_buffer
+PFNGLCOPYBUFFERSUBDATAPROC glCopyBufferSubData;
+
 // ARB_uniform_buffer_object
 PFNGLBINDBUFFERBASEPROC glBindBufferBase;
 PFNGLBINDBUFFERRANGEPROC glBindBufferRange;
@@ -750,6 +753,9 @@ PFNGLRENDERBUFFERSTORAGEMULTISAMPLECOVERAGENVPROC glRenderbufferStorageMultisamp
 // ARB_sample_shading
 PFNGLMINSAMPLESHADINGARBPROC glMinSampleShadingARB;
 
+// ARB_parallel_shader_compile
+PFNGLMAXSHADERCOMPILERTHREADSARBPROC glMaxShaderCompilerThreadsARB;
+
 // ARB_debug_output
 PFNGLDEBUGMESSAGECALLBACKARBPROC glDebugMessageCallbackARB;
 PFNGLDEBUGMESSAGECONTROLARBPROC glDebugMessageControlARB;
@@ -1413,6 +1419,9 @@ const GLFunc gl_function_array[] =
 	GLFUNC_REQUIRES(glGetBufferParameteri64v, "VERSION_3_2"),
 	GLFUNC_REQUIRES(glGetInteger64i_v,        "VERSION_3_2"),
 
+	// ARB_copy_buffer
+	GLFUNC_REQUIRES(glCopyBufferSubData, "GL_ARB_copy_buffer"),
+
 	// ARB_uniform_buffer_object
 	GLFUNC_REQUIRES(glBindBufferBase,            "GL_ARB_uniform_buffer_object"),
 	GLFUNC_REQUIRES(glBindBufferRange,           "GL_ARB_uniform_buffer_object"),
@@ -1532,6 +1541,9 @@ const GLFunc gl_function_array[] =
 	// ARB_sample_shading
 	GLFUNC_REQUIRES(glMinSampleShadingARB, "GL_ARB_sample_shading"),
 
+	// ARB_parallel_shader_compile
+	GLFUNC_REQUIRES(glMaxShaderCompilerThreadsARB, "GL_ARB_parallel_shader_compile"),
+
 	// ARB_debug_output
 	GLFUNC_REQUIRES(glDebugMessageCallbackARB, "GL_ARB_debug_output"),
 	GLFUNC_REQUIRES(glDebugMessageControlARB,  "GL_ARB_debug_output"),
@@ -1595,6 +1607,7 @@ namespace GLExtensions
 			// XXX: Add all extensions that a base ES3 implementation supports
 			std::string gles3exts[] = {
 				"GL_ARB_uniform_buffer_object",
+				"GL_ARB_copy_buffer",
 				"GL_ARB_sampler_objects",
 				"GL_ARB_map_buffer_range",
 				"GL_ARB_vertex_array_object",
@@ -8,12 +8,14 @@
 
 #include "VideoBackends/OGL/GLExtensions/ARB_blend_func_extended.h"
 #include "VideoBackends/OGL/GLExtensions/ARB_buffer_storage.h"
+#include "VideoBackends/OGL/GLExtensions/ARB_copy_buffer.h"
 #include "VideoBackends/OGL/GLExtensions/ARB_debug_output.h"
 #include "VideoBackends/OGL/GLExtensions/ARB_draw_elements_base_vertex.h"
 #include "VideoBackends/OGL/GLExtensions/ARB_ES2_compatibility.h"
 #include "VideoBackends/OGL/GLExtensions/ARB_framebuffer_object.h"
 #include "VideoBackends/OGL/GLExtensions/ARB_get_program_binary.h"
 #include "VideoBackends/OGL/GLExtensions/ARB_map_buffer_range.h"
+#include "VideoBackends/OGL/GLExtensions/ARB_parallel_shader_compile.h"
 #include "VideoBackends/OGL/GLExtensions/ARB_sample_shading.h"
 #include "VideoBackends/OGL/GLExtensions/ARB_sampler_objects.h"
 #include "VideoBackends/OGL/GLExtensions/ARB_sync.h"
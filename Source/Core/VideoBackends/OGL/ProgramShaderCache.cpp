@@ -24,13 +24,33 @@ u32 ProgramShaderCache::s_ubo_buffer_size;
 s32 ProgramShaderCache::s_ubo_align;
 
 static StreamBuffer *s_buffer;
+
+// With GL_ARB_copy_buffer, both constant blocks live in a persistent buffer. Only the dirty
+// registers are streamed and then copied into place on the gpu.
+static GLuint s_ubo;
+struct UBOCopy
+{
+	u32 src, dst, size;
+};
+static std::vector<UBOCopy> s_ubo_copies;
+
+// Dirty ranges with fewer clean registers in between are copied at once, every copy has some overhead.
+static const size_t UBO_MERGE_GAP = 4;
+// If there are more ranges, the whole blocks are copied instead.
+static const size_t UBO_MAX_COPIES = 16;
+
 static int num_failures = 0;
 
 LinearDiskCache<SHADERUID, u8> g_program_disk_cache;
+static LinearDiskCache<SHADERUID, char> s_program_source_cache;
+static bool s_source_cache_open = false;
 static GLuint CurrentProgram = 0;
 ProgramShaderCache::PCache ProgramShaderCache::pshaders;
 ProgramShaderCache::PCacheEntry* ProgramShaderCache::last_entry;
 SHADERUID ProgramShaderCache::last_uid;
+ProgramShaderCache::PendingMap ProgramShaderCache::pending_shaders;
+ProgramShaderCache::UberPCache ProgramShaderCache::ubershaders;
+std::map<UberPixelShaderUid, GLuint> ProgramShaderCache::uber_pixel_shaders;
 UidChecker<PixelShaderUid,PixelShaderCode> ProgramShaderCache::pixel_uid_checker;
 UidChecker<VertexShaderUid,VertexShaderCode> ProgramShaderCache::vertex_uid_checker;
 
@@ -105,29 +125,84 @@ void SHADER::Bind()
 	}
 }
 
+template <typename T>
+static void AddDirtyRanges(const ConstantDirtyTracker<T>& regs, u32 base)
+{
+	regs.ForEachRange([base](size_t first, size_t count) {
+		UBOCopy copy = { 0, base + (u32)(first * sizeof(float4)), (u32)(count * sizeof(float4)) };
+		s_ubo_copies.push_back(copy);
+	}, UBO_MERGE_GAP);
+}
+
 void ProgramShaderCache::UploadConstants()
 {
-	if(PixelShaderManager::dirty || VertexShaderManager::dirty)
+	if(!PixelShaderManager::dirty && !VertexShaderManager::dirty)
+		return;
+
+	const u32 vs_offset = ROUND_UP(sizeof(PixelShaderConstants), s_ubo_align);
+
+	if (!s_ubo)
 	{
 		auto buffer = s_buffer->Map(s_ubo_buffer_size, s_ubo_align);
 
 		memcpy(buffer.first,
 			&PixelShaderManager::constants, sizeof(PixelShaderConstants));
 
-		memcpy(buffer.first + ROUND_UP(sizeof(PixelShaderConstants), s_ubo_align),
+		memcpy(buffer.first + vs_offset,
 			&VertexShaderManager::constants, sizeof(VertexShaderConstants));
 
 		s_buffer->Unmap(s_ubo_buffer_size);
 		glBindBufferRange(GL_UNIFORM_BUFFER, 1, s_buffer->m_buffer, buffer.second,
 					sizeof(PixelShaderConstants));
-		glBindBufferRange(GL_UNIFORM_BUFFER, 2, s_buffer->m_buffer, buffer.second + ROUND_UP(sizeof(PixelShaderConstants), s_ubo_align),
+		glBindBufferRange(GL_UNIFORM_BUFFER, 2, s_buffer->m_buffer, buffer.second + vs_offset,
 					sizeof(VertexShaderConstants));
 
-		PixelShaderManager::dirty = false;
-		VertexShaderManager::dirty = false;
-
 		ADDSTAT(stats.thisFrame.bytesUniformStreamed, s_ubo_buffer_size);
+		ADDSTAT(stats.thisFrame.numUniformRanges, 2);
+	}
+	else
+	{
+		s_ubo_copies.clear();
+		AddDirtyRanges(PixelShaderManager::dirty_regs, 0);
+		AddDirtyRanges(VertexShaderManager::dirty_regs, vs_offset);
+		if (s_ubo_copies.size() > UBO_MAX_COPIES)
+		{
+			s_ubo_copies.clear();
+			UBOCopy ps = { 0, 0, sizeof(PixelShaderConstants) };
+			UBOCopy vs = { 0, vs_offset, sizeof(VertexShaderConstants) };
+			s_ubo_copies.push_back(ps);
+			s_ubo_copies.push_back(vs);
+		}
+
+		// pack the dirty ranges into the stream buffer
+		auto buffer = s_buffer->Map(s_ubo_buffer_size, s_ubo_align);
+		u32 used = 0;
+		for (UBOCopy& copy : s_ubo_copies)
+		{
+			const u8* src = copy.dst < vs_offset ?
+				(const u8*)&PixelShaderManager::constants + copy.dst :
+				(const u8*)&VertexShaderManager::constants + (copy.dst - vs_offset);
+			memcpy(buffer.first + used, src, copy.size);
+			copy.src = (u32)buffer.second + used;
+			used += copy.size;
+		}
+		s_buffer->Unmap(used);
+
+		glBindBuffer(GL_COPY_READ_BUFFER, s_buffer->m_buffer);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, s_ubo);
+		for (const UBOCopy& copy : s_ubo_copies)
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, copy.src, copy.dst, copy.size);
+
+		ADDSTAT(stats.thisFrame.bytesUniformStreamed, used);
+		ADDSTAT(stats.thisFrame.numUniformRanges, (int)s_ubo_copies.size());
 	}
+
+	PixelShaderManager::dirty = false;
+	VertexShaderManager::dirty = false;
+	PixelShaderManager::dirty_regs.Clear();
+	VertexShaderManager::dirty_regs.Clear();
+
+	INCSTAT(stats.thisFrame.numUniformUploads);
 }
 
 GLuint ProgramShaderCache::GetCurrentProgram(void)
@@ -137,6 +212,9 @@ GLuint ProgramShaderCache::GetCurrentProgram(void)
 
 SHADER* ProgramShaderCache::SetShader ( DSTALPHA_MODE dstAlphaMode, u32 components )
 {
+	if (g_ActiveConfig.bUberShaders && CanUseUberPixelShader())
+		return SetUberShader(dstAlphaMode, components);
+
 	SHADERUID uid;
 	GetShaderId(&uid, dstAlphaMode, components);
 
@@ -145,9 +223,7 @@ SHADER* ProgramShaderCache::SetShader ( DSTALPHA_MODE dstAlphaMode, u32 componen
 	{
 		if (uid == last_uid)
 		{
-			GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
-			last_entry->shader.Bind();
-			return &last_entry->shader;
+			return BindShader(uid, *last_entry, dstAlphaMode, components);
 		}
 	}
 
@@ -157,18 +233,15 @@ SHADER* ProgramShaderCache::SetShader ( DSTALPHA_MODE dstAlphaMode, u32 componen
 	PCache::iterator iter = pshaders.find(uid);
 	if (iter != pshaders.end())
 	{
-		PCacheEntry *entry = &iter->second;
-		last_entry = entry;
-
-		GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
-		last_entry->shader.Bind();
-		return &last_entry->shader;
+		last_entry = &iter->second;
+		return BindShader(uid, *last_entry, dstAlphaMode, components);
 	}
 
 	// Make an entry in the table
 	PCacheEntry& newentry = pshaders[uid];
 	last_entry = &newentry;
 	newentry.in_cache = 0;
+	newentry.pending = false;
 
 	VertexShaderCode vcode;
 	PixelShaderCode pcode;
@@ -192,23 +265,166 @@ SHADER* ProgramShaderCache::SetShader ( DSTALPHA_MODE dstAlphaMode, u32 componen
 	}
 #endif
 
-	if (!CompileShader(newentry.shader, vcode.GetBuffer(), pcode.GetBuffer())) {
-		GFX_DEBUGGER_PAUSE_AT(NEXT_ERROR, true);
-		return NULL;
+	if (s_source_cache_open)
+		LogShaderSource(uid, vcode.GetBuffer(), pcode.GetBuffer());
+
+	if (g_ActiveConfig.bAsyncShaderCompilation)
+	{
+		// Let the driver compile in the background, draws using this program
+		// fall back to the uber shader until it's linked
+		QueueShader(uid, newentry, vcode.GetBuffer(), pcode.GetBuffer());
+		if (!newentry.pending)
+		{
+			// Don't leave an entry without a program behind for later lookups to bind
+			EraseShader(uid);
+			GFX_DEBUGGER_PAUSE_AT(NEXT_ERROR, true);
+			return NULL;
+		}
+
+		INCSTAT(stats.numPixelShadersCreated);
+		SETSTAT(stats.numPixelShadersAlive, pshaders.size());
+
+		return BindShader(uid, newentry, dstAlphaMode, components);
+	}
+	else
+	{
+		if (!CompileShader(newentry.shader, vcode.GetBuffer(), pcode.GetBuffer())) {
+			GFX_DEBUGGER_PAUSE_AT(NEXT_ERROR, true);
+			return NULL;
+		}
+
+		INCSTAT(stats.numPixelShadersCreated);
+		SETSTAT(stats.numPixelShadersAlive, pshaders.size());
 	}
 
-	INCSTAT(stats.numPixelShadersCreated);
-	SETSTAT(stats.numPixelShadersAlive, pshaders.size());
 	GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
 
 	last_entry->shader.Bind();
 	return &last_entry->shader;
 }
 
+SHADER* ProgramShaderCache::SetUberShader ( DSTALPHA_MODE dstAlphaMode, u32 components )
+{
+	UBERSHADERUID uid;
+	GetUberPixelShaderUid(uid.puid, dstAlphaMode);
+	GetVertexShaderUid(uid.vuid, components, API_OPENGL);
+
+	UberPCache::iterator iter = ubershaders.find(uid);
+	if (iter != ubershaders.end())
+	{
+		if (!iter->second.shader.glprogid)
+			return NULL;
+
+		iter->second.shader.Bind();
+		return &iter->second.shader;
+	}
+
+	PCacheEntry& newentry = ubershaders[uid];
+	newentry.in_cache = false;
+	newentry.pending = false;
+
+	VertexShaderCode vcode;
+	PixelShaderCode pcode;
+	GenerateVertexShaderCode(vcode, components, API_OPENGL);
+	GenerateUberPixelShaderCode(pcode, dstAlphaMode);
+
+	if (g_ActiveConfig.bEnableShaderDebugging)
+	{
+		newentry.shader.strvprog = vcode.GetBuffer();
+		newentry.shader.strpprog = pcode.GetBuffer();
+	}
+
+	// The fragment shader is the expensive part, so only compile it once per uber uid
+	GLuint& psid = uber_pixel_shaders[uid.puid];
+	if (!psid)
+		psid = CompileSingleShader(GL_FRAGMENT_SHADER, pcode.GetBuffer());
+
+	GLuint vsid = CompileSingleShader(GL_VERTEX_SHADER, vcode.GetBuffer());
+	if (!vsid || !psid)
+	{
+		glDeleteShader(vsid);
+		return NULL;
+	}
+
+	LinkProgram(newentry.shader, vsid, psid);
+	glDeleteShader(vsid);
+
+	if (!FinishCompileShader(newentry.shader, vcode.GetBuffer(), pcode.GetBuffer()))
+		return NULL;
+
+	INCSTAT(stats.numPixelShadersCreated);
+
+	newentry.shader.Bind();
+	return &newentry.shader;
+}
+
+SHADER* ProgramShaderCache::GetFallbackShader ( DSTALPHA_MODE dstAlphaMode, u32 components )
+{
+	if (!CanUseUberPixelShader())
+		return NULL;
+
+	return SetUberShader(dstAlphaMode, components);
+}
+
+SHADER* ProgramShaderCache::BindShader ( const SHADERUID& uid, PCacheEntry& entry, DSTALPHA_MODE dstAlphaMode, u32 components )
+{
+	if (entry.pending)
+	{
+		bool ready = false;
+		if (g_ActiveConfig.bAsyncShaderCompilation)
+		{
+			ready = IsShaderReady(uid, entry, false);
+			if (!ready && entry.pending)
+			{
+				SHADER* fallback = GetFallbackShader(dstAlphaMode, components);
+				if (fallback)
+					return fallback;
+			}
+		}
+
+		// Without a fallback, wait for the driver rather than dropping the draw
+		if (entry.pending)
+			ready = IsShaderReady(uid, entry, true);
+
+		if (!ready)
+		{
+			EraseShader(uid);
+			GFX_DEBUGGER_PAUSE_AT(NEXT_ERROR, true);
+			return NULL;
+		}
+	}
+
+	GFX_DEBUGGER_PAUSE_AT(NEXT_PIXEL_SHADER_CHANGE, true);
+	entry.shader.Bind();
+	return &entry.shader;
+}
+
+void ProgramShaderCache::EraseShader ( const SHADERUID& uid )
+{
+	PCache::iterator iter = pshaders.find(uid);
+	if (iter == pshaders.end())
+		return;
+
+	if (last_entry == &iter->second)
+		last_entry = NULL;
+
+	iter->second.Destroy();
+	pshaders.erase(iter);
+	SETSTAT(stats.numPixelShadersAlive, pshaders.size());
+}
+
 bool ProgramShaderCache::CompileShader ( SHADER& shader, const char* vcode, const char* pcode )
 {
-	GLuint vsid = CompileSingleShader(GL_VERTEX_SHADER, vcode);
-	GLuint psid = CompileSingleShader(GL_FRAGMENT_SHADER, pcode);
+	if (!StartCompileShader(shader, vcode, pcode, true))
+		return false;
+
+	return FinishCompileShader(shader, vcode, pcode);
+}
+
+bool ProgramShaderCache::StartCompileShader ( SHADER& shader, const char* vcode, const char* pcode, bool check_status )
+{
+	GLuint vsid = CompileSingleShader(GL_VERTEX_SHADER, vcode, check_status);
+	GLuint psid = CompileSingleShader(GL_FRAGMENT_SHADER, pcode, check_status);
 
 	if(!vsid || !psid)
 	{
@@ -217,7 +433,18 @@ bool ProgramShaderCache::CompileShader ( SHADER& shader, const char* vcode, cons
 		return false;
 	}
 
-	GLuint pid = shader.glprogid = glCreateProgram();;
+	LinkProgram(shader, vsid, psid);
+
+	// original shaders aren't needed any more
+	glDeleteShader(vsid);
+	glDeleteShader(psid);
+
+	return true;
+}
+
+void ProgramShaderCache::LinkProgram ( SHADER& shader, GLuint vsid, GLuint psid )
+{
+	GLuint pid = shader.glprogid = glCreateProgram();
 
 	glAttachShader(pid, vsid);
 	glAttachShader(pid, psid);
@@ -228,10 +455,11 @@ bool ProgramShaderCache::CompileShader ( SHADER& shader, const char* vcode, cons
 	shader.SetProgramBindings();
 
 	glLinkProgram(pid);
+}
 
-	// original shaders aren't needed any more
-	glDeleteShader(vsid);
-	glDeleteShader(psid);
+bool ProgramShaderCache::FinishCompileShader ( SHADER& shader, const char* vcode, const char* pcode )
+{
+	GLuint pid = shader.glprogid;
 
 	GLint linkStatus;
 	glGetProgramiv(pid, GL_LINK_STATUS, &linkStatus);
@@ -267,6 +495,7 @@ bool ProgramShaderCache::CompileShader ( SHADER& shader, const char* vcode, cons
 
 		// Don't try to use this shader
 		glDeleteProgram(pid);
+		shader.glprogid = 0;
 		return false;
 	}
 
@@ -275,7 +504,7 @@ bool ProgramShaderCache::CompileShader ( SHADER& shader, const char* vcode, cons
 	return true;
 }
 
-GLuint ProgramShaderCache::CompileSingleShader (GLuint type, const char* code )
+GLuint ProgramShaderCache::CompileSingleShader (GLuint type, const char* code, bool check_status )
 {
 	GLuint result = glCreateShader(type);
 
@@ -283,6 +512,12 @@ GLuint ProgramShaderCache::CompileSingleShader (GLuint type, const char* code )
 
 	glShaderSource(result, 2, src, NULL);
 	glCompileShader(result);
+
+	// Querying the compile status would wait for the compiler,
+	// errors will show up in the program info log instead.
+	if (!check_status)
+		return result;
+
 	GLint compileStatus;
 	glGetShaderiv(result, GL_COMPILE_STATUS, &compileStatus);
 	GLsizei length = 0;
@@ -354,6 +589,55 @@ ProgramShaderCache::PCacheEntry ProgramShaderCache::GetShaderProgram(void)
 	return *last_entry;
 }
 
+void ProgramShaderCache::QueueShader(const SHADERUID& uid, PCacheEntry& entry, const std::string& vcode, const std::string& pcode)
+{
+	if (!StartCompileShader(entry.shader, vcode.c_str(), pcode.c_str(), false))
+		return;
+
+	PendingProgram& pending = pending_shaders[uid];
+	pending.vcode = vcode;
+	pending.pcode = pcode;
+	pending.submit_frame = frameCount;
+	entry.pending = true;
+}
+
+bool ProgramShaderCache::IsShaderReady(const SHADERUID& uid, PCacheEntry& entry, bool wait)
+{
+	PendingMap::iterator iter = pending_shaders.find(uid);
+
+	if (!wait)
+	{
+		if (g_ogl_config.bSupportsParallelShaderCompile)
+		{
+			GLint complete = GL_FALSE;
+			glGetProgramiv(entry.shader.glprogid, GL_COMPLETION_STATUS_ARB, &complete);
+			if (complete != GL_TRUE)
+				return false;
+		}
+		else if (iter->second.submit_frame == frameCount)
+		{
+			// Every status query blocks without the extension,
+			// so give the driver's compiler thread until the next frame.
+			return false;
+		}
+	}
+
+	bool success = FinishCompileShader(entry.shader, iter->second.vcode.c_str(), iter->second.pcode.c_str());
+	pending_shaders.erase(iter);
+	entry.pending = false;
+	return success;
+}
+
+void ProgramShaderCache::LogShaderSource(const SHADERUID& uid, const char* vcode, const char* pcode)
+{
+	// Stored as "vcode\0pcode\0" so that the next session can compile it before the game starts
+	std::string data(vcode);
+	data.push_back('\0');
+	data += pcode;
+
+	s_program_source_cache.Append(uid, data.c_str(), (u32)data.size() + 1);
+}
+
 void ProgramShaderCache::Init(void)
 {
 	// We have to get the UBO alignment here because
@@ -368,6 +652,25 @@ void ProgramShaderCache::Init(void)
 	// Then once more to get bytes
 	s_buffer = StreamBuffer::Create(GL_UNIFORM_BUFFER, UBO_LENGTH);
 
+	if (g_ogl_config.bSupportsCopyBuffer)
+	{
+		glGenBuffers(1, &s_ubo);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, s_ubo);
+		glBufferData(GL_COPY_WRITE_BUFFER, s_ubo_buffer_size, nullptr, GL_DYNAMIC_DRAW);
+		glBindBufferRange(GL_UNIFORM_BUFFER, 1, s_ubo, 0, sizeof(PixelShaderConstants));
+		glBindBufferRange(GL_UNIFORM_BUFFER, 2, s_ubo, ROUND_UP(sizeof(PixelShaderConstants), s_ubo_align),
+					sizeof(VertexShaderConstants));
+
+		// glBindBufferRange also changed the generic binding, but the stream buffer expects its own one
+		glBindBuffer(GL_UNIFORM_BUFFER, s_buffer->m_buffer);
+
+		// the new buffer is undefined, so everything has to be uploaded once
+		PixelShaderManager::dirty_regs.SetAll();
+		PixelShaderManager::dirty = true;
+		VertexShaderManager::dirty_regs.SetAll();
+		VertexShaderManager::dirty = true;
+	}
+
 	// Read our shader cache, only if supported
 	if (g_ogl_config.bSupportsGLSLCache && !g_Config.bEnableShaderDebugging)
 	{
@@ -395,19 +698,62 @@ void ProgramShaderCache::Init(void)
 
 	CreateHeader();
 
+	// Read the sources of all programs seen in earlier sessions and compile the ones
+	// which aren't in the binary cache, so async mode doesn't have to skip draws for them
+	if (g_ActiveConfig.bAsyncShaderCompilation && !g_Config.bEnableShaderDebugging)
+	{
+		if (g_ogl_config.bSupportsParallelShaderCompile)
+			glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+
+		if (!File::Exists(File::GetUserPath(D_SHADERCACHE_IDX)))
+			File::CreateDir(File::GetUserPath(D_SHADERCACHE_IDX).c_str());
+
+		char cache_filename[MAX_PATH];
+		sprintf(cache_filename, "%sogl-%s-sources.cache", File::GetUserPath(D_SHADERCACHE_IDX).c_str(),
+			SConfig::GetInstance().m_LocalCoreStartupParameter.m_strUniqueID.c_str());
+
+		ProgramSourceCacheInserter inserter;
+		s_program_source_cache.OpenAndRead(cache_filename, inserter);
+		s_source_cache_open = true;
+
+		// All programs have been submitted before waiting on the first one,
+		// so the driver is free to link them in parallel.
+		while (!pending_shaders.empty())
+		{
+			SHADERUID uid = pending_shaders.begin()->first;
+			if (!IsShaderReady(uid, pshaders[uid], true))
+				EraseShader(uid);
+		}
+		SETSTAT(stats.numPixelShadersAlive, pshaders.size());
+	}
+
 	CurrentProgram = 0;
 	last_entry = NULL;
 }
 
 void ProgramShaderCache::Shutdown(void)
 {
+	// finish all programs which are still being compiled
+	while (!pending_shaders.empty())
+	{
+		SHADERUID uid = pending_shaders.begin()->first;
+		IsShaderReady(uid, pshaders[uid], true);
+	}
+
+	if (s_source_cache_open)
+	{
+		s_program_source_cache.Sync();
+		s_program_source_cache.Close();
+		s_source_cache_open = false;
+	}
+
 	// store all shaders in cache on disk
 	if (g_ogl_config.bSupportsGLSLCache && !g_Config.bEnableShaderDebugging)
 	{
 		PCache::iterator iter = pshaders.begin();
 		for (; iter != pshaders.end(); ++iter)
 		{
-			if(iter->second.in_cache) continue;
+			if(iter->second.in_cache || !iter->second.shader.glprogid) continue;
 
 			GLint binary_size;
 			glGetProgramiv(iter->second.shader.glprogid, GL_PROGRAM_BINARY_LENGTH, &binary_size);
@@ -433,11 +779,26 @@ void ProgramShaderCache::Shutdown(void)
 		iter->second.Destroy();
 	pshaders.clear();
 
+	for (auto& entry : ubershaders)
+		entry.second.Destroy();
+	ubershaders.clear();
+
+	for (auto& entry : uber_pixel_shaders)
+		glDeleteShader(entry.second);
+	uber_pixel_shaders.clear();
+
 	pixel_uid_checker.Invalidate();
 	vertex_uid_checker.Invalidate();
 
 	delete s_buffer;
 	s_buffer = 0;
+
+	if (s_ubo)
+	{
+		glDeleteBuffers(1, &s_ubo);
+		s_ubo = 0;
+	}
+	s_ubo_copies.clear();
 }
 
 void ProgramShaderCache::CreateHeader ( void )
@@ -489,6 +850,7 @@ void ProgramShaderCache::ProgramShaderCacheInserter::Read ( const SHADERUID& key
 
 	PCacheEntry entry;
 	entry.in_cache = 1;
+	entry.pending = false;
 	entry.shader.glprogid = glCreateProgram();
 	glProgramBinary(entry.shader.glprogid, *prog_format, binary, binary_size);
 
@@ -505,4 +867,24 @@ void ProgramShaderCache::ProgramShaderCacheInserter::Read ( const SHADERUID& key
 }
 
 
+void ProgramShaderCache::ProgramSourceCacheInserter::Read ( const SHADERUID& key, const char* value, u32 value_size )
+{
+	// Programs loaded from the binary cache don't need to be compiled again
+	if (pshaders.find(key) != pshaders.end())
+		return;
+
+	if (!value_size || value[value_size - 1] != '\0')
+		return;
+
+	std::string vcode(value);
+	if (vcode.size() + 1 >= value_size)
+		return;
+	std::string pcode(value + vcode.size() + 1);
+
+	PCacheEntry& entry = pshaders[key];
+	entry.in_cache = 0;
+	entry.pending = false;
+	QueueShader(key, entry, vcode, pcode);
+}
+
 } // namespace OGL
@@ -8,6 +8,7 @@
 #include "Core/ConfigManager.h"
 #include "VideoBackends/OGL/GLUtil.h"
 #include "VideoCommon/PixelShaderGen.h"
+#include "VideoCommon/UberShaderPixel.h"
 #include "VideoCommon/VertexShaderGen.h"
 
 namespace OGL
@@ -37,6 +38,30 @@ public:
 	}
 };
 
+class UBERSHADERUID
+{
+public:
+	VertexShaderUid vuid;
+	UberPixelShaderUid puid;
+
+	UBERSHADERUID() {}
+
+	UBERSHADERUID(const UBERSHADERUID& r) : vuid(r.vuid), puid(r.puid) {}
+
+	bool operator <(const UBERSHADERUID& r) const
+	{
+		if(puid < r.puid) return true;
+		if(r.puid < puid) return false;
+		if(vuid < r.vuid) return true;
+		return false;
+	}
+
+	bool operator ==(const UBERSHADERUID& r) const
+	{
+		return puid == r.puid && vuid == r.vuid;
+	}
+};
+
 
 const int NUM_UNIFORMS = 19;
 extern const char *UniformNames[NUM_UNIFORMS];
@@ -68,6 +93,7 @@ public:
 	{
 		SHADER shader;
 		bool in_cache;
+		bool pending; // linked asynchronously, link status not queried yet
 
 		void Destroy()
 		{
@@ -76,14 +102,21 @@ public:
 	};
 
 	typedef std::map<SHADERUID, PCacheEntry> PCache;
+	typedef std::map<UBERSHADERUID, PCacheEntry> UberPCache;
 
 	static PCacheEntry GetShaderProgram(void);
 	static GLuint GetCurrentProgram(void);
 	static SHADER* SetShader(DSTALPHA_MODE dstAlphaMode, u32 components);
+	static SHADER* SetUberShader(DSTALPHA_MODE dstAlphaMode, u32 components);
 	static void GetShaderId(SHADERUID *uid, DSTALPHA_MODE dstAlphaMode, u32 components);
 
 	static bool CompileShader(SHADER &shader, const char* vcode, const char* pcode);
-	static GLuint CompileSingleShader(GLuint type, const char *code);
+	static GLuint CompileSingleShader(GLuint type, const char *code, bool check_status = true);
+
+	// Async compilation: Start submits the program to the driver without waiting for it,
+	// Finish queries the link status (blocking if the driver isn't done yet).
+	static bool StartCompileShader(SHADER &shader, const char* vcode, const char* pcode, bool check_status);
+	static bool FinishCompileShader(SHADER &shader, const char* vcode, const char* pcode);
 	static void UploadConstants();
 
 	static void Init(void);
@@ -97,10 +130,43 @@ private:
 		void Read(const SHADERUID &key, const u8 *value, u32 value_size) override;
 	};
 
+	// Reads the shader sources logged in previous sessions and queues them for compilation
+	class ProgramSourceCacheInserter : public LinearDiskCacheReader<SHADERUID, char>
+	{
+	public:
+		void Read(const SHADERUID &key, const char *value, u32 value_size) override;
+	};
+
+	struct PendingProgram
+	{
+		std::string vcode, pcode;
+		int submit_frame;
+	};
+	typedef std::map<SHADERUID, PendingProgram> PendingMap;
+
+	static void LinkProgram(SHADER &shader, GLuint vsid, GLuint psid);
+
+	// Used instead of a specialized program which isn't linked yet, NULL if the uber shader can't be used
+	static SHADER* GetFallbackShader(DSTALPHA_MODE dstAlphaMode, u32 components);
+
+	// Binds entry, or its fallback while it's still being compiled. Failed programs are removed from the cache
+	static SHADER* BindShader(const SHADERUID& uid, PCacheEntry& entry, DSTALPHA_MODE dstAlphaMode, u32 components);
+	static void EraseShader(const SHADERUID& uid);
+
+	static void QueueShader(const SHADERUID& uid, PCacheEntry& entry, const std::string& vcode, const std::string& pcode);
+	static bool IsShaderReady(const SHADERUID& uid, PCacheEntry& entry, bool wait);
+	static void LogShaderSource(const SHADERUID& uid, const char* vcode, const char* pcode);
+
+	static PendingMap pending_shaders;
+
 	static PCache pshaders;
 	static PCacheEntry* last_entry;
 	static SHADERUID last_uid;
 
+	static UberPCache ubershaders;
+	// compiled uber fragment shaders, linked against every vertex shader
+	static std::map<UberPixelShaderUid, GLuint> uber_pixel_shaders;
+
 	static UidChecker<PixelShaderUid,PixelShaderCode> pixel_uid_checker;
 	static UidChecker<VertexShaderUid,VertexShaderCode> vertex_uid_checker;
 
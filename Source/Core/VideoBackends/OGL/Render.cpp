@@ -469,6 +469,8 @@ Renderer::Renderer()
 	g_ogl_config.bSupportSampleShading = GLExtensions::Supports("GL_ARB_sample_shading");
 	g_ogl_config.bSupportOGL31 = GLExtensions::Version() >= 310;
 	g_ogl_config.bSupportViewportFloat = GLExtensions::Supports("GL_ARB_viewport_array");
+	g_ogl_config.bSupportsParallelShaderCompile = GLExtensions::Supports("GL_ARB_parallel_shader_compile");
+	g_ogl_config.bSupportsCopyBuffer = GLExtensions::Supports("GL_ARB_copy_buffer");
 
 	if (GLInterface->GetMode() == GLInterfaceMode::MODE_OPENGLES3)
 		g_ogl_config.eSupportedGLSLVersion = GLSLES3;
@@ -541,7 +543,7 @@ Renderer::Renderer()
 				g_ogl_config.gl_renderer,
 				g_ogl_config.gl_version), 5000);
 
-	WARN_LOG(VIDEO,"Missing OGL Extensions: %s%s%s%s%s%s%s%s%s%s",
+	WARN_LOG(VIDEO,"Missing OGL Extensions: %s%s%s%s%s%s%s%s%s%s%s%s",
 			g_ActiveConfig.backend_info.bSupportsDualSourceBlend ? "" : "DualSourceBlend ",
 			g_ActiveConfig.backend_info.bSupportsPrimitiveRestart ? "" : "PrimitiveRestart ",
 			g_ActiveConfig.backend_info.bSupportsEarlyZ ? "" : "EarlyZ ",
@@ -551,7 +553,9 @@ Renderer::Renderer()
 			g_ogl_config.bSupportsGLBufferStorage ? "" : "BufferStorage ",
 			g_ogl_config.bSupportsGLSync ? "" : "Sync ",
 			g_ogl_config.bSupportCoverageMSAA ? "" : "CSAA ",
-			g_ogl_config.bSupportSampleShading ? "" : "SSAA "
+			g_ogl_config.bSupportSampleShading ? "" : "SSAA ",
+			g_ogl_config.bSupportsParallelShaderCompile ? "" : "ParallelShaderCompile ",
+			g_ogl_config.bSupportsCopyBuffer ? "" : "CopyBuffer "
 			);
 
 	s_LastMultisampleMode = g_ActiveConfig.iMultisampleMode;
@@ -607,12 +611,12 @@ Renderer::Renderer()
 			if(g_ogl_config.bSupportOGL31)
 			{
 				glEnable(GL_PRIMITIVE_RESTART);
-				glPrimitiveRestartIndex(65535);
+				glPrimitiveRestartIndex(0xFFFFFFFF);
 			}
 			else
 			{
 				glEnableClientState(GL_PRIMITIVE_RESTART_NV);
-				glPrimitiveRestartIndexNV(65535);
+				glPrimitiveRestartIndexNV(0xFFFFFFFF);
 			}
 	}
 	UpdateActiveConfig();
@@ -26,6 +26,8 @@ extern struct VideoConfig {
 	GLSL_VERSION eSupportedGLSLVersion;
 	bool bSupportOGL31;
 	bool bSupportViewportFloat;
+	bool bSupportsParallelShaderCompile;
+	bool bSupportsCopyBuffer;
 
 	const char *gl_vendor;
 	const char *gl_renderer;
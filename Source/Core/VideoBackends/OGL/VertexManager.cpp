@@ -34,7 +34,7 @@ extern NativeVertexFormat *g_nativeVertexFmt;
 namespace OGL
 {
 //This are the initially requested size for the buffers expressed in bytes
-const u32 MAX_IBUFFER_SIZE =  2*1024*1024;
+const u32 MAX_IBUFFER_SIZE =  8*1024*1024;
 const u32 MAX_VBUFFER_SIZE = 32*1024*1024;
 
 static StreamBuffer *s_vertexBuffer;
@@ -79,7 +79,7 @@ void VertexManager::DestroyDeviceObjects()
 void VertexManager::PrepareDrawBuffers(u32 stride)
 {
 	u32 vertex_data_size = IndexGenerator::GetNumVerts() * stride;
-	u32 index_data_size = IndexGenerator::GetIndexLen() * sizeof(u16);
+	u32 index_data_size = IndexGenerator::GetIndexLen() * sizeof(u32);
 
 	s_vertexBuffer->Unmap(vertex_data_size);
 	s_indexBuffer->Unmap(index_data_size);
@@ -95,8 +95,8 @@ void VertexManager::ResetBuffer(u32 stride)
 	s_pEndBufferPointer = buffer.first + MAXVBUFFERSIZE;
 	s_baseVertex = buffer.second / stride;
 
-	buffer = s_indexBuffer->Map(MAXIBUFFERSIZE * sizeof(u16));
-	IndexGenerator::Start((u16*)buffer.first);
+	buffer = s_indexBuffer->Map(MAXIBUFFERSIZE * sizeof(u32));
+	IndexGenerator::Start((u32*)buffer.first);
 	s_index_offset = buffer.second;
 }
 
@@ -120,9 +120,9 @@ void VertexManager::Draw(u32 stride)
 	}
 
 	if(g_ogl_config.bSupportsGLBaseVertex) {
-		glDrawRangeElementsBaseVertex(primitive_mode, 0, max_index, index_size, GL_UNSIGNED_SHORT, (u8*)NULL+s_index_offset, (GLint)s_baseVertex);
+		glDrawRangeElementsBaseVertex(primitive_mode, 0, max_index, index_size, GL_UNSIGNED_INT, (u8*)NULL+s_index_offset, (GLint)s_baseVertex);
 	} else {
-		glDrawRangeElements(primitive_mode, 0, max_index, index_size, GL_UNSIGNED_SHORT, (u8*)NULL+s_index_offset);
+		glDrawRangeElements(primitive_mode, 0, max_index, index_size, GL_UNSIGNED_INT, (u8*)NULL+s_index_offset);
 	}
 	INCSTAT(stats.thisFrame.numIndexedDrawCalls);
 }
@@ -143,25 +143,37 @@ void VertexManager::vFlush(bool useDstAlpha)
 	// Makes sure we can actually do Dual source blending
 	bool dualSourcePossible = g_ActiveConfig.backend_info.bSupportsDualSourceBlend;
 
+	// Without dual source blending, dst alpha needs a second pass which only writes alpha.
+	// Resolve its program up front so that either both passes are drawn or neither is.
+	bool alphaPass = useDstAlpha && !dualSourcePossible;
+	SHADER* alphaShader = NULL;
+	if (alphaPass)
+		alphaShader = ProgramShaderCache::SetShader(DSTALPHA_ALPHA_PASS, g_nativeVertexFmt->m_components);
+
 	// finally bind
+	SHADER* shader;
 	if (dualSourcePossible)
 	{
 		if (useDstAlpha)
 		{
 			// If host supports GL_ARB_blend_func_extended, we can do dst alpha in
 			// the same pass as regular rendering.
-			ProgramShaderCache::SetShader(DSTALPHA_DUAL_SOURCE_BLEND, g_nativeVertexFmt->m_components);
+			shader = ProgramShaderCache::SetShader(DSTALPHA_DUAL_SOURCE_BLEND, g_nativeVertexFmt->m_components);
 		}
 		else
 		{
-			ProgramShaderCache::SetShader(DSTALPHA_NONE,g_nativeVertexFmt->m_components);
+			shader = ProgramShaderCache::SetShader(DSTALPHA_NONE,g_nativeVertexFmt->m_components);
 		}
 	}
 	else
 	{
-		ProgramShaderCache::SetShader(DSTALPHA_NONE,g_nativeVertexFmt->m_components);
+		shader = ProgramShaderCache::SetShader(DSTALPHA_NONE,g_nativeVertexFmt->m_components);
 	}
 
+	// Pending programs are waited on or replaced by the uber shader, so this only happens if compilation failed
+	if (!shader || (alphaPass && !alphaShader))
+		return;
+
 	// upload global constants
 	ProgramShaderCache::UploadConstants();
 
@@ -173,9 +185,9 @@ void VertexManager::vFlush(bool useDstAlpha)
 	Draw(stride);
 
 	// run through vertex groups again to set alpha
-	if (useDstAlpha && !dualSourcePossible)
+	if (alphaPass)
 	{
-		ProgramShaderCache::SetShader(DSTALPHA_ALPHA_PASS,g_nativeVertexFmt->m_components);
+		alphaShader->Bind();
 
 		// only update alpha
 		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_TRUE);
@@ -42,6 +42,22 @@ void RenderToXFB(const BPCmd &bp, const EFBRectangle &rc, float yScale, float xf
 {
 	Renderer::RenderToXFB(xfbAddr, dstWidth, dstHeight, rc, gamma);
 }
+// Registers which are packed into the uber shader constants by PixelShaderManager::SetUberShaderState
+static bool IsUberShaderStateReg(u32 address)
+{
+	return address == BPMEM_GENMODE ||
+		(address >= BPMEM_IND_CMD && address < BPMEM_IND_CMD + 16) ||
+		(address >= BPMEM_IREF && address < BPMEM_TREF + 8) ||
+		address == BPMEM_ZMODE ||
+		address == BPMEM_ZCOMPARE ||
+		(address >= BPMEM_TEV_COLOR_ENV && address < BPMEM_TEV_COLOR_ENV + 32) ||
+		address == BPMEM_FOGRANGE ||
+		address == BPMEM_FOGPARAM3 ||
+		address == BPMEM_ALPHACOMPARE ||
+		address == BPMEM_ZTEX2 ||
+		(address >= BPMEM_TEV_KSEL && address < BPMEM_TEV_KSEL + 8);
+}
+
 void BPWritten(const BPCmd& bp)
 {
 	/*
@@ -86,6 +102,9 @@ void BPWritten(const BPCmd& bp)
 
 	((u32*)&bpmem)[bp.address] = bp.newvalue;
 
+	if (IsUberShaderStateReg(bp.address))
+		PixelShaderManager::SetUberShaderStateChanged();
+
 	switch (bp.address)
 	{
 	case BPMEM_GENMODE: // Set the Generation Mode
@@ -4,6 +4,10 @@
 
 #pragma once
 
+#include <cstddef>
+
+#include "Common/CommonTypes.h"
+
 // all constant buffer attributes must be 16 bytes aligned, so this are the only allowed components:
 typedef float float4[4];
 typedef u32 uint4[4];
@@ -23,6 +27,11 @@ struct PixelShaderConstants
 	// For pixel lighting
 	float4 plights[40];
 	float4 pmaterials[4];
+
+	// For the uber shader, see UberShaderPixel.h
+	uint4 ubergenmode;
+	uint4 ubermisc;
+	uint4 uberstages[16];
 };
 
 struct VertexShaderConstants
@@ -37,3 +46,80 @@ struct VertexShaderConstants
 	float4 posttransformmatrices[64];
 	float4 depthparams;
 };
+
+// Remembers which registers of a constant block were written since the last upload,
+// so backends can update only the touched ranges instead of the whole block.
+template <typename T>
+class ConstantDirtyTracker
+{
+public:
+	enum { NUM_REGS = sizeof(T) / sizeof(float4) };
+
+	ConstantDirtyTracker() { Clear(); }
+
+	// member has to point into block
+	void Set(const T& block, const void* member, size_t size)
+	{
+		const size_t offset = (const u8*)member - (const u8*)&block;
+		const size_t first = offset / sizeof(float4);
+		const size_t end = (offset + size + sizeof(float4) - 1) / sizeof(float4);
+		for (size_t i = first; i < end; ++i)
+			m_bits[i / 64] |= 1ULL << (i % 64);
+	}
+
+	void SetAll()
+	{
+		for (size_t i = 0; i < NUM_WORDS; ++i)
+			m_bits[i] = ~0ULL;
+		if (NUM_REGS % 64)
+			m_bits[NUM_WORDS - 1] = (1ULL << (NUM_REGS % 64)) - 1;
+	}
+
+	void Clear()
+	{
+		for (size_t i = 0; i < NUM_WORDS; ++i)
+			m_bits[i] = 0;
+	}
+
+	bool IsSet(size_t reg) const { return (m_bits[reg / 64] >> (reg % 64)) & 1; }
+
+	// Calls func(first, count) for every run of dirty registers, in ascending order.
+	// Runs separated by at most max_gap clean registers are reported as one.
+	// Returns the number of registers covered by the reported runs.
+	template <typename F>
+	size_t ForEachRange(F func, size_t max_gap = 0) const
+	{
+		size_t total = 0;
+		size_t reg = 0;
+		while (reg < NUM_REGS)
+		{
+			if (!IsSet(reg))
+			{
+				// skip clean words at once
+				if (reg % 64 == 0 && !m_bits[reg / 64])
+					reg += 64;
+				else
+					++reg;
+				continue;
+			}
+
+			const size_t first = reg;
+			size_t end = reg + 1;
+			for (reg = end; reg < NUM_REGS && reg <= end + max_gap; ++reg)
+			{
+				if (IsSet(reg))
+					end = reg + 1;
+			}
+			reg = end;
+
+			func(first, end - first);
+			total += end - first;
+		}
+		return total;
+	}
+
+private:
+	enum { NUM_WORDS = (NUM_REGS + 63) / 64 };
+
+	u64 m_bits[NUM_WORDS];
+};
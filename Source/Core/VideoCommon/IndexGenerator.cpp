@@ -8,14 +8,18 @@
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/VideoConfig.h"
 
+#if _M_X86
+#include <emmintrin.h>
+#endif
+
 //Init
-u16 *IndexGenerator::index_buffer_current;
-u16 *IndexGenerator::BASEIptr;
+u32 *IndexGenerator::index_buffer_current;
+u32 *IndexGenerator::BASEIptr;
 u32 IndexGenerator::base_index;
 
-static const u16 s_primitive_restart = -1;
+static const u32 s_primitive_restart = -1;
 
-static u16* (*primitive_table[8])(u16*, u32, u32);
+static u32* (*primitive_table[8])(u32*, u32, u32);
 
 void IndexGenerator::Init()
 {
@@ -39,7 +43,7 @@ void IndexGenerator::Init()
 	primitive_table[7] = &IndexGenerator::AddPoints;
 }
 
-void IndexGenerator::Start(u16* Indexptr)
+void IndexGenerator::Start(u32* Indexptr)
 {
 	index_buffer_current = Indexptr;
 	BASEIptr = Indexptr;
@@ -52,8 +56,26 @@ void IndexGenerator::AddIndices(int primitive, u32 numVerts)
 	base_index += numVerts;
 }
 
+__forceinline u32* IndexGenerator::WriteSequence(u32 *Iptr, u32 count, u32 index)
+{
+	u32 i = 0;
+#if _M_X86
+	// long strips are common, so write four indices at once
+	__m128i indices = _mm_add_epi32(_mm_set1_epi32(index), _mm_set_epi32(3, 2, 1, 0));
+	const __m128i step = _mm_set1_epi32(4);
+	for (; i + 4 <= count; i += 4)
+	{
+		_mm_storeu_si128((__m128i*)(Iptr + i), indices);
+		indices = _mm_add_epi32(indices, step);
+	}
+#endif
+	for (; i < count; ++i)
+		Iptr[i] = index + i;
+	return Iptr + count;
+}
+
 // Triangles
-template <bool pr> __forceinline u16* IndexGenerator::WriteTriangle(u16 *Iptr, u32 index1, u32 index2, u32 index3)
+template <bool pr> __forceinline u32* IndexGenerator::WriteTriangle(u32 *Iptr, u32 index1, u32 index2, u32 index3)
 {
 	*Iptr++ = index1;
 	*Iptr++ = index2;
@@ -63,8 +85,12 @@ template <bool pr> __forceinline u16* IndexGenerator::WriteTriangle(u16 *Iptr, u
 	return Iptr;
 }
 
-template <bool pr> u16* IndexGenerator::AddList(u16 *Iptr, u32 const numVerts, u32 index)
+template <bool pr> u32* IndexGenerator::AddList(u32 *Iptr, u32 const numVerts, u32 index)
 {
+	// without restart indices, a list is just all vertices in order
+	if (!pr)
+		return WriteSequence(Iptr, numVerts - numVerts % 3, index);
+
 	for (u32 i = 2; i < numVerts; i+=3)
 	{
 		Iptr = WriteTriangle<pr>(Iptr, index + i - 2, index + i - 1, index + i);
@@ -72,16 +98,12 @@ template <bool pr> u16* IndexGenerator::AddList(u16 *Iptr, u32 const numVerts, u
 	return Iptr;
 }
 
-template <bool pr> u16* IndexGenerator::AddStrip(u16 *Iptr, u32 const numVerts, u32 index)
+template <bool pr> u32* IndexGenerator::AddStrip(u32 *Iptr, u32 const numVerts, u32 index)
 {
 	if(pr)
 	{
-		for (u32 i = 0; i < numVerts; ++i)
-		{
-			*Iptr++ = index + i;
-		}
+		Iptr = WriteSequence(Iptr, numVerts, index);
 		*Iptr++ = s_primitive_restart;
-
 	}
 	else
 	{
@@ -118,7 +140,7 @@ template <bool pr> u16* IndexGenerator::AddStrip(u16 *Iptr, u32 const numVerts,
  * so we use 6 indices for 3 triangles
  */
 
-template <bool pr> u16* IndexGenerator::AddFan(u16 *Iptr, u32 numVerts, u32 index)
+template <bool pr> u32* IndexGenerator::AddFan(u32 *Iptr, u32 numVerts, u32 index)
 {
 	u32 i = 2;
 
@@ -168,9 +190,31 @@ template <bool pr> u16* IndexGenerator::AddFan(u16 *Iptr, u32 numVerts, u32 inde
  * A simple triangle has to be rendered for three vertices.
  * ZWW do this for sun rays
  */
-template <bool pr> u16* IndexGenerator::AddQuads(u16 *Iptr, u32 numVerts, u32 index)
+template <bool pr> u32* IndexGenerator::AddQuads(u32 *Iptr, u32 numVerts, u32 index)
 {
 	u32 i = 3;
+#if _M_X86
+	// one quad per iteration, only the base index changes
+	const __m128i pattern = pr ? _mm_set_epi32(3, 0, 2, 1) : _mm_set_epi32(0, 2, 1, 0);
+	__m128i base = _mm_set1_epi32(index);
+	const __m128i step = _mm_set1_epi32(4);
+	for (; i < numVerts; i+=4)
+	{
+		_mm_storeu_si128((__m128i*)Iptr, _mm_add_epi32(base, pattern));
+		if(pr)
+		{
+			Iptr[4] = s_primitive_restart;
+			Iptr += 5;
+		}
+		else
+		{
+			Iptr[4] = index + i - 1;
+			Iptr[5] = index + i - 0;
+			Iptr += 6;
+		}
+		base = _mm_add_epi32(base, step);
+	}
+#endif
 	for (; i < numVerts; i+=4)
 	{
 		if(pr)
@@ -197,20 +241,14 @@ template <bool pr> u16* IndexGenerator::AddQuads(u16 *Iptr, u32 numVerts, u32 in
 }
 
 // Lines
-u16* IndexGenerator::AddLineList(u16 *Iptr, u32 numVerts, u32 index)
+u32* IndexGenerator::AddLineList(u32 *Iptr, u32 numVerts, u32 index)
 {
-	for (u32 i = 1; i < numVerts; i+=2)
-	{
-		*Iptr++ = index + i - 1;
-		*Iptr++ = index + i;
-	}
-	return Iptr;
-
+	return WriteSequence(Iptr, numVerts & ~1, index);
 }
 
 // shouldn't be used as strips as LineLists are much more common
 // so converting them to lists
-u16* IndexGenerator::AddLineStrip(u16 *Iptr, u32 numVerts, u32 index)
+u32* IndexGenerator::AddLineStrip(u32 *Iptr, u32 numVerts, u32 index)
 {
 	for (u32 i = 1; i < numVerts; ++i)
 	{
@@ -221,18 +259,14 @@ u16* IndexGenerator::AddLineStrip(u16 *Iptr, u32 numVerts, u32 index)
 }
 
 // Points
-u16* IndexGenerator::AddPoints(u16 *Iptr, u32 numVerts, u32 index)
+u32* IndexGenerator::AddPoints(u32 *Iptr, u32 numVerts, u32 index)
 {
-	for (u32 i = 0; i != numVerts; ++i)
-	{
-		*Iptr++ = index + i;
-	}
-	return Iptr;
+	return WriteSequence(Iptr, numVerts, index);
 }
 
 
 u32 IndexGenerator::GetRemainingIndices()
 {
-	u32 max_index = 65534; // -1 is reserved for primitive restart (ogl + dx11)
+	u32 max_index = 0xFFFFFFFE; // -1 is reserved for primitive restart (ogl + dx11)
 	return max_index - base_index;
 }
@@ -14,7 +14,7 @@ class IndexGenerator
 public:
 	// Init
 	static void Init();
-	static void Start(u16 *Indexptr);
+	static void Start(u32 *Indexptr);
 
 	static void AddIndices(int primitive, u32 numVertices);
 
@@ -26,22 +26,25 @@ public:
 	static u32 GetRemainingIndices();
 
 private:
+	// Writes count consecutive indices starting at index
+	static u32* WriteSequence(u32 *Iptr, u32 count, u32 index);
+
 	// Triangles
-	template <bool pr> static u16* AddList(u16 *Iptr, u32 numVerts, u32 index);
-	template <bool pr> static u16* AddStrip(u16 *Iptr, u32 numVerts, u32 index);
-	template <bool pr> static u16* AddFan(u16 *Iptr, u32 numVerts, u32 index);
-	template <bool pr> static u16* AddQuads(u16 *Iptr, u32 numVerts, u32 index);
+	template <bool pr> static u32* AddList(u32 *Iptr, u32 numVerts, u32 index);
+	template <bool pr> static u32* AddStrip(u32 *Iptr, u32 numVerts, u32 index);
+	template <bool pr> static u32* AddFan(u32 *Iptr, u32 numVerts, u32 index);
+	template <bool pr> static u32* AddQuads(u32 *Iptr, u32 numVerts, u32 index);
 
 	// Lines
-	static u16* AddLineList(u16 *Iptr, u32 numVerts, u32 index);
-	static u16* AddLineStrip(u16 *Iptr, u32 numVerts, u32 index);
+	static u32* AddLineList(u32 *Iptr, u32 numVerts, u32 index);
+	static u32* AddLineStrip(u32 *Iptr, u32 numVerts, u32 index);
 
 	// Points
-	static u16* AddPoints(u16 *Iptr, u32 numVerts, u32 index);
+	static u32* AddPoints(u32 *Iptr, u32 numVerts, u32 index);
 
-	template <bool pr> static u16* WriteTriangle(u16 *Iptr, u32 index1, u32 index2, u32 index3);
+	template <bool pr> static u32* WriteTriangle(u32 *Iptr, u32 index1, u32 index2, u32 index3);
 
-	static u16 *index_buffer_current;
-	static u16 *BASEIptr;
+	static u32 *index_buffer_current;
+	static u32 *BASEIptr;
 	static u32 base_index;
 };
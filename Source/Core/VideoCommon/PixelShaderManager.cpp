@@ -9,14 +9,18 @@
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/Statistics.h"
+#include "VideoCommon/UberShaderPixel.h"
 #include "VideoCommon/VideoCommon.h"
 #include "VideoCommon/VideoConfig.h"
 
 static bool s_bFogRangeAdjustChanged;
 static bool s_bViewPortChanged;
 static int nLightsChanged[2]; // min,max
+static bool s_bUberStateChanged;
+static bool s_bUberFastDepth;
 
 PixelShaderConstants PixelShaderManager::constants;
+ConstantDirtyTracker<PixelShaderConstants> PixelShaderManager::dirty_regs;
 bool PixelShaderManager::dirty;
 
 void PixelShaderManager::Init()
@@ -30,6 +34,11 @@ void PixelShaderManager::Dirty()
 	s_bFogRangeAdjustChanged = true;
 	s_bViewPortChanged = true;
 	nLightsChanged[0] = 0; nLightsChanged[1] = 0x80;
+	s_bUberStateChanged = true;
+
+	// some registers are only written when their content changes, so make sure everything is uploaded again
+	dirty_regs.SetAll();
+	dirty = true;
 
 	SetColorChanged(0, 0);
 	SetColorChanged(0, 1);
@@ -94,7 +103,7 @@ void PixelShaderManager::SetConstants()
 			constants.fog[2][1] = 1;
 			constants.fog[2][2] = 1;
 		}
-		dirty = true;
+		MarkDirty(constants.fog[2], sizeof(float4));
 
 		s_bFogRangeAdjustChanged = false;
 	}
@@ -131,7 +140,7 @@ void PixelShaderManager::SetConstants()
 					constants.plights[5*i+j+1][2] = xfmemptr[2];
 				}
 			}
-			dirty = true;
+			MarkDirty(constants.plights[5*istart], (iend - istart) * 5 * sizeof(float4));
 
 			nLightsChanged[0] = nLightsChanged[1] = -1;
 		}
@@ -141,9 +150,82 @@ void PixelShaderManager::SetConstants()
 	{
 		constants.zbias[1][0] = xfregs.viewport.farZ / 16777216.0f;
 		constants.zbias[1][1] = xfregs.viewport.zRange / 16777216.0f;
-		dirty = true;
+		MarkDirty(constants.zbias[1], sizeof(float4));
 		s_bViewPortChanged = false;
 	}
+
+	// The uber shader reads the whole TEV setup from constants, repack it once the registers feeding it changed
+	if ((g_ActiveConfig.bUberShaders || g_ActiveConfig.bAsyncShaderCompilation) && CanUseUberPixelShader() &&
+		(s_bUberStateChanged || s_bUberFastDepth != g_ActiveConfig.bFastDepthCalc))
+	{
+		SetUberShaderState();
+		s_bUberStateChanged = false;
+		s_bUberFastDepth = g_ActiveConfig.bFastDepthCalc;
+	}
+}
+
+void PixelShaderManager::SetUberShaderState()
+{
+	uint4 genmode;
+	uint4 misc;
+	uint4 stages[16];
+	memset(misc, 0, sizeof(misc));
+	memset(stages, 0, sizeof(stages));
+
+	const AlphaTest::TEST_RESULT pretest = bpmem.alpha_test.TestResult();
+
+	u32 flags = bpmem.fog.c_proj_fsel.fsel << UBER_FLAG_FOG_FSEL_SHIFT;
+	flags |= bpmem.ztex2.op << UBER_FLAG_ZTEX_OP_SHIFT;
+	if (bpmem.fog.c_proj_fsel.proj)
+		flags |= UBER_FLAG_FOG_PROJ;
+	if (bpmem.fogRange.Base.Enabled)
+		flags |= UBER_FLAG_FOG_RANGE;
+	if (bpmem.UseEarlyDepthTest())
+		flags |= UBER_FLAG_EARLY_ZTEST;
+	if (g_ActiveConfig.bFastDepthCalc)
+		flags |= UBER_FLAG_FAST_DEPTH;
+	if (pretest == AlphaTest::UNDETERMINED || (pretest == AlphaTest::FAIL && bpmem.UseLateDepthTest()))
+		flags |= UBER_FLAG_ALPHA_TEST;
+	if (bpmem.UseEarlyDepthTest() && bpmem.zmode.updateenable && !g_ActiveConfig.backend_info.bSupportsEarlyZ)
+		flags |= UBER_FLAG_ZCOMPLOC_HACK;
+
+	genmode[0] = bpmem.genMode.hex;
+	genmode[1] = bpmem.alpha_test.hex;
+	genmode[2] = flags;
+	genmode[3] = bpmem.tevindref.hex;
+
+	for (int i = 0; i < 4; ++i)
+	{
+		const u32 swap = bpmem.tevksel[i*2].swap1 | bpmem.tevksel[i*2].swap2 << 2 |
+		                 bpmem.tevksel[i*2+1].swap1 << 4 | bpmem.tevksel[i*2+1].swap2 << 6;
+		misc[0] |= swap << (8 * i);
+	}
+	for (int i = 0; i < 8; ++i)
+		misc[1] |= (xfregs.texMtxInfo[i].projection == XF_TEXPROJ_STQ) << i;
+
+	const unsigned int numStages = bpmem.genMode.numtevstages + 1;
+	for (unsigned int n = 0; n < numStages; ++n)
+	{
+		stages[n][0] = bpmem.combiners[n].colorC.hex & 0xFFFFFF;
+		stages[n][1] = bpmem.combiners[n].alphaC.hex & 0xFFFFFF;
+		stages[n][2] = bpmem.tevind[n].hex & 0x1FFFFF;
+		stages[n][3] = bpmem.tevorders[n/2].getTexMap(n&1) |
+		               bpmem.tevorders[n/2].getTexCoord(n&1) << 3 |
+		               bpmem.tevorders[n/2].getEnable(n&1) << 6 |
+		               bpmem.tevorders[n/2].getColorChan(n&1) << 7 |
+		               bpmem.tevksel[n/2].getKC(n&1) << 16 |
+		               bpmem.tevksel[n/2].getKA(n&1) << 21;
+	}
+
+	memcpy(constants.ubergenmode, genmode, sizeof(genmode));
+	memcpy(constants.ubermisc, misc, sizeof(misc));
+	memcpy(constants.uberstages, stages, sizeof(stages));
+	MarkDirty(constants.ubergenmode, sizeof(genmode) + sizeof(misc) + sizeof(stages));
+}
+
+void PixelShaderManager::SetUberShaderStateChanged()
+{
+	s_bUberStateChanged = true;
 }
 
 // This one is high in profiles (0.5%).
@@ -157,7 +239,7 @@ void PixelShaderManager::SetColorChanged(int type, int num)
 	c[num][3] = bpmem.tevregs[num].low.b / 255.0f;
 	c[num][2] = bpmem.tevregs[num].high.a / 255.0f;
 	c[num][1] = bpmem.tevregs[num].high.b / 255.0f;
-	dirty = true;
+	MarkDirty(c[num], sizeof(float4));
 
 	PRIM_LOG("pixel %scolor%d: %f %f %f %f\n", type?"k":"", num, c[num][0], c[num][1], c[num][2], c[num][3]);
 }
@@ -166,13 +248,13 @@ void PixelShaderManager::SetAlpha()
 {
 	constants.alpha[0] = bpmem.alpha_test.ref0 / 255.0f;
 	constants.alpha[1] = bpmem.alpha_test.ref1 / 255.0f;
-	dirty = true;
+	MarkDirty(constants.alpha, sizeof(float4));
 }
 
 void PixelShaderManager::SetDestAlpha()
 {
 	constants.alpha[3] = bpmem.dstalpha.alpha / 255.0f;
-	dirty = true;
+	MarkDirty(constants.alpha, sizeof(float4));
 }
 
 void PixelShaderManager::SetTexDims(int texmapid, u32 width, u32 height, u32 wraps, u32 wrapt)
@@ -180,7 +262,7 @@ void PixelShaderManager::SetTexDims(int texmapid, u32 width, u32 height, u32 wra
 	// TODO: move this check out to callee. There we could just call this function on texture changes
 	// or better, use textureSize() in glsl
 	if(constants.texdims[texmapid][0] != 1.0f/width || constants.texdims[texmapid][1] != 1.0f/height)
-		dirty = true;
+		MarkDirty(constants.texdims[texmapid], sizeof(float4));
 
 	constants.texdims[texmapid][0] = 1.0f/width;
 	constants.texdims[texmapid][1] = 1.0f/height;
@@ -189,7 +271,7 @@ void PixelShaderManager::SetTexDims(int texmapid, u32 width, u32 height, u32 wra
 void PixelShaderManager::SetZTextureBias()
 {
 	constants.zbias[1][3] = bpmem.ztex1.bias/16777215.0f;
-	dirty = true;
+	MarkDirty(constants.zbias[1], sizeof(float4));
 }
 
 void PixelShaderManager::SetViewportChanged()
@@ -204,7 +286,7 @@ void PixelShaderManager::SetIndTexScaleChanged(bool high)
 	constants.indtexscale[high][1] = bpmem.texscale[high].getScaleT(0);
 	constants.indtexscale[high][2] = bpmem.texscale[high].getScaleS(1);
 	constants.indtexscale[high][3] = bpmem.texscale[high].getScaleT(1);
-	dirty = true;
+	MarkDirty(constants.indtexscale[high], sizeof(float4));
 }
 
 void PixelShaderManager::SetIndMatrixChanged(int matrixidx)
@@ -225,7 +307,7 @@ void PixelShaderManager::SetIndMatrixChanged(int matrixidx)
 	constants.indtexmtx[2*matrixidx+1][1] = bpmem.indmtx[matrixidx].col1.md * fscale;
 	constants.indtexmtx[2*matrixidx+1][2] = bpmem.indmtx[matrixidx].col2.mf * fscale;
 	constants.indtexmtx[2*matrixidx+1][3] = fscale * 4.0f;
-	dirty = true;
+	MarkDirty(constants.indtexmtx[2*matrixidx], 2 * sizeof(float4));
 
 	PRIM_LOG("indmtx%d: scale=%f, mat=(%f %f %f; %f %f %f)\n",
 			matrixidx, 1024.0f*fscale,
@@ -259,7 +341,7 @@ void PixelShaderManager::SetZTextureTypeChanged()
 		default:
 			break;
         }
-        dirty = true;
+        MarkDirty(constants.zbias[0], sizeof(float4));
 }
 
 void PixelShaderManager::SetTexCoordChanged(u8 texmapid)
@@ -267,7 +349,7 @@ void PixelShaderManager::SetTexCoordChanged(u8 texmapid)
 	TCoordInfo& tc = bpmem.texcoords[texmapid];
 	constants.texdims[texmapid][2] = (float)(tc.s.scale_minus_1 + 1);
 	constants.texdims[texmapid][3] = (float)(tc.t.scale_minus_1 + 1);
-	dirty = true;
+	MarkDirty(constants.texdims[texmapid], sizeof(float4));
 }
 
 void PixelShaderManager::SetFogColorChanged()
@@ -275,7 +357,7 @@ void PixelShaderManager::SetFogColorChanged()
 	constants.fog[0][0] = bpmem.fog.color.r / 255.0f;
 	constants.fog[0][1] = bpmem.fog.color.g / 255.0f;
 	constants.fog[0][2] = bpmem.fog.color.b / 255.0f;
-	dirty = true;
+	MarkDirty(constants.fog[0], sizeof(float4));
 }
 
 void PixelShaderManager::SetFogParamChanged()
@@ -294,7 +376,7 @@ void PixelShaderManager::SetFogParamChanged()
 		constants.fog[1][2] = 0;
 		constants.fog[1][3] = 1;
 	}
-	dirty = true;
+	MarkDirty(constants.fog[1], sizeof(float4));
 }
 
 void PixelShaderManager::SetFogRangeAdjustChanged()
@@ -330,7 +412,7 @@ void PixelShaderManager::SetMaterialColorChanged(int index, u32 color)
 		constants.pmaterials[index][1] = ((color >> 16) & 0xFF) / 255.0f;
 		constants.pmaterials[index][2] = ((color >>  8) & 0xFF) / 255.0f;
 		constants.pmaterials[index][3] = ( color        & 0xFF) / 255.0f;
-		dirty = true;
+		MarkDirty(constants.pmaterials[index], sizeof(float4));
 	}
 }
 
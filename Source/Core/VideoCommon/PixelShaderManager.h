@@ -41,7 +41,19 @@ public:
 	static void SetFogRangeAdjustChanged();
 	static void InvalidateXFRange(int start, int end);
 	static void SetMaterialColorChanged(int index, u32 color);
+	static void SetUberShaderStateChanged();
 
 	static PixelShaderConstants constants;
+	static ConstantDirtyTracker<PixelShaderConstants> dirty_regs; // registers changed since the last upload
 	static bool dirty;
+
+private:
+	// flags the registers covered by a part of constants for the next upload
+	static void MarkDirty(const void* member, size_t size)
+	{
+		dirty_regs.Set(constants, member, size);
+		dirty = true;
+	}
+
+	static void SetUberShaderState();
 };
@@ -10,11 +10,28 @@
 
 Statistics stats;
 
+// ThisFrame is nothing but ints
+static void AddCounters(Statistics::ThisFrame &to, const Statistics::ThisFrame &from)
+{
+	static_assert(sizeof(Statistics::ThisFrame) % sizeof(int) == 0, "ThisFrame has to be all ints");
+	int *dst = (int*)&to;
+	const int *src = (const int*)&from;
+	for (size_t i = 0; i < sizeof(Statistics::ThisFrame) / sizeof(int); i++)
+		dst[i] += src[i];
+}
+
 void Statistics::ResetFrame()
 {
+	AddCounters(prevFrames, thisFrame);
 	memset(&thisFrame, 0, sizeof(ThisFrame));
 }
 
+void Statistics::GetTotals(ThisFrame &out) const
+{
+	out = prevFrames;
+	AddCounters(out, thisFrame);
+}
+
 void Statistics::SwapDL()
 {
 	std::swap(stats.thisFrame.numDLPrims, stats.thisFrame.numPrims);
@@ -51,6 +68,7 @@ char *Statistics::ToString(char *ptr)
 	ptr+=sprintf(ptr,"Vertex streamed: %i kB\n",stats.thisFrame.bytesVertexStreamed/1024);
 	ptr+=sprintf(ptr,"Index streamed: %i kB\n",stats.thisFrame.bytesIndexStreamed/1024);
 	ptr+=sprintf(ptr,"Uniform streamed: %i kB\n",stats.thisFrame.bytesUniformStreamed/1024);
+	ptr+=sprintf(ptr,"Uniform uploads: %i (%i ranges)\n",stats.thisFrame.numUniformUploads,stats.thisFrame.numUniformRanges);
 	ptr+=sprintf(ptr,"Vertex Loaders: %i\n",stats.numVertexLoaders);
 
 	std::string text1;
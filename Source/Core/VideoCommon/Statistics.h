@@ -64,9 +64,15 @@ struct Statistics
 		int bytesVertexStreamed;
 		int bytesIndexStreamed;
 		int bytesUniformStreamed;
+		int numUniformUploads;
+		int numUniformRanges;
 	};
 	ThisFrame thisFrame;
+	// thisFrame summed over all the frames before it
+	ThisFrame prevFrames;
 	void ResetFrame();
+	// The counters of all frames so far, for spans that don't end at a swap
+	void GetTotals(ThisFrame &out) const;
 	static void SwapDL();
 
 	// Yeah, this is unsafe, but we really don't wanna faff around allocating
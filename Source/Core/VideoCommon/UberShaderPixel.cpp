@@ -0,0 +1,537 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstdio>
+#include <locale.h>
+#ifdef __APPLE__
+	#include <xlocale.h>
+#endif
+
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/UberShaderPixel.h"
+#include "VideoCommon/VideoConfig.h"
+#include "VideoCommon/XFMemory.h"
+
+// Uniform layout (filled by PixelShaderManager):
+//   ubergenmode.x   = bpmem.genMode
+//   ubergenmode.y   = bpmem.alpha_test
+//   ubergenmode.z   = UBER_FLAG_* bits
+//   ubergenmode.w   = bpmem.tevindref
+//   ubermisc.x      = swap mode table, one byte per entry (2 bits per channel)
+//   ubermisc.y      = xfregs.texMtxInfo[n].projection, one bit per texgen
+//   uberstages[n].x = bpmem.combiners[n].colorC
+//   uberstages[n].y = bpmem.combiners[n].alphaC
+//   uberstages[n].z = bpmem.tevind[n]
+//   uberstages[n].w = texmap | texcoord << 3 | enable << 6 | colorchan << 7 | kcsel << 16 | kasel << 21
+
+static char text[32768];
+
+bool CanUseUberPixelShader()
+{
+	return g_ActiveConfig.backend_info.bSupportsUberShaders &&
+		!(g_ActiveConfig.bEnablePixelLighting && g_ActiveConfig.backend_info.bSupportsPixelLighting);
+}
+
+template<class T>
+static inline void WriteHelpers(T& out)
+{
+	// Fmod implementation gleaned from Nvidia
+	// At http://http.developer.nvidia.com/Cg/fmod.html
+	out.Write("float fmod( float x, float y )\n");
+	out.Write("{\n");
+	out.Write("\tfloat z = fract( abs( x / y) ) * abs( y );\n");
+	out.Write("\treturn (x < 0.0) ? -z : z;\n");
+	out.Write("}\n\n");
+
+	out.Write("uint bitfield(uint value, uint offset, uint size)\n");
+	out.Write("{\n");
+	out.Write("\treturn (value >> offset) & ((1u << size) - 1u);\n");
+	out.Write("}\n\n");
+
+	// emulation of unsigned 8 overflow
+	out.Write("float4 Wrap8(float4 x)\n");
+	out.Write("{\n");
+	out.Write("\treturn frac(x * (255.0/256.0)) * (256.0/255.0);\n");
+	out.Write("}\n\n");
+
+	// GLSL 1.30 can't index sampler arrays dynamically
+	out.Write("float4 SampleTexmap(uint texmap, float2 coord)\n");
+	out.Write("{\n");
+	for (int i = 0; i < 7; ++i)
+		out.Write("\tif (texmap == %du) return texture(samp%d, coord * " I_TEXDIMS"[%d].xy);\n", i, i, i);
+	out.Write("\treturn texture(samp7, coord * " I_TEXDIMS"[7].xy);\n");
+	out.Write("}\n\n");
+
+	out.Write("float Channel(float4 color, uint index)\n");
+	out.Write("{\n");
+	out.Write("\treturn index == 0u ? color.r : index == 1u ? color.g : index == 2u ? color.b : color.a;\n");
+	out.Write("}\n\n");
+
+	out.Write("float4 Swap(float4 color, uint table)\n");
+	out.Write("{\n");
+	out.Write("\tuint swap = bitfield(" I_UBERMISC".x, table * 8u, 8u);\n");
+	out.Write("\treturn float4(Channel(color, bitfield(swap, 0u, 2u)), Channel(color, bitfield(swap, 2u, 2u)),\n");
+	out.Write("\t              Channel(color, bitfield(swap, 4u, 2u)), Channel(color, bitfield(swap, 6u, 2u)));\n");
+	out.Write("}\n\n");
+
+	out.Write("float4 Konst(uint kc, uint ka)\n");
+	out.Write("{\n");
+	out.Write("\tfloat4 result = float4(0.0, 0.0, 0.0, 0.0);\n");
+	out.Write("\tif (kc < 8u) result.rgb = float3(1.0 - float(kc) * 0.125);\n");
+	out.Write("\telse if (kc >= 12u && kc < 16u) result.rgb = " I_KCOLORS"[kc - 12u].rgb;\n");
+	out.Write("\telse if (kc >= 16u) result.rgb = float3(Channel(" I_KCOLORS"[kc & 3u], (kc - 16u) >> 2));\n");
+	out.Write("\tif (ka < 8u) result.a = 1.0 - float(ka) * 0.125;\n");
+	out.Write("\telse if (ka >= 16u) result.a = Channel(" I_KCOLORS"[ka & 3u], (ka - 16u) >> 2);\n");
+	out.Write("\treturn result;\n");
+	out.Write("}\n\n");
+
+	// TEVCOLORARG_*, r[] holds prev, c0, c1 and c2
+	out.Write("float3 ColorInput(uint sel, float4 r[4], float4 tex, float4 ras, float4 konst)\n");
+	out.Write("{\n");
+	out.Write("\tif (sel < 8u) return (sel & 1u) == 0u ? r[sel >> 1].rgb : r[sel >> 1].aaa;\n");
+	out.Write("\tif (sel == 8u) return tex.rgb;\n");
+	out.Write("\tif (sel == 9u) return tex.aaa;\n");
+	out.Write("\tif (sel == 10u) return ras.rgb;\n");
+	out.Write("\tif (sel == 11u) return ras.aaa;\n");
+	out.Write("\tif (sel == 12u) return float3(1.0, 1.0, 1.0);\n");
+	out.Write("\tif (sel == 13u) return float3(0.5, 0.5, 0.5);\n");
+	out.Write("\tif (sel == 14u) return konst.rgb;\n");
+	out.Write("\treturn float3(0.0, 0.0, 0.0);\n");
+	out.Write("}\n\n");
+
+	// TEVALPHAARG_*, the whole register is returned since the compare modes look at the color channels
+	out.Write("float4 AlphaInput(uint sel, float4 r[4], float4 tex, float4 ras, float4 konst)\n");
+	out.Write("{\n");
+	out.Write("\tif (sel < 4u) return r[sel];\n");
+	out.Write("\tif (sel == 4u) return tex;\n");
+	out.Write("\tif (sel == 5u) return ras;\n");
+	out.Write("\tif (sel == 6u) return konst;\n");
+	out.Write("\treturn float4(0.0, 0.0, 0.0, 0.0);\n");
+	out.Write("}\n\n");
+
+	out.Write("float TevScale(uint shift)\n");
+	out.Write("{\n");
+	out.Write("\treturn shift == 0u ? 1.0 : shift == 1u ? 2.0 : shift == 2u ? 4.0 : 0.5;\n");
+	out.Write("}\n\n");
+
+	out.Write("float TevBias(uint bias)\n");
+	out.Write("{\n");
+	out.Write("\treturn bias == 1u ? 0.5 : bias == 2u ? -0.5 : 0.0;\n");
+	out.Write("}\n\n");
+
+	out.Write("bool AlphaCompare(float alpha, float ref, uint comp)\n");
+	out.Write("{\n");
+	out.Write("\tif (comp == 0u) return false;\n");
+	out.Write("\tif (comp == 1u) return alpha <= ref - (0.25/255.0);\n");
+	out.Write("\tif (comp == 2u) return abs(alpha - ref) < (0.5/255.0);\n");
+	out.Write("\tif (comp == 3u) return alpha < ref + (0.25/255.0);\n");
+	out.Write("\tif (comp == 4u) return alpha >= ref + (0.25/255.0);\n");
+	out.Write("\tif (comp == 5u) return abs(alpha - ref) >= (0.5/255.0);\n");
+	out.Write("\tif (comp == 6u) return alpha > ref - (0.25/255.0);\n");
+	out.Write("\treturn true;\n");
+	out.Write("}\n\n");
+}
+
+template<class T>
+static inline void WriteStageLoop(T& out)
+{
+	out.Write("\tfor (uint n = 0u; n < num_stages; ++n)\n");
+	out.Write("\t{\n");
+	out.Write("\t\tuint cc = " I_UBERSTAGES"[n].x;\n");
+	out.Write("\t\tuint ac = " I_UBERSTAGES"[n].y;\n");
+	out.Write("\t\tuint ind = " I_UBERSTAGES"[n].z;\n");
+	out.Write("\t\tuint order = " I_UBERSTAGES"[n].w;\n\n");
+
+	out.Write("\t\tuint texcoord = bitfield(order, 3u, 3u);\n");
+	out.Write("\t\tbool has_texcoord = texcoord < num_texgens;\n");
+	out.Write("\t\tif (!has_texcoord)\n");
+	out.Write("\t\t\ttexcoord = 0u;\n\n");
+
+	// indirect op
+	out.Write("\t\tuint bt = bitfield(ind, 0u, 2u);\n");
+	out.Write("\t\tbool has_ind_stage = (ind & 0x17fe00u) != 0u && bt < num_ind_stages;\n");
+	out.Write("\t\tif (has_ind_stage)\n");
+	out.Write("\t\t{\n");
+	out.Write("\t\t\tuint fmt = bitfield(ind, 2u, 2u);\n");
+	out.Write("\t\t\tuint bias = bitfield(ind, 4u, 3u);\n");
+	out.Write("\t\t\tuint bs = bitfield(ind, 7u, 2u);\n");
+	out.Write("\t\t\tuint mid = bitfield(ind, 9u, 4u);\n");
+	out.Write("\t\t\tuint sw = bitfield(ind, 13u, 3u);\n");
+	out.Write("\t\t\tuint tw = bitfield(ind, 16u, 3u);\n");
+	out.Write("\t\t\tfloat3 itex = indtex[bt];\n");
+	out.Write("\t\t\tif (bs != 0u)\n");
+	out.Write("\t\t\t\talphabump = Channel(itex.xyzz, bs - 1u) * (fmt == 1u ? (224.0/255.0) : fmt == 2u ? (240.0/255.0) : (248.0/255.0));\n");
+	out.Write("\t\t\tfloat3 indtevcrd = itex * (fmt == 0u ? 255.0 : fmt == 1u ? 31.0 : fmt == 2u ? 15.0 : 7.0);\n");
+	out.Write("\t\t\tfloat biasadd = fmt == 0u ? -128.0 : 1.0;\n");
+	out.Write("\t\t\tif ((bias & 1u) != 0u) indtevcrd.x += biasadd;\n");
+	out.Write("\t\t\tif ((bias & 2u) != 0u) indtevcrd.y += biasadd;\n");
+	out.Write("\t\t\tif ((bias & 4u) != 0u) indtevcrd.z += biasadd;\n");
+	out.Write("\t\t\tfloat2 indtevtrans = float2(0.0, 0.0);\n");
+	out.Write("\t\t\tif (mid != 0u && mid <= 3u)\n");
+	out.Write("\t\t\t{\n");
+	out.Write("\t\t\t\tuint mtxidx = 2u * (mid - 1u);\n");
+	out.Write("\t\t\t\tindtevtrans = float2(dot(" I_INDTEXMTX"[mtxidx].xyz, indtevcrd), dot(" I_INDTEXMTX"[mtxidx + 1u].xyz, indtevcrd));\n");
+	out.Write("\t\t\t}\n");
+	out.Write("\t\t\telse if (mid >= 5u && mid <= 7u && has_texcoord)\n");
+	out.Write("\t\t\t\tindtevtrans = " I_INDTEXMTX"[2u * (mid - 5u)].ww * uv[texcoord].xy * indtevcrd.xx;\n");
+	out.Write("\t\t\telse if (mid >= 9u && mid <= 11u && has_texcoord)\n");
+	out.Write("\t\t\t\tindtevtrans = " I_INDTEXMTX"[2u * (mid - 9u)].ww * uv[texcoord].xy * indtevcrd.yy;\n");
+	out.Write("\t\t\tfloat2 wrappedcoord;\n");
+	out.Write("\t\t\twrappedcoord.x = sw == 0u ? uv[texcoord].x : sw == 6u ? 0.0 : fmod(uv[texcoord].x, float(512u >> sw));\n");
+	out.Write("\t\t\twrappedcoord.y = tw == 0u ? uv[texcoord].y : tw == 6u ? 0.0 : fmod(uv[texcoord].y, float(512u >> tw));\n");
+	out.Write("\t\t\tif (bitfield(ind, 20u, 1u) != 0u)\n");
+	out.Write("\t\t\t\ttevcoord.xy += wrappedcoord + indtevtrans;\n");
+	out.Write("\t\t\telse\n");
+	out.Write("\t\t\t\ttevcoord.xy = wrappedcoord + indtevtrans;\n");
+	out.Write("\t\t}\n\n");
+
+	// rasterized color
+	out.Write("\t\tuint colorchan = bitfield(order, 7u, 3u);\n");
+	out.Write("\t\tif (colorchan == 0u) rastemp = colors_0;\n");
+	out.Write("\t\telse if (colorchan == 1u) rastemp = colors_1;\n");
+	out.Write("\t\telse if (colorchan == 5u) rastemp = float4(alphabump, alphabump, alphabump, alphabump);\n");
+	out.Write("\t\telse if (colorchan == 6u) rastemp = float4(alphabump, alphabump, alphabump, alphabump) * (255.0/248.0);\n");
+	out.Write("\t\telse rastemp = float4(0.0, 0.0, 0.0, 0.0);\n");
+	out.Write("\t\trastemp = Swap(rastemp, bitfield(ac, 0u, 2u));\n\n");
+
+	// texture
+	out.Write("\t\tif (bitfield(order, 6u, 1u) != 0u)\n");
+	out.Write("\t\t{\n");
+	out.Write("\t\t\tif (!has_ind_stage)\n");
+	out.Write("\t\t\t\ttevcoord.xy = has_texcoord ? uv[texcoord].xy : float2(0.0, 0.0);\n");
+	out.Write("\t\t\ttextemp = Swap(SampleTexmap(bitfield(order, 0u, 3u), tevcoord.xy), bitfield(ac, 2u, 2u));\n");
+	out.Write("\t\t}\n");
+	out.Write("\t\telse\n");
+	out.Write("\t\t{\n");
+	out.Write("\t\t\ttextemp = float4(1.0, 1.0, 1.0, 1.0);\n");
+	out.Write("\t\t}\n\n");
+
+	out.Write("\t\tkonsttemp = Konst(bitfield(order, 16u, 5u), bitfield(order, 21u, 5u));\n\n");
+
+	// The a, b and c inputs always go through overflow emulation, d is used as is
+	out.Write("\t\tfloat4 cregs[4];\n");
+	out.Write("\t\tfor (uint i = 0u; i < 4u; ++i)\n");
+	out.Write("\t\t\tcregs[i] = Wrap8(regs[i]);\n");
+	out.Write("\t\tfloat4 crastemp = Wrap8(rastemp);\n");
+	out.Write("\t\tfloat4 ckonsttemp = Wrap8(konsttemp);\n\n");
+
+	// color combine
+	out.Write("\t\t{\n");
+	out.Write("\t\t\tfloat3 a = ColorInput(bitfield(cc, 12u, 4u), cregs, textemp, crastemp, ckonsttemp);\n");
+	out.Write("\t\t\tfloat3 b = ColorInput(bitfield(cc, 8u, 4u), cregs, textemp, crastemp, ckonsttemp);\n");
+	out.Write("\t\t\tfloat3 c = ColorInput(bitfield(cc, 4u, 4u), cregs, textemp, crastemp, ckonsttemp);\n");
+	out.Write("\t\t\tfloat3 d = ColorInput(bitfield(cc, 0u, 4u), regs, textemp, rastemp, konsttemp);\n");
+	out.Write("\t\t\tuint bias = bitfield(cc, 16u, 2u);\n");
+	out.Write("\t\t\tuint op = bitfield(cc, 18u, 1u);\n");
+	out.Write("\t\t\tuint shift = bitfield(cc, 20u, 2u);\n");
+	out.Write("\t\t\tfloat3 result;\n");
+	out.Write("\t\t\tif (bias != 3u)\n");
+	out.Write("\t\t\t{\n");
+	out.Write("\t\t\t\tfloat3 lerped = lerp(a, b, c);\n");
+	out.Write("\t\t\t\tresult = TevScale(shift) * ((op == 0u ? d + lerped : d - lerped) + TevBias(bias));\n");
+	out.Write("\t\t\t}\n");
+	out.Write("\t\t\telse\n");
+	out.Write("\t\t\t{\n");
+	out.Write("\t\t\t\tuint cmp = (shift << 1) | op;\n");
+	out.Write("\t\t\t\tfloat3 cmpresult;\n");
+	out.Write("\t\t\t\tif (cmp == 0u) cmpresult = (a.r >= b.r + (0.25/255.0)) ? c : float3(0.0, 0.0, 0.0);\n");
+	out.Write("\t\t\t\telse if (cmp == 1u) cmpresult = (abs(a.r - b.r) < (0.5/255.0)) ? c : float3(0.0, 0.0, 0.0);\n");
+	out.Write("\t\t\t\telse if (cmp == 2u) cmpresult = (dot(a, comp16) >= dot(b, comp16) + (0.25/255.0)) ? c : float3(0.0, 0.0, 0.0);\n");
+	out.Write("\t\t\t\telse if (cmp == 3u) cmpresult = (abs(dot(a, comp16) - dot(b, comp16)) < (0.5/255.0)) ? c : float3(0.0, 0.0, 0.0);\n");
+	out.Write("\t\t\t\telse if (cmp == 4u) cmpresult = (dot(a, comp24) >= dot(b, comp24) + (0.25/255.0)) ? c : float3(0.0, 0.0, 0.0);\n");
+	out.Write("\t\t\t\telse if (cmp == 5u) cmpresult = (abs(dot(a, comp24) - dot(b, comp24)) < (0.5/255.0)) ? c : float3(0.0, 0.0, 0.0);\n");
+	out.Write("\t\t\t\telse if (cmp == 6u) cmpresult = max(sign(a - b - (0.25/255.0)), float3(0.0, 0.0, 0.0)) * c;\n");
+	out.Write("\t\t\t\telse cmpresult = (float3(1.0, 1.0, 1.0) - max(sign(abs(a - b) - (0.5/255.0)), float3(0.0, 0.0, 0.0))) * c;\n");
+	out.Write("\t\t\t\tresult = d + cmpresult;\n");
+	out.Write("\t\t\t}\n");
+	out.Write("\t\t\tif (bitfield(cc, 19u, 1u) != 0u)\n");
+	out.Write("\t\t\t\tresult = clamp(result, 0.0, 1.0);\n");
+	out.Write("\t\t\tregs[bitfield(cc, 22u, 2u)].rgb = result;\n");
+	out.Write("\t\t}\n\n");
+
+	// alpha combine
+	out.Write("\t\t{\n");
+	out.Write("\t\t\tfloat4 a = AlphaInput(bitfield(ac, 13u, 3u), cregs, textemp, crastemp, ckonsttemp);\n");
+	out.Write("\t\t\tfloat4 b = AlphaInput(bitfield(ac, 10u, 3u), cregs, textemp, crastemp, ckonsttemp);\n");
+	out.Write("\t\t\tfloat4 c = AlphaInput(bitfield(ac, 7u, 3u), cregs, textemp, crastemp, ckonsttemp);\n");
+	out.Write("\t\t\tfloat d = AlphaInput(bitfield(ac, 4u, 3u), regs, textemp, rastemp, konsttemp).a;\n");
+	out.Write("\t\t\tuint bias = bitfield(ac, 16u, 2u);\n");
+	out.Write("\t\t\tuint op = bitfield(ac, 18u, 1u);\n");
+	out.Write("\t\t\tuint shift = bitfield(ac, 20u, 2u);\n");
+	out.Write("\t\t\tfloat result;\n");
+	out.Write("\t\t\tif (bias != 3u)\n");
+	out.Write("\t\t\t{\n");
+	out.Write("\t\t\t\tfloat lerped = lerp(a.a, b.a, c.a);\n");
+	out.Write("\t\t\t\tresult = TevScale(shift) * ((op == 0u ? d + lerped : d - lerped) + TevBias(bias));\n");
+	out.Write("\t\t\t}\n");
+	out.Write("\t\t\telse\n");
+	out.Write("\t\t\t{\n");
+	out.Write("\t\t\t\tuint cmp = (shift << 1) | op;\n");
+	out.Write("\t\t\t\tbool pass;\n");
+	out.Write("\t\t\t\tif (cmp == 0u) pass = a.r >= b.r + (0.25/255.0);\n");
+	out.Write("\t\t\t\telse if (cmp == 1u) pass = abs(a.r - b.r) < (0.5/255.0);\n");
+	out.Write("\t\t\t\telse if (cmp == 2u) pass = dot(a.rgb, comp16) >= dot(b.rgb, comp16) + (0.25/255.0);\n");
+	out.Write("\t\t\t\telse if (cmp == 3u) pass = abs(dot(a.rgb, comp16) - dot(b.rgb, comp16)) < (0.5/255.0);\n");
+	out.Write("\t\t\t\telse if (cmp == 4u) pass = dot(a.rgb, comp24) >= dot(b.rgb, comp24) + (0.25/255.0);\n");
+	out.Write("\t\t\t\telse if (cmp == 5u) pass = abs(dot(a.rgb, comp24) - dot(b.rgb, comp24)) < (0.5/255.0);\n");
+	out.Write("\t\t\t\telse if (cmp == 6u) pass = a.a >= b.a + (0.25/255.0);\n");
+	out.Write("\t\t\t\telse pass = abs(a.a - b.a) < (0.5/255.0);\n");
+	out.Write("\t\t\t\tresult = d + (pass ? c.a : 0.0);\n");
+	out.Write("\t\t\t}\n");
+	out.Write("\t\t\tif (bitfield(ac, 19u, 1u) != 0u)\n");
+	out.Write("\t\t\t\tresult = clamp(result, 0.0, 1.0);\n");
+	out.Write("\t\t\tregs[bitfield(ac, 22u, 2u)].a = result;\n");
+	out.Write("\t\t}\n");
+	out.Write("\t}\n\n");
+}
+
+template<class T>
+static inline void GenerateUberPixelShader(T& out, DSTALPHA_MODE dstAlphaMode)
+{
+	// Non-uid template parameters will write to the dummy data (=> gets optimized out)
+	uber_pixel_shader_uid_data dummy_data;
+	uber_pixel_shader_uid_data& uid_data = (&out.template GetUidData<uber_pixel_shader_uid_data>() != NULL)
+										? out.template GetUidData<uber_pixel_shader_uid_data>() : dummy_data;
+
+	out.SetBuffer(text);
+	const bool is_writing_shadercode = (out.GetBuffer() != NULL);
+#ifndef ANDROID
+	locale_t locale;
+	locale_t old_locale;
+	if (is_writing_shadercode)
+	{
+		locale = newlocale(LC_NUMERIC_MASK, "C", NULL); // New locale for compilation
+		old_locale = uselocale(locale); // Apply the locale for this thread
+	}
+#endif
+
+	if (is_writing_shadercode)
+		text[sizeof(text) - 1] = 0x7C;  // canary
+
+	const unsigned int numTexGens = xfregs.numTexGen.numTexGens;
+
+	uid_data.num_values = sizeof(uid_data);
+	uid_data.dstAlphaMode = dstAlphaMode;
+	uid_data.numTexGens = numTexGens;
+
+	// Same conditions as in GeneratePixelShader. Writing the depth at all disables early depth
+	// testing on most hardware, so this needs a separate program rather than a runtime flag.
+	const bool forced_early_z = g_ActiveConfig.backend_info.bSupportsEarlyZ && bpmem.UseEarlyDepthTest() && (g_ActiveConfig.bFastDepthCalc || bpmem.alpha_test.TestResult() == AlphaTest::UNDETERMINED);
+	const bool per_pixel_depth = (bpmem.ztex2.op != ZTEXTURE_DISABLE && bpmem.UseLateDepthTest()) || (!g_ActiveConfig.bFastDepthCalc && bpmem.zmode.testenable && !forced_early_z);
+	uid_data.per_pixel_depth = per_pixel_depth;
+	uid_data.forced_early_z = forced_early_z;
+
+	out.Write("//Uber pixel shader, TEV state is read from " I_UBERGENMODE"/" I_UBERMISC"/" I_UBERSTAGES"\n");
+	out.Write("//%i texgens\n", numTexGens);
+
+	// 32 bit integers are needed for unpacking the bitfields
+	out.Write("precision highp int;\n\n");
+
+	// Declare samplers
+	for (int i = 0; i < 8; ++i)
+		out.Write("uniform sampler2D samp%d;\n", i);
+	out.Write("\n");
+
+	// Must match the layout used by GeneratePixelShader, extended by the uber shader state
+	out.Write("layout(std140%s) uniform PSBlock {\n", g_ActiveConfig.backend_info.bSupportShadingLanguage420pack ? ", binding = 1" : "");
+	DeclareUniform(out, API_OPENGL, C_COLORS, "float4", I_COLORS"[4]");
+	DeclareUniform(out, API_OPENGL, C_KCOLORS, "float4", I_KCOLORS"[4]");
+	DeclareUniform(out, API_OPENGL, C_ALPHA, "float4", I_ALPHA"[1]");
+	DeclareUniform(out, API_OPENGL, C_TEXDIMS, "float4", I_TEXDIMS"[8]");
+	DeclareUniform(out, API_OPENGL, C_ZBIAS, "float4", I_ZBIAS"[2]");
+	DeclareUniform(out, API_OPENGL, C_INDTEXSCALE, "float4", I_INDTEXSCALE"[2]");
+	DeclareUniform(out, API_OPENGL, C_INDTEXMTX, "float4", I_INDTEXMTX"[6]");
+	DeclareUniform(out, API_OPENGL, C_FOG, "float4", I_FOG"[3]");
+	DeclareUniform(out, API_OPENGL, C_PLIGHTS, "float4", I_PLIGHTS"[40]");
+	DeclareUniform(out, API_OPENGL, C_PMATERIALS, "float4", I_PMATERIALS"[4]");
+	DeclareUniform(out, API_OPENGL, C_UBERGENMODE, "uvec4", I_UBERGENMODE);
+	DeclareUniform(out, API_OPENGL, C_UBERMISC, "uvec4", I_UBERMISC);
+	DeclareUniform(out, API_OPENGL, C_UBERSTAGES, "uvec4", I_UBERSTAGES"[16]");
+	out.Write("};\n\n");
+
+	out.Write("out vec4 ocol0;\n");
+	if (dstAlphaMode == DSTALPHA_DUAL_SOURCE_BLEND)
+		out.Write("out vec4 ocol1;\n");
+
+	out.Write("centroid in float4 colors_02;\n");
+	out.Write("centroid in float4 colors_12;\n");
+	for (unsigned int i = 0; i < numTexGens; ++i)
+		out.Write("centroid in float3 uv%d_2;\n", i);
+	out.Write("centroid in float4 clipPos_2;\n\n");
+
+	if (forced_early_z)
+	{
+		// HACK: This doesn't force the driver to write to depth buffer if alpha test fails.
+		// It just allows it, but it seems that all drivers do.
+		out.Write("layout(early_fragment_tests) in;\n\n");
+	}
+
+	WriteHelpers<T>(out);
+
+	out.Write("void main()\n{\n");
+
+	out.Write("\tuint genmode = " I_UBERGENMODE".x;\n");
+	out.Write("\tuint alpha_test = " I_UBERGENMODE".y;\n");
+	out.Write("\tuint flags = " I_UBERGENMODE".z;\n");
+	out.Write("\tuint tevindref = " I_UBERGENMODE".w;\n");
+	out.Write("\tuint num_texgens = bitfield(genmode, 0u, 4u);\n");
+	out.Write("\tuint num_stages = bitfield(genmode, 10u, 4u) + 1u;\n");
+	out.Write("\tuint num_ind_stages = bitfield(genmode, 16u, 3u);\n\n");
+
+	out.Write("\tfloat4 regs[4];\n");
+	out.Write("\tregs[0] = float4(0.0, 0.0, 0.0, 0.0);\n");
+	out.Write("\tregs[1] = " I_COLORS"[1];\n");
+	out.Write("\tregs[2] = " I_COLORS"[2];\n");
+	out.Write("\tregs[3] = " I_COLORS"[3];\n");
+	out.Write("\tfloat4 textemp = float4(0.0, 0.0, 0.0, 0.0), rastemp = float4(0.0, 0.0, 0.0, 0.0), konsttemp = float4(0.0, 0.0, 0.0, 0.0);\n");
+	out.Write("\tfloat3 comp16 = float3(1.0, 255.0, 0.0), comp24 = float3(1.0, 255.0, 255.0*255.0);\n");
+	out.Write("\tfloat alphabump = 0.0;\n");
+	out.Write("\tfloat3 tevcoord = float3(0.0, 0.0, 0.0);\n\n");
+
+	// On Mali, global variables must be initialized as constants.
+	// This is why we initialize these variables locally instead.
+	out.Write("\tfloat4 rawpos = gl_FragCoord;\n");
+	out.Write("\tfloat4 colors_0 = colors_02;\n");
+	out.Write("\tfloat4 colors_1 = colors_12;\n");
+	out.Write("\tfloat4 clipPos = float4(rawpos.x, rawpos.y, clipPos_2.z, clipPos_2.w);\n");
+	out.Write("\tfloat3 uv[8];\n");
+	for (unsigned int i = 0; i < 8; ++i)
+	{
+		if (i < numTexGens)
+			out.Write("\tuv[%d] = uv%d_2;\n", i, i);
+		else
+			out.Write("\tuv[%d] = float3(0.0, 0.0, 0.0);\n", i);
+	}
+	out.Write("\n");
+
+	// optional perspective divides
+	out.Write("\tfor (uint i = 0u; i < num_texgens; ++i)\n");
+	out.Write("\t{\n");
+	out.Write("\t\tif (bitfield(" I_UBERMISC".y, i, 1u) != 0u && uv[i].z != 0.0)\n");
+	out.Write("\t\t\tuv[i].xy = uv[i].xy / uv[i].z;\n");
+	out.Write("\t\tuv[i].xy = uv[i].xy * " I_TEXDIMS"[i].zw;\n");
+	out.Write("\t}\n\n");
+
+	// indirect texture map lookup
+	out.Write("\tfloat3 indtex[4];\n");
+	out.Write("\tfor (uint i = 0u; i < 4u; ++i)\n");
+	out.Write("\t{\n");
+	out.Write("\t\tindtex[i] = float3(0.0, 0.0, 0.0);\n");
+	out.Write("\t\tif (i >= num_ind_stages)\n");
+	out.Write("\t\t\tcontinue;\n");
+	out.Write("\t\tuint texcoord = bitfield(tevindref, 6u * i + 3u, 3u);\n");
+	out.Write("\t\tfloat2 tempcoord = float2(0.0, 0.0);\n");
+	out.Write("\t\tif (texcoord < num_texgens)\n");
+	out.Write("\t\t\ttempcoord = uv[texcoord].xy * ((i & 1u) != 0u ? " I_INDTEXSCALE"[i >> 1].zw : " I_INDTEXSCALE"[i >> 1].xy);\n");
+	out.Write("\t\tindtex[i] = SampleTexmap(bitfield(tevindref, 6u * i, 3u), tempcoord).abg;\n");
+	out.Write("\t}\n\n");
+
+	WriteStageLoop<T>(out);
+
+	// The results of the last texenv stage are put onto the screen,
+	// regardless of the used destination register
+	out.Write("\tuint last_cc = " I_UBERSTAGES"[num_stages - 1u].x;\n");
+	out.Write("\tuint last_ac = " I_UBERSTAGES"[num_stages - 1u].y;\n");
+	out.Write("\tfloat4 prev = Wrap8(float4(regs[bitfield(last_cc, 22u, 2u)].rgb, regs[bitfield(last_ac, 22u, 2u)].a));\n\n");
+
+	// alpha test
+	out.Write("\tbool alpha_pass = true;\n");
+	out.Write("\tif ((flags & %uu) != 0u)\n", UBER_FLAG_ALPHA_TEST);
+	out.Write("\t{\n");
+	out.Write("\t\tbool comp0 = AlphaCompare(prev.a, " I_ALPHA"[0].r, bitfield(alpha_test, 16u, 3u));\n");
+	out.Write("\t\tbool comp1 = AlphaCompare(prev.a, " I_ALPHA"[0].g, bitfield(alpha_test, 19u, 3u));\n");
+	out.Write("\t\tuint logic = bitfield(alpha_test, 22u, 2u);\n");
+	out.Write("\t\talpha_pass = logic == 0u ? (comp0 && comp1) : logic == 1u ? (comp0 || comp1) : logic == 2u ? (comp0 != comp1) : (comp0 == comp1);\n");
+	out.Write("\t}\n");
+	// With the zcomploc hack the fragment is kept, see WriteAlphaTest in PixelShaderGen.cpp
+	out.Write("\tif (!alpha_pass && (flags & %uu) == 0u)\n", UBER_FLAG_ZCOMPLOC_HACK);
+	out.Write("\t{\n");
+	out.Write("\t\tdiscard;\n");
+	out.Write("\t\treturn;\n");
+	out.Write("\t}\n\n");
+
+	out.Write("\tfloat zCoord = (flags & %uu) != 0u ? rawpos.z : " I_ZBIAS"[1].x + (clipPos.z / clipPos.w) * " I_ZBIAS"[1].y;\n", UBER_FLAG_FAST_DEPTH);
+	out.Write("\tbool early_ztest = (flags & %uu) != 0u;\n", UBER_FLAG_EARLY_ZTEST);
+	if (per_pixel_depth)
+	{
+		// Note: z-textures are not written to depth buffer if early depth test is used
+		out.Write("\tgl_FragDepth = early_ztest ? zCoord : rawpos.z;\n");
+	}
+
+	out.Write("\tuint ztex_op = bitfield(flags, %du, 2u);\n", UBER_FLAG_ZTEX_OP_SHIFT);
+	out.Write("\tif (ztex_op != %du)\n", ZTEXTURE_DISABLE);
+	out.Write("\t{\n");
+	out.Write("\t\tzCoord = dot(" I_ZBIAS"[0].xyzw, textemp.xyzw) + " I_ZBIAS"[1].w + (ztex_op == %du ? zCoord : 0.0);\n", ZTEXTURE_ADD);
+	// U24 overflow emulation
+	out.Write("\t\tzCoord = frac(zCoord * (16777215.0/16777216.0)) * (16777216.0/16777215.0);\n");
+	out.Write("\t}\n");
+
+	if (per_pixel_depth)
+	{
+		out.Write("\tif (!early_ztest)\n");
+		out.Write("\t\tgl_FragDepth = zCoord;\n");
+	}
+	out.Write("\n");
+
+	if (dstAlphaMode == DSTALPHA_ALPHA_PASS)
+	{
+		out.Write("\tocol0 = float4(prev.rgb, " I_ALPHA"[0].a);\n");
+	}
+	else
+	{
+		// fog
+		out.Write("\tuint fsel = bitfield(flags, %du, 3u);\n", UBER_FLAG_FOG_FSEL_SHIFT);
+		out.Write("\tif (fsel != 0u)\n");
+		out.Write("\t{\n");
+		out.Write("\t\tfloat ze;\n");
+		out.Write("\t\tif ((flags & %uu) == 0u)\n", UBER_FLAG_FOG_PROJ);
+		out.Write("\t\t\tze = " I_FOG"[1].x / (" I_FOG"[1].y - (zCoord / " I_FOG"[1].w));\n");
+		out.Write("\t\telse\n");
+		out.Write("\t\t\tze = " I_FOG"[1].x * zCoord;\n");
+		out.Write("\t\tif ((flags & %uu) != 0u)\n", UBER_FLAG_FOG_RANGE);
+		out.Write("\t\t{\n");
+		out.Write("\t\t\tfloat x_adjust = (2.0 * (clipPos.x / " I_FOG"[2].y)) - 1.0 - " I_FOG"[2].x;\n");
+		out.Write("\t\t\tx_adjust = sqrt(x_adjust * x_adjust + " I_FOG"[2].z * " I_FOG"[2].z) / " I_FOG"[2].z;\n");
+		out.Write("\t\t\tze *= x_adjust;\n");
+		out.Write("\t\t}\n");
+		out.Write("\t\tfloat fog = clamp(ze - " I_FOG"[1].z, 0.0, 1.0);\n");
+		out.Write("\t\tif (fsel == 4u) fog = 1.0 - exp2(-8.0 * fog);\n");
+		out.Write("\t\telse if (fsel == 5u) fog = 1.0 - exp2(-8.0 * fog * fog);\n");
+		out.Write("\t\telse if (fsel == 6u) fog = exp2(-8.0 * (1.0 - fog));\n");
+		out.Write("\t\telse if (fsel == 7u) fog = exp2(-8.0 * (1.0 - fog) * (1.0 - fog));\n");
+		out.Write("\t\tprev.rgb = lerp(prev.rgb, " I_FOG"[0].rgb, fog);\n");
+		out.Write("\t}\n");
+		out.Write("\tocol0 = prev;\n");
+	}
+
+	// Use dual-source color blending to perform dst alpha in a single pass
+	if (dstAlphaMode == DSTALPHA_DUAL_SOURCE_BLEND)
+	{
+		out.Write("\tocol1 = prev;\n");
+		out.Write("\tocol0.a = " I_ALPHA"[0].a;\n");
+	}
+
+	out.Write("}\n");
+
+	if (is_writing_shadercode)
+	{
+		if (text[sizeof(text) - 1] != 0x7C)
+			PanicAlert("UberShaderPixel generator - buffer too small, canary has been eaten!");
+
+#ifndef ANDROID
+		uselocale(old_locale); // restore locale
+		freelocale(locale);
+#endif
+	}
+}
+
+void GetUberPixelShaderUid(UberPixelShaderUid& object, DSTALPHA_MODE dstAlphaMode)
+{
+	GenerateUberPixelShader<UberPixelShaderUid>(object, dstAlphaMode);
+}
+
+void GenerateUberPixelShaderCode(PixelShaderCode& object, DSTALPHA_MODE dstAlphaMode)
+{
+	GenerateUberPixelShader<PixelShaderCode>(object, dstAlphaMode);
+}
@@ -0,0 +1,58 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "VideoCommon/PixelShaderGen.h"
+#include "VideoCommon/ShaderGenCommon.h"
+#include "VideoCommon/VideoCommon.h"
+
+// The uber pixel shader interprets the TEV configuration at runtime instead of baking it into
+// the shader source. All state it needs is packed into the I_UBER* uniforms by PixelShaderManager,
+// so a single program per vertex shader can draw any TEV setup while specialized shaders compile.
+// Only GLSL is generated, so backends without GLSL leave bSupportsUberShaders unset.
+
+#define I_UBERGENMODE "ubergenmode"
+#define I_UBERMISC    "ubermisc"
+#define I_UBERSTAGES  "uberstages"
+
+#define C_UBERGENMODE   C_PENVCONST_END
+#define C_UBERMISC      (C_UBERGENMODE + 1)
+#define C_UBERSTAGES    (C_UBERMISC + 1)
+#define C_UBER_END      (C_UBERSTAGES + 16)
+
+// Bits of ubergenmode.z
+enum
+{
+	UBER_FLAG_FOG_FSEL_SHIFT     = 0,  // 3 bits
+	UBER_FLAG_FOG_PROJ           = 1 << 3,
+	UBER_FLAG_FOG_RANGE          = 1 << 4,
+	UBER_FLAG_ZTEX_OP_SHIFT      = 5,  // 2 bits
+	UBER_FLAG_EARLY_ZTEST        = 1 << 7,
+	UBER_FLAG_FAST_DEPTH         = 1 << 8,
+	UBER_FLAG_ALPHA_TEST         = 1 << 9,
+	UBER_FLAG_ZCOMPLOC_HACK      = 1 << 10,
+};
+
+#pragma pack(1)
+struct uber_pixel_shader_uid_data
+{
+	u32 num_values; // TODO: Shouldn't be a u32
+	u32 NumValues() const { return num_values; }
+
+	u32 dstAlphaMode : 2;
+	u32 numTexGens : 4; // number of varyings declared by the vertex shader
+	u32 per_pixel_depth : 1; // gl_FragDepth is only written by the programs which need it
+	u32 forced_early_z : 1; // early_fragment_tests is a layout qualifier, not a runtime flag
+	u32 pad0 : 24;
+};
+#pragma pack()
+
+typedef ShaderUid<uber_pixel_shader_uid_data> UberPixelShaderUid;
+
+// Returns false if the current configuration needs features the uber shader doesn't implement (e.g. per-pixel lighting).
+bool CanUseUberPixelShader();
+
+void GetUberPixelShaderUid(UberPixelShaderUid& object, DSTALPHA_MODE dstAlphaMode);
+void GenerateUberPixelShaderCode(PixelShaderCode& object, DSTALPHA_MODE dstAlphaMode);
@@ -67,7 +67,7 @@ void VertexManager::PrepareForAdditionalData(int primitive, u32 count, u32 strid
 		Flush();
 
 		if(count > IndexGenerator::GetRemainingIndices())
-			ERROR_LOG(VIDEO, "Too little remaining index values. Use 32-bit or reset them on flush.");
+			ERROR_LOG(VIDEO, "Too little remaining index values.");
 		if (count > GetRemainingIndices(primitive))
 			ERROR_LOG(VIDEO, "VertexManager: Buffer not large enough for all indices! "
 				"Increase MAXIBUFFERSIZE or we need primitive breaking after all.");
@@ -35,6 +35,7 @@ static float s_fViewTranslationVector[3];
 static float s_fViewRotation[2];
 
 VertexShaderConstants VertexShaderManager::constants;
+ConstantDirtyTracker<VertexShaderConstants> VertexShaderManager::dirty_regs;
 bool VertexShaderManager::dirty;
 
 struct ProjectionHack
@@ -213,6 +214,8 @@ void VertexShaderManager::Dirty()
 
 	nMaterialsChanged = 15;
 
+	// some registers are only written when their content changes, so make sure everything is uploaded again
+	dirty_regs.SetAll();
 	dirty = true;
 }
 
@@ -225,7 +228,7 @@ void VertexShaderManager::SetConstants()
 		int startn = nTransformMatricesChanged[0] / 4;
 		int endn = (nTransformMatricesChanged[1] + 3) / 4;
 		memcpy(constants.transformmatrices[startn], &xfmem[startn * 4], (endn - startn) * 16);
-		dirty = true;
+		MarkDirty(constants.transformmatrices[startn], (endn - startn) * 16);
 		nTransformMatricesChanged[0] = nTransformMatricesChanged[1] = -1;
 	}
 
@@ -237,7 +240,7 @@ void VertexShaderManager::SetConstants()
 		{
 			memcpy(constants.normalmatrices[i], &xfmem[XFMEM_NORMALMATRICES + 3*i], 12);
 		}
-		dirty = true;
+		MarkDirty(constants.normalmatrices[startn], (endn - startn) * 16);
 		nNormalMatricesChanged[0] = nNormalMatricesChanged[1] = -1;
 	}
 
@@ -246,7 +249,7 @@ void VertexShaderManager::SetConstants()
 		int startn = nPostTransformMatricesChanged[0] / 4;
 		int endn = (nPostTransformMatricesChanged[1] + 3 ) / 4;
 		memcpy(constants.posttransformmatrices[startn], &xfmem[XFMEM_POSTMATRICES + startn * 4], (endn - startn) * 16);
-		dirty = true;
+		MarkDirty(constants.posttransformmatrices[startn], (endn - startn) * 16);
 		nPostTransformMatricesChanged[0] = nPostTransformMatricesChanged[1] = -1;
 	}
 
@@ -282,7 +285,7 @@ void VertexShaderManager::SetConstants()
 				constants.lights[5*i+j+1][2] = xfmemptr[2];
 			}
 		}
-		dirty = true;
+		MarkDirty(constants.lights[5*istart], (iend - istart) * 5 * 16);
 
 		nLightsChanged[0] = nLightsChanged[1] = -1;
 	}
@@ -298,6 +301,7 @@ void VertexShaderManager::SetConstants()
 				constants.materials[i][1] = ((data >> 16) & 0xFF) / 255.0f;
 				constants.materials[i][2] = ((data >>  8) & 0xFF) / 255.0f;
 				constants.materials[i][3] = ( data        & 0xFF) / 255.0f;
+				MarkDirty(constants.materials[i], 16);
 			}
 		}
 
@@ -310,9 +314,9 @@ void VertexShaderManager::SetConstants()
 				constants.materials[i+2][1] = ((data >> 16) & 0xFF) / 255.0f;
 				constants.materials[i+2][2] = ((data >>  8) & 0xFF) / 255.0f;
 				constants.materials[i+2][3] = ( data        & 0xFF) / 255.0f;
+				MarkDirty(constants.materials[i+2], 16);
 			}
 		}
-		dirty = true;
 
 		nMaterialsChanged = 0;
 	}
@@ -328,7 +332,7 @@ void VertexShaderManager::SetConstants()
 		memcpy(constants.posnormalmatrix[3], norm, 12);
 		memcpy(constants.posnormalmatrix[4], norm+3, 12);
 		memcpy(constants.posnormalmatrix[5], norm+6, 12);
-		dirty = true;
+		MarkDirty(constants.posnormalmatrix, sizeof(constants.posnormalmatrix));
 	}
 
 	if (bTexMatricesChanged[0])
@@ -344,7 +348,7 @@ void VertexShaderManager::SetConstants()
 		{
 			memcpy(constants.texmatrices[3*i], fptrs[i], 3*16);
 		}
-		dirty = true;
+		MarkDirty(constants.texmatrices[0], 12*16);
 	}
 
 	if (bTexMatricesChanged[1])
@@ -359,7 +363,7 @@ void VertexShaderManager::SetConstants()
 		{
 			memcpy(constants.texmatrices[3*i+12], fptrs[i], 3*16);
 		}
-		dirty = true;
+		MarkDirty(constants.texmatrices[12], 12*16);
 	}
 
 	if (bViewportChanged)
@@ -367,7 +371,7 @@ void VertexShaderManager::SetConstants()
 		bViewportChanged = false;
 		constants.depthparams[0] = xfregs.viewport.farZ / 16777216.0f;
 		constants.depthparams[1] = xfregs.viewport.zRange / 16777216.0f;
-		dirty = true;
+		MarkDirty(constants.depthparams, sizeof(float4));
 		// This is so implementation-dependent that we can't have it here.
 		g_renderer->SetViewport();
 		
@@ -514,7 +518,7 @@ void VertexShaderManager::SetConstants()
 			Matrix44::Multiply(s_viewportCorrection, projMtx, correctedMtx);
 			memcpy(constants.projection, correctedMtx.data, 4*16);
 		}
-		dirty = true;
+		MarkDirty(constants.projection, sizeof(constants.projection));
 	}
 }
 
@@ -35,5 +35,14 @@ public:
 	static void ResetView();
 
 	static VertexShaderConstants constants;
+	static ConstantDirtyTracker<VertexShaderConstants> dirty_regs; // registers changed since the last upload
 	static bool dirty;
+
+private:
+	// flags the registers covered by a part of constants for the next upload
+	static void MarkDirty(const void* member, size_t size)
+	{
+		dirty_regs.Set(constants, member, size);
+		dirty = true;
+	}
 };
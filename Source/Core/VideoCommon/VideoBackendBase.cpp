@@ -6,6 +6,7 @@
 #ifdef _WIN32
 #include "VideoBackends/D3D/VideoBackend.h"
 #endif
+#include "VideoBackends/Null/VideoBackend.h"
 #include "VideoBackends/OGL/VideoBackend.h"
 #include "VideoBackends/Software/VideoBackend.h"
 
@@ -47,6 +48,8 @@ void VideoBackend::PopulateList()
 		g_available_video_backends.push_back(backends[1] = new DX11::VideoBackend);
 #endif
 	g_available_video_backends.push_back(backends[3] = new SW::VideoSoftware);
+	// Only ever picked by name
+	g_available_video_backends.push_back(new Null::VideoBackend);
 
 	for (VideoBackend* backend : backends)
 	{
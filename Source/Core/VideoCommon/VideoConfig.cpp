@@ -83,6 +83,8 @@ void VideoConfig::Load(const char *ini_file)
 	iniFile.Get("Settings", "OMPDecoder", &bOMPDecoder, false);
 
 	iniFile.Get("Settings", "EnableShaderDebugging", &bEnableShaderDebugging, false);
+	iniFile.Get("Settings", "AsyncShaderCompilation", &bAsyncShaderCompilation, false);
+	iniFile.Get("Settings", "UberShaders", &bUberShaders, false);
 
 	iniFile.Get("Enhancements", "ForceFiltering", &bForceFiltering, 0);
 	iniFile.Get("Enhancements", "MaxAnisotropy", &iMaxAnisotropy, 0);  // NOTE - this is x in (1 << x)
@@ -181,6 +183,8 @@ void VideoConfig::GameIniLoad()
 	CHECK_SETTING("Video_Settings", "DstAlphaPass", bDstAlphaPass);
 	CHECK_SETTING("Video_Settings", "DisableFog", bDisableFog);
 	CHECK_SETTING("Video_Settings", "OMPDecoder", bOMPDecoder);
+	CHECK_SETTING("Video_Settings", "AsyncShaderCompilation", bAsyncShaderCompilation);
+	CHECK_SETTING("Video_Settings", "UberShaders", bUberShaders);
 
 	CHECK_SETTING("Video_Enhancements", "ForceFiltering", bForceFiltering);
 	CHECK_SETTING("Video_Enhancements", "MaxAnisotropy", iMaxAnisotropy);  // NOTE - this is x in (1 << x)
@@ -259,6 +263,8 @@ void VideoConfig::Save(const char *ini_file)
 	iniFile.Set("Settings", "OMPDecoder", bOMPDecoder);
 
 	iniFile.Set("Settings", "EnableShaderDebugging", bEnableShaderDebugging);
+	iniFile.Set("Settings", "AsyncShaderCompilation", bAsyncShaderCompilation);
+	iniFile.Set("Settings", "UberShaders", bUberShaders);
 
 	iniFile.Set("Enhancements", "ForceFiltering", bForceFiltering);
 	iniFile.Set("Enhancements", "MaxAnisotropy", iMaxAnisotropy);
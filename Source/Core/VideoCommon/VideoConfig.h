@@ -70,6 +70,12 @@ struct VideoConfig
 	// OpenMP
 	bool bOMPDecoder;
 
+	// Compile new shaders in the background and skip draws using them until they are ready
+	bool bAsyncShaderCompilation;
+
+	// Draw everything with the uber pixel shader instead of specialized shaders
+	bool bUberShaders;
+
 	// Enhancements
 	int iMultisampleMode;
 	int iEFBScale;
@@ -153,6 +159,7 @@ struct VideoConfig
 		bool bSupportsOversizedViewports;
 		bool bSupportsEarlyZ; // needed by PixelShaderGen, so must stay in VideoCommon
 		bool bSupportShadingLanguage420pack; // needed by ShaderGen, so must stay in VideoCommon
+		bool bSupportsUberShaders; // needed by PixelShaderManager, so must stay in VideoCommon
 	} backend_info;
 
 	// Utility
@@ -142,6 +142,7 @@ void XFRegWritten(int transferSize, u32 baseAddress, u32 *pData)
 		case XFMEM_SETTEXMTXINFO+6:
 		case XFMEM_SETTEXMTXINFO+7:
 			VertexManager::Flush();
+			PixelShaderManager::SetUberShaderStateChanged();
 
 			nextAddress = XFMEM_SETTEXMTXINFO + 8;
 			break;
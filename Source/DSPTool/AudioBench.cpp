@@ -0,0 +1,220 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "AudioCommon/DPL2Decoder.h"
+#include "AudioCommon/Resampler.h"
+#include "Common/Common.h"
+#include "Common/Timer.h"
+
+#include "AudioBench.h"
+
+// Same ring size as CMixer
+#define RING_FRAMES     4096
+#define RING_MASK       (RING_FRAMES * 2 - 1)
+
+// Output frames per audio callback
+#define CALLBACK_FRAMES 256
+#define BENCH_MIN_MS    200
+#define TONE_HZ         997.0
+#define TONE_AMPLITUDE  16000.0
+#define QUALITY_FRAMES  8192
+
+#define TONE_FRAMES     (1 << 16)
+
+struct Stream
+{
+	short ring[RING_FRAMES * 2];
+	u32 indexR;
+	u32 indexW;
+	u32 written; // input frames produced so far
+	std::vector<short> tone; // big endian, like the samples the DSP pushes
+};
+
+static void ResetStream(Stream& stream, double in_rate)
+{
+	const double pi = 3.14159265358979323846;
+	memset(stream.ring, 0, sizeof(stream.ring));
+	stream.indexR = 0;
+	stream.indexW = 0;
+	stream.written = 0;
+	if (!stream.tone.empty())
+		return;
+	stream.tone.resize(TONE_FRAMES * 2);
+	for (u32 i = 0; i < TONE_FRAMES; ++i)
+	{
+		s16 sample = (s16)lrint(TONE_AMPLITUDE * sin(2 * pi * TONE_HZ * i / in_rate));
+		stream.tone[i * 2] = Common::swap16(sample);
+		stream.tone[i * 2 + 1] = Common::swap16((u16)-sample);
+	}
+}
+
+// Tops the ring up to fill frames of the tone
+static void Produce(Stream& stream, u32 fill)
+{
+	u32 used = ((stream.indexW - stream.indexR) & RING_MASK) / 2;
+	for (; used < fill; ++used)
+	{
+		u32 frame = stream.written++ & (TONE_FRAMES - 1);
+		stream.ring[stream.indexW & RING_MASK] = stream.tone[frame * 2];
+		stream.ring[(stream.indexW + 1) & RING_MASK] = stream.tone[frame * 2 + 1];
+		stream.indexW += 2;
+	}
+}
+
+// ns per output frame with the ring kept full. Refilling the ring is included.
+static double TimeResampler(int type, double in_rate, u32 ratio)
+{
+	std::unique_ptr<Resampler> resampler(Resampler::Create(type));
+	std::unique_ptr<Stream> stream(new Stream);
+	ResetStream(*stream, in_rate);
+	short out[CALLBACK_FRAMES * 2];
+
+	u64 frames = 0;
+	u32 start = Common::Timer::GetTimeMs();
+	u32 elapsed;
+	do
+	{
+		for (int i = 0; i < 64; ++i)
+		{
+			Produce(*stream, RING_FRAMES - 1);
+			frames += resampler->Resample(stream->ring, RING_MASK, stream->indexR, stream->indexW, out, CALLBACK_FRAMES, ratio);
+		}
+		elapsed = Common::Timer::GetTimeMs() - start;
+	} while (elapsed < BENCH_MIN_MS);
+
+	return elapsed * 1000000.0 / frames;
+}
+
+// Ratio of the tone to everything else in the output, in dB. The tone is
+// fitted by least squares since every resampler has a different delay.
+static double MeasureQuality(int type, double in_rate, u32 ratio)
+{
+	const double pi = 3.14159265358979323846;
+	std::unique_ptr<Resampler> resampler(Resampler::Create(type));
+	std::unique_ptr<Stream> stream(new Stream);
+	ResetStream(*stream, in_rate);
+
+	std::vector<short> out(QUALITY_FRAMES * 2);
+	u32 done = 0;
+	while (done < QUALITY_FRAMES)
+	{
+		Produce(*stream, RING_FRAMES - 1);
+		done += resampler->Resample(stream->ring, RING_MASK, stream->indexR, stream->indexW,
+		                            &out[done * 2], std::min<u32>(CALLBACK_FRAMES, QUALITY_FRAMES - done), ratio);
+	}
+
+	// Skip the start, where the filter history is still silent
+	const u32 first = 64;
+	const double w = 2 * pi * TONE_HZ / in_rate * ratio / 65536.0;
+	double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+	for (u32 i = first; i < QUALITY_FRAMES; ++i)
+	{
+		double s = sin(w * i), c = cos(w * i), y = out[i * 2 + 1];
+		ss += s * s; sc += s * c; cc += c * c;
+		ys += y * s; yc += y * c;
+	}
+	double det = ss * cc - sc * sc;
+	double a = (ys * cc - yc * sc) / det;
+	double b = (yc * ss - ys * sc) / det;
+
+	double signal = 0, noise = 0;
+	for (u32 i = first; i < QUALITY_FRAMES; ++i)
+	{
+		double fit = a * sin(w * i) + b * cos(w * i);
+		double err = out[i * 2 + 1] - fit;
+		signal += fit * fit;
+		noise += err * err;
+	}
+	return 10 * log10(signal / std::max(noise, 1e-9));
+}
+
+// The fewest input frames (in the ring plus held back by the resampler) that
+// play CALLBACK_FRAMES sized callbacks without running dry.
+static u32 MeasureMinLatency(int type, double in_rate, u32 ratio)
+{
+	std::unique_ptr<Stream> stream(new Stream);
+	short out[CALLBACK_FRAMES * 2];
+
+	for (u32 fill = 1; fill < RING_FRAMES; ++fill)
+	{
+		std::unique_ptr<Resampler> resampler(Resampler::Create(type));
+		ResetStream(*stream, in_rate);
+
+		bool underrun = false;
+		u32 latency = 0;
+		for (int i = 0; i < 400 && !underrun; ++i)
+		{
+			Produce(*stream, fill);
+			latency = std::max(latency, fill + resampler->GetDelay());
+			u32 done = resampler->Resample(stream->ring, RING_MASK, stream->indexR, stream->indexW, out, CALLBACK_FRAMES, ratio);
+			// The first callbacks fill the filter history
+			underrun = i >= 4 && done < CALLBACK_FRAMES;
+		}
+		if (!underrun)
+			return latency;
+	}
+	return RING_FRAMES;
+}
+
+void RunResamplerBench()
+{
+	static const struct
+	{
+		int type;
+		const char* name;
+	} resamplers[] = {
+		{ RESAMPLER_LINEAR, "linear" },
+		{ RESAMPLER_SINC, "sinc" },
+	};
+	static const double in_rates[] = { 32000.0, 48000.0 };
+	const double out_rate = 48000.0;
+
+	printf("%-8s %-14s %12s %10s %14s\n", "", "rates", "ns/frame", "SNR (dB)", "latency (ms)");
+	for (double in_rate : in_rates)
+	{
+		const u32 ratio = (u32)(65536.0 * in_rate / out_rate);
+		for (auto& resampler : resamplers)
+		{
+			double ns = TimeResampler(resampler.type, in_rate, ratio);
+			double snr = MeasureQuality(resampler.type, in_rate, ratio);
+			u32 latency = MeasureMinLatency(resampler.type, in_rate, ratio);
+			printf("%-8s %5.0f->%-6.0f %12.2f %10.1f %14.2f\n", resampler.name, in_rate, out_rate,
+			       ns, snr, latency * 1000.0 / in_rate);
+		}
+	}
+}
+
+void RunDPL2Bench()
+{
+	const double pi = 3.14159265358979323846;
+	std::vector<float> in(CALLBACK_FRAMES * 2 * 64);
+	std::vector<float> out(CALLBACK_FRAMES * 6);
+	for (u32 i = 0; i < in.size() / 2; ++i)
+	{
+		in[i * 2] = (float)(0.25 * sin(2 * pi * TONE_HZ * i / 48000.0));
+		in[i * 2 + 1] = (float)(0.25 * cos(2 * pi * TONE_HZ * 3 * i / 48000.0));
+	}
+
+	dpl2reset();
+	u64 frames = 0;
+	u32 start = Common::Timer::GetTimeMs();
+	u32 elapsed;
+	do
+	{
+		for (u32 i = 0; i < 64; ++i)
+		{
+			dpl2decode(&in[i * CALLBACK_FRAMES * 2], CALLBACK_FRAMES, &out[0]);
+			frames += CALLBACK_FRAMES;
+		}
+		elapsed = Common::Timer::GetTimeMs() - start;
+	} while (elapsed < BENCH_MIN_MS);
+
+	printf("%-8s %-14s %12.2f\n", "dpl2", "48000", elapsed * 1000000.0 / frames);
+}
@@ -0,0 +1,13 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Times the resamplers of CMixer at 32000 -> 48000 and 48000 -> 48000 Hz and
+// measures their quality and the lowest buffer latency they play without
+// underruns at.
+void RunResamplerBench();
+
+// Times the Dolby Pro Logic II decoder of the OpenAL backend in ns per frame.
+void RunDPL2Bench();
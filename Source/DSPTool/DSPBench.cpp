@@ -0,0 +1,452 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Common/Common.h"
+#include "Common/CommonPaths.h"
+#include "Common/FileUtil.h"
+#include "Common/MemoryUtil.h"
+#include "Common/StringUtil.h"
+#include "Common/Timer.h"
+
+#include "Core/DSP/DSPAnalyzer.h"
+#include "Core/DSP/DSPCodeUtil.h"
+#include "Core/DSP/DSPCore.h"
+#include "Core/DSP/DSPEmitter.h"
+#include "Core/DSP/DSPHWInterface.h"
+#include "Core/DSP/DSPTables.h"
+
+#include "DSPBench.h"
+
+// Layout of the main memory dsp_base.inc talks to. The register dumps are
+// DMAed back over the register image, like DSPSpy does it.
+#define HOST_RAM_SIZE   0x8000
+#define HOST_DRAM_IMAGE 0x1000
+#define HOST_REGS       0x4000
+
+// Where the test ucodes keep their registers in DRAM (see dsp_base.inc).
+#define UCODE_REGS_BASE 0x0f80
+#define UCODE_ENTRY     0x0010
+
+#define SLICE_CYCLES     5000
+// The ucodes end in an endless loop. They are done once they stop sending
+// mail for this many slices.
+#define MAX_IDLE_SLICES  40
+
+// Every opcode is repeated this many times per loop iteration...
+#define BENCH_UNROLL     32
+// ...for this many iterations.
+#define BENCH_ITERATIONS 255
+#define BENCH_MIN_MS     20
+
+// The registers DSPSpy starts the tests with.
+static const u16 s_regs_in[32] = {
+	0x0410, 0x0510, 0x0610, 0x0710, 0x0810, 0x0910, 0x0a10, 0x0b10,
+	0xffff, 0xffff, 0xffff, 0xffff, 0x0855, 0x0966, 0x0a77, 0x0b88,
+	0x0014, 0xfff5, 0x00ff, 0x2200, 0x0000, 0x0000, 0x0000, 0x0000,
+	0x0003, 0x0004, 0x8000, 0x000c, 0x0007, 0x0008, 0x0009, 0x000a,
+};
+
+// The registers the opcode loops start with. The addressing registers wrap
+// inside DRAM so that memory opcodes never reach the hardware registers.
+static const u16 s_regs_bench[32] = {
+	0x0100, 0x0200, 0x0300, 0x0400, 0x0001, 0x0002, 0x0003, 0x0004,
+	0x00ff, 0x00ff, 0x00ff, 0x00ff, 0x0000, 0x0000, 0x0000, 0x0000,
+	0x0000, 0xffff, 0x00ff, 0x0000, 0x1234, 0x5678, 0x0012, 0x0000,
+	0x0123, 0x4567, 0x89ab, 0x7def, 0x1357, 0x2468, 0x1234, 0x8765,
+};
+
+struct ROMStub
+{
+	u16 addr;
+	const char *text;
+};
+
+// The ROM routines dsp_base.inc calls, which the free ROM doesn't have.
+static const ROMStub s_rom_stubs[] = {
+	// Wait for mail from the CPU, returns its high half in $ac0.m.
+	{ 0x8078, "	jmp	0x8f00\n" },
+	// Wait until the CPU read the last mail.
+	{ 0x807e, "	jmp	0x8f08\n" },
+	// Wait for DMA. It completes instantly in Dolphin.
+	{ 0x863d, "	ret\n" },
+	{ 0x8f00,
+	  "	lr	$ac0.m, @CMBH\n"
+	  "	andcf	$ac0.m, #0x8000\n"
+	  "	jlnz	0x8f00\n"
+	  "	ret\n" },
+	{ 0x8f08,
+	  "	lr	$ac0.m, @DMBH\n"
+	  "	andcf	$ac0.m, #0x8000\n"
+	  "	jlz	0x8f08\n"
+	  "	ret\n" },
+};
+
+struct TestResult
+{
+	std::vector<u16> dumps;
+	std::vector<u32> exceptions;
+};
+
+struct OpcodeBench
+{
+	std::string name;
+	std::vector<u16> inst;
+	// Final state on the interpreter, the JIT must match it.
+	u16 regs[32];
+	std::vector<u16> dram;
+	double ns[2];
+};
+
+static std::vector<u8> s_host_ram;
+
+static bool InitCore(const std::string &rom_dir, bool jit)
+{
+	std::string irom = rom_dir + DIR_SEP DSP_IROM;
+	std::string coef = rom_dir + DIR_SEP DSP_COEF;
+	if (!DSPCore_Init(irom.c_str(), coef.c_str(), jit))
+		return false;
+
+	s_host_ram.assign(HOST_RAM_SIZE, 0);
+	g_dsp.cpu_ram = &s_host_ram[0];
+	DSPCore_Reset();
+
+	UnWriteProtectMemory(g_dsp.irom, DSP_IROM_BYTE_SIZE, false);
+	for (auto& stub : s_rom_stubs)
+	{
+		std::vector<u16> code;
+		if (!Assemble(stub.text, code))
+		{
+			DSPCore_Shutdown();
+			return false;
+		}
+		std::copy(code.begin(), code.end(), g_dsp.irom + (stub.addr - 0x8000));
+	}
+	WriteProtectMemory(g_dsp.irom, DSP_IROM_BYTE_SIZE, false);
+
+	return true;
+}
+
+static void LoadIRAM(const std::vector<u16> &code, u16 addr)
+{
+	UnWriteProtectMemory(g_dsp.iram, DSP_IRAM_BYTE_SIZE, false);
+	for (int i = 0; i < DSP_IRAM_SIZE; i++)
+		g_dsp.iram[i] = 0x0021; // HALT
+	std::copy(code.begin(), code.begin() + std::min<size_t>(code.size(), DSP_IRAM_SIZE - addr), g_dsp.iram + addr);
+	WriteProtectMemory(g_dsp.iram, DSP_IRAM_BYTE_SIZE, false);
+
+	if (dspjit)
+		dspjit->ClearIRAM();
+	DSPAnalyzer::Analyze();
+}
+
+static void ResetState(const u16 *regs)
+{
+	memset(&g_dsp.r, 0, sizeof(g_dsp.r));
+	memset(g_dsp.reg_stack_ptr, 0, sizeof(g_dsp.reg_stack_ptr));
+	memset(g_dsp.reg_stack, 0, sizeof(g_dsp.reg_stack));
+	for (int i = 0; i < 32; i++)
+	{
+		if (i < DSP_REG_ST0 || i > DSP_REG_ST3)
+			DSPCore_WriteRegister(i, regs[i]);
+	}
+	g_dsp.exceptions = 0;
+	g_dsp.cr &= ~CR_HALT;
+	g_dsp.pc = UCODE_ENTRY;
+	gdsp_ifx_init();
+}
+
+static void SendMail(u32 mail)
+{
+	gdsp_mbox_write_h(GDSP_MBOX_CPU, mail >> 16);
+	gdsp_mbox_write_l(GDSP_MBOX_CPU, mail & 0xffff);
+}
+
+static u16 ReadHostU16(u32 addr)
+{
+	return Common::swap16(*(const u16*)&s_host_ram[addr]);
+}
+
+// Drives dsp_base.inc the way DSPSpy does and collects the register dumps.
+static void RunTestUCode(const std::vector<u16> &code, TestResult &result)
+{
+	for (int i = 0; i < 32; i++)
+		*(u16*)&s_host_ram[HOST_REGS + i * 2] = Common::swap16(s_regs_in[i]);
+	for (u32 i = 0; i < 0x2000; i += 2)
+		*(u16*)&s_host_ram[HOST_DRAM_IMAGE + i] = Common::swap16((u16)(i * 0x0101 + 0x1234));
+
+	LoadIRAM(code, 0);
+	ResetState(s_regs_in);
+	g_dsp.r.sr |= SR_INT_ENABLE | SR_EXT_INT_ENABLE;
+
+	int idle = 0;
+	while (!(g_dsp.cr & CR_HALT) && idle < MAX_IDLE_SLICES)
+	{
+		DSPCore_RunCycles(SLICE_CYCLES);
+
+		if (!(gdsp_mbox_peek(GDSP_MBOX_DSP) & 0x80000000))
+		{
+			idle++;
+			continue;
+		}
+		idle = 0;
+
+		u32 mail = gdsp_mbox_read_h(GDSP_MBOX_DSP) << 16;
+		mail |= gdsp_mbox_read_l(GDSP_MBOX_DSP);
+		if (mail == 0x8888dead)
+		{
+			SendMail(0x80000000 | HOST_DRAM_IMAGE);
+		}
+		else if (mail == 0x8888beef)
+		{
+			SendMail(0x80000000 | HOST_REGS);
+		}
+		else if (mail == 0x8888feeb)
+		{
+			for (int i = 0; i < 32; i++)
+				result.dumps.push_back(ReadHostU16(HOST_REGS + (UCODE_REGS_BASE + i) * 2));
+			SendMail(0x8000dead);
+		}
+		else if ((mail & 0xffff0000) == 0x8bad0000)
+		{
+			result.exceptions.push_back(mail);
+		}
+	}
+}
+
+static bool CompareTestResults(const std::string &name, const TestResult &interpreter, const TestResult &jit)
+{
+	bool same = true;
+	if (interpreter.dumps.size() != jit.dumps.size())
+	{
+		printf("%s: interpreter sent %d dumps, JIT sent %d\n", name.c_str(),
+		       (int)interpreter.dumps.size() / 32, (int)jit.dumps.size() / 32);
+		same = false;
+	}
+	size_t count = std::min(interpreter.dumps.size(), jit.dumps.size());
+	for (size_t i = 0; i < count; i++)
+	{
+		if (interpreter.dumps[i] != jit.dumps[i])
+		{
+			printf("%s: step %d: %-7s interpreter %04x, JIT %04x\n", name.c_str(), (int)(i / 32) + 1,
+			       pdregname(i % 32), interpreter.dumps[i], jit.dumps[i]);
+			same = false;
+		}
+	}
+	if (interpreter.exceptions != jit.exceptions)
+	{
+		printf("%s: the engines raised different exceptions\n", name.c_str());
+		same = false;
+	}
+	return same;
+}
+
+static std::string GetOpcodeName(UDSPInstruction inst, const DSPOPCTemplate *opcode)
+{
+	std::string name = opcode->name;
+	if (opcode->extended)
+	{
+		const DSPOPCTemplate *ext = extOpTable[(inst >> 12) == 0x3 ? inst & 0x7f : inst & 0xff];
+		if (ext && strcmp(ext->name, "XXX"))
+			name += StringFromFormat("'%s", ext->name);
+	}
+	return name;
+}
+
+// Opcodes that can't simply be repeated: control flow, and memory accesses
+// to fixed addresses which mostly hit the hardware registers.
+static bool IsBenchable(const DSPOPCTemplate *opcode)
+{
+	if (opcode->branch || opcode == &cw)
+		return false;
+	for (int i = 0; i < opcode->param_count; i++)
+	{
+		if (opcode->params[i].type == P_MEM)
+			return false;
+	}
+	return true;
+}
+
+static void CollectOpcodes(const std::vector<u16> &code, std::vector<OpcodeBench> &benches)
+{
+	for (size_t addr = 0; addr < code.size();)
+	{
+		UDSPInstruction inst = code[addr];
+		const DSPOPCTemplate *opcode = GetOpTemplate(inst);
+		size_t size = opcode->size ? opcode->size : 1;
+		if (addr + size > code.size())
+			break;
+
+		if (IsBenchable(opcode))
+		{
+			std::string name = GetOpcodeName(inst, opcode);
+			bool seen = false;
+			for (auto& bench : benches)
+				seen |= bench.name == name;
+			if (!seen)
+			{
+				OpcodeBench bench;
+				bench.name = name;
+				bench.inst.assign(code.begin() + addr, code.begin() + addr + size);
+				bench.ns[0] = bench.ns[1] = 0;
+				benches.push_back(bench);
+			}
+		}
+		addr += size;
+	}
+}
+
+// BLOOPI over BENCH_UNROLL copies of the opcode, then HALT.
+static std::vector<u16> BuildOpcodeLoop(const std::vector<u16> &inst)
+{
+	std::vector<u16> code;
+	u16 loop_end = UCODE_ENTRY + 2 + BENCH_UNROLL * (u16)inst.size() - 1;
+	code.push_back(0x1100 | BENCH_ITERATIONS);
+	code.push_back(loop_end);
+	for (int i = 0; i < BENCH_UNROLL; i++)
+		code.insert(code.end(), inst.begin(), inst.end());
+	code.push_back(0x0021);
+	return code;
+}
+
+static void RunOpcodeLoop()
+{
+	ResetState(s_regs_bench);
+	memset(g_dsp.dram, 0, DSP_DRAM_BYTE_SIZE);
+	while (!(g_dsp.cr & CR_HALT))
+		DSPCore_RunCycles(0x8000);
+}
+
+// Runs the loop once to check that it does what it should, then times it.
+static bool BenchOpcode(OpcodeBench &bench, int engine)
+{
+	std::vector<u16> code = BuildOpcodeLoop(bench.inst);
+	LoadIRAM(code, UCODE_ENTRY);
+
+	RunOpcodeLoop();
+	u16 regs[32];
+	for (int i = 0; i < 32; i++)
+		regs[i] = DSPCore_ReadRegister(i);
+
+	if (engine == 0)
+	{
+		// The interpreter leaves pc on the HALT, which is only reached once
+		// the loop ran to the end.
+		if (g_dsp.pc != UCODE_ENTRY + code.size() - 1 || g_dsp.exceptions ||
+		    g_dsp.reg_stack_ptr[0] || g_dsp.reg_stack_ptr[1] ||
+		    g_dsp.reg_stack_ptr[2] || g_dsp.reg_stack_ptr[3])
+			return false;
+		memcpy(bench.regs, regs, sizeof(regs));
+		bench.dram.assign(g_dsp.dram, g_dsp.dram + DSP_DRAM_SIZE);
+	}
+	else
+	{
+		bool same = true;
+		for (int i = 0; i < 32; i++)
+		{
+			if (regs[i] != bench.regs[i])
+			{
+				printf("%s: %-7s interpreter %04x, JIT %04x\n", bench.name.c_str(), pdregname(i), bench.regs[i], regs[i]);
+				same = false;
+			}
+		}
+		if (memcmp(&bench.dram[0], g_dsp.dram, DSP_DRAM_BYTE_SIZE))
+		{
+			printf("%s: DRAM differs between interpreter and JIT\n", bench.name.c_str());
+			same = false;
+		}
+		if (!same)
+			return false;
+	}
+
+	int runs = 0;
+	u32 start = Common::Timer::GetTimeMs();
+	u32 elapsed;
+	do
+	{
+		RunOpcodeLoop();
+		runs++;
+		elapsed = Common::Timer::GetTimeMs() - start;
+	} while (elapsed < BENCH_MIN_MS);
+
+	bench.ns[engine] = elapsed * 1000000.0 / ((double)runs * BENCH_ITERATIONS * BENCH_UNROLL);
+	return true;
+}
+
+bool RunDSPBench(const std::vector<std::string> &files, const std::string &rom_dir)
+{
+	InitInstructionTable();
+
+	std::vector<std::string> names;
+	std::vector<std::vector<u16>> codes;
+	for (auto& file : files)
+	{
+		std::string source;
+		std::vector<u16> code;
+		if (!File::ReadFileToString(file.c_str(), source) || !Assemble(source.c_str(), code))
+		{
+			printf("%s: Assembly failed\n", file.c_str());
+			return false;
+		}
+		names.push_back(file);
+		codes.push_back(code);
+	}
+
+	std::vector<TestResult> results[2];
+	std::vector<OpcodeBench> benches;
+	std::vector<bool> valid;
+	for (auto& code : codes)
+		CollectOpcodes(code, benches);
+	valid.assign(benches.size(), true);
+
+	for (int engine = 0; engine < 2; engine++)
+	{
+		if (!InitCore(rom_dir, engine == 1))
+		{
+			printf("Could not load the DSP ROMs from %s\n", rom_dir.c_str());
+			return false;
+		}
+
+		results[engine].resize(codes.size());
+		for (size_t i = 0; i < codes.size(); i++)
+			RunTestUCode(codes[i], results[engine][i]);
+
+		for (size_t i = 0; i < benches.size(); i++)
+		{
+			if (valid[i])
+				valid[i] = BenchOpcode(benches[i], engine);
+		}
+
+		DSPCore_Shutdown();
+	}
+
+	bool same = true;
+	for (size_t i = 0; i < codes.size(); i++)
+	{
+		bool test_same = CompareTestResults(names[i], results[0][i], results[1][i]);
+		printf("%s: %d dumps, %s\n", names[i].c_str(), (int)results[0][i].dumps.size() / 32,
+		       test_same ? "interpreter and JIT agree" : "MISMATCH");
+		same &= test_same;
+	}
+
+	printf("\n%-16s %12s %12s\n", "opcode", "interp ns", "jit ns");
+	for (size_t i = 0; i < benches.size(); i++)
+	{
+		if (valid[i])
+			printf("%-16s %12.2f %12.2f\n", benches[i].name.c_str(), benches[i].ns[0], benches[i].ns[1]);
+		else if (benches[i].ns[0] > 0)
+			printf("%-16s %12.2f %12s\n", benches[i].name.c_str(), benches[i].ns[0], "MISMATCH");
+		else
+			printf("%-16s %12s\n", benches[i].name.c_str(), "skipped");
+	}
+
+	for (size_t i = 0; i < benches.size(); i++)
+		same &= valid[i] || benches[i].ns[0] == 0;
+
+	return same;
+}
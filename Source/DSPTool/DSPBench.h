@@ -0,0 +1,13 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Runs DSPSpy test ucodes (Source/DSPSpy/tests) on the interpreter and on the
+// JIT, checks that both send back the same register dumps and times every
+// opcode the ucodes use on both engines. Returns false if the engines differ.
+bool RunDSPBench(const std::vector<std::string> &files, const std::string &rom_dir);
@@ -3,11 +3,17 @@
 // Refer to the license.txt file included.
 
 #include "Common/Common.h"
+#include "Common/CommonPaths.h"
 #include "Common/FileUtil.h"
 #include "Common/StringUtil.h"
 #include "Core/DSP/DSPCodeUtil.h"
 #include "Core/DSP/DSPTables.h"
 
+#include "AudioBench.h"
+#include "DSPBench.h"
+#include "NetPlayBench.h"
+#include "QueueBench.h"
+
 // Stub out the dsplib host stuff, since this is just a simple cmdline tools.
 u8 DSPHost_ReadHostMemory(u32 addr) { return 0; }
 void DSPHost_WriteHostMemory(u8 value, u32 addr) {}
@@ -197,6 +203,14 @@ void RunAsmTests()
 //   dsptool [-f] -h asdf.h asdf.txt
 // Print results from DSPSpy register dump
 //   dsptool -p dsp_dump0.bin
+// Compare interpreter and JIT on DSPSpy tests and time their opcodes
+//   dsptool -b [-r romdir] tests/arith_test.ds tests/mul_test.ds
+// Time the audio mixer's resamplers and the DPL2 decoder
+//   dsptool -a
+// Compare the NetPlay input protocols over localhost
+//   dsptool -n
+// Compare FifoQueue and RingQueue
+//   dsptool -q
 // So far, all this binary can do is test partially that itself works correctly.
 int main(int argc, const char *argv[])
 {
@@ -214,6 +228,10 @@ int main(int argc, const char *argv[])
 		printf("-ps <DUMP FILE>: Print results of DSPSpy register dump (disable SR output)\n");
 		printf("-pm <DUMP FILE>: Print results of DSPSpy register dump (convert PROD values)\n");
 		printf("-psm <DUMP FILE>: Print results of DSPSpy register dump (convert PROD values/disable SR output)\n");
+		printf("-b [-r <ROM DIR>] <DSPSPY TEST FILES>: Run DSPSpy tests on the interpreter and the JIT, compare them and time each opcode\n");
+		printf("-a: Time the audio mixer's resamplers and the DPL2 decoder\n");
+		printf("-n: Compare the NetPlay input protocols over localhost\n");
+		printf("-q: Compare FifoQueue and RingQueue\n");
 
 		return 0;
 	}
@@ -224,6 +242,41 @@ int main(int argc, const char *argv[])
 		return 0;
 	}
 
+	if (argc == 2 && !strcmp(argv[1], "-a"))
+	{
+		RunResamplerBench();
+		RunDPL2Bench();
+		return 0;
+	}
+
+	if (argc == 2 && !strcmp(argv[1], "-n"))
+		return RunNetPlayBench() ? 0 : 1;
+
+	if (argc == 2 && !strcmp(argv[1], "-q"))
+	{
+		RunQueueBench();
+		return 0;
+	}
+
+	if (!strcmp(argv[1], "-b"))
+	{
+		std::string rom_dir = File::GetSysDirectory() + GC_SYS_DIR;
+		std::vector<std::string> files;
+		for (int i = 2; i < argc; i++)
+		{
+			if (!strcmp(argv[i], "-r") && i + 1 < argc)
+				rom_dir = argv[++i];
+			else
+				files.push_back(argv[i]);
+		}
+		if (files.empty())
+		{
+			printf("ERROR: Must specify at least one test file\n");
+			return 1;
+		}
+		return RunDSPBench(files, rom_dir) ? 0 : 1;
+	}
+
 	std::string input_name;
 	std::string output_header_name;
 	std::string output_name;
@@ -0,0 +1,388 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <SFML/Network.hpp>
+
+#include "Common/Common.h"
+#include "Common/Thread.h"
+#include "Common/Timer.h"
+
+#include "Core/NetPlayInput.h"
+#include "Core/NetPlayProto.h"
+
+#include "NetPlayBench.h"
+
+#define BENCH_PORT       2626
+#define BENCH_PLAYERS    4
+#define BENCH_POLLS      20000
+// Two seconds at the rate games poll pads at
+#define PACED_POLLS      240
+#define PACED_PERIOD_US  8333
+
+// Core buttons, accelerometer and a Nunchuk
+#define WIIMOTE_REPORT_SIZE 21
+
+// The messages the old protocol sent for every single state
+#define OLD_MSG_PAD_DATA     0x60
+#define OLD_MSG_WIIMOTE_DATA 0x70
+
+struct Protocol
+{
+	const char* name;
+	// 0 for the old protocol
+	u32 batch_polls;
+};
+
+static const Protocol s_protocols[] = {
+	{ "old", 0 },
+	{ "batch 1", 1 },
+	{ "batch 4", 4 },
+};
+
+struct Result
+{
+	u64 messages;
+	u64 bytes;
+	u64 states;
+	u64 elapsed_us;
+	u64 latency_sum_us;
+	u64 latency_max_us;
+};
+
+// Every player owns the in-game controller with its own number. Buttons
+// change every now and then and sticks a bit more often, while the
+// accelerometer of a Wii Remote never holds still.
+static void MakeState(bool wiimote, u32 player, u32 poll, std::vector<u8>& data)
+{
+	if (!wiimote)
+	{
+		data.assign(8, 0x80);
+		data[0] = (u8)(poll / 30 + player);
+		data[2] = (u8)(0x80 + (poll / 4) % 16);
+		data[6] = 0;
+		data[7] = 0;
+	}
+	else
+	{
+		data.assign(WIIMOTE_REPORT_SIZE, 0x00);
+		data[0] = (u8)(poll / 30 + player);
+		data[2] = (u8)(0x80 + (poll * 7) % 5);
+		data[3] = (u8)(0x80 + (poll * 3) % 7);
+		data[4] = (u8)(0x9a + poll % 3);
+		data[5] = (u8)(0x80 + (poll / 4) % 16);
+		data[6] = 0x80;
+	}
+}
+
+class Loopback
+{
+public:
+	bool Open()
+	{
+		sf::SocketTCP listener;
+		bool listening = false;
+		for (u16 port = BENCH_PORT; port < BENCH_PORT + 10 && !listening; port++)
+		{
+			listening = listener.Listen(port);
+			m_port = port;
+		}
+		if (!listening)
+			return false;
+
+		for (u32 i = 0; i < BENCH_PLAYERS; i++)
+		{
+			if (players[i].Connect(m_port, sf::IPAddress("127.0.0.1")) != sf::Socket::Done ||
+			    listener.Accept(server[i]) != sf::Socket::Done)
+			{
+				listener.Close();
+				return false;
+			}
+		}
+		listener.Close();
+		return true;
+	}
+
+	void Close()
+	{
+		for (u32 i = 0; i < BENCH_PLAYERS; i++)
+		{
+			players[i].Close();
+			server[i].Close();
+		}
+	}
+
+	// The sockets of the players and their ends at the server
+	sf::SocketTCP players[BENCH_PLAYERS];
+	sf::SocketTCP server[BENCH_PLAYERS];
+
+private:
+	u16 m_port;
+};
+
+static void SendPlayers(Loopback& loopback, const Protocol& protocol, bool wiimote, u32 polls, bool paced,
+                        std::vector<std::atomic<u64>>& sent_us)
+{
+	NetInputWriter writers[BENCH_PLAYERS];
+	std::vector<char> wire;
+	std::vector<u8> data;
+	const u64 start = Common::Timer::GetTimeUs();
+
+	for (u32 poll = 0; poll < polls; poll++)
+	{
+		if (paced)
+		{
+			const u64 due = start + (u64)poll * PACED_PERIOD_US;
+			u64 now;
+			while ((now = Common::Timer::GetTimeUs()) < due)
+			{
+				if (due - now > 2000)
+					Common::SleepCurrentThread(1);
+			}
+		}
+		sent_us[poll] = Common::Timer::GetTimeUs();
+
+		for (u32 p = 0; p < BENCH_PLAYERS; p++)
+		{
+			MakeState(wiimote, p, poll, data);
+			if (!protocol.batch_polls)
+			{
+				sf::Packet packet;
+				if (wiimote)
+				{
+					packet << (MessageId)OLD_MSG_WIIMOTE_DATA << (PadMapping)p << (u8)data.size();
+					packet.Append(data.data(), data.size());
+				}
+				else
+				{
+					packet << (MessageId)OLD_MSG_PAD_DATA << (PadMapping)p;
+					packet << Common::swap32(&data[0]) << Common::swap32(&data[4]);
+				}
+				loopback.players[p].Send(packet);
+				continue;
+			}
+
+			if (wiimote)
+				writers[p].AddWiimote(p, data);
+			else
+				writers[p].AddPad(p, Common::swap32(&data[0]), Common::swap32(&data[4]));
+
+			if (writers[p].GetPolls() >= protocol.batch_polls || poll + 1 == polls)
+			{
+				SerializePacket(writers[p].GetPacket(), wire);
+				writers[p].Clear();
+				loopback.players[p].Send(wire.data(), wire.size());
+			}
+		}
+	}
+}
+
+// Reads and checks every state like NetPlayServer, then relays them to the
+// other players
+static void RelayServer(Loopback& loopback, const Protocol& protocol, u32 polls)
+{
+	NetInputReader readers[BENCH_PLAYERS];
+	sf::SelectorTCP selector;
+	for (sf::SocketTCP& socket : loopback.server)
+		selector.Add(socket);
+
+	std::vector<char> wire;
+	u64 states = 0;
+	while (states < (u64)polls * BENCH_PLAYERS)
+	{
+		const u32 ready = selector.Wait(1.0f);
+		for (u32 r = 0; r < ready; r++)
+		{
+			sf::SocketTCP socket = selector.GetSocketReady(r);
+			const u32 p = (u32)(std::find(loopback.server, loopback.server + BENCH_PLAYERS, socket) - loopback.server);
+
+			sf::Packet packet;
+			if (socket.Receive(packet) != sf::Socket::Done)
+				return;
+
+			if (!protocol.batch_polls)
+			{
+				// The old server built a new message for every state
+				MessageId mid;
+				PadMapping map;
+				sf::Packet spac;
+				packet >> mid >> map;
+				if (mid == OLD_MSG_PAD_DATA)
+				{
+					u32 hi, lo;
+					packet >> hi >> lo;
+					spac << mid << map << hi << lo;
+				}
+				else
+				{
+					u8 size;
+					packet >> size;
+					NetWiimote nw(size);
+					for (u8& byte : nw)
+						packet >> byte;
+					spac << mid << map << size;
+					spac.Append(nw.data(), nw.size());
+				}
+				states++;
+
+				for (u32 i = 0; i < BENCH_PLAYERS; i++)
+				{
+					if (i != p)
+						loopback.server[i].Send(spac);
+				}
+				continue;
+			}
+
+			MessageId mid;
+			packet >> mid;
+			NetInputState state;
+			while (!packet.EndOfPacket())
+			{
+				if (!readers[p].Read(packet, state) || state.map != (PadMapping)p)
+					return;
+				states++;
+			}
+
+			SerializePacket(packet, wire);
+			for (u32 i = 0; i < BENCH_PLAYERS; i++)
+			{
+				if (i != p)
+					loopback.server[i].Send(wire.data(), wire.size());
+			}
+		}
+	}
+}
+
+// Receives like NetPlayClient, the states of every controller arrive in the
+// order they were polled in
+static void ReceivePlayers(Loopback& loopback, const Protocol& protocol, u32 polls,
+                           const std::vector<std::atomic<u64>>& sent_us, Result& result)
+{
+	NetInputReader readers[BENCH_PLAYERS];
+	u32 received[BENCH_PLAYERS][BENCH_PLAYERS] = {};
+	sf::SelectorTCP selector;
+	for (sf::SocketTCP& socket : loopback.players)
+		selector.Add(socket);
+
+	const u64 expected = (u64)polls * BENCH_PLAYERS * (BENCH_PLAYERS - 1);
+	while (result.states < expected)
+	{
+		const u32 ready = selector.Wait(1.0f);
+		if (!ready)
+			return;
+
+		for (u32 r = 0; r < ready; r++)
+		{
+			sf::SocketTCP socket = selector.GetSocketReady(r);
+			const u32 p = (u32)(std::find(loopback.players, loopback.players + BENCH_PLAYERS, socket) - loopback.players);
+
+			sf::Packet packet;
+			if (socket.Receive(packet) != sf::Socket::Done)
+				return;
+			const u64 now = Common::Timer::GetTimeUs();
+			result.messages++;
+			result.bytes += 4 + packet.GetDataSize();
+
+			MessageId mid;
+			packet >> mid;
+			while (!packet.EndOfPacket())
+			{
+				PadMapping map;
+				if (!protocol.batch_polls)
+				{
+					packet >> map;
+					if (mid == OLD_MSG_PAD_DATA)
+					{
+						u32 hi, lo;
+						packet >> hi >> lo;
+					}
+					else
+					{
+						u8 size;
+						packet >> size;
+						NetWiimote nw(size);
+						for (u8& byte : nw)
+							packet >> byte;
+					}
+				}
+				else
+				{
+					NetInputState state;
+					if (!readers[p].Read(packet, state))
+						return;
+					map = state.map;
+				}
+
+				const u64 latency = now - sent_us[received[p][map]++];
+				result.latency_sum_us += latency;
+				result.latency_max_us = std::max(result.latency_max_us, latency);
+				result.states++;
+			}
+		}
+	}
+}
+
+static bool RunProtocol(Loopback& loopback, const Protocol& protocol, bool wiimote, u32 polls, bool paced, Result& result)
+{
+	std::vector<std::atomic<u64>> sent_us(polls);
+	result = Result();
+
+	const u64 start = Common::Timer::GetTimeUs();
+	std::thread server(RelayServer, std::ref(loopback), std::cref(protocol), polls);
+	std::thread receiver(ReceivePlayers, std::ref(loopback), std::cref(protocol), polls,
+	                     std::cref(sent_us), std::ref(result));
+	SendPlayers(loopback, protocol, wiimote, polls, paced, sent_us);
+	receiver.join();
+	server.join();
+	result.elapsed_us = Common::Timer::GetTimeUs() - start;
+
+	if (result.states != (u64)polls * BENCH_PLAYERS * (BENCH_PLAYERS - 1))
+	{
+		printf("%s: Only %llu of the states arrived\n", protocol.name, (unsigned long long)result.states);
+		return false;
+	}
+	return true;
+}
+
+bool RunNetPlayBench()
+{
+	Loopback loopback;
+	if (!loopback.Open())
+	{
+		printf("Couldn't connect the players over localhost\n");
+		return false;
+	}
+
+	printf("%d players, %d polls unthrottled and %d at 120 Hz\n", BENCH_PLAYERS, BENCH_POLLS, PACED_POLLS);
+	printf("%-9s %-8s %12s %12s %12s %14s %14s\n", "", "", "msgs/s", "bytes/state", "states/s",
+	       "avg lat (ms)", "max lat (ms)");
+
+	bool ok = true;
+	for (bool wiimote : { false, true })
+	{
+		for (const Protocol& protocol : s_protocols)
+		{
+			Result fast, paced;
+			if (!RunProtocol(loopback, protocol, wiimote, BENCH_POLLS, false, fast) ||
+			    !RunProtocol(loopback, protocol, wiimote, PACED_POLLS, true, paced))
+			{
+				ok = false;
+				break;
+			}
+
+			const double seconds = fast.elapsed_us / 1000000.0;
+			printf("%-9s %-8s %12.0f %12.2f %12.0f %14.2f %14.2f\n", wiimote ? "wiimotes" : "pads",
+			       protocol.name, fast.messages / seconds, (double)fast.bytes / fast.states, fast.states / seconds,
+			       paced.latency_sum_us / 1000.0 / paced.states, paced.latency_max_us / 1000.0);
+		}
+	}
+
+	loopback.Close();
+	return ok;
+}
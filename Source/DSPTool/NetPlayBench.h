@@ -0,0 +1,11 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Sends the controller input of four players through a NetPlay-like server
+// relay over localhost, with the old one message per state protocol and with
+// the batched NP_MSG_INPUT_DATA one, and prints the messages, bytes and states
+// per second each reaches and their latency at 120 polls per second.
+bool RunNetPlayBench();
@@ -0,0 +1,107 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+#include "Common/Common.h"
+#include "Common/FifoQueue.h"
+#include "Common/RingQueue.h"
+#include "Common/Timer.h"
+
+#include "QueueBench.h"
+
+#define BENCH_ELEMENTS  2000000
+#define BENCH_BULK      64
+#define RING_CAPACITY   1024
+
+typedef Common::RingQueue<u32, RING_CAPACITY> BenchRing;
+
+static double TimeFifoQueue()
+{
+	Common::FifoQueue<u32> fifo;
+	const u64 start = Common::Timer::GetTimeUs();
+	std::thread producer([&fifo] {
+		for (u32 i = 0; i < BENCH_ELEMENTS; ++i)
+			fifo.Push(i);
+	});
+
+	u32 value, received = 0;
+	while (received < BENCH_ELEMENTS)
+	{
+		if (fifo.Pop(value))
+			++received;
+		else
+			std::this_thread::yield();
+	}
+	producer.join();
+	return (Common::Timer::GetTimeUs() - start) * 1000.0 / BENCH_ELEMENTS;
+}
+
+static double TimeRingQueue()
+{
+	BenchRing ring;
+	const u64 start = Common::Timer::GetTimeUs();
+	std::thread producer([&ring] {
+		for (u32 i = 0; i < BENCH_ELEMENTS; ++i)
+		{
+			while (!ring.Push(i))
+				std::this_thread::yield();
+		}
+	});
+
+	u32 value, received = 0;
+	while (received < BENCH_ELEMENTS)
+	{
+		if (ring.Pop(value))
+			++received;
+		else
+			std::this_thread::yield();
+	}
+	producer.join();
+	return (Common::Timer::GetTimeUs() - start) * 1000.0 / BENCH_ELEMENTS;
+}
+
+static double TimeRingQueueBulk()
+{
+	BenchRing ring;
+	const u64 start = Common::Timer::GetTimeUs();
+	std::thread producer([&ring] {
+		u32 items[BENCH_BULK];
+		for (u32 i = 0; i < BENCH_ELEMENTS; )
+		{
+			const u32 count = std::min<u32>(BENCH_BULK, BENCH_ELEMENTS - i);
+			for (u32 j = 0; j < count; ++j)
+				items[j] = i + j;
+			for (u32 pushed = 0; pushed < count; )
+			{
+				pushed += (u32)ring.PushBulk(items + pushed, count - pushed);
+				if (pushed < count)
+					std::this_thread::yield();
+			}
+			i += count;
+		}
+	});
+
+	u32 items[BENCH_BULK];
+	u32 received = 0;
+	while (received < BENCH_ELEMENTS)
+	{
+		const u32 count = (u32)ring.PopBulk(items, BENCH_BULK);
+		if (!count)
+			std::this_thread::yield();
+		received += count;
+	}
+	producer.join();
+	return (Common::Timer::GetTimeUs() - start) * 1000.0 / BENCH_ELEMENTS;
+}
+
+void RunQueueBench()
+{
+	printf("%-16s %12s\n", "", "ns/element");
+	printf("%-16s %12.2f\n", "FifoQueue", TimeFifoQueue());
+	printf("%-16s %12.2f\n", "RingQueue", TimeRingQueue());
+	printf("%-16s %12.2f\n", "RingQueue bulk", TimeRingQueueBulk());
+}
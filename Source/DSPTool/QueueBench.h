@@ -0,0 +1,10 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#pragma once
+
+// Passes elements from a producer thread to the main thread through
+// FifoQueue and RingQueue, one at a time and in bulk, and prints how long
+// each takes per element.
+void RunQueueBench();
@@ -0,0 +1,164 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "AudioCommon/DPL2Decoder.h"
+
+// Not in the header, but the reference decoder needs the same filter and AGC
+float* calc_coefficients_125Hz_lowpass(int rate);
+float passive_lock(float x);
+
+#define DLBUFLEN 240
+
+// The per-frame decoder the block decoder replaced, with its rear delay of 0
+// folded in and the LFE input taken from the frame being decoded.
+class ReferenceDecoder
+{
+public:
+	ReferenceDecoder()
+		: cyc_pos(DLBUFLEN - 1)
+		, lfe_pos(0)
+		, l_fwr(0), r_fwr(0), lpr_fwr(0), lmr_fwr(0)
+		, adapt_l_gain(0), adapt_r_gain(0), adapt_lpr_gain(0), adapt_lmr_gain(0)
+		, fwrbuf_l(DLBUFLEN), fwrbuf_r(DLBUFLEN), lfe_buf(256)
+	{
+		coefs = calc_coefficients_125Hz_lowpass(48000);
+	}
+
+	~ReferenceDecoder()
+	{
+		free(coefs);
+	}
+
+	void Decode(const float* in, int num_frames, float* out)
+	{
+		const float M9_03DB = 0.3535533906f;
+		const float MATCOMPGAIN = 0.37f;
+		const float SQRT1_2 = 0.70710678118654752440f;
+
+		for (int i = 0; i < num_frames; ++i, in += 2, out += 6)
+		{
+			const int k = cyc_pos;
+			l_fwr += fabs(in[0]) - fabs(fwrbuf_l[k]);
+			r_fwr += fabs(in[1]) - fabs(fwrbuf_r[k]);
+			lpr_fwr += fabs(in[0] + in[1]) - fabs(fwrbuf_l[k] + fwrbuf_r[k]);
+			lmr_fwr += fabs(in[0] - in[1]) - fabs(fwrbuf_l[k] - fwrbuf_r[k]);
+			fwrbuf_l[k] = in[0];
+			fwrbuf_r[k] = in[1];
+
+			float l_gain = (l_fwr + r_fwr) / (1 + l_fwr + l_fwr);
+			float r_gain = (l_fwr + r_fwr) / (1 + r_fwr + r_fwr);
+			float lmr_lim_fwr = lmr_fwr > M9_03DB * lpr_fwr ? lmr_fwr : M9_03DB * lpr_fwr;
+			float lpr_gain = (lpr_fwr + lmr_lim_fwr) / (1 + lpr_fwr + lpr_fwr);
+			float lmr_gain = (lpr_fwr + lmr_lim_fwr) / (1 + lmr_lim_fwr + lmr_lim_fwr);
+			float lmr_unlim_gain = (lpr_fwr + lmr_fwr) / (1 + lmr_fwr + lmr_fwr);
+
+			float f = (fabs(l_gain - adapt_l_gain) + fabs(r_gain - adapt_r_gain)) * 0.5f * (1.0f / 8.0f);
+			f = 1.0f - 1.0f / (1 + f * f);
+			adapt_l_gain = (1 - f) * adapt_l_gain + f * l_gain;
+			adapt_r_gain = (1 - f) * adapt_r_gain + f * r_gain;
+			float l_agc = in[0] * passive_lock(adapt_l_gain);
+			float r_agc = in[1] * passive_lock(adapt_r_gain);
+			float cf = (l_agc + r_agc) * SQRT1_2;
+			float lr = (l_agc - r_agc) * SQRT1_2;
+			float rr = lr;
+			lr *= (l_fwr + l_fwr) / (1 + l_fwr + r_fwr);
+			rr *= (r_fwr + r_fwr) / (1 + l_fwr + r_fwr);
+
+			float lpr = (in[0] + in[1]) * SQRT1_2;
+			float lmr = (in[0] - in[1]) * SQRT1_2;
+			f = fabs(lmr_unlim_gain - adapt_lmr_gain) * (1.0f / 8.0f);
+			f = 1.0f - 1.0f / (1 + f * f);
+			adapt_lpr_gain = (1 - f) * adapt_lpr_gain + f * lpr_gain;
+			adapt_lmr_gain = (1 - f) * adapt_lmr_gain + f * lmr_gain;
+			float lpr_agc = lpr * passive_lock(adapt_lpr_gain);
+			float lmr_agc = lmr * passive_lock(adapt_lmr_gain);
+			float lf = (lpr_agc + lmr_agc) * SQRT1_2;
+			float rf = (lpr_agc - lmr_agc) * SQRT1_2;
+
+			float c_gain = 8 * (adapt_lpr_gain - 0.67677f);
+			c_gain = c_gain > 0 ? c_gain : 0;
+			c_gain = MATCOMPGAIN / (1 + c_gain * c_gain);
+			float c_agc_cfk = c_gain * cf;
+
+			out[0] = lf - c_agc_cfk;
+			out[1] = rf - c_agc_cfk;
+			out[2] = cf + c_agc_cfk + c_agc_cfk;
+			// Ring buffer FIR: the first tap weighs the newest frame, the
+			// following ones the oldest to the second newest.
+			lfe_buf[lfe_pos] = (out[0] + out[1]) / 2;
+			float lfe = 0;
+			for (int j = 0; j < 256; ++j)
+				lfe += lfe_buf[(lfe_pos + j) & 255] * coefs[j];
+			out[3] = lfe;
+			lfe_pos = (lfe_pos + 1) & 255;
+			out[4] = lr;
+			out[5] = rr;
+
+			if (--cyc_pos < 0)
+				cyc_pos += DLBUFLEN;
+		}
+	}
+
+private:
+	int cyc_pos;
+	int lfe_pos;
+	float l_fwr, r_fwr, lpr_fwr, lmr_fwr;
+	float adapt_l_gain, adapt_r_gain, adapt_lpr_gain, adapt_lmr_gain;
+	std::vector<float> fwrbuf_l, fwrbuf_r, lfe_buf;
+	float* coefs;
+};
+
+// Stereo input in the range OpenALStream feeds the decoder: a steered low
+// tone, a high one and some noise.
+static std::vector<float> MakeInput(int num_frames)
+{
+	const double pi = 3.14159265358979323846;
+	std::vector<float> input(num_frames * 2);
+	srand(1234);
+	for (int i = 0; i < num_frames; ++i)
+	{
+		double low = 0.2 * sin(2 * pi * 60 * i / 48000.0);
+		double high = 0.1 * sin(2 * pi * 3000 * i / 48000.0);
+		double pan = 0.5 + 0.5 * sin(2 * pi * 0.5 * i / 48000.0);
+		double noise = (rand() % 2001 - 1000) / 100000.0;
+		input[i * 2] = (float)(low * pan + high + noise);
+		input[i * 2 + 1] = (float)(low * (1 - pan) - high + noise);
+	}
+	return input;
+}
+
+TEST(DPL2Decoder, MatchesReference)
+{
+	const int total_frames = 48000;
+	std::vector<float> input = MakeInput(total_frames);
+
+	std::vector<float> ref_out(total_frames * 6);
+	{
+		ReferenceDecoder reference;
+		reference.Decode(&input[0], total_frames, &ref_out[0]);
+	}
+
+	// Block sized, odd and bigger than a block calls
+	static const int call_sizes[] = { 1, 7, 256, 257, 1000 };
+	std::vector<float> out(total_frames * 6);
+	dpl2reset();
+	int done = 0;
+	for (int i = 0; done < total_frames; ++i)
+	{
+		int num = std::min(call_sizes[i % 5], total_frames - done);
+		dpl2decode(&input[done * 2], num, &out[done * 6]);
+		done += num;
+	}
+
+	// The LFE filter sums in a different order and the AGC rounds a little
+	// differently.
+	for (int i = 0; i < total_frames * 6; ++i)
+		ASSERT_NEAR(ref_out[i], out[i], 1e-5f) << "frame " << i / 6 << ", channel " << i % 6;
+}
@@ -0,0 +1,250 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "AudioCommon/FLACWriter.h"
+
+// Just enough of a FLAC decoder for the frames FLACFileWriter writes: fixed
+// predictors and partitioned Rice residuals.
+class FrameReader
+{
+public:
+	FrameReader(const std::vector<u8>& data) : m_data(data), m_pos(0) {}
+
+	u32 Read(int bits)
+	{
+		u32 value = 0;
+		for (int i = 0; i < bits; i++, m_pos++)
+			value = (value << 1) | ((m_data.at(m_pos / 8) >> (7 - m_pos % 8)) & 1);
+		return value;
+	}
+
+	s32 ReadSigned(int bits)
+	{
+		u32 value = Read(bits);
+		return (s32)(value << (32 - bits)) >> (32 - bits);
+	}
+
+	u32 ReadUnary()
+	{
+		u32 zeros = 0;
+		while (!Read(1))
+			zeros++;
+		return zeros;
+	}
+
+	void Align() { m_pos = (m_pos + 7) & ~7; }
+	size_t BytePos() const { return m_pos / 8; }
+
+private:
+	const std::vector<u8>& m_data;
+	size_t m_pos;
+};
+
+static u8 CRC8(const u8* data, size_t size)
+{
+	u8 crc = 0;
+	for (size_t i = 0; i < size; i++)
+		for (int bit = 7; bit >= 0; bit--)
+			crc = (u8)((crc << 1) ^ ((((crc >> 7) ^ (data[i] >> bit)) & 1) ? 0x07 : 0));
+	return crc;
+}
+
+static u16 CRC16(const u8* data, size_t size)
+{
+	u16 crc = 0;
+	for (size_t i = 0; i < size; i++)
+		for (int bit = 7; bit >= 0; bit--)
+			crc = (u16)((crc << 1) ^ ((((crc >> 15) ^ (data[i] >> bit)) & 1) ? 0x8005 : 0));
+	return crc;
+}
+
+static void DecodeSubframe(FrameReader& reader, u32 count, int bps, s32* out)
+{
+	ASSERT_EQ(0u, reader.Read(1));
+	u32 type = reader.Read(6);
+	ASSERT_EQ(0u, reader.Read(1)) << "no wasted bits";
+
+	if (type == 0)
+	{
+		s32 value = reader.ReadSigned(bps);
+		for (u32 i = 0; i < count; i++)
+			out[i] = value;
+		return;
+	}
+
+	ASSERT_EQ(8u, type & ~7u) << "only fixed subframes";
+	u32 order = type & 7;
+	ASSERT_LE(order, 4u);
+	for (u32 i = 0; i < order; i++)
+		out[i] = reader.ReadSigned(bps);
+
+	ASSERT_EQ(0u, reader.Read(2));
+	u32 partition_order = reader.Read(4);
+	u32 i = order;
+	for (u32 p = 0; p < (1u << partition_order); p++)
+	{
+		u32 param = reader.Read(4);
+		ASSERT_NE(15u, param);
+		for (u32 end = (p + 1) * (count >> partition_order); i < end; i++)
+		{
+			u32 u = (reader.ReadUnary() << param) | reader.Read(param);
+			s32 residual = (s32)(u >> 1) ^ -(s32)(u & 1);
+			switch (order)
+			{
+			case 0: out[i] = residual; break;
+			case 1: out[i] = residual + out[i - 1]; break;
+			case 2: out[i] = residual + 2 * out[i - 1] - out[i - 2]; break;
+			case 3: out[i] = residual + 3 * out[i - 1] - 3 * out[i - 2] + out[i - 3]; break;
+			case 4: out[i] = residual + 4 * out[i - 1] - 6 * out[i - 2] + 4 * out[i - 3] - out[i - 4]; break;
+			}
+		}
+	}
+	ASSERT_EQ(count, i);
+}
+
+static void DecodeFrame(const std::vector<u8>& frame, u32 count, u32 frame_number, s32* left, s32* right)
+{
+	FrameReader reader(frame);
+	ASSERT_EQ(0x3ffeu, reader.Read(14));
+	ASSERT_EQ(0u, reader.Read(2));
+	u32 size_code = reader.Read(4);
+	ASSERT_EQ(0u, reader.Read(4));
+	u32 assignment = reader.Read(4);
+	ASSERT_EQ(4u, reader.Read(3));
+	ASSERT_EQ(0u, reader.Read(1));
+
+	// UTF-8 coded frame number
+	u32 first = reader.Read(8);
+	int extra = 0;
+	while (first & (0x80 >> extra))
+		extra++;
+	u32 number = first & (0x7f >> extra);
+	for (int i = 1; i < extra; i++)
+	{
+		u32 next = reader.Read(8);
+		ASSERT_EQ(0x80u, next & 0xc0);
+		number = (number << 6) | (next & 0x3f);
+	}
+	ASSERT_EQ(frame_number, number);
+
+	if (size_code == 12)
+	{
+		ASSERT_EQ((u32)FLAC_BLOCK_SIZE, count);
+	}
+	else
+	{
+		ASSERT_EQ(7u, size_code);
+	}
+	if (size_code == 7)
+	{
+		ASSERT_EQ(count - 1, reader.Read(16));
+	}
+
+	size_t header_size = reader.BytePos();
+	ASSERT_EQ(CRC8(frame.data(), header_size), reader.Read(8));
+
+	std::vector<s32> ch0(count), ch1(count);
+	int bps0 = assignment == 9 ? 17 : 16;
+	int bps1 = assignment >= 8 && assignment != 9 ? 17 : 16;
+	DecodeSubframe(reader, count, bps0, ch0.data());
+	DecodeSubframe(reader, count, bps1, ch1.data());
+	reader.Align();
+
+	size_t end = reader.BytePos();
+	ASSERT_EQ(frame.size(), end + 2);
+	ASSERT_EQ(CRC16(frame.data(), end), (u16)reader.Read(16));
+
+	for (u32 i = 0; i < count; i++)
+	{
+		switch (assignment)
+		{
+		case 1: left[i] = ch0[i]; right[i] = ch1[i]; break;
+		case 8: left[i] = ch0[i]; right[i] = ch0[i] - ch1[i]; break;
+		case 9: left[i] = ch1[i] + ch0[i]; right[i] = ch1[i]; break;
+		case 10:
+		{
+			s32 mid = (ch0[i] << 1) | (ch1[i] & 1);
+			left[i] = (mid + ch1[i]) >> 1;
+			right[i] = (mid - ch1[i]) >> 1;
+			break;
+		}
+		default: FAIL() << "channel assignment " << assignment;
+		}
+	}
+}
+
+static void CheckRoundTrip(const std::vector<s32>& left, const std::vector<s32>& right, u32 frame_number)
+{
+	std::vector<u8> frame;
+	u32 count = (u32)left.size();
+	FLACFileWriter::EncodeFrame(left.data(), right.data(), count, frame_number, frame);
+
+	std::vector<s32> out_left(count), out_right(count);
+	DecodeFrame(frame, count, frame_number, out_left.data(), out_right.data());
+	for (u32 i = 0; i < count; i++)
+	{
+		ASSERT_EQ(left[i], out_left[i]) << "sample " << i;
+		ASSERT_EQ(right[i], out_right[i]) << "sample " << i;
+	}
+}
+
+TEST(FLACWriter, RoundTrip)
+{
+	const double pi = 3.14159265358979323846;
+	static const u32 sizes[] = { FLAC_BLOCK_SIZE, 1, 3, 5, 100, 1000 };
+	static const u32 frame_numbers[] = { 0, 0x7f, 0x80, 0x7ff, 0x800, 0x12345, 0x3ffffff };
+
+	srand(42);
+	for (u32 size : sizes)
+	{
+		std::vector<s32> left(size), right(size);
+
+		// Correlated tones
+		for (u32 i = 0; i < size; i++)
+		{
+			left[i] = (s32)(12000 * sin(2 * pi * 440 * i / 48000.0));
+			right[i] = left[i] / 2 + (rand() % 64);
+		}
+		for (u32 number : frame_numbers)
+			CheckRoundTrip(left, right, number);
+
+		// Full scale noise, opposite extremes and silence
+		for (u32 i = 0; i < size; i++)
+		{
+			left[i] = (s16)rand();
+			right[i] = (s16)rand();
+		}
+		CheckRoundTrip(left, right, 1);
+		for (u32 i = 0; i < size; i++)
+		{
+			left[i] = i & 1 ? 32767 : -32768;
+			right[i] = -left[i] - 1;
+		}
+		CheckRoundTrip(left, right, 2);
+		std::fill(left.begin(), left.end(), 0);
+		std::fill(right.begin(), right.end(), -5);
+		CheckRoundTrip(left, right, 3);
+	}
+}
+
+// Smooth audio is what the fixed predictors are for
+TEST(FLACWriter, Compresses)
+{
+	const double pi = 3.14159265358979323846;
+	std::vector<s32> left(FLAC_BLOCK_SIZE), right(FLAC_BLOCK_SIZE);
+	for (u32 i = 0; i < FLAC_BLOCK_SIZE; i++)
+	{
+		left[i] = (s32)(8000 * sin(2 * pi * 300 * i / 48000.0) + 3000 * sin(2 * pi * 1234 * i / 48000.0));
+		right[i] = (s32)(8000 * sin(2 * pi * 300 * i / 48000.0 + 0.3));
+	}
+
+	std::vector<u8> frame;
+	FLACFileWriter::EncodeFrame(left.data(), right.data(), FLAC_BLOCK_SIZE, 0, frame);
+	EXPECT_LT(frame.size(), FLAC_BLOCK_SIZE * 4u / 2u);
+}
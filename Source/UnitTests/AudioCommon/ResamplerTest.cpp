@@ -0,0 +1,186 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "AudioCommon/Resampler.h"
+#include "Common/Common.h"
+
+// Small enough to wrap around often
+#define RING_FRAMES 128
+#define RING_MASK   (RING_FRAMES * 2 - 1)
+
+static void FillRing(short* ring, u32 start, u32 count)
+{
+	for (u32 i = 0; i < count; ++i)
+		ring[(start + i) & RING_MASK] = (short)(rand() & 0xffff);
+}
+
+// The loop CMixer::Mix used before the resamplers were split out of it
+static unsigned int MixerLoop(const short* ring, u32& indexR, u32 indexW, short* samples, unsigned int numSamples, u32 ratio, u32& frac)
+{
+	unsigned int currentSample = 0;
+	for (; currentSample < numSamples*2 && ((indexW-indexR) & RING_MASK) > 2; currentSample+=2) {
+		u32 indexR2 = indexR + 2; //next sample
+
+		s16 l1 = Common::swap16(ring[indexR & RING_MASK]); //current
+		s16 l2 = Common::swap16(ring[indexR2 & RING_MASK]); //next
+		int sampleL = ((l1 << 16) + (l2 - l1) * (u16)frac)  >> 16;
+		samples[currentSample+1] = sampleL;
+
+		s16 r1 = Common::swap16(ring[(indexR + 1) & RING_MASK]); //current
+		s16 r2 = Common::swap16(ring[(indexR2 + 1) & RING_MASK]); //next
+		int sampleR = ((r1 << 16) + (r2 - r1) * (u16)frac)  >> 16;
+		samples[currentSample] = sampleR;
+
+		frac += ratio;
+		indexR += 2 * (u16)(frac >> 16);
+		frac &= 0xffff;
+	}
+	return currentSample / 2;
+}
+
+TEST(Resampler, LinearMatchesMixerLoop)
+{
+	static const u32 ratios[] = { 0xaaaa, 0x10000, 0x8000, 0xfff0, 0x10400 };
+
+	for (u32 ratio : ratios)
+	{
+		srand(ratio);
+		short ring[RING_FRAMES * 2];
+		LinearResampler resampler;
+		u32 index = 0, ref_index = 0, frac = 0, end = 0;
+
+		for (int i = 0; i < 200; ++i)
+		{
+			// Keep the ring between empty and full
+			u32 fill = rand() % (RING_FRAMES - 1 - ((end - index) & RING_MASK) / 2 + 1);
+			FillRing(ring, end, fill * 2);
+			end += fill * 2;
+
+			unsigned int num = rand() % 64;
+			short out[64 * 2], ref_out[64 * 2];
+			unsigned int ref_written = MixerLoop(ring, ref_index, end, ref_out, num, ratio, frac);
+			unsigned int written = resampler.Resample(ring, RING_MASK, index, end, out, num, ratio);
+
+			ASSERT_EQ(ref_written, written);
+			ASSERT_EQ(ref_index, index);
+			for (unsigned int j = 0; j < written * 2; ++j)
+				ASSERT_EQ(ref_out[j], out[j]);
+		}
+	}
+}
+
+// A constant comes out unchanged, with the channels swapped like the mixer
+// always output them.
+TEST(Resampler, SincPassesDC)
+{
+	static const u32 ratios[] = { 0xaaaa, 0x10000, 0x10400 };
+
+	for (u32 ratio : ratios)
+	{
+		short ring[RING_FRAMES * 2];
+		for (u32 i = 0; i < RING_FRAMES; ++i)
+		{
+			ring[i * 2] = Common::swap16((u16)1000);
+			ring[i * 2 + 1] = Common::swap16((u16)-2000);
+		}
+
+		SincResampler resampler;
+		u32 index = 0;
+		short out[64 * 2];
+		unsigned int written = resampler.Resample(ring, RING_MASK, index, RING_FRAMES * 2 - 2, out, 64, ratio);
+		EXPECT_EQ(64u, written);
+		for (unsigned int j = 0; j < written; ++j)
+		{
+			EXPECT_EQ(-2000, out[j * 2]);
+			EXPECT_EQ(1000, out[j * 2 + 1]);
+		}
+	}
+}
+
+// How the output is split into calls and how much input is ready at a time
+// must not change the output.
+TEST(Resampler, SincChunking)
+{
+	static const u32 ratios[] = { 0xaaaa, 0x10000, 0x10400 };
+	const u32 total_frames = 2000;
+
+	for (u32 ratio : ratios)
+	{
+		srand(ratio);
+		std::vector<short> input(total_frames * 2 * 2);
+		for (auto& sample : input)
+			sample = (short)(rand() & 0xffff);
+
+		// Everything at once
+		std::vector<short> ref_out(total_frames * 2);
+		{
+			std::unique_ptr<SincResampler> resampler(new SincResampler);
+			u32 written = 0;
+			u32 pos = 0;
+			short ring[RING_FRAMES * 2];
+			u32 index = 0, end = 0;
+			while (written < total_frames)
+			{
+				while (((end - index) & RING_MASK) / 2 < RING_FRAMES - 1)
+				{
+					ring[end & RING_MASK] = input[pos++];
+					ring[(end + 1) & RING_MASK] = input[pos++];
+					end += 2;
+				}
+				unsigned int done = resampler->Resample(ring, RING_MASK, index, end, &ref_out[written * 2], total_frames - written, ratio);
+				ASSERT_NE(0u, done);
+				written += done;
+			}
+		}
+
+		// Random calls with a random amount of input ready
+		std::vector<short> out(total_frames * 2);
+		{
+			std::unique_ptr<SincResampler> resampler(new SincResampler);
+			u32 written = 0;
+			u32 pos = 0;
+			short ring[RING_FRAMES * 2];
+			u32 index = 0, end = 0;
+			while (written < total_frames)
+			{
+				u32 fill = rand() % (RING_FRAMES - ((end - index) & RING_MASK) / 2);
+				for (u32 i = 0; i < fill; ++i)
+				{
+					ring[end & RING_MASK] = input[pos++];
+					ring[(end + 1) & RING_MASK] = input[pos++];
+					end += 2;
+				}
+				unsigned int num = std::min<u32>(rand() % 100, total_frames - written);
+				written += resampler->Resample(ring, RING_MASK, index, end, &out[written * 2], num, ratio);
+			}
+		}
+
+		for (u32 j = 0; j < total_frames * 2; ++j)
+			ASSERT_EQ(ref_out[j], out[j]) << "ratio " << ratio << ", sample " << j;
+	}
+}
+
+TEST(Resampler, SincUnderrun)
+{
+	short ring[RING_FRAMES * 2] = {};
+	SincResampler resampler;
+	u32 index = 10;
+	short out[16 * 2];
+
+	// Nothing to read
+	EXPECT_EQ(0u, resampler.Resample(ring, RING_MASK, index, 10, out, 16, 0x10000));
+	EXPECT_EQ(10u, index);
+
+	// Not enough for a single output frame yet
+	EXPECT_EQ(0u, resampler.Resample(ring, RING_MASK, index, 10 + (SINC_TAPS - 1) * 2, out, 16, 0x10000));
+	EXPECT_EQ(10u + (SINC_TAPS - 1) * 2, index);
+	EXPECT_EQ((unsigned int)SINC_TAPS - 1, resampler.GetDelay());
+	EXPECT_EQ(1u, resampler.Resample(ring, RING_MASK, index, 10 + SINC_TAPS * 2, out, 16, 0x10000));
+}
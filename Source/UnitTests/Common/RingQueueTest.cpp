@@ -0,0 +1,110 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/RingQueue.h"
+
+TEST(RingQueue, Simple)
+{
+	Common::RingQueue<u32, 4> q;
+
+	EXPECT_TRUE(q.Empty());
+	EXPECT_EQ(0u, q.Size());
+
+	for (u32 i = 0; i < 4; ++i)
+		EXPECT_TRUE(q.Push(i));
+	EXPECT_FALSE(q.Push(4u));
+	EXPECT_EQ(4u, q.Size());
+
+	EXPECT_EQ(0u, q.Front());
+	q.Pop();
+
+	u32 v;
+	for (u32 i = 1; i < 4; ++i)
+	{
+		EXPECT_TRUE(q.Pop(v));
+		EXPECT_EQ(i, v);
+	}
+	EXPECT_FALSE(q.Pop(v));
+	EXPECT_TRUE(q.Empty());
+
+	// wrap around
+	for (u32 i = 0; i < 10; ++i)
+	{
+		EXPECT_TRUE(q.Push(i));
+		EXPECT_TRUE(q.Pop(v));
+		EXPECT_EQ(i, v);
+	}
+
+	q.Push(1u);
+	q.Clear();
+	EXPECT_TRUE(q.Empty());
+}
+
+TEST(RingQueue, Bulk)
+{
+	Common::RingQueue<u32, 8> q;
+	u32 in[12];
+	u32 out[12];
+	for (u32 i = 0; i < 12; ++i)
+		in[i] = i;
+
+	EXPECT_EQ(5u, q.PushBulk(in, 5));
+	EXPECT_EQ(3u, q.PushBulk(in + 5, 7));
+	EXPECT_EQ(0u, q.PushBulk(in + 8, 4));
+
+	EXPECT_EQ(6u, q.PopBulk(out, 6));
+	EXPECT_EQ(4u, q.PushBulk(in + 8, 4));
+	EXPECT_EQ(6u, q.PopBulk(out + 6, 12));
+	EXPECT_EQ(0u, q.PopBulk(out, 12));
+
+	for (u32 i = 0; i < 12; ++i)
+		EXPECT_EQ(i, out[i]);
+}
+
+TEST(RingQueue, MultiThreaded)
+{
+	const u32 count = 100000;
+	const u32 num_producers = 3;
+	Common::RingQueue<u32, 256, true> q;
+
+	std::vector<std::thread> producers;
+	for (u32 p = 0; p < num_producers; ++p)
+	{
+		producers.push_back(std::thread([&q, p, count]() {
+			for (u32 i = 0; i < count; ++i)
+			{
+				while (!q.Push(p << 24 | i))
+					std::this_thread::yield();
+			}
+		}));
+	}
+
+	// every producer's values have to arrive in order
+	std::vector<u32> next(num_producers, 0);
+	u32 received = 0;
+	u32 v;
+	while (received < count * num_producers)
+	{
+		if (!q.Pop(v))
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		u32 p = v >> 24;
+		ASSERT_LT(p, num_producers);
+		EXPECT_EQ(next[p], v & 0xFFFFFF);
+		next[p] = (v & 0xFFFFFF) + 1;
+		++received;
+	}
+
+	for (auto& thread : producers)
+		thread.join();
+	EXPECT_TRUE(q.Empty());
+}
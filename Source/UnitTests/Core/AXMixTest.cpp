@@ -0,0 +1,357 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/HW/DSPHLE/UCodes/UCode_AX_Mix.h"
+
+#define AX_GC
+#include "Core/HW/DSPHLE/UCodes/UCode_AX_Voice.h"
+
+// The voice code reads sample data through the ARAM interface, back it with a
+// small buffer instead of the emulated hardware.
+static u8 s_aram[0x10000];
+
+u8 DSP::ReadARAM(u32 address)
+{
+	return s_aram[address & (sizeof(s_aram) - 1)];
+}
+
+// The scalar versions AX HLE used before the kernels were vectorized
+static void ReferenceMixAdd(int* out, const s16* input, u32 count, u16& volume, u16 volume_delta, s16* dpop)
+{
+	for (u32 i = 0; i < count; ++i)
+	{
+		s64 sample = input[i];
+		sample *= volume;
+		sample >>= 15;
+
+		out[i] += (s16)sample;
+		volume += volume_delta;
+
+		*dpop = (s16)sample;
+	}
+}
+
+static void ReferenceApplyVolume(s16* samples, u32 count, u16& volume, u16 volume_delta)
+{
+	for (u32 i = 0; i < count; ++i)
+	{
+		samples[i] = ((s32)samples[i] * volume) >> 15;
+		volume += volume_delta;
+	}
+}
+
+static s16 RandomSample(u32 i)
+{
+	// include the extremes, they are the interesting cases for the truncation
+	switch (i % 7)
+	{
+	case 0: return -0x8000;
+	case 1: return 0x7FFF;
+	default: return (s16)(rand() & 0xFFFF);
+	}
+}
+
+static const u16 s_volumes[] = { 0, 1, 0x7FFF, 0x8000, 0xFFFF, 0x1234, 0xFFF0 };
+static const u16 s_deltas[] = { 0, 1, 0xFFFF, 0x100, 0xFF00, 0x2345 };
+
+TEST(AXMix, MixAddIsBitExact)
+{
+	srand(1);
+	for (u32 count = 0; count <= 100; ++count)
+	{
+		for (u16 start_volume : s_volumes)
+		{
+			for (u16 delta : s_deltas)
+			{
+				std::vector<s16> input(count);
+				std::vector<int> out(count), expected_out(count);
+				for (u32 i = 0; i < count; ++i)
+				{
+					input[i] = RandomSample(i);
+					out[i] = expected_out[i] = rand() - RAND_MAX / 2;
+				}
+
+				u16 volume = start_volume, expected_volume = start_volume;
+				s16 dpop = 0x55, expected_dpop = 0x55;
+				AXMix::MixAdd(out.data(), input.data(), count, volume, delta, &dpop);
+				ReferenceMixAdd(expected_out.data(), input.data(), count, expected_volume, delta, &expected_dpop);
+
+				EXPECT_EQ(expected_out, out);
+				EXPECT_EQ(expected_volume, volume);
+				EXPECT_EQ(expected_dpop, dpop);
+			}
+		}
+	}
+}
+
+TEST(AXMix, ApplyVolumeIsBitExact)
+{
+	srand(2);
+	for (u32 count = 0; count <= 100; ++count)
+	{
+		for (u16 start_volume : s_volumes)
+		{
+			for (u16 delta : s_deltas)
+			{
+				std::vector<s16> samples(count);
+				for (u32 i = 0; i < count; ++i)
+					samples[i] = RandomSample(i);
+				std::vector<s16> expected = samples;
+
+				u16 volume = start_volume, expected_volume = start_volume;
+				AXMix::ApplyVolume(samples.data(), count, volume, delta);
+				ReferenceApplyVolume(expected.data(), count, expected_volume, delta);
+
+				EXPECT_EQ(expected, samples);
+				EXPECT_EQ(expected_volume, volume);
+			}
+		}
+	}
+}
+
+// The per-sample accelerator AX HLE used before voices were decoded in blocks
+static u16 ReferenceGetSample()
+{
+	u16 ret;
+
+	if ((*acc_cur_addr & ~1) == (acc_end_addr & ~1))
+	{
+		*acc_cur_addr = acc_loop_addr;
+
+		if (acc_pb->audio_addr.looping)
+		{
+			acc_pb->adpcm.pred_scale = acc_pb->adpcm_loop_info.pred_scale;
+			if (!acc_pb->is_stream)
+			{
+				acc_pb->adpcm.yn1 = acc_pb->adpcm_loop_info.yn1;
+				acc_pb->adpcm.yn2 = acc_pb->adpcm_loop_info.yn2;
+			}
+		}
+		else
+		{
+			acc_pb->running = 0;
+		}
+	}
+
+	if (acc_end_reached)
+		return 0;
+
+	switch (acc_pb->audio_addr.sample_format)
+	{
+		case 0x00:
+		{
+			if ((*acc_cur_addr & 15) == 0)
+			{
+				acc_pb->adpcm.pred_scale = DSP::ReadARAM((*acc_cur_addr & ~15) >> 1);
+				*acc_cur_addr += 2;
+			}
+
+			int scale = 1 << (acc_pb->adpcm.pred_scale & 0xF);
+			int coef_idx = (acc_pb->adpcm.pred_scale >> 4) & 0x7;
+
+			s32 coef1 = acc_pb->adpcm.coefs[coef_idx * 2 + 0];
+			s32 coef2 = acc_pb->adpcm.coefs[coef_idx * 2 + 1];
+
+			int temp = (*acc_cur_addr & 1) ?
+					(DSP::ReadARAM(*acc_cur_addr >> 1) & 0xF) :
+					(DSP::ReadARAM(*acc_cur_addr >> 1) >> 4);
+
+			if (temp >= 8)
+				temp -= 16;
+
+			int val = (scale * temp) + ((0x400 + coef1 * acc_pb->adpcm.yn1 + coef2 * acc_pb->adpcm.yn2) >> 11);
+			MathUtil::Clamp(&val, -0x7FFF, 0x7FFF);
+
+			acc_pb->adpcm.yn2 = acc_pb->adpcm.yn1;
+			acc_pb->adpcm.yn1 = val;
+			*acc_cur_addr += 1;
+			ret = val;
+			break;
+		}
+
+		case 0x0A:
+			ret = (DSP::ReadARAM(*acc_cur_addr * 2) << 8) | DSP::ReadARAM(*acc_cur_addr * 2 + 1);
+			acc_pb->adpcm.yn2 = acc_pb->adpcm.yn1;
+			acc_pb->adpcm.yn1 = ret;
+			*acc_cur_addr += 1;
+			break;
+
+		case 0x19:
+			ret = DSP::ReadARAM(*acc_cur_addr) << 8;
+			acc_pb->adpcm.yn2 = acc_pb->adpcm.yn1;
+			acc_pb->adpcm.yn1 = ret;
+			*acc_cur_addr += 1;
+			break;
+
+		default:
+			return 0;
+	}
+
+	return ret;
+}
+
+// GetInputSamples as it was before, also returns how many samples were read
+static u32 ReferenceGetInputSamples(AXPB& pb, s16* samples, u16 count)
+{
+	u32 cur_addr = HILO_TO_32(pb.audio_addr.cur_addr);
+	AcceleratorSetup(&pb, &cur_addr);
+
+	u32 read = 0;
+	u32 curr_pos = ResampleAudio([&read](u32) { ++read; return ReferenceGetSample(); },
+	                             samples, count, pb.src.last_samples,
+	                             pb.src.cur_addr_frac, HILO_TO_32(pb.src.ratio),
+	                             pb.src_type, NULL);
+	pb.src.cur_addr_frac = (curr_pos & 0xFFFF);
+
+	pb.audio_addr.cur_addr_hi = (u16)(cur_addr >> 16);
+	pb.audio_addr.cur_addr_lo = (u16)(cur_addr & 0xFFFF);
+	return read;
+}
+
+static void FillARAM(u32 seed)
+{
+	srand(seed);
+	for (u8& b : s_aram)
+		b = rand() & 0xFF;
+}
+
+// Sets up a voice which crosses its end address after <before_end> samples
+static void SetupVoice(AXPB& pb, u16 format, bool looping, u32 before_end, u32 ratio, u16 src_type)
+{
+	memset(&pb, 0, sizeof(pb));
+	pb.running = 1;
+	pb.src_type = src_type;
+	pb.audio_addr.sample_format = format;
+	pb.audio_addr.looping = looping;
+
+	// ADPCM addresses count nibbles and skip the header byte of each 8 byte frame
+	u32 loop_addr = format == 0x00 ? 0x102 : 0x100;
+	u32 cur_addr = format == 0x00 ? 0x4002 : 0x4000;
+	u32 end_addr = format == 0x00 ? cur_addr + before_end + 2 * (before_end / 14) : cur_addr + before_end;
+	pb.audio_addr.loop_addr_hi = loop_addr >> 16;
+	pb.audio_addr.loop_addr_lo = loop_addr & 0xFFFF;
+	pb.audio_addr.end_addr_hi = end_addr >> 16;
+	pb.audio_addr.end_addr_lo = end_addr & 0xFFFF;
+	pb.audio_addr.cur_addr_hi = cur_addr >> 16;
+	pb.audio_addr.cur_addr_lo = cur_addr & 0xFFFF;
+
+	for (s16& coef : pb.adpcm.coefs)
+		coef = (s16)(rand() & 0xFFFF) >> 4;
+	pb.adpcm.pred_scale = rand() & 0x7F;
+	pb.adpcm.yn1 = rand() & 0xFFFF;
+	pb.adpcm.yn2 = rand() & 0xFFFF;
+	pb.adpcm_loop_info.pred_scale = rand() & 0x7F;
+	pb.adpcm_loop_info.yn1 = rand() & 0xFFFF;
+	pb.adpcm_loop_info.yn2 = rand() & 0xFFFF;
+
+	pb.src.ratio_hi = ratio >> 16;
+	pb.src.ratio_lo = ratio & 0xFFFF;
+	pb.src.cur_addr_frac = rand() & 0xFFFF;
+	for (s16& last : pb.src.last_samples)
+		last = rand() & 0xFFFF;
+}
+
+static const u16 s_formats[] = { 0x00, 0x0A, 0x19 };
+static const u32 s_ratios[] = { 0x10000, 0x8000, 0x18000, 0x2A5A5, 0x3FFFF, 0x40000, 0x200 };
+
+TEST(AXVoice, DecodeSamplesIsBitExact)
+{
+	FillARAM(3);
+	for (u16 format : s_formats)
+	{
+		for (u32 looping = 0; looping < 2; ++looping)
+		{
+			// crosses the end address at the start, in the middle and at the end of a block
+			for (u32 before_end : { 1u, 100u, 255u, 256u, 300u })
+			{
+				AXPB pb, expected_pb;
+				SetupVoice(pb, format, looping != 0, before_end, 0x10000, SRCTYPE_LINEAR);
+				expected_pb = pb;
+
+				const u32 count = 700;
+				s16 samples[count], expected[count];
+
+				u32 cur_addr = HILO_TO_32(expected_pb.audio_addr.cur_addr);
+				AcceleratorSetup(&expected_pb, &cur_addr);
+				for (u32 i = 0; i < count; ++i)
+					expected[i] = ReferenceGetSample();
+				u32 expected_addr = cur_addr;
+
+				cur_addr = HILO_TO_32(pb.audio_addr.cur_addr);
+				AcceleratorSetup(&pb, &cur_addr);
+				for (u32 i = 0; i < count; i += 128)
+					AcceleratorGetSamples(samples + i, std::min<u32>(128, count - i));
+
+				EXPECT_EQ(0, memcmp(expected, samples, sizeof(samples))) << "format " << format << " before_end " << before_end;
+				EXPECT_EQ(expected_addr, cur_addr);
+				EXPECT_EQ(0, memcmp(&expected_pb, &pb, sizeof(pb)));
+			}
+		}
+	}
+}
+
+TEST(AXVoice, ResampleInputCountIsExact)
+{
+	srand(4);
+	for (u32 ratio : s_ratios)
+	{
+		for (u32 count = 1; count <= 96; ++count)
+		{
+			for (u32 frac : { 0u, 1u, 0x8000u, 0xFFFFu, (u32)rand() & 0xFFFF })
+			{
+				for (int src_type : { SRCTYPE_POLYPHASE, SRCTYPE_LINEAR, SRCTYPE_NEAREST })
+				{
+					s16 output[96];
+					s16 last_samples[4] = {};
+					u32 read = 0;
+					ResampleAudio([&read](u32) { ++read; return (s16)0; },
+					              output, count, last_samples, frac, ratio, src_type, NULL);
+					EXPECT_EQ(read, ResampleInputCount(count, frac, ratio, src_type));
+				}
+			}
+		}
+	}
+}
+
+TEST(AXVoice, GetInputSamplesIsBitExact)
+{
+	FillARAM(5);
+	for (u16 format : s_formats)
+	{
+		for (u32 looping = 0; looping < 2; ++looping)
+		{
+			for (u32 ratio : s_ratios)
+			{
+				for (u16 src_type : { SRCTYPE_LINEAR, SRCTYPE_NEAREST })
+				{
+					// at up to 4 input samples per output, 96 samples read more than one block
+					AXPB pb, expected_pb;
+					SetupVoice(pb, format, looping != 0, 150, ratio, src_type);
+					expected_pb = pb;
+
+					for (u32 frame = 0; frame < 8; ++frame)
+					{
+						const u16 count = 96;
+						s16 samples[count], expected[count];
+
+						u32 bound = ResampleInputCount(count, pb.src.cur_addr_frac, HILO_TO_32(pb.src.ratio), pb.src_type);
+						GetInputSamples(pb, samples, count, NULL);
+						u32 read = ReferenceGetInputSamples(expected_pb, expected, count);
+
+						EXPECT_EQ(bound, read);
+						EXPECT_EQ(0, memcmp(expected, samples, sizeof(samples))) << "format " << format << " ratio " << ratio << " frame " << frame;
+						EXPECT_EQ(0, memcmp(&expected_pb, &pb, sizeof(pb)));
+					}
+				}
+			}
+		}
+	}
+}
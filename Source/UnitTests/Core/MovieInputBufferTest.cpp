@@ -0,0 +1,162 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Core/MovieInputBuffer.h"
+
+using Movie::InputBuffer;
+
+static std::vector<u8> RandomData(size_t size)
+{
+	std::vector<u8> data(size);
+	for (u8& byte : data)
+		byte = (u8)rand();
+	return data;
+}
+
+static std::vector<u8> ReadAll(const InputBuffer& buffer)
+{
+	std::vector<u8> data((size_t)buffer.GetSize());
+	EXPECT_TRUE(buffer.Read(0, data.data(), data.size()));
+	return data;
+}
+
+static std::vector<u8> ReadFile(const std::string& filename)
+{
+	File::IOFile file(filename, "rb");
+	std::vector<u8> data((size_t)file.GetSize());
+	file.ReadBytes(data.data(), data.size());
+	return data;
+}
+
+TEST(MovieInputBuffer, AppendReadWriteTruncate)
+{
+	srand(1);
+	std::vector<u8> expected;
+	InputBuffer buffer;
+
+	// Odd sizes, so writes straddle chunks
+	for (int i = 0; i < 100; i++)
+	{
+		std::vector<u8> data = RandomData(rand() % 1000 + 1);
+		buffer.Append(data.data(), data.size());
+		expected.insert(expected.end(), data.begin(), data.end());
+	}
+	EXPECT_EQ(expected, ReadAll(buffer));
+
+	u8 byte;
+	EXPECT_FALSE(buffer.Read(buffer.GetSize(), &byte, 1));
+
+	std::vector<u8> patch = RandomData(InputBuffer::CHUNK_SIZE + 10);
+	buffer.Write(InputBuffer::CHUNK_SIZE - 5, patch.data(), patch.size());
+	std::copy(patch.begin(), patch.end(), expected.begin() + InputBuffer::CHUNK_SIZE - 5);
+	EXPECT_EQ(expected, ReadAll(buffer));
+
+	// Writing past the end appends
+	buffer.Write(expected.size() - 3, patch.data(), patch.size());
+	expected.resize(expected.size() - 3);
+	expected.insert(expected.end(), patch.begin(), patch.end());
+	EXPECT_EQ(expected, ReadAll(buffer));
+
+	buffer.Truncate(InputBuffer::CHUNK_SIZE * 2 + 7);
+	expected.resize(InputBuffer::CHUNK_SIZE * 2 + 7);
+	EXPECT_EQ(expected, ReadAll(buffer));
+
+	buffer.Append(patch.data(), patch.size());
+	expected.insert(expected.end(), patch.begin(), patch.end());
+	EXPECT_EQ(expected, ReadAll(buffer));
+
+	buffer.Clear();
+	EXPECT_TRUE(buffer.IsEmpty());
+}
+
+TEST(MovieInputBuffer, LoadFromFile)
+{
+	const std::string filename = "MovieInputBufferTest.bin";
+	srand(2);
+	std::vector<u8> contents = RandomData(InputBuffer::CHUNK_SIZE * 3 + 100);
+	{
+		File::IOFile file(filename, "wb");
+		file.WriteBytes(contents.data(), contents.size());
+	}
+
+	InputBuffer buffer;
+	std::vector<u8> prefix(contents.begin(), contents.begin() + InputBuffer::CHUNK_SIZE + 1);
+	prefix.push_back(contents[prefix.size()] ^ 1);
+	prefix.resize(InputBuffer::CHUNK_SIZE * 5, 0xcc);
+	buffer.Append(prefix.data(), prefix.size());
+
+	File::IOFile file(filename, "rb");
+	EXPECT_TRUE(buffer.LoadFromFile(file, contents.size()));
+	EXPECT_EQ(contents, ReadAll(buffer));
+
+	// Asking for more than there is keeps what could be read
+	file.Seek(0, SEEK_SET);
+	EXPECT_FALSE(buffer.LoadFromFile(file, contents.size() + 1));
+	EXPECT_EQ(contents.size() - contents.size() % InputBuffer::CHUNK_SIZE, buffer.GetSize());
+
+	file.Close();
+	File::Delete(filename);
+}
+
+TEST(MovieInputBuffer, Streaming)
+{
+	const std::string filename = "MovieInputBufferTest.dtm";
+	srand(3);
+	std::vector<u8> header = RandomData(256);
+	std::vector<u8> expected = RandomData(1000);
+	InputBuffer buffer;
+	buffer.Append(expected.data(), expected.size());
+
+	ASSERT_TRUE(buffer.StartStreaming(filename, header.data(), header.size()));
+	EXPECT_TRUE(buffer.IsStreaming());
+
+	// Many small appends and some rewinds, like recording with state loads
+	// in between
+	for (int i = 0; i < 2000; i++)
+	{
+		if (i % 300 == 299)
+		{
+			size_t size = expected.size() - rand() % std::min<size_t>(expected.size(), InputBuffer::CHUNK_SIZE * 2);
+			buffer.Truncate(size);
+			expected.resize(size);
+		}
+		else if (i % 500 == 0)
+		{
+			std::vector<u8> data = RandomData(300);
+			size_t offset = expected.size() / 2;
+			buffer.Write(offset, data.data(), data.size());
+			std::copy(data.begin(), data.end(), expected.begin() + offset);
+		}
+		std::vector<u8> data = RandomData(rand() % 200 + 1);
+		buffer.Append(data.data(), data.size());
+		expected.insert(expected.end(), data.begin(), data.end());
+	}
+
+	header = RandomData(256);
+	buffer.SetStreamHeader(header.data(), header.size());
+	buffer.StopStreaming();
+	EXPECT_FALSE(buffer.IsStreaming());
+	EXPECT_EQ(expected, ReadAll(buffer));
+
+	std::vector<u8> file = ReadFile(filename);
+	ASSERT_EQ(header.size() + expected.size(), file.size());
+	EXPECT_TRUE(std::equal(header.begin(), header.end(), file.begin()));
+	EXPECT_TRUE(std::equal(expected.begin(), expected.end(), file.begin() + header.size()));
+
+	// A shorter movie leaves nothing of the previous one behind
+	buffer.Truncate(InputBuffer::CHUNK_SIZE + 3);
+	ASSERT_TRUE(buffer.StartStreaming(filename, header.data(), header.size()));
+	buffer.StopStreaming();
+	EXPECT_EQ(header.size() + InputBuffer::CHUNK_SIZE + 3, ReadFile(filename).size());
+
+	File::Delete(filename);
+}
@@ -0,0 +1,118 @@
+// Copyright 2014 Dolphin Emulator Project
+// Licensed under GPLv2
+// Refer to the license.txt file included.
+
+#include <cstdlib>
+#include <vector>
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/NetPlayInput.h"
+
+// Sends the batch through the wire format and reads it back
+static std::vector<NetInputState> ReadBatch(NetInputReader& reader, const NetInputWriter& writer)
+{
+	std::vector<char> wire;
+	SerializePacket(writer.GetPacket(), wire);
+	EXPECT_EQ(4 + writer.GetPacket().GetDataSize(), wire.size());
+
+	sf::Packet packet;
+	packet.Append(wire.data() + 4, wire.size() - 4);
+	MessageId mid;
+	packet >> mid;
+	EXPECT_EQ(NP_MSG_INPUT_DATA, mid);
+
+	std::vector<NetInputState> states;
+	NetInputState state;
+	while (!packet.EndOfPacket())
+	{
+		EXPECT_TRUE(reader.Read(packet, state));
+		states.push_back(state);
+	}
+	return states;
+}
+
+TEST(NetPlayInput, RoundTrip)
+{
+	srand(1);
+	NetInputWriter writer;
+	NetInputReader reader;
+	u32 hi = 0x00808080, lo = 0x80800000;
+	NetWiimote nw(21, 0x80);
+
+	for (int batch = 0; batch < 100; batch++)
+	{
+		// Repeats, small changes, big changes and Wii Remote reports that
+		// change size
+		std::vector<NetInputState> expected;
+		for (int poll = 0; poll < 4; poll++)
+		{
+			if (rand() % 2)
+				hi ^= 1 << (rand() % 32);
+			if (rand() % 8 == 0)
+				lo = (u32)rand();
+			for (u8& byte : nw)
+			{
+				if (rand() % 4 == 0)
+					byte = (u8)rand();
+			}
+			if (rand() % 16 == 0)
+				nw.resize(rand() % 24);
+
+			writer.AddPad(poll % 2, hi, lo);
+			writer.AddWiimote(3, nw);
+
+			NetInputState pad = { (PadMapping)(poll % 2), false, hi, lo, NetWiimote() };
+			NetInputState wiimote = { 3, true, 0, 0, nw };
+			expected.push_back(pad);
+			expected.push_back(wiimote);
+		}
+		EXPECT_EQ(4u, writer.GetPolls());
+
+		std::vector<NetInputState> states = ReadBatch(reader, writer);
+		writer.Clear();
+		ASSERT_EQ(expected.size(), states.size());
+		for (size_t i = 0; i < states.size(); i++)
+		{
+			EXPECT_EQ(expected[i].map, states[i].map);
+			EXPECT_EQ(expected[i].is_wiimote, states[i].is_wiimote);
+			if (expected[i].is_wiimote)
+			{
+				EXPECT_EQ(expected[i].wiimote, states[i].wiimote);
+			}
+			else
+			{
+				EXPECT_EQ(expected[i].pad_hi, states[i].pad_hi);
+				EXPECT_EQ(expected[i].pad_lo, states[i].pad_lo);
+			}
+		}
+	}
+}
+
+TEST(NetPlayInput, Malformed)
+{
+	NetInputWriter writer;
+	writer.AddPad(0, 1, 2);
+	writer.AddPad(0, 1, 2);
+	writer.AddPad(0, 1, 3);
+
+	// The first state has to be sent in full after a reset
+	NetInputReader reader;
+	EXPECT_EQ(3u, ReadBatch(reader, writer).size());
+	writer.Clear();
+	writer.AddPad(0, 1, 4);
+	NetInputReader fresh;
+	sf::Packet packet = writer.GetPacket();
+	MessageId mid;
+	packet >> mid;
+	NetInputState state;
+	EXPECT_FALSE(fresh.Read(packet, state));
+
+	// Truncated
+	writer.Reset();
+	writer.AddPad(0, 1, 2);
+	sf::Packet truncated;
+	truncated.Append(writer.GetPacket().GetData(), writer.GetPacket().GetDataSize() - 1);
+	truncated >> mid;
+	EXPECT_FALSE(fresh.Read(truncated, state));
+}